@@ -7,7 +7,8 @@ namespace editor {
 
 class CameraSystem : public saturn::systems::System {
 public:
-    void startup(ph::VulkanContext&, saturn::Scene& scene) override;
+    void startup(ph::VulkanContext*, saturn::Scene& scene) override;
+    void declare_access(saturn::ecs::system_access& access) override;
     void update(saturn::FrameContext& ctx) override;
 };
 
@@ -19,8 +19,9 @@ class EditorSystem : public saturn::systems::System {
 public:
     EditorSystem(LogWindow* log_window);
 
-    void startup(ph::VulkanContext& ctx, saturn::Scene& scene) override;
+    void startup(ph::VulkanContext* ctx, saturn::Scene& scene) override;
     void update(saturn::FrameContext& ctx) override;
+    void declare_access(saturn::ecs::system_access& access) override;
 private:
     LogWindow* log_window;
     Inspector inspector;
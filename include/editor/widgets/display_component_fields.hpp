@@ -10,6 +10,7 @@
 #include <saturn/components/name.hpp>
 #include <editor/components/editor_camera.hpp>
 #include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
 #include <samples/components/rotator.hpp>
 
 namespace editor {
@@ -23,6 +24,7 @@ void display_component_fields(saturn::components::PointLight& component);
 void display_component_fields(saturn::components::Name& component);
 void display_component_fields(saturn::components::EditorCamera& component);
 void display_component_fields(saturn::components::Transform& component);
+void display_component_fields(saturn::components::WorldTransform& component);
 void display_component_fields(saturn::components::Rotator& component);
 
 }
@@ -4,6 +4,7 @@
 #include <string_view>
 
 #include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
 
 #include <saturn/utility/handle.hpp>
 #include <saturn/utility/color.hpp>
@@ -19,6 +20,7 @@ public:
     void operator()(std::string_view name, float* value);
     void operator()(std::string_view name, glm::vec3* value);
     void operator()(std::string_view name, saturn::color3* value);
+    void operator()(std::string_view name, glm::mat4* value);
     void operator()(std::string_view name, saturn::ecs::entity_t* value);
 
     void operator()(std::string_view name, saturn::Handle<ph::Mesh>* value);
@@ -0,0 +1,34 @@
+#ifndef SATURN_EDITOR_PROFILER_WIDGET_HPP_
+#define SATURN_EDITOR_PROFILER_WIDGET_HPP_
+
+#include <editor/widgets/widget.hpp>
+
+#include <saturn/utility/profiler.hpp>
+
+#include <stl/vector.hpp>
+
+namespace editor {
+
+// Shows the average time of every profiler zone and a graph of recent frame times
+class ProfilerWidget : public Widget {
+public:
+    void show(saturn::FrameContext& ctx) override;
+
+private:
+    void refresh();
+
+    // Capturing copies all ring buffers, so the statistics are only refreshed a few times per second
+    float time_since_refresh = 0.0f;
+
+    stl::vector<saturn::ProfileZone> zones;
+    stl::vector<stl::uint64_t> frame_starts;
+    stl::vector<stl::uint64_t> frame_allocations;
+    stl::vector<saturn::ZoneSummary> summaries;
+    stl::vector<float> frame_times;
+    float max_frame_time = 0.0f;
+    float allocations_per_frame = 0.0f;
+};
+
+}
+
+#endif
@@ -7,6 +7,8 @@ namespace editor {
 
 class Widget {
 public:
+    virtual ~Widget() = default;
+
     virtual void show(saturn::FrameContext& ctx) = 0;
     
     bool* get_shown_pointer() { return &shown; }
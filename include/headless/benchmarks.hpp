@@ -0,0 +1,44 @@
+#ifndef SATURN_HEADLESS_BENCHMARKS_HPP_
+#define SATURN_HEADLESS_BENCHMARKS_HPP_
+
+#include <stl/types.hpp>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace headless {
+
+// Benchmarks run by SaturnHeadless --benchmark-*. They print their timings to stdout and return the exit code of the
+// program. Inputs are generated from a fixed seed, so runs on the same machine are comparable.
+
+// Times reading an OBJ file with the native parser and with Assimp, and prints the throughput of both
+int benchmark_obj(fs::path const& path);
+
+// Times iterating the Transform, StaticMesh, MeshRenderer view over [count] entities, half of which have a mesh,
+// against iterating the owning group of the same types
+int benchmark_groups(stl::size_t count);
+
+// Times a kernel over the Transform view of [count] entities in a serial loop and with par_each on pools of 1 thread
+// up to the number of hardware threads, and checks that every run gives the same result as the serial loop
+int benchmark_parallel(stl::size_t count);
+
+// Adds [count] textures under generated paths, then times loading them by path again, which must return the handles
+// they were added with, and getting each one and its path. Also times getting all of [count] materials.
+int benchmark_assets(stl::size_t count);
+
+// Writes a text mesh of [triangle_count] random triangles, converts it to a binary mesh, and times reading both
+// including going over their vertices once. Checks that both contain the same vertices and indices.
+int benchmark_mesh_load(stl::size_t triangle_count);
+
+// Times inserting 10k, 100k and 1M random boxes into an AABBTree, moving them, and frustum, ray,
+// sphere and box queries against testing every box. Checks that the tree finds the same entities as brute force.
+int benchmark_aabb_tree();
+
+// Times the scalar and the SSE kernel of the rotator systems over the Transform, Rotator group of [count] entities.
+// Requires a build with SATURN_BUILD_SAMPLES.
+int benchmark_rotator(stl::size_t count);
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef SATURN_HEADLESS_CHECKS_HPP_
+#define SATURN_HEADLESS_CHECKS_HPP_
+
+namespace headless {
+
+// Self checks run by SaturnHeadless --check-*. They compare an optimized engine path against a brute force
+// reference on generated inputs, print a summary to stdout and return the exit code of the program: 0 if the
+// results agree, 1 otherwise. Inputs are generated from a fixed seed, so a failure reproduces.
+
+// Compares FrustumCuller against testing every object's bounds against the frustum planes one by one, and checks
+// that no culled object has a point inside the frustum.
+int check_culling();
+
+// Tests every light against every cluster with an exact sphere to froxel distance, and checks that LightClusters
+// lists the light in each cluster it reaches. Lights listed in clusters they don't reach are counted but allowed,
+// since lights are binned by the box around their sphere.
+int check_light_clusters();
+
+// Moves objects with generated LOD chains away from the camera and back, and compares select_lod against the
+// coarsest level whose projected error fits the limit. Also checks that levels only get coarser moving away and
+// finer moving closer, that switching to a coarser level leaves the hysteresis margin, and that jittering around
+// a switch distance doesn't flicker between two levels.
+int check_lod();
+
+// Sorts generated draw keys with radix_sort and compares the order with std::stable_sort, with keys that make it skip
+// passes for bytes shared by all keys and end after an odd amount of passes. Remaps generated frames of draws with
+// DrawKeyRemap and checks that build_batches merges exactly the runs of equal material and mesh, and that the
+// restored batches hold the original ids. Also checks that the remap refuses one material more than a key holds.
+int check_batching();
+
+// Generates a few hundred meshes, textures and models, some of them missing or broken, and loads them all
+// asynchronously while running frames through a FramePipeline, which finishes loads within the frame budget. Checks
+// that handles resolve to the default assets until their load finishes, that every callback runs once, and that the
+// handles end up resolving to the loaded assets, or keep resolving to the defaults if the load failed. Entities
+// spawned by load callbacks must get a WorldTransform and a draw in the render scene.
+int check_async_loads();
+
+// Imports a generated OBJ model through the asset cache and checks that re-imports hit the cache, and that changing
+// the model or its material libraries, adding a library that was missing, using a different importer key, and
+// corrupting or deleting the entry all make the next import miss it. Every import must equal importing the files
+// without the cache. Also checks that the Assimp importer records the material libraries it reads.
+int check_asset_cache();
+
+}
+
+#endif
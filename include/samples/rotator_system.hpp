@@ -7,6 +7,7 @@ namespace samples {
 
 class RotatorSystem : public saturn::systems::System {
 public:
+    void declare_access(saturn::ecs::system_access& access) override;
     void update(saturn::FrameContext& ctx) override;
 };
 
@@ -0,0 +1,28 @@
+#ifndef SATURN_SAMPLE_SIMD_ROTATOR_SYSTEM_HPP_
+#define SATURN_SAMPLE_SIMD_ROTATOR_SYSTEM_HPP_
+
+#include <saturn/systems/system.hpp>
+#include <saturn/utility/span.hpp>
+#include <saturn/components/transform.hpp>
+#include <samples/components/rotator.hpp>
+
+namespace samples {
+
+// Same as RotatorSystem, but written as an SSE kernel over the chunks of the Transform, Rotator group, where both
+// arrays are packed in the same order. Register either this one or RotatorSystem, not both.
+class SimdRotatorSystem : public saturn::systems::System {
+public:
+    void declare_access(saturn::ecs::system_access& access) override;
+    void update(saturn::FrameContext& ctx) override;
+};
+
+// The kernels of the rotator systems. Element i of both spans belongs to the same entity.
+void rotate_scalar(saturn::Span<saturn::components::Transform> transforms,
+    saturn::Span<saturn::components::Rotator> rotators);
+// Falls back to rotate_scalar on targets without SSE
+void rotate_simd(saturn::Span<saturn::components::Transform> transforms,
+    saturn::Span<saturn::components::Rotator> rotators);
+
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SATURN_ASSET_CACHE_HPP_
+#define SATURN_ASSET_CACHE_HPP_
+
+#include <saturn/assets/import_data.hpp>
+
+#include <stl/types.hpp>
+
+#include <filesystem>
+#include <optional>
+
+namespace fs = std::filesystem;
+
+namespace saturn::assets {
+
+// The asset cache stores the output of the importers on disk, so later runs load it instead of importing the source
+// again. An entry is only used if it was made by the same importer version and settings, summed up in an importer
+// key, from the same source contents. Entries also record the other files an import read, like material
+// libraries, and are outdated once one of those changes.
+// Every source has one entry file, named after a hash of its path. Outdated entries are replaced when the source
+// is imported again, so the cache doesn't grow with every edit.
+// The cached files are compared by size and write time first, and only hashed when those changed. Touching a file
+// without changing it keeps its entry valid.
+
+struct AssetCacheStats {
+    // Lookups that returned a cached import
+    stl::uint64_t hits = 0;
+    // Lookups that found no entry
+    stl::uint64_t misses = 0;
+    // Lookups that found an outdated or unreadable entry
+    stl::uint64_t invalidations = 0;
+    // Entries written, and entries that couldn't be written
+    stl::uint64_t stores = 0;
+    stl::uint64_t failed_stores = 0;
+    stl::uint64_t bytes_read = 0;
+    stl::uint64_t bytes_written = 0;
+};
+
+// An empty directory disables the cache. Defaults to data/cache. Only change it while no assets are loading.
+void set_asset_cache_directory(fs::path const& directory);
+
+fs::path const& get_asset_cache_directory();
+
+// Counted since the start of the program or the last reset
+AssetCacheStats get_asset_cache_stats();
+
+void reset_asset_cache_stats();
+
+// 64 bit hash of a block of memory, for building importer keys. Stable across runs.
+stl::uint64_t hash_bytes(void const* data, stl::size_t size, stl::uint64_t seed = 0);
+
+// The functions below are safe to call from any thread.
+
+// Returns nothing on a miss. Meshes of the returned model point into the mapped entry instead of being copied out
+// of it, their levels of detail and the material table are copied. Textures are not part of model entries.
+std::optional<ImportedModel> read_cached_model(fs::path const& source, stl::uint64_t importer_key);
+
+// Stores a model imported from source, with ImportedModel::dependencies as the other files the import read.
+// Returns false if the cache is disabled or the entry couldn't be written.
+bool write_cached_model(fs::path const& source, stl::uint64_t importer_key, ImportedModel const& model);
+
+std::optional<ImportedTexture> read_cached_texture(fs::path const& source, stl::uint64_t importer_key);
+
+bool write_cached_texture(fs::path const& source, stl::uint64_t importer_key, ImportedTexture const& texture);
+
+} // namespace saturn::assets
+
+#endif
@@ -3,13 +3,17 @@
 
 #include <saturn/utility/handle.hpp>
 #include <saturn/utility/context.hpp>
+#include <saturn/utility/bounds.hpp>
+#include <saturn/utility/span.hpp>
 
 #include <saturn/assets/model.hpp>
+#include <saturn/assets/import_data.hpp>
 
 #include <phobos/forward.hpp>
 
 #include <stl/vector.hpp>
 #include <filesystem>
+#include <functional>
 #include <string_view>
 
 #include <saturn/ecs/entity.hpp>
@@ -18,21 +22,90 @@ namespace fs = std::filesystem;
 
 namespace saturn::assets {
 
+// ASYNC LOADING
+
+// The load_*_async functions return a handle right away, and read and decode the asset on a loader thread. Until
+// the asset is ready, its getters return the default asset of its type, or nullptr if there is none. GPU resources
+// are created on the main thread in finish_async_loads(), which FramePipeline calls at the start of every frame.
+enum class LoadState {
+    Loading,
+    Ready,
+    // The handle keeps resolving to the default asset
+    Failed
+};
+
+// Called on the main thread once an asynchronous load finished. Check get_load_state() to see whether it succeeded.
+template<typename T>
+using LoadCallback = std::function<void(Handle<T>)>;
+
+// Finishes loads whose CPU side is done: creates GPU resources, stores the assets and runs their callbacks.
+// Stops once budget_ms has passed, the remaining loads are finished in later calls. Main thread only.
+void finish_async_loads(Context& ctx, float budget_ms);
+
+// Blocks until all asynchronous loads are finished, including the ones started by callbacks while waiting
+void wait_for_async_loads(Context& ctx);
+
+// Asynchronous loads that weren't finished yet
+stl::size_t get_pending_load_count();
+
+// Counts loads that finished or failed. Caches of asset pointers compare it with the last value they saw, to know
+// when assets they found loading may have changed.
+stl::uint64_t get_finished_load_count();
+
 // MESH
 
-// Takes ownership of given mesh and returns a handle to it
-Handle<ph::Mesh> take_mesh(ph::Mesh& mesh, std::string_view name);
+// One level of detail of a mesh
+struct MeshLod {
+    Handle<ph::Mesh> mesh;
+    // Geometric error compared to the full resolution mesh, in mesh units
+    float error = 0.0f;
+};
+
+// Takes ownership of given mesh and returns a handle to it. Bounds are the local space bounds of the vertices.
+Handle<ph::Mesh> take_mesh(ph::Mesh& mesh, std::string_view name, Bounds const& bounds);
 
+// Files with the .smesh extension are read as binary meshes, anything else as a text mesh
 Handle<ph::Mesh> load_mesh(Context& ctx, fs::path const& path);
 
+// If the path is already loaded or loading, on_done is called right away or when that load finishes
+Handle<ph::Mesh> load_mesh_async(Context& ctx, fs::path const& path, LoadCallback<ph::Mesh> on_done = {});
+
+LoadState get_load_state(Handle<ph::Mesh> handle);
+
+// Returned by get_mesh() for meshes that are loading or failed to load
+void set_default_mesh(Handle<ph::Mesh> handle);
+
 ph::Mesh* get_mesh(Handle<ph::Mesh> handle);
 
 fs::path const& get_mesh_path(Handle<ph::Mesh> handle);
 
+// Returns nullptr if the handle is invalid
+Bounds const* get_mesh_bounds(Handle<ph::Mesh> handle);
+
+// Adds lod as the next coarser level of detail of mesh. Levels must be added in order of increasing error,
+// before the mesh is used in a scene, since render scenes keep the span returned by get_mesh_lods().
+void add_mesh_lod(Handle<ph::Mesh> mesh, Handle<ph::Mesh> lod, float error);
+
+// Levels of detail of a mesh, ordered by increasing error. Level 0 is the mesh itself. Empty if the handle is invalid.
+Span<MeshLod const> get_mesh_lods(Handle<ph::Mesh> handle);
+
 // TEXTURE
 
 Handle<ph::Texture> load_texture(Context& ctx, fs::path const& path);
 
+// If the path is already loaded or loading, on_done is called right away or when that load finishes
+Handle<ph::Texture> load_texture_async(Context& ctx, fs::path const& path, LoadCallback<ph::Texture> on_done = {});
+
+// Creates a texture from decoded pixels and stores it under path. If path is already loaded, the pixels are dropped
+// and the loaded texture is returned. Used by importers that decode textures as part of a bigger asset.
+Handle<ph::Texture> take_texture(Context& ctx, ImportedTexture const& texture, fs::path const& path);
+
+LoadState get_load_state(Handle<ph::Texture> handle);
+
+// Returned by get_texture() for textures that are loading or failed to load. Materials keep the pointer they got
+// from get_texture(), so don't create materials from textures that are still loading.
+void set_default_texture(Handle<ph::Texture> handle);
+
 ph::Texture* get_texture(Handle<ph::Texture> handle);
 
 fs::path const& get_texture_path(Handle<ph::Texture> handle);
@@ -43,6 +116,12 @@ Handle<Model> load_model(ecs::entity_t root, Context& ctx, fs::path const& path)
 
 Handle<Model> load_model(Context& ctx, fs::path const& path);
 
+// The blueprint root of the model is created right away. Its meshes are added below it once the model is loaded.
+// If the path is already loaded or loading, on_done is called right away or when that load finishes.
+Handle<Model> load_model_async(Context& ctx, fs::path const& path, LoadCallback<Model> on_done = {});
+
+LoadState get_load_state(Handle<Model> handle);
+
 Model* get_model(Handle<Model> handle);
 
 fs::path const& get_model_path(Handle<Model> handle);
@@ -57,8 +136,13 @@ ph::Material* get_material(Handle<ph::Material> handle);
 
 fs::path const& get_material_path(Handle<ph::Material> handle);
 
-stl::vector<ph::Material*> get_all_materials();
+// Indexed by material handle id. The array is cached and only rebuilt after materials were added.
+Span<ph::Material* const> get_all_materials();
+
+// Materials are never unloaded, so a change in count means new materials were added
+stl::size_t get_material_count();
 
+// Destroys the GPU resources of all assets and invalidates all handles
 void destroy_all_assets();
 
 }
@@ -0,0 +1,90 @@
+#ifndef SATURN_ASSETS_IMPORT_DATA_HPP_
+#define SATURN_ASSETS_IMPORT_DATA_HPP_
+
+#include <saturn/utility/bounds.hpp>
+#include <saturn/utility/mapped_file.hpp>
+#include <saturn/utility/span.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace saturn::assets {
+
+// Output of the CPU side of importing. The importers' read functions produce these without touching the scene, the
+// asset storages or the GPU, so they can run on any thread. Turning them into assets happens on the main thread.
+
+struct ImportedMeshLod {
+    stl::vector<float> vertices;
+    stl::vector<stl::uint32_t> indices;
+    // Geometric error compared to the full resolution mesh, in mesh units
+    float error = 0.0f;
+};
+
+struct ImportedMesh {
+    std::string name;
+    // Interleaved vertices of vertex_size floats, with the position first
+    stl::size_t vertex_size = 0;
+    stl::vector<float> vertices;
+    stl::vector<stl::uint32_t> indices;
+    // Meshes read from a binary mesh file aren't copied out of it. Their vertices and indices point into the
+    // mapped file instead, and the vectors above stay empty.
+    std::shared_ptr<MappedFile const> mapping;
+    Span<float const> mapped_vertices;
+    Span<stl::uint32_t const> mapped_indices;
+    Bounds bounds;
+    // Simplified versions of the mesh, in order of increasing error
+    stl::vector<ImportedMeshLod> lods;
+    // Index into ImportedModel::materials. Unused for meshes that aren't part of a model.
+    stl::uint32_t material = 0;
+
+    Span<float const> vertex_data() const {
+        if (mapping) { return mapped_vertices; }
+        return Span<float const>(vertices.data(), vertices.size());
+    }
+
+    Span<stl::uint32_t const> index_data() const {
+        if (mapping) { return mapped_indices; }
+        return Span<stl::uint32_t const>(indices.data(), indices.size());
+    }
+};
+
+// Decoded RGBA8 image
+struct ImportedTexture {
+    stl::uint32_t width = 0;
+    stl::uint32_t height = 0;
+    stl::vector<stl::uint8_t> pixels;
+};
+
+struct ImportedMaterial {
+    std::string name;
+    // Empty if the material has no diffuse texture
+    fs::path texture_path;
+    // Empty if there is no texture, or if it couldn't be decoded
+    ImportedTexture texture;
+};
+
+struct ImportedNode {
+    // Index into ImportedModel::meshes, or -1 for nodes without a mesh
+    stl::int64_t mesh = -1;
+    stl::vector<stl::size_t> children;
+};
+
+struct ImportedModel {
+    stl::vector<ImportedMesh> meshes;
+    stl::vector<ImportedMaterial> materials;
+    // Node 0 is the root
+    stl::vector<ImportedNode> nodes;
+    // Files besides the model file that the import read, like material libraries. Also lists files that were
+    // referenced but missing, since adding them changes the import.
+    stl::vector<fs::path> dependencies;
+};
+
+} // namespace saturn::assets
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SATURN_BINARY_MESH_IMPORTER_HPP_
+#define SATURN_BINARY_MESH_IMPORTER_HPP_
+
+#include <saturn/assets/import_data.hpp>
+
+#include <stl/types.hpp>
+
+#include <filesystem>
+#include <optional>
+
+namespace fs = std::filesystem;
+
+namespace saturn::assets::importers {
+
+// Binary mesh files (.smesh) store a mesh the way it's uploaded, so loading it is mapping the file and pointing the
+// mesh create info at it. Values are stored in native byte order, which is little endian on all supported
+// platforms. The file consists of
+//  - a BinaryMeshHeader
+//  - header.attribute_count BinaryMeshAttributes describing the interleaved vertex layout, position first
+//  - the vertices as floats, starting at header.vertex_offset
+//  - the indices as uint32s, starting at header.index_offset
+// Both offsets are multiples of binary_mesh_alignment.
+
+inline constexpr char binary_mesh_magic[4] = { 'S', 'M', 'S', 'H' };
+// Bump when the layout changes. Files of other versions are rejected.
+inline constexpr stl::uint32_t binary_mesh_version = 1;
+inline constexpr stl::size_t binary_mesh_alignment = 16;
+inline constexpr char const* binary_mesh_extension = ".smesh";
+
+enum class VertexAttribute : stl::uint32_t {
+    Position = 0,
+    Normal = 1,
+    TexCoord = 2,
+    // Anything the engine doesn't interpret, like the extra values of a text mesh
+    Custom = 3
+};
+
+struct BinaryMeshAttribute {
+    VertexAttribute attribute;
+    // Number of floats
+    stl::uint32_t components;
+};
+
+struct BinaryMeshHeader {
+    char magic[4];
+    stl::uint32_t version;
+    // Floats per vertex, the sum of the attribute components
+    stl::uint32_t vertex_size;
+    stl::uint32_t attribute_count;
+    stl::uint64_t vertex_count;
+    stl::uint64_t index_count;
+    // Byte offsets from the start of the file
+    stl::uint64_t vertex_offset;
+    stl::uint64_t index_offset;
+    // Bounds, so they don't have to be computed from the vertices when loading
+    float bounds_center[3];
+    float bounds_extents[3];
+    float bounds_radius;
+    stl::uint32_t reserved;
+};
+
+static_assert(sizeof(BinaryMeshAttribute) == 8);
+static_assert(sizeof(BinaryMeshHeader) % binary_mesh_alignment == 0);
+
+// Maps a binary mesh file. The returned mesh references the mapping instead of copying the data.
+// Safe to call from any thread. Returns nothing if the file is missing, truncated or of a different version.
+std::optional<ImportedMesh> read_binary_mesh(fs::path const& path);
+
+// Writes a mesh as a binary mesh file. Meshes of 8 floats per vertex are assumed to be position, normal and
+// texture coordinates like the ones the OBJ importer creates. Other meshes are stored as a position and a custom
+// attribute. Returns false if the file can't be written.
+bool write_binary_mesh(ImportedMesh const& mesh, fs::path const& path);
+
+// Converts a text mesh or every mesh of a model file to binary mesh files. A model with several meshes is written to
+// one file per mesh, named after the destination with the mesh index appended.
+// Returns the number of files written, 0 if the source couldn't be read.
+stl::size_t convert_to_binary_mesh(fs::path const& source, fs::path const& destination);
+
+}
+
+#endif
@@ -2,7 +2,9 @@
 #define SATURN_OBJ_IMPORTER_HPP_
 
 #include <saturn/assets/model.hpp>
+#include <saturn/assets/import_data.hpp>
 #include <saturn/utility/context.hpp>
+#include <saturn/utility/thread_pool.hpp>
 
 #include <saturn/ecs/entity.hpp>
 
@@ -11,6 +13,24 @@ namespace fs = std::filesystem;
 
 namespace saturn::assets::importers {
 
+// Reads a model, generates levels of detail for its meshes and decodes its textures, using pool for the parts that
+// run in parallel. OBJ files are read with parse_obj, other formats with Assimp. Models and textures found in the
+// asset cache skip their importers, and ones that weren't are stored there. Safe to call from any thread.
+// Throws std::runtime_error if the file can't be imported.
+ImportedModel read_obj_model(fs::path const& path, ThreadPool& pool = ThreadPool::get_default());
+
+// Reads a model with Assimp, without generating levels of detail or decoding textures.
+// Throws std::runtime_error if the file can't be imported.
+ImportedModel read_assimp_model(fs::path const& path);
+
+// Creates the blueprint entity a model is imported into
+Model create_model_root(Context& ctx, fs::path const& path);
+
+// Creates the meshes, textures and materials of a read model, and puts the meshes on the blueprint entities below
+// model.blueprint. With existing_tree, those entities already exist, for example because the blueprints were
+// loaded from a file. Otherwise they are created.
+void create_model(Context& ctx, ImportedModel const& imported, Model model, bool existing_tree);
+
 // Imports a model into an existing entity tree
 Model import_obj_model(ecs::entity_t root, Context& ctx, fs::path const& path);
 Model import_obj_model(Context& ctx, fs::path const& path);
@@ -0,0 +1,26 @@
+#ifndef SATURN_OBJ_PARSER_HPP_
+#define SATURN_OBJ_PARSER_HPP_
+
+#include <saturn/assets/import_data.hpp>
+#include <saturn/utility/thread_pool.hpp>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace saturn::assets::importers {
+
+// Parses a Wavefront OBJ file and the MTL files it references, using pool to parse and weld in parallel.
+// The file is memory mapped and split into line aligned chunks that are parsed independently. Polygons are
+// triangulated as fans, and corners with the same position, texture coordinate and normal are welded into one vertex.
+// Corners without a normal get the flat normal of their triangle and aren't welded with corners of other triangles,
+// which gives the same shading as aiProcess_GenNormals in the Assimp importer.
+// The result has the structure the Assimp importer produces: node 0 is the root, with one child node per object
+// or group, holding the object's first mesh. Objects get one mesh per material. Material 0 is a default material,
+// followed by the materials of the MTL files.
+// Textures are not decoded and no LODs are generated. Throws std::runtime_error if the file can't be parsed.
+ImportedModel parse_obj(fs::path const& path, ThreadPool& pool);
+
+}
+
+#endif
@@ -1,9 +1,8 @@
 #ifndef SATURN_SIMPLE_MESH_IMPORTER_HPP_
 #define SATURN_SIMPLE_MESH_IMPORTER_HPP_
 
-#include <saturn/utility/context.hpp>
+#include <saturn/assets/import_data.hpp>
 
-#include <phobos/forward.hpp>
 #include <filesystem>
 
 #include <optional>
@@ -14,7 +13,8 @@ namespace saturn {
 
 namespace assets::importers {
 
-std::optional<ph::Mesh> import_simple_mesh(Context& ctx, fs::path const& path);
+// Reads the vertices of a mesh file. Safe to call from any thread.
+std::optional<ImportedMesh> read_simple_mesh(fs::path const& path);
 
 }
 
@@ -1,16 +1,21 @@
 #ifndef SATURN_STB_TEXTURE_IMPORT_HPP_
 #define SATURN_STB_TEXTURE_IMPORT_HPP_
 
-#include <phobos/forward.hpp>
-#include <saturn/utility/context.hpp>
+#include <saturn/assets/import_data.hpp>
 
 #include <filesystem>
+#include <optional>
 
 namespace fs = std::filesystem;
 
 namespace saturn::assets::importers {
 
-ph::Texture import_with_stb(Context& ctx, fs::path const& path);
+// Decodes an image to RGBA8. Safe to call from any thread. Returns nothing if the image can't be decoded.
+std::optional<ImportedTexture> read_with_stb(fs::path const& path);
+
+// Same as read_with_stb, but takes the texture from the asset cache if it was decoded before, and stores it there
+// otherwise
+std::optional<ImportedTexture> read_texture(fs::path const& path);
 
 }
 
@@ -0,0 +1,62 @@
+#ifndef SATURN_ASSETS_MESH_LOD_HPP_
+#define SATURN_ASSETS_MESH_LOD_HPP_
+
+#include <saturn/utility/span.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn::assets {
+
+// Interleaved vertices with the position in the first 3 floats of every vertex
+struct MeshData {
+    float const* vertices = nullptr;
+    stl::size_t vertex_count = 0;
+    stl::size_t vertex_size = 0;
+};
+
+struct SimplifySettings {
+    // Stop once the mesh has at most this many indices
+    stl::size_t target_index_count = 0;
+    // Stop before a collapse would cause more error than this, relative to the radius of the mesh
+    float max_error = 0.05f;
+    // Weight of every float after the position. Attributes are compared as if positions were scaled to a unit sphere,
+    // so a weight of 1 makes an attribute difference of 1 as bad as moving the vertex by the radius of the mesh.
+    // Missing weights are 0.
+    Span<float const> attribute_weights;
+};
+
+// Simplifies a triangle list by collapsing edges in order of their quadric error. The quadrics measure the distance
+// in position and weighted attribute space, so collapses along UV seams and normal creases are expensive. Vertices on
+// borders (including seams, where vertices are split) are never moved. The result indexes the original vertices.
+// Returns the largest error of all collapses in mesh units, or 0 if nothing was collapsed.
+float simplify_mesh(MeshData const& mesh, Span<stl::uint32_t const> indices, SimplifySettings const& settings,
+    stl::vector<stl::uint32_t>& result);
+
+struct LodChainSettings {
+    // Maximum amount of levels after the full resolution mesh
+    stl::size_t max_levels = 4;
+    // Every level targets this fraction of the indices of the previous level
+    float reduction = 0.5f;
+    // Maximum error of a single level, relative to the radius of the mesh
+    float max_error = 0.05f;
+    Span<float const> attribute_weights;
+};
+
+struct MeshLodData {
+    stl::vector<stl::uint32_t> indices;
+    // Error relative to the full resolution mesh, in mesh units
+    float error = 0.0f;
+};
+
+// Generates increasingly simplified index lists, each one simplified from the previous one. Stops early when a level
+// can't remove at least 10% of the triangles. The full resolution mesh is not part of the result.
+stl::vector<MeshLodData> generate_lod_chain(MeshData const& mesh, Span<stl::uint32_t const> indices, 
+    LodChainSettings const& settings);
+
+// Copies the vertices referenced by indices into a new vertex list, and rewrites indices to point into it
+void compact_vertices(MeshData const& mesh, stl::vector<stl::uint32_t>& indices, stl::vector<float>& vertices);
+
+} // namespace saturn::assets
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SATURN_ASSETS_RENDER_RESOURCES_HPP_
+#define SATURN_ASSETS_RENDER_RESOURCES_HPP_
+
+#include <saturn/utility/context.hpp>
+#include <saturn/assets/import_data.hpp>
+
+#include <phobos/renderer/mesh.hpp>
+#include <phobos/renderer/texture.hpp>
+
+namespace saturn::assets {
+
+// Importers create their GPU resources through these. Without a Vulkan context, as in headless runs, nothing is
+// uploaded and an empty resource is returned, so assets still get handles, bounds and levels of detail.
+ph::Mesh create_mesh(Context const& ctx, ph::Mesh::CreateInfo const& info);
+ph::Texture create_texture(Context const& ctx, ph::Texture::CreateInfo const& info);
+
+// Same as above, from the output of an importer's read function
+ph::Mesh create_mesh(Context const& ctx, ImportedMesh const& mesh);
+ph::Mesh create_mesh(Context const& ctx, ImportedMeshLod const& lod, stl::size_t vertex_size);
+ph::Texture create_texture(Context const& ctx, ImportedTexture const& texture);
+
+} // namespace saturn::assets
+
+#endif
@@ -31,6 +31,8 @@ struct ComponentMeta {
     std::string name;
     std::string unscoped_name;
     std::vector<Field> fields;
+    // False for components marked [[serialize::ignore]], they are left out of saved scenes
+    bool serialized = true;
 };
 
 struct VisitResult {
@@ -6,6 +6,8 @@
 namespace saturn::codegen {
 
 void generate_meta_files(VisitResult const& data);
+// Generates constexpr component type ids and the total component count
+void generate_component_ids(VisitResult const& data);
 
 }
 
@@ -0,0 +1,21 @@
+#ifndef SATURN_COMPONENT_WORLD_TRANSFORM_HPP_
+#define SATURN_COMPONENT_WORLD_TRANSFORM_HPP_
+
+#include <glm/mat4x4.hpp>
+
+namespace saturn {
+
+namespace components {
+
+// Cached local to world matrix. Kept up to date by TransformSystem from the Transform of the entity
+// and the WorldTransform of its parent, so don't write to it directly. It isn't saved with the scene,
+// TransformSystem computes it again after loading.
+struct [[component, serialize::ignore]] WorldTransform {
+    glm::mat4 matrix = glm::mat4(1.0f);
+};
+
+} // namespace components
+
+} // namespace saturn
+
+#endif
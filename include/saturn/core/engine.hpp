@@ -4,6 +4,7 @@
 #include <phobos/forward.hpp>
 
 #include <saturn/ecs/system_manager.hpp>
+#include <saturn/core/frame_pipeline.hpp>
 
 namespace saturn {
 
@@ -19,12 +20,18 @@ public:
     ecs::system_manager& get_systems() {
         return systems;
     }
+
+    // Pipelining and the simulation tick rate. Must be set before run().
+    void set_frame_settings(FrameSettings const& settings) {
+        frame_settings = settings;
+    }
     
 private:
     ph::WindowContext* window_context;
     ph::VulkanContext* vulkan_context;
 
     ecs::system_manager systems;
+    FrameSettings frame_settings;
 };
 
 } // namespace saturn
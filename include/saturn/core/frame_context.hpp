@@ -3,6 +3,7 @@
 
 #include <saturn/scene/scene.hpp>
 #include <saturn/ecs/registry.hpp>
+#include <saturn/utility/frame_arena.hpp>
 #include <phobos/present/frame_info.hpp>
 
 #include <phobos/forward.hpp>
@@ -10,11 +11,16 @@
 namespace saturn {
 
 struct FrameContext {
+    // Null in headless runs
     ph::VulkanContext* vulkan;
     Scene& scene;
     ecs::registry& ecs;
-    ph::FrameInfo& render_info;
+    // Null in headless runs
+    ph::FrameInfo* render_info;
     float delta_time = 0;
+    // Memory for temporaries that only live until the end of the frame. Null when the caller has no arena, so use
+    // ArenaAllocator, which falls back to the heap.
+    FrameArena* arena = nullptr;
 };  
 
 }
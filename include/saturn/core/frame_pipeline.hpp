@@ -0,0 +1,140 @@
+#ifndef SATURN_FRAME_PIPELINE_HPP_
+#define SATURN_FRAME_PIPELINE_HPP_
+
+#include <saturn/core/frame_context.hpp>
+#include <saturn/ecs/system_manager.hpp>
+#include <saturn/systems/transform_system.hpp>
+
+#include <phobos/renderer/render_graph.hpp>
+
+#include <stl/types.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace saturn {
+
+struct FrameSettings {
+    // Prepare the render graph on a separate thread while the next frame is simulated. Adds a frame of latency.
+    bool pipelined = false;
+    // Simulation ticks per second. 0 runs one tick per frame with the measured frame time.
+    float tick_rate = 0.0f;
+    // Upper bound for the ticks of one frame, so a slow frame doesn't make the next one slower still
+    stl::uint32_t max_ticks_per_frame = 4;
+    // Place transforms, lights and the camera between the last two ticks. Only used with a tick rate.
+    bool interpolate = true;
+    // Main thread time per frame for finishing asynchronous asset loads, see assets::finish_async_loads()
+    float asset_load_budget_ms = 2.0f;
+};
+
+// Decides how many simulation ticks each frame runs, and where the frame lies between the ticks that were rendered
+class SimulationClock {
+public:
+    explicit SimulationClock(float tick_rate = 0.0f, stl::uint32_t max_ticks_per_frame = 4);
+
+    bool is_fixed() const {
+        return tick_delta_time > 0.0f;
+    }
+
+    // Adds the time of a frame and returns how many ticks to run for it. Always 1 without a fixed tick rate.
+    stl::uint32_t advance(float frame_time);
+
+    // Time step of a single tick. Without a fixed tick rate this is the time of the last frame.
+    float get_tick_delta() const {
+        return is_fixed() ? tick_delta_time : last_frame_time;
+    }
+
+    // Called when the render state was synced after running ticks
+    void on_sync();
+
+    // Position of the current frame between the render states of the last two syncs. The frame is drawn one tick
+    // behind the simulation, so it can be interpolated. Always 1 without a fixed tick rate.
+    float get_alpha() const;
+
+private:
+    float tick_delta_time;
+    stl::uint32_t max_ticks;
+    float last_frame_time = 0.0f;
+
+    // Time not yet simulated, always less than a tick
+    double accumulator = 0.0;
+    double simulated_time = 0.0;
+    double synced_time = 0.0;
+    double previous_synced_time = 0.0;
+};
+
+// Runs the simulation and render graph construction of a frame. Without pipelining, both happen on the calling thread.
+// With pipelining, the graph is prepared on a worker thread while the calling thread simulates the next frame.
+// Only the render scene and the graph are touched by the worker, syncing them with the registry happens on the
+// calling thread in between.
+class FramePipeline {
+public:
+    static constexpr stl::size_t graph_count = 2;
+
+    FramePipeline(Scene& scene, ecs::system_manager& systems, systems::TransformSystem& transform_system, 
+        FrameSettings const& settings = {});
+    FramePipeline(FramePipeline const&) = delete;
+    FramePipeline& operator=(FramePipeline const&) = delete;
+    ~FramePipeline();
+
+    // Finishes asynchronous asset loads within the frame's budget, then runs the ticks the clock asks for, each
+    // followed by the transform system, and then the per frame systems. Without a fixed tick rate, all systems run
+    // once. The delta time of ctx is replaced by the tick delta.
+    void simulate(FrameContext const& ctx, float frame_time);
+
+    // Returns the graph to render this frame. With pipelining, this is the graph prepared during the previous frame,
+    // and the worker starts on the next one before this returns. The graph stays valid until the next call.
+    ph::RenderGraph& build_render_graph(float aspect_ratio);
+
+    // Waits until the worker is done. Call this before touching the render scene outside of the pipeline.
+    void finish();
+
+    // Both graphs are rendered in turn when pipelining, settings like the clear color have to be set on both
+    ph::RenderGraph& get_graph(stl::size_t index) {
+        return graphs[index];
+    }
+
+    SimulationClock const& get_clock() const {
+        return clock;
+    }
+
+    // Passed to systems through FrameContext::arena, and reset at the start of every frame
+    FrameArena const& get_frame_arena() const {
+        return arena;
+    }
+
+private:
+    void worker_main();
+    // Prepares the back graph on the worker
+    void start_prepare(float alpha);
+
+    Scene& scene;
+    ecs::system_manager& systems;
+    systems::TransformSystem& transform_system;
+    FrameSettings settings;
+    SimulationClock clock;
+    FrameArena arena;
+    // Ticks run since the last build_render_graph()
+    stl::uint32_t pending_ticks = 0;
+
+    ph::RenderGraph graphs[graph_count];
+    // Graph that is rendered, and the graph that is prepared for the next frame
+    stl::size_t front = 0;
+    stl::size_t back = 1;
+
+    // Set once the worker prepared its first graph
+    bool started = false;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake_worker;
+    std::condition_variable prepare_done;
+    bool preparing = false;
+    bool stop = false;
+    float prepare_alpha = 1.0f;
+};
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef SATURN_HEADLESS_ENGINE_HPP_
+#define SATURN_HEADLESS_ENGINE_HPP_
+
+#include <saturn/ecs/system_manager.hpp>
+#include <saturn/core/frame_pipeline.hpp>
+#include <saturn/assets/asset_cache.hpp>
+
+#include <phobos/renderer/render_graph.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+#include <atomic>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace saturn {
+
+// Takes the place of ph::Renderer when there is no GPU. Consumes the render graph like a renderer would
+// and keeps counts of what it would have drawn.
+class NullRenderer {
+public:
+    void render_frame(ph::RenderGraph const& graph);
+
+    stl::size_t get_draw_count() const {
+        return draw_count;
+    }
+
+    stl::size_t get_light_count() const {
+        return light_count;
+    }
+
+private:
+    stl::size_t draw_count = 0;
+    stl::size_t light_count = 0;
+};
+
+struct HeadlessSettings {
+    fs::path ecs_path = "data/ecs.json";
+    fs::path blueprints_path = "data/blueprints.json";
+
+    // Stop after this many frames. 0 means no frame limit.
+    stl::uint64_t max_frames = 0;
+    // Stop after this many seconds of wall clock time. 0 means no time limit.
+    double max_seconds = 0.0;
+
+    // Advance the simulation by fixed_delta_time every frame instead of by the measured frame time,
+    // which makes runs reproducible
+    bool fixed_timestep = true;
+    float fixed_delta_time = 1.0f / 60.0f;
+
+    // Used for the camera projection, since there is no render target
+    float aspect_ratio = 16.0f / 9.0f;
+
+    // Pipelining and the simulation tick rate. The frame time above drives the simulation clock.
+    FrameSettings frame;
+
+    // When not empty, the profiler zones of the run are written to this file as a Chrome trace
+    fs::path trace_path;
+
+    // Assets loaded asynchronously while the run starts, to measure loading next to the simulation. Directories are
+    // searched recursively for .obj models, .smesh meshes and .png, .jpg and .tga textures, other files are loaded
+    // as meshes. The run waits for all loads to finish before it returns.
+    stl::vector<fs::path> asset_paths;
+
+    // Directory of the asset cache. Empty disables the cache, which makes every run import its assets from source.
+    fs::path asset_cache_path = "data/cache";
+};
+
+struct HeadlessStats {
+    stl::uint64_t frames = 0;
+    double total_seconds = 0.0;
+    double min_frame_ms = 0.0;
+    double max_frame_ms = 0.0;
+    double average_frame_ms = 0.0;
+    // Heap allocations per frame, not counting the first frame which fills the caches. Always 0 when the
+    // engine is built without SATURN_COUNT_ALLOCATIONS.
+    double average_frame_allocations = 0.0;
+    stl::uint64_t max_frame_allocations = 0;
+    // Render graph contents of the last frame
+    stl::size_t draws = 0;
+    stl::size_t lights = 0;
+    // Asynchronous loads of HeadlessSettings::asset_paths
+    stl::size_t assets_loaded = 0;
+    stl::size_t assets_failed = 0;
+    // Time from the start of the run until the last asset load finished
+    double asset_load_seconds = 0.0;
+    // Asset cache use of the run, including the assets of the scene
+    assets::AssetCacheStats asset_cache;
+};
+
+// Runs the simulation without a window, Vulkan context or ImGui. Systems, scene loading and render graph construction
+// run like they do in Engine, but the graph goes to a NullRenderer. Used for performance runs and soak tests on
+// machines without a display or GPU.
+class HeadlessEngine {
+public:
+    explicit HeadlessEngine(HeadlessSettings const& settings = {});
+
+    // Systems added here must not depend on ImGui, input or a Vulkan context
+    ecs::system_manager& get_systems() {
+        return systems;
+    }
+
+    // Runs until a limit from the settings is reached or stop() is called. Without limits this runs until stopped.
+    HeadlessStats run();
+
+    // Makes run() return after the current frame. Safe to call from any thread.
+    void stop() {
+        stop_requested.store(true, std::memory_order_relaxed);
+    }
+
+private:
+    HeadlessSettings settings;
+    ecs::system_manager systems;
+    std::atomic<bool> stop_requested = false;
+};
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef SATURN_ECS_ARCHETYPE_HPP_
+#define SATURN_ECS_ARCHETYPE_HPP_
+
+#include <saturn/ecs/entity.hpp>
+#include <saturn/ecs/component_id.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+#include <new>
+#include <unordered_map>
+#include <utility>
+
+namespace saturn::ecs {
+
+// Type-erased information about a component type, needed to move components between archetypes.
+struct component_type_info {
+    stl::uint64_t id;
+    stl::size_t size;
+    stl::size_t alignment;
+    // Move constructs the component into dst and destroys the one at src
+    void (*relocate)(void* dst, void* src);
+    void (*destroy)(void* ptr);
+};
+
+template<typename T>
+component_type_info const* get_component_type_info() {
+    static component_type_info const info {
+        get_component_type_id<T>(),
+        sizeof(T),
+        alignof(T),
+        [](void* dst, void* src) {
+            new (dst) T(std::move(*static_cast<T*>(src)));
+            static_cast<T*>(src)->~T();
+        },
+        [](void* ptr) {
+            static_cast<T*>(ptr)->~T();
+        }
+    };
+    return &info;
+}
+
+// Table storing all entities that have exactly the same set of components. Rows are stored in fixed-size
+// chunks, each chunk holds the entity array followed by one array per component type (SoA).
+// Rows are kept packed: all chunks except the last one are always full.
+class archetype {
+public:
+    static constexpr stl::size_t chunk_bytes = 16 * 1024;
+    // Every column in a chunk starts on a cache line
+    static constexpr stl::size_t column_alignment = 64;
+    static constexpr stl::uint32_t npos = 0xFFFFFFFF;
+
+    // The types must be sorted by type id
+    explicit archetype(stl::vector<component_type_info const*> types);
+    archetype(archetype const&) = delete;
+    archetype& operator=(archetype const&) = delete;
+    ~archetype();
+
+    stl::vector<component_type_info const*> const& get_types() const {
+        return types;
+    }
+
+    // Returns the column index for this type id, or npos if this archetype doesn't have it.
+    stl::uint32_t column_of(stl::uint64_t type_id) const;
+
+    bool has_type(stl::uint64_t type_id) const {
+        return column_of(type_id) != npos;
+    }
+
+    // Adds an uninitialized row for this entity and returns its index. The caller must construct all components.
+    stl::uint32_t allocate_row(entity_t entity);
+    // Destroys the components in a row and fills the hole with the last row.
+    // Returns the entity that was moved into the row, or the removed entity if it was the last row.
+    entity_t remove_row(stl::uint32_t row);
+    // Same as remove_row, but assumes the components were already moved out.
+    entity_t remove_moved_row(stl::uint32_t row);
+
+    void* component_at(stl::uint32_t column, stl::uint32_t row) {
+        stl::uint32_t const chunk = row / chunk_capacity;
+        stl::uint32_t const offset = row % chunk_capacity;
+        return chunks[chunk] + column_offsets[column] + offset * types[column]->size;
+    }
+
+    entity_t entity_at(stl::uint32_t row) const {
+        return chunk_entities(row / chunk_capacity)[row % chunk_capacity];
+    }
+
+    stl::size_t size() const {
+        return row_count;
+    }
+
+    stl::size_t chunk_count() const {
+        return chunks.size();
+    }
+
+    stl::uint32_t get_chunk_capacity() const {
+        return chunk_capacity;
+    }
+
+    // Number of used rows in a chunk
+    stl::uint32_t chunk_size(stl::size_t chunk) const {
+        return chunk + 1 < chunk_count() ? chunk_capacity : row_count - chunk * chunk_capacity;
+    }
+
+    entity_t const* chunk_entities(stl::size_t chunk) const {
+        return reinterpret_cast<entity_t const*>(chunks[chunk]);
+    }
+
+    void* chunk_column(stl::size_t chunk, stl::uint32_t column) {
+        return chunks[chunk] + column_offsets[column];
+    }
+
+    // Archetypes reached by adding or removing a single component type from this one
+    std::unordered_map<stl::uint64_t, archetype*> add_edges;
+    std::unordered_map<stl::uint64_t, archetype*> remove_edges;
+
+private:
+    entity_t* chunk_entities(stl::size_t chunk) {
+        return reinterpret_cast<entity_t*>(chunks[chunk]);
+    }
+
+    void compute_layout();
+
+    stl::vector<component_type_info const*> types;
+    stl::vector<stl::size_t> column_offsets;
+    stl::vector<std::byte*> chunks;
+    stl::size_t bytes_per_chunk = chunk_bytes;
+    stl::uint32_t chunk_capacity = 0;
+    stl::uint32_t row_count = 0;
+};
+
+} // namespace saturn::ecs
+
+#endif
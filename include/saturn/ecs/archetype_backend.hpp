@@ -0,0 +1,159 @@
+#ifndef SATURN_ECS_ARCHETYPE_BACKEND_HPP_
+#define SATURN_ECS_ARCHETYPE_BACKEND_HPP_
+
+#include <saturn/ecs/archetype.hpp>
+#include <saturn/ecs/archetype_view.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/unique_ptr.hpp>
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace saturn::ecs {
+
+// Component storage backend that stores entities with the same set of components together in an archetype.
+// Adding or removing a component moves the entity to a different archetype.
+class archetype_backend {
+public:
+    archetype_backend();
+    archetype_backend(archetype_backend&&) = default;
+    archetype_backend& operator=(archetype_backend&&) = default;
+
+    template<typename T, typename... Args>
+    void add(entity_t entity, Args&&... args) {
+        component_type_info const* type = get_component_type_info<T>();
+        STL_ASSERT(!has<T>(entity), "Entity already has this component");
+
+        location& loc = get_location(entity);
+        archetype* target = find_add_target(loc.table, type);
+        stl::uint32_t const row = move_entity(entity, loc, target);
+        new (target->component_at(target->column_of(type->id), row)) T{std::forward<Args>(args) ...};
+        // Grow the tick table here so mark_changed never reallocates it while other threads stamp ticks.
+        change_table& table = change_tables[type->id];
+        stl::uint32_t const index = entity_index(entity);
+        if (table.enabled && index >= table.ticks.size()) {
+            table.ticks.resize(index + 1, 0);
+        }
+    }
+
+    template<typename T>
+    void remove(entity_t entity) {
+        if (!has<T>(entity)) { return; }
+
+        location& loc = get_location(entity);
+        stl::uint64_t const id = get_component_type_id<T>();
+        // Destroy the component first, move_entity only moves the components the target archetype has.
+        static_cast<T*>(loc.table->component_at(loc.table->column_of(id), loc.row))->~T();
+        archetype* target = find_remove_target(loc.table, id);
+        move_entity(entity, loc, target);
+    }
+
+    void remove_all(entity_t entity);
+
+    template<typename T>
+    bool has(entity_t entity) const {
+        location const* loc = find_location(entity);
+        return loc && loc->table->has_type(get_component_type_id<T>());
+    }
+
+    template<typename T>
+    T& get(entity_t entity) {
+        location const* loc = find_location(entity);
+        STL_ASSERT(loc, "Entity not in storage");
+        stl::uint32_t const column = loc->table->column_of(get_component_type_id<T>());
+        STL_ASSERT(column != archetype::npos, "Entity does not have this component");
+        return *static_cast<T*>(loc->table->component_at(column, loc->row));
+    }
+
+    template<typename T>
+    T const& get(entity_t entity) const {
+        return const_cast<archetype_backend*>(this)->get<T>(entity);
+    }
+
+    // Archetype rows move whenever a component is added or removed, so change ticks are kept in a
+    // table per component type indexed by entity index instead of next to the component data.
+    // The table is sized when a component is added, stamping a tick only writes to it.
+    template<typename T>
+    void enable_change_tracking(stl::uint64_t tick) {
+        change_table& table = change_tables[get_component_type_id<T>()];
+        if (table.enabled) { return; }
+        table.enabled = true;
+        table.ticks.clear();
+        table.ticks.resize(locations.size(), tick);
+    }
+
+    template<typename T>
+    void mark_changed(entity_t entity, stl::uint64_t tick) {
+        change_table& table = change_tables[get_component_type_id<T>()];
+        if (!table.enabled) { return; }
+        stl::uint32_t const index = entity_index(entity);
+        STL_ASSERT(index < table.ticks.size(), "Entity does not have this component");
+        table.ticks[index] = tick;
+    }
+
+    template<typename T>
+    bool changed_since(entity_t entity, stl::uint64_t tick) const {
+        change_table const& table = change_tables[get_component_type_id<T>()];
+        if (!table.enabled) { return true; }
+        stl::uint32_t const index = entity_index(entity);
+        return index < table.ticks.size() && table.ticks[index] > tick;
+    }
+
+    template<typename... Ts>
+    archetype_view<Ts...> view() {
+        return archetype_view<Ts...>(archetypes);
+    }
+
+    // Entities with the same components are already stored together, so a group is just a view.
+    template<typename... Ts>
+    archetype_view<Ts...> group() {
+        return view<Ts...>();
+    }
+
+private:
+    struct change_table {
+        bool enabled = false;
+        stl::vector<stl::uint64_t> ticks;
+    };
+
+    struct location {
+        entity_t entity = 0;
+        archetype* table = nullptr;
+        stl::uint32_t row = 0;
+    };
+
+    location* find_location(entity_t entity) {
+        stl::uint32_t const index = entity_index(entity);
+        if (index >= locations.size() || locations[index].table == nullptr || locations[index].entity != entity) {
+            return nullptr;
+        }
+        return &locations[index];
+    }
+
+    location const* find_location(entity_t entity) const {
+        return const_cast<archetype_backend*>(this)->find_location(entity);
+    }
+
+    // Returns the location of the entity, placing it in the empty archetype if it has no components yet.
+    location& get_location(entity_t entity);
+
+    archetype* find_add_target(archetype* source, component_type_info const* type);
+    archetype* find_remove_target(archetype* source, stl::uint64_t type_id);
+    archetype* find_or_create_archetype(stl::vector<component_type_info const*> types);
+
+    // Moves all components the target has from the current archetype of the entity to the target.
+    // Returns the new row. Components the target has but the source doesn't are left uninitialized.
+    stl::uint32_t move_entity(entity_t entity, location& loc, archetype* target);
+
+    // Index 0 is always the archetype without any components.
+    stl::vector<stl::unique_ptr<archetype>> archetypes;
+    // Indexed by entity index
+    stl::vector<location> locations;
+    std::array<change_table, component_type_count> change_tables;
+};
+
+} // namespace saturn::ecs
+
+#endif
@@ -0,0 +1,235 @@
+#ifndef SATURN_ECS_ARCHETYPE_VIEW_HPP_
+#define SATURN_ECS_ARCHETYPE_VIEW_HPP_
+
+#include <saturn/ecs/archetype.hpp>
+#include <saturn/ecs/system_access.hpp>
+#include <saturn/utility/thread_pool.hpp>
+#include <saturn/utility/span.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/assert.hpp>
+
+#include <array>
+#include <tuple>
+#include <utility>
+
+namespace saturn::ecs {
+
+// View over all archetypes containing at least the types Ts. Has the same interface as component_view,
+// but walks the chunk columns directly.
+template<typename... Ts>
+class archetype_view {
+private:
+    struct match {
+        archetype* table;
+        std::array<stl::uint32_t, sizeof...(Ts)> columns;
+    };
+
+public:
+    static_assert(sizeof...(Ts) > 0, "archetype_view must view at least one type.");
+
+    class iterator {
+    public:
+        iterator() = default;
+        // If single_chunk is true, the iterator stops at the end of the chunk it starts in
+        iterator(archetype_view* view, stl::size_t table, stl::size_t chunk, bool single_chunk = false)
+            : view(view), table(table), chunk(chunk), single_chunk(single_chunk) {
+            load_chunk();
+            if (!single_chunk) { skip_empty(); }
+        }
+
+        iterator(iterator const&) = default;
+
+        iterator& operator=(iterator const&) = default;
+
+        auto operator*() {
+            STL_ASSERT(row < rows_in_chunk, "Cannot dereference end iterator");
+            return std::tie(std::get<Ts*>(columns)[row] ...);
+        }
+
+        entity_t get_entity() const {
+            archetype const* current = view->matches[table].table;
+            return current->chunk_entities(chunk)[row];
+        }
+
+        iterator operator++() {
+            advance();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator copy = *this;
+            advance();
+            return copy;
+        }
+
+        bool operator==(iterator const& other) const {
+            return view == other.view && table == other.table && chunk == other.chunk && row == other.row;
+        }
+
+        bool operator!=(iterator const& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class archetype_view;
+
+        void advance() {
+            ++row;
+            if (row == rows_in_chunk && !single_chunk) {
+                ++chunk;
+                row = 0;
+                load_chunk();
+                skip_empty();
+            }
+        }
+
+        // Moves to the next chunk that has rows, or to the end position
+        void skip_empty() {
+            while (table < view->matches.size() && rows_in_chunk == 0) {
+                if (chunk + 1 < view->matches[table].table->chunk_count()) {
+                    ++chunk;
+                } else {
+                    ++table;
+                    chunk = 0;
+                }
+                load_chunk();
+            }
+            if (table >= view->matches.size()) {
+                table = view->matches.size();
+                chunk = 0;
+                row = 0;
+            }
+        }
+
+        void load_chunk() {
+            row = 0;
+            rows_in_chunk = 0;
+            if (table >= view->matches.size()) { return; }
+            match const& m = view->matches[table];
+            if (chunk >= m.table->chunk_count()) { return; }
+
+            rows_in_chunk = m.table->chunk_size(chunk);
+            load_columns(m, std::index_sequence_for<Ts...>{});
+        }
+
+        template<stl::size_t... Is>
+        void load_columns(match const& m, std::index_sequence<Is...>) {
+            ((std::get<Is>(columns) = static_cast<Ts*>(m.table->chunk_column(chunk, m.columns[Is]))), ...);
+        }
+
+        archetype_view* view = nullptr;
+        stl::size_t table = 0;
+        stl::size_t chunk = 0;
+        stl::uint32_t row = 0;
+        stl::uint32_t rows_in_chunk = 0;
+        bool single_chunk = false;
+        std::tuple<Ts* ...> columns;
+    };
+
+    // A single chunk of a single archetype
+    class range {
+    public:
+        range(iterator first, iterator last) : first(first), last(last) {}
+
+        iterator begin() const {
+            return first;
+        }
+
+        iterator end() const {
+            return last;
+        }
+
+    private:
+        iterator first;
+        iterator last;
+    };
+
+    // The archetypes must outlive the view
+    template<typename Archetypes>
+    explicit archetype_view(Archetypes const& archetypes) {
+        std::array<stl::uint64_t, sizeof...(Ts)> const ids { get_component_type_id<Ts>() ... };
+        for (auto const& table : archetypes) {
+            match m { &*table, {} };
+            bool matches_all = true;
+            for (stl::size_t i = 0; i < ids.size(); ++i) {
+                m.columns[i] = table->column_of(ids[i]);
+                matches_all = matches_all && m.columns[i] != archetype::npos;
+            }
+            if (matches_all && table->size() > 0) {
+                matches.push_back(m);
+            }
+        }
+    }
+
+    archetype_view(archetype_view const&) = delete;
+    archetype_view& operator=(archetype_view const&) = delete;
+
+    iterator begin() {
+        return iterator(this, 0, 0);
+    }
+
+    iterator end() {
+        return iterator(this, matches.size(), 0);
+    }
+
+    // Calls f(range&) for every chunk on the thread pool. Chunks are already 16 KiB blocks, so the chunk size
+    // is ignored. It's only there to keep the interface the same as component_view::par_chunks
+    template<typename F>
+    void par_chunks(F&& f, stl::size_t = 0, ThreadPool& pool = ThreadPool::get_default()) {
+        stl::vector<std::pair<stl::size_t, stl::size_t>> work;
+        for (stl::size_t table = 0; table < matches.size(); ++table) {
+            for (stl::size_t chunk = 0; chunk < matches[table].table->chunk_count(); ++chunk) {
+                work.push_back({ table, chunk });
+            }
+        }
+
+        system_access const* const access = current_system_access();
+        pool.parallel_for(work.size(), 1, [this, &f, &work, access](stl::size_t begin, stl::size_t end) {
+            system_access_scope scope(access);
+            for (stl::size_t i = begin; i < end; ++i) {
+                iterator first(this, work[i].first, work[i].second, true);
+                iterator last = first;
+                last.row = last.rows_in_chunk;
+                range chunk(first, last);
+                f(chunk);
+            }
+        });
+    }
+
+    template<typename F>
+    void par_each(F&& f, stl::size_t chunk_size = 0, ThreadPool& pool = ThreadPool::get_default()) {
+        par_chunks([&f](range& chunk) {
+            for (auto components : chunk) {
+                std::apply(f, components);
+            }
+        }, chunk_size, pool);
+    }
+
+    // Calls f(Span<entity_t const> entities, Span<Ts> components...) for every chunk. Columns are
+    // aligned to archetype::column_alignment. The chunk size is ignored, see par_chunks.
+    template<typename F>
+    void each_chunk(F&& f, stl::size_t = 0) {
+        for (match const& m : matches) {
+            archetype const& table = *m.table;
+            for (stl::size_t chunk = 0; chunk < table.chunk_count(); ++chunk) {
+                stl::size_t const rows = table.chunk_size(chunk);
+                call_chunk(f, m, chunk, rows, std::index_sequence_for<Ts...>{});
+            }
+        }
+    }
+
+private:
+    template<typename F, stl::size_t... Is>
+    static void call_chunk(F& f, match const& m, stl::size_t chunk, stl::size_t rows, std::index_sequence<Is...>) {
+        archetype const* table = m.table;
+        f(Span<entity_t const>(table->chunk_entities(chunk), rows),
+            Span<Ts>(static_cast<Ts*>(m.table->chunk_column(chunk, m.columns[Is])), rows) ...);
+    }
+
+    stl::vector<match> matches;
+};
+
+} // namespace saturn::ecs
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef SATURN_ECS_CHANGED_VIEW_HPP_
+#define SATURN_ECS_CHANGED_VIEW_HPP_
+
+#include <saturn/ecs/entity.hpp>
+
+#include <stl/types.hpp>
+#include <stl/assert.hpp>
+
+#include <utility>
+
+namespace saturn::ecs {
+
+// View over the components T, Ts... that skips entities whose T component did not change after a tick.
+// If changes to T are not tracked, every entity passes the filter.
+template<typename Backend, typename T, typename... Ts>
+class changed_view {
+private:
+    using view_type = decltype(std::declval<Backend&>().template view<T, Ts...>());
+    using base_iterator = decltype(std::declval<view_type&>().begin());
+
+public:
+    class iterator {
+    public:
+        iterator() = default;
+        iterator(base_iterator current, base_iterator last, Backend const* backend, stl::uint64_t tick)
+            : current(current), last(last), backend(backend), tick(tick) {
+            skip_unchanged();
+        }
+
+        iterator(iterator const&) = default;
+
+        iterator& operator=(iterator const&) = default;
+
+        auto operator*() {
+            return *current;
+        }
+
+        entity_t get_entity() const {
+            return current.get_entity();
+        }
+
+        iterator operator++() {
+            ++current;
+            skip_unchanged();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator copy = *this;
+            ++current;
+            skip_unchanged();
+            return copy;
+        }
+
+        bool operator==(iterator const& other) const {
+            return current == other.current;
+        }
+
+        bool operator!=(iterator const& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        void skip_unchanged() {
+            while (current != last && !backend->template changed_since<T>(current.get_entity(), tick)) {
+                ++current;
+            }
+        }
+
+        base_iterator current;
+        base_iterator last;
+        Backend const* backend = nullptr;
+        stl::uint64_t tick = 0;
+    };
+
+    changed_view(Backend& backend, stl::uint64_t tick)
+        : view(backend.template view<T, Ts...>()), backend(&backend), tick(tick) {}
+
+    changed_view(changed_view const&) = delete;
+    changed_view& operator=(changed_view const&) = delete;
+
+    iterator begin() {
+        return iterator(view.begin(), view.end(), backend, tick);
+    }
+
+    iterator end() {
+        return iterator(view.end(), view.end(), backend, tick);
+    }
+
+private:
+    view_type view;
+    Backend const* backend;
+    stl::uint64_t tick;
+};
+
+} // namespace saturn::ecs
+
+#endif
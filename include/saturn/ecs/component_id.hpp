@@ -3,23 +3,18 @@
 
 #include <stl/types.hpp>
 
-namespace saturn::ecs {
-
-struct type_id_counter {
-    static inline stl::uint64_t cur = 0;
+#include <saturn/meta/component_ids.hpp>
 
-    static stl::uint64_t next() {
-        return cur++;
-    }
-};
+namespace saturn::ecs {
 
+// Ids are generated by CodeGen, see meta/component_ids.hpp
 template<typename T>
-stl::uint64_t get_component_type_id() {
-    static stl::uint64_t id = type_id_counter::next();
-    return id;
+constexpr stl::uint64_t get_component_type_id() {
+    return meta::component_id<T>::value;
 }
 
+constexpr stl::size_t component_type_count = meta::component_count;
 
 } // namespace saturn::ecs
 
-#endif
\ No newline at end of file
+#endif
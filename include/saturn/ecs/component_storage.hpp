@@ -1,7 +1,8 @@
 #ifndef SATURN_ECS_COMPONENT_STORAGE_HPP_
 #define SATURN_ECS_COMPONENT_STORAGE_HPP_
 
-#include <stl/sparse_set.hpp>
+#include <stl/vector.hpp>
+#include <stl/utility.hpp>
 
 #include <saturn/ecs/component_storage_base.hpp>
 #include <saturn/ecs/entity.hpp>
@@ -12,8 +13,6 @@ namespace saturn::ecs {
 template<typename T>
 class component_storage : public component_storage_base {
 public:
-    using underlying_storage = stl::sparse_set<entity_t>;
-
     class iterator {
     public:
         using value_type = T;
@@ -77,11 +76,11 @@ public:
         }
 
         T& operator*() {
-            return components_ref->at(index);
+            return (*components_ref)[index];
         }
 
         T const& operator*() const {
-            return components_ref->at(index);
+            return (*components_ref)[index];
         }
 
         auto operator->() {
@@ -89,8 +88,6 @@ public:
         }
 
     private:
-        friend class sparse_set;
-
         stl::vector<T>* components_ref;
         size_t index;
     };
@@ -158,7 +155,7 @@ public:
         }
 
         T const& operator*() const {
-            return components_ref->at(index);
+            return (*components_ref)[index];
         }
 
         auto operator->() {
@@ -170,8 +167,6 @@ public:
         }
 
     private:
-        friend class sparse_set;
-
         stl::vector<T> const* components_ref;
         size_t index;
     };
@@ -203,37 +198,80 @@ public:
 
     iterator insert(entity_t entity, T const& value) {
         // By inserting at the end, this component will be at the same index as the value in our
-        // direct list in the sparse set.
+        // dense list in the sparse set.
         components.push_back(value);
-        underlying_storage::insert(entity);
+        insert_entity(entity);
+        notify_construct(entity);
 
-        return iterator(&components, components.size() - 1);
+        return find(entity);
     }
 
     template<typename... Args>
     iterator construct(entity_t entity, Args&&... args) {
         components.push_back(T{std::forward<Args>(args) ...});
-        underlying_storage::insert(entity);
+        insert_entity(entity);
+        // Observers (like groups) may move the new component, so look it up again afterwards
+        notify_construct(entity);
 
-        return iterator(&components, components.size() - 1);
+        return find(entity);
+    }
+
+    // Swap-and-pop removal, keeps the component array packed.
+    void remove(entity_t entity) override {
+        if (!contains(entity)) { return; }
+        notify_remove(entity);
+
+        stl::uint32_t const position = position_of(entity);
+
+        if (position != components.size() - 1) {
+            components[position] = stl::move(components.back());
+        }
+        components.pop_back();
+        swap_and_pop_entity(position);
     }
 
     iterator find(entity_t entity) {
-        underlying_storage::iterator it = underlying_storage::find(entity);
-        if (it == underlying_storage::end()) {
+        stl::uint32_t const position = position_of(entity);
+        if (position == null_position) {
             return end();
         }
 
-        return iterator(&components, it.get_index());
+        return iterator(&components, position);
     }
 
     const_iterator find(entity_t entity) const {
-        underlying_storage::iterator it = underlying_storage::find(entity);
-        if (it == underlying_storage::end()) {
+        stl::uint32_t const position = position_of(entity);
+        if (position == null_position) {
             return end();
         }
 
-        return const_iterator(&components, it.get_index());
+        return const_iterator(&components, position);
+    }
+
+    void swap_positions(stl::uint32_t lhs, stl::uint32_t rhs) override {
+        if (lhs == rhs) { return; }
+        T tmp = stl::move(components[lhs]);
+        components[lhs] = stl::move(components[rhs]);
+        components[rhs] = stl::move(tmp);
+        swap_entities(lhs, rhs);
+    }
+
+    // The packed component array, in the same order as entities()
+    Span<T> data() {
+        return Span<T>(components.data(), components.size());
+    }
+
+    Span<T const> data() const {
+        return Span<T const>(components.data(), components.size());
+    }
+
+    // Unchecked access to the component at a position in the packed array
+    T& at_position(stl::uint32_t position) {
+        return components[position];
+    }
+
+    T const& at_position(stl::uint32_t position) const {
+        return components[position];
     }
 
     T& get(entity_t entity) {
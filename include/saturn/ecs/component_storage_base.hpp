@@ -1,16 +1,186 @@
 #ifndef SATURN_ECS_COMPONENT_STORAGE_BASE_HPP_
 #define SATURN_ECS_COMPONENT_STORAGE_BASE_HPP_
 
-#include <stl/sparse_set.hpp>
+#include <stl/vector.hpp>
+#include <stl/assert.hpp>
 #include <saturn/ecs/entity.hpp>
+#include <saturn/ecs/storage_observer.hpp>
+#include <saturn/utility/span.hpp>
 
 namespace saturn::ecs {
 
-class component_storage_base : public stl::sparse_set<entity_t> {
+// Sparse set of entities. The sparse array is indexed by entity index and stores the position of the
+// entity in the packed (dense) array. Dense positions are kept in sync with the component array
+// in component_storage<T>, so removal is a swap with the last element followed by a pop.
+class component_storage_base {
 public:
-    using sparse_set::sparse_set;
+    using iterator = entity_t const*;
+
+    static constexpr stl::uint32_t null_position = 0xFFFFFFFF;
+
+    component_storage_base() = default;
+    component_storage_base(component_storage_base const&) = default;
+    component_storage_base(component_storage_base&&) = default;
+
+    component_storage_base& operator=(component_storage_base const&) = default;
+    component_storage_base& operator=(component_storage_base&&) = default;
+
+    virtual ~component_storage_base() = default;
+
+    // Removes the component belonging to this entity. Does nothing if the entity is not in this storage.
+    virtual void remove(entity_t entity) = 0;
+
+    // Swaps two elements in the packed arrays. Used by groups to keep their entities in a shared prefix.
+    virtual void swap_positions(stl::uint32_t lhs, stl::uint32_t rhs) = 0;
+
+    void add_observer(storage_observer* observer) {
+        observers.push_back(observer);
+    }
+
+    // A storage can be owned by at most one group, since the group decides the order of the packed arrays.
+    storage_observer* get_owner() const {
+        return owner;
+    }
+
+    void set_owner(storage_observer* new_owner) {
+        STL_ASSERT(owner == nullptr || new_owner == nullptr, "Storage is already owned by a group");
+        owner = new_owner;
+    }
+
+    entity_t entity_at(stl::uint32_t position) const {
+        return dense[position];
+    }
+
+    // The packed entity array. Entity i is the owner of component i in component_storage<T>::data()
+    Span<entity_t const> entities() const {
+        return Span<entity_t const>(dense.data(), dense.size());
+    }
+
+    iterator begin() const {
+        return dense.data();
+    }
+
+    iterator end() const {
+        return dense.data() + dense.size();
+    }
+
+    bool contains(entity_t entity) const {
+        stl::uint32_t const index = entity_index(entity);
+        if (index >= sparse.size()) { return false; }
+        stl::uint32_t const position = sparse[index];
+        // Comparing the full handle also rejects stale handles with an outdated version
+        return position != null_position && dense[position] == entity;
+    }
+
+    // Returns the position of the entity in the packed array, or null_position if it's not in this storage.
+    stl::uint32_t position_of(entity_t entity) const {
+        return contains(entity) ? sparse[entity_index(entity)] : null_position;
+    }
+
+    stl::size_t size() const {
+        return dense.size();
+    }
+
+    bool empty() const {
+        return dense.empty();
+    }
+
+    // Starts keeping a change tick for every component in this storage. Components that already
+    // exist count as changed at [tick].
+    void enable_change_tracking(stl::uint64_t tick) {
+        if (tracks_changes) { return; }
+        tracks_changes = true;
+        change_ticks.clear();
+        change_ticks.resize(dense.size(), tick);
+    }
+
+    bool is_tracking_changes() const {
+        return tracks_changes;
+    }
+
+    // Stamps the component of this entity as changed at [tick]. Does nothing if changes are not tracked.
+    void mark_changed(entity_t entity, stl::uint64_t tick) {
+        if (!tracks_changes) { return; }
+        stl::uint32_t const position = position_of(entity);
+        if (position != null_position) {
+            change_ticks[position] = tick;
+        }
+    }
+
+    // Returns true if the component of this entity changed after [tick]. Without change tracking
+    // every component counts as changed.
+    bool changed_since(entity_t entity, stl::uint64_t tick) const {
+        if (!tracks_changes) { return true; }
+        stl::uint32_t const position = position_of(entity);
+        return position != null_position && change_ticks[position] > tick;
+    }
+
+protected:
+    void insert_entity(entity_t entity) {
+        STL_ASSERT(!contains(entity), "Entity already in storage");
+        stl::uint32_t const index = entity_index(entity);
+        if (index >= sparse.size()) {
+            sparse.resize(index + 1, null_position);
+        }
+        sparse[index] = static_cast<stl::uint32_t>(dense.size());
+        dense.push_back(entity);
+        if (tracks_changes) {
+            // The registry stamps new components with the current tick
+            change_ticks.push_back(0);
+        }
+    }
+
+    // Moves the last entity into the slot of the erased entity. The caller is responsible for
+    // doing the same swap on the component data.
+    void swap_and_pop_entity(stl::uint32_t position) {
+        entity_t const last = dense.back();
+        entity_t const removed = dense[position];
+        dense[position] = last;
+        sparse[entity_index(last)] = position;
+        sparse[entity_index(removed)] = null_position;
+        dense.pop_back();
+        if (tracks_changes) {
+            change_ticks[position] = change_ticks.back();
+            change_ticks.pop_back();
+        }
+    }
+
+    void swap_entities(stl::uint32_t lhs, stl::uint32_t rhs) {
+        entity_t const lhs_entity = dense[lhs];
+        entity_t const rhs_entity = dense[rhs];
+        dense[lhs] = rhs_entity;
+        dense[rhs] = lhs_entity;
+        sparse[entity_index(lhs_entity)] = rhs;
+        sparse[entity_index(rhs_entity)] = lhs;
+        if (tracks_changes) {
+            stl::uint64_t const lhs_tick = change_ticks[lhs];
+            change_ticks[lhs] = change_ticks[rhs];
+            change_ticks[rhs] = lhs_tick;
+        }
+    }
+
+    void notify_construct(entity_t entity) {
+        for (storage_observer* observer : observers) {
+            observer->on_construct(entity);
+        }
+    }
+
+    void notify_remove(entity_t entity) {
+        for (storage_observer* observer : observers) {
+            observer->on_remove(entity);
+        }
+    }
+
+    stl::vector<entity_t> dense;
+    stl::vector<stl::uint32_t> sparse;
+    // Parallel to dense, only filled if tracks_changes is set
+    stl::vector<stl::uint64_t> change_ticks;
+    bool tracks_changes = false;
+
+    stl::vector<storage_observer*> observers;
+    storage_observer* owner = nullptr;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -2,7 +2,10 @@
 #define SATURN_COMPONENT_VIEW_HPP_
 
 #include <saturn/ecs/component_storage.hpp>
+#include <saturn/ecs/system_access.hpp>
+#include <saturn/utility/thread_pool.hpp>
 
+#include <algorithm>
 #include <tuple>
 
 namespace saturn::ecs {
@@ -40,6 +43,11 @@ public:
             return std::tie(std::get<component_storage<Ts>*>(*view)->get(*entity) ... );
         }
 
+        // The entity the iterator currently points to
+        entity_t get_entity() const {
+            return *entity;
+        }
+
         iterator operator++() {
             advance_to_next();
             return *this;
@@ -62,8 +70,7 @@ public:
     private:
         void advance_to_next() {
             ++entity;
-            if (entity == end) { return; }
-            while(
+            while(entity != end &&
                 !((std::get<component_storage<Ts>*>(*view)->find(*entity) != std::get<component_storage<Ts>*>(*view)->end()) && ...)
             ) {
                 ++entity;
@@ -75,6 +82,31 @@ public:
         component_storage_base::iterator end;
     };
 
+    // A contiguous range of the storage driving the iteration. Iterating it yields the same tuples as the view.
+    class range {
+    public:
+        range(iterator first, iterator last) : first(first), last(last) {}
+
+        iterator begin() const {
+            return first;
+        }
+
+        iterator end() const {
+            return last;
+        }
+
+    private:
+        iterator first;
+        iterator last;
+    };
+
+    // Chunk sizes are rounded up to a multiple of this, so SIMD kernels over the chunks of each_chunk() only need a
+    // scalar tail loop for the last chunk. Chunks are not aligned to cache lines: the arrays don't start on one, and
+    // the other storages of a view are in a different order. Two threads can share a line of components at the
+    // edges of their chunks, which large chunks keep rare.
+    static constexpr stl::size_t chunk_size_multiple = 16;
+    static constexpr stl::size_t default_chunk_size = 1024;
+
     component_view(component_storage<Ts>& ... storages)
         : storages { &storages ...} {
         
@@ -89,10 +121,58 @@ public:
         return iterator(storages, storage_to_check->end(), storage_to_check->end());
     }
 
+    // Splits the storage being iterated into chunks and calls f(range&) for each chunk on the thread pool.
+    // f may only touch the components of the entities in its range.
+    template<typename F>
+    void par_chunks(F&& f, stl::size_t chunk_size = default_chunk_size, ThreadPool& pool = ThreadPool::get_default()) {
+        chunk_size = round_chunk_size(chunk_size);
+        component_storage_base::iterator const base = storage_to_check->begin();
+        system_access const* const access = current_system_access();
+        auto run_chunk = [this, &f, base, access](stl::size_t begin, stl::size_t end) {
+            // Validation checks the chunks against the access of the system that started the iteration
+            system_access_scope scope(access);
+            range chunk(iterator(storages, base + begin, base + end), iterator(storages, base + end, base + end));
+            f(chunk);
+        };
+        pool.parallel_for(storage_to_check->size(), chunk_size, run_chunk);
+    }
+
+    // Calls f(components...) for every entity in the view, in parallel. See par_chunks().
+    template<typename F>
+    void par_each(F&& f, stl::size_t chunk_size = default_chunk_size, ThreadPool& pool = ThreadPool::get_default()) {
+        par_chunks([&f](range& chunk) {
+            for (auto components : chunk) {
+                std::apply(f, components);
+            }
+        }, chunk_size, pool);
+    }
+
+    // Calls f(Span<entity_t const> entities, Span<T> components) for consecutive chunks of the packed arrays.
+    // All chunks except the last one have exactly chunk_size elements (rounded up to chunk_size_multiple), so a
+    // SIMD kernel only needs a scalar loop for the tail. Storages of different types are not in the same order,
+    // so this is only available for views of a single type. Use a group for multiple types.
+    template<typename F>
+    void each_chunk(F&& f, stl::size_t chunk_size = default_chunk_size) {
+        static_assert(sizeof...(Ts) == 1, "each_chunk requires a single component type. Use a group for multiple types");
+        auto& storage = *std::get<0>(storages);
+        Span<entity_t const> const entities = storage.entities();
+        auto const components = storage.data();
+
+        chunk_size = round_chunk_size(chunk_size);
+        for (stl::size_t begin = 0; begin < entities.size(); begin += chunk_size) {
+            stl::size_t const length = std::min(chunk_size, entities.size() - begin);
+            f(entities.subspan(begin, length), components.subspan(begin, length));
+        }
+    }
+
 private:
     view_type storages;
     component_storage_base* storage_to_check;
 
+    static stl::size_t round_chunk_size(stl::size_t chunk_size) {
+        return (chunk_size + chunk_size_multiple - 1) / chunk_size_multiple * chunk_size_multiple;
+    }
+
     component_storage_base* find_smallest_storage() {
         return find_smallest_storage_impl<component_storage<Ts>* ...>();
     }
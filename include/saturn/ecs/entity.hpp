@@ -5,8 +5,29 @@
 
 namespace saturn::ecs {
 
+// An entity handle packs a 32-bit index (lower bits) and a 32-bit version (upper bits).
+// The index is recycled when an entity is destroyed, the version is bumped so old handles
+// to that index can be detected as stale.
 using entity_t = stl::uint64_t;
 
+// Handle that never refers to an entity. Note that entity 0 is a valid entity, it is the root of the hierarchy.
+constexpr entity_t null_entity = 0xFFFFFFFFFFFFFFFF;
+
+constexpr stl::uint64_t entity_index_bits = 32;
+constexpr stl::uint64_t entity_index_mask = 0xFFFFFFFF;
+
+constexpr stl::uint32_t entity_index(entity_t entity) {
+    return static_cast<stl::uint32_t>(entity & entity_index_mask);
+}
+
+constexpr stl::uint32_t entity_version(entity_t entity) {
+    return static_cast<stl::uint32_t>(entity >> entity_index_bits);
+}
+
+constexpr entity_t make_entity(stl::uint32_t index, stl::uint32_t version) {
+    return (static_cast<entity_t>(version) << entity_index_bits) | static_cast<entity_t>(index);
+}
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,178 @@
+#ifndef SATURN_ECS_GROUP_HPP_
+#define SATURN_ECS_GROUP_HPP_
+
+#include <saturn/ecs/component_storage.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+namespace saturn::ecs {
+
+class group_base : public storage_observer {
+public:
+    // Identifies the owned types in their order, so a group can't be mistaken for one of the same types in a
+    // different order
+    virtual void const* type_key() const = 0;
+};
+
+// An owning group keeps the packed arrays of all its storages sorted so that entities that have all
+// components are stored in the first [size()] elements of each storage, at the same position. Iterating
+// a group is a linear walk over these arrays, without any lookups.
+// A storage can only be owned by a single group.
+template<typename... Ts>
+class group : public group_base {
+private:
+    using storage_type = std::tuple<component_storage<Ts>* ...>;
+public:
+    static_assert(sizeof...(Ts) > 1, "group must own at least two types. Use a component_view for a single type");
+
+    class iterator {
+    public:
+        iterator() = default;
+        iterator(storage_type* storages, stl::uint32_t position) : storages(storages), position(position) {}
+
+        iterator(iterator const&) = default;
+
+        iterator& operator=(iterator const&) = default;
+
+        auto operator*() {
+            STL_ASSERT(storages, "Iterator pointing to invalid group");
+            return std::tie(std::get<component_storage<Ts>*>(*storages)->at_position(position) ...);
+        }
+
+        entity_t get_entity() const {
+            return std::get<0>(*storages)->entity_at(position);
+        }
+
+        iterator operator++() {
+            ++position;
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator copy = *this;
+            ++position;
+            return copy;
+        }
+
+        bool operator==(iterator other) const {
+            return storages == other.storages && position == other.position;
+        }
+
+        bool operator!=(iterator other) const {
+            return !(*this == other);
+        }
+
+    private:
+        storage_type* storages = nullptr;
+        stl::uint32_t position = 0;
+    };
+
+    group(component_storage<Ts>& ... owned) : storages { &owned ... } {
+        (owned.set_owner(this), ...);
+        (owned.add_observer(this), ...);
+
+        // Sort the entities that already exist into the group. We copy the entities of the first storage since
+        // on_construct reorders it.
+        component_storage_base const& first = *std::get<0>(storages);
+        stl::vector<entity_t> existing(stl::tags::reserve, first.size());
+        for (entity_t entity : first) {
+            existing.push_back(entity);
+        }
+        for (entity_t entity : existing) {
+            on_construct(entity);
+        }
+    }
+
+    group(group const&) = delete;
+    group& operator=(group const&) = delete;
+
+    ~group() override = default;
+
+    iterator begin() {
+        return iterator(&storages, 0);
+    }
+
+    iterator end() {
+        return iterator(&storages, length);
+    }
+
+    // Calls f(entity, components...) for each entity in the group
+    template<typename F>
+    void each(F&& f) {
+        component_storage_base const& first = *std::get<0>(storages);
+        for (stl::uint32_t i = 0; i < length; ++i) {
+            f(first.entity_at(i), std::get<component_storage<Ts>*>(storages)->at_position(i) ...);
+        }
+    }
+
+    // Calls f(Span<entity_t const> entities, Span<Ts> components...) for consecutive chunks of the group.
+    // All spans in a call have the same length and element i of each span belongs to the same entity.
+    // All chunks except the last one have exactly chunk_size elements.
+    template<typename F>
+    void each_chunk(F&& f, stl::size_t chunk_size = 1024) {
+        STL_ASSERT(chunk_size > 0, "Chunk size cannot be zero");
+        component_storage_base const& first = *std::get<0>(storages);
+        Span<entity_t const> const entities = first.entities();
+        for (stl::size_t begin = 0; begin < length; begin += chunk_size) {
+            stl::size_t const count = std::min<stl::size_t>(chunk_size, length - begin);
+            f(entities.subspan(begin, count), std::get<component_storage<Ts>*>(storages)->data().subspan(begin, count) ...);
+        }
+    }
+
+    stl::size_t size() const {
+        return length;
+    }
+
+    bool empty() const {
+        return length == 0;
+    }
+
+    bool contains(entity_t entity) const {
+        component_storage_base const& first = *std::get<0>(storages);
+        return first.contains(entity) && first.position_of(entity) < length;
+    }
+
+    static void const* static_type_key() {
+        // Every instantiation has its own tag, so its address is unique to the type list
+        static constexpr char tag = 0;
+        return &tag;
+    }
+
+    void const* type_key() const override {
+        return static_type_key();
+    }
+
+    void on_construct(entity_t entity) override {
+        if (!(std::get<component_storage<Ts>*>(storages)->contains(entity) && ...)) { return; }
+        // The entity may already be in the group if it was sorted in from the constructor
+        if (contains(entity)) { return; }
+
+        // Move the entity to the end of the shared prefix in every storage
+        (swap_into(*std::get<component_storage<Ts>*>(storages), entity, length), ...);
+        ++length;
+    }
+
+    void on_remove(entity_t entity) override {
+        if (!contains(entity)) { return; }
+
+        // Move the entity to the end of the shared prefix and shrink it
+        --length;
+        (swap_into(*std::get<component_storage<Ts>*>(storages), entity, length), ...);
+    }
+
+private:
+    storage_type storages;
+    stl::uint32_t length = 0;
+
+    static void swap_into(component_storage_base& storage, entity_t entity, stl::uint32_t position) {
+        storage.swap_positions(storage.position_of(entity), position);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef SATURN_ECS_HIERARCHY_HPP_
+#define SATURN_ECS_HIERARCHY_HPP_
+
+#include <saturn/ecs/entity.hpp>
+#include <saturn/utility/span.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/assert.hpp>
+
+#include <type_traits>
+
+namespace saturn::ecs {
+
+// Parent/child relations between entities. Every entity stores links to its parent, its first and last child
+// and its previous and next sibling, in an array indexed by entity index. Inserting, removing and reparenting
+// only update a few links. Missing links are null_entity.
+// The first entity inserted is the root, every other entity is a descendant of it.
+class hierarchy {
+public:
+    // Adds the entity as the last child of parent. Parent is ignored for the first entity, which becomes the root.
+    void insert(entity_t entity, entity_t parent);
+    // Unlinks the entity and all its descendants
+    void erase(entity_t entity);
+    // Moves the entity, along with its descendants, to the end of the children of new_parent.
+    void reparent(entity_t entity, entity_t new_parent);
+
+    bool contains(entity_t entity) const {
+        stl::uint32_t const index = entity_index(entity);
+        return index < nodes.size() && nodes[index].self == entity;
+    }
+
+    bool empty() const {
+        return root_entity == null_entity;
+    }
+
+    entity_t root() const {
+        return root_entity;
+    }
+
+    entity_t parent(entity_t entity) const {
+        return node(entity).parent;
+    }
+
+    entity_t first_child(entity_t entity) const {
+        return node(entity).first_child;
+    }
+
+    entity_t next_sibling(entity_t entity) const {
+        return node(entity).next_sibling;
+    }
+
+    bool has_children(entity_t entity) const {
+        return node(entity).first_child != null_entity;
+    }
+
+    // Returns true if ancestor is entity itself or one of its (grand)parents
+    bool is_ancestor_of(entity_t ancestor, entity_t entity) const;
+
+    // Depth-first walk over the subtree of [from], without recursion. pre(entity) is called before the children
+    // of an entity are visited, and can return false to skip them. post(entity) is called after the children.
+    // The hierarchy must not be modified during the walk.
+    template<typename Pre, typename Post>
+    void traverse(entity_t from, Pre&& pre, Post&& post) const {
+        if (from == null_entity) { return; }
+
+        entity_t current = from;
+        while (true) {
+            bool descend = true;
+            if constexpr (std::is_void_v<std::invoke_result_t<Pre&, entity_t>>) {
+                pre(current);
+            } else {
+                descend = pre(current);
+            }
+
+            entity_t const child = first_child(current);
+            if (descend && child != null_entity) {
+                current = child;
+                continue;
+            }
+
+            // Walk back up until there is a sibling left to visit
+            while (true) {
+                post(current);
+                if (current == from) { return; }
+
+                entity_t const sibling = next_sibling(current);
+                if (sibling != null_entity) {
+                    current = sibling;
+                    break;
+                }
+                current = parent(current);
+            }
+        }
+    }
+
+    template<typename Pre>
+    void traverse(entity_t from, Pre&& pre) const {
+        traverse(from, pre, [](entity_t) {});
+    }
+
+    // All entities in breadth-first order, so parents always come before their children. Entities of the
+    // same depth are stored together, see depth_level(). Rebuilt on first use after the hierarchy changed,
+    // so the first call after a modification must not race with other calls.
+    Span<entity_t const> depth_sorted() const;
+
+    // Number of depth levels, the root is at depth 0
+    stl::size_t depth_count() const;
+    // The entities at a certain depth, a subrange of depth_sorted()
+    Span<entity_t const> depth_level(stl::size_t depth) const;
+
+private:
+    struct links {
+        entity_t self = null_entity;
+        entity_t parent = null_entity;
+        entity_t first_child = null_entity;
+        entity_t last_child = null_entity;
+        entity_t prev_sibling = null_entity;
+        entity_t next_sibling = null_entity;
+    };
+
+    links& node(entity_t entity) {
+        STL_ASSERT(contains(entity), "Entity is not in the hierarchy");
+        return nodes[entity_index(entity)];
+    }
+
+    links const& node(entity_t entity) const {
+        STL_ASSERT(contains(entity), "Entity is not in the hierarchy");
+        return nodes[entity_index(entity)];
+    }
+
+    void link(entity_t entity, entity_t parent);
+    void unlink(entity_t entity);
+    void rebuild_depth_order() const;
+
+    // Indexed by entity index
+    stl::vector<links> nodes;
+    entity_t root_entity = null_entity;
+
+    mutable stl::vector<entity_t> depth_order;
+    // depth_order[level_offsets[d] .. level_offsets[d + 1]] are the entities at depth d
+    mutable stl::vector<stl::size_t> level_offsets;
+    mutable bool depth_order_dirty = true;
+};
+
+} // namespace saturn::ecs
+
+#endif
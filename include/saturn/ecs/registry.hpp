@@ -1,16 +1,42 @@
 #ifndef SATURN_ECS_REGISTRY_HPP_
 #define SATURN_ECS_REGISTRY_HPP_
 
-#include <saturn/ecs/component_storage.hpp>
-#include <saturn/ecs/component_id.hpp>
-#include <saturn/ecs/component_view.hpp>
+#include <saturn/ecs/entity.hpp>
+#include <saturn/ecs/hierarchy.hpp>
+#include <saturn/ecs/system_access.hpp>
+#include <saturn/ecs/changed_view.hpp>
+#include <saturn/ecs/storage_observer.hpp>
+
+// The component storage backend is selected at compile time. Both backends have the same interface.
+#ifdef SATURN_ECS_ARCHETYPE_STORAGE
+    #include <saturn/ecs/archetype_backend.hpp>
+#else
+    #include <saturn/ecs/sparse_set_backend.hpp>
+#endif
 
 #include <stl/vector.hpp>
-#include <stl/tree.hpp>
 #include <stl/unique_ptr.hpp>
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <array>
+
+// Validates entity handles passed to the registry. Compiled out in release builds,
+// where a stale handle simply fails the version comparison in the component storages.
+#ifndef NDEBUG
+    #define SATURN_ECS_CHECK_ENTITY(entity) STL_ASSERT(is_alive(entity), "Stale or invalid entity handle")
+#else
+    #define SATURN_ECS_CHECK_ENTITY(entity) ((void)0)
+#endif
 
 namespace saturn::ecs {
 
+#ifdef SATURN_ECS_ARCHETYPE_STORAGE
+    using storage_backend = archetype_backend;
+#else
+    using storage_backend = sparse_set_backend;
+#endif
+
 class registry {
 public:
     registry();
@@ -22,101 +48,200 @@ public:
 
     ~registry() = default;
 
+    // Creates an entity as the last child of parent. The first entity created is the root of the hierarchy.
     entity_t create_entity(entity_t parent = 0);
     entity_t create_blueprint_entity(entity_t parent = 0);
 
+    // Destroys an entity and all its children, removing all their components. The entity indices are recycled
+    // for new entities, with a bumped version so old handles can be detected.
+    void destroy_entity(entity_t entity);
+
+    // Returns true if the handle refers to an entity that has not been destroyed yet.
+    bool is_alive(entity_t entity) const;
+
+    // Moves an entity and its children to a new parent. Marks the Transform of the entity as changed.
+    void set_parent(entity_t entity, entity_t parent);
+
     // 'Imports' an entity from registry [source] to this registry. Effectively makes a copy of all entity data
     entity_t import_blueprint(registry& source, entity_t other);
 
     template<typename T, typename... Args>
     void add_component(entity_t entity, Args&&... args) {
-        component_storage<T>& storage = get_or_emplace_storage<T>();
-        storage.construct(entity, std::forward<Args>(args) ...);
+        SATURN_ECS_CHECK_ENTITY(entity);
+        validate_write_access<T>();
+        backend.add<T>(entity, std::forward<Args>(args) ...);
+        backend.mark_changed<T>(entity, tick);
+        notify_construct(get_component_type_id<T>(), entity);
+    }
+
+    template<typename T>
+    void remove_component(entity_t entity) {
+        SATURN_ECS_CHECK_ENTITY(entity);
+        validate_write_access<T>();
+        if (backend.has<T>(entity)) {
+            notify_remove(get_component_type_id<T>(), entity);
+        }
+        backend.remove<T>(entity);
     }
 
     template<typename T>
     bool has_component(entity_t entity) const {
-        component_storage<T> const& storage = get_or_emplace_storage<T>();
-        auto const it = storage.find(entity);
-        return it != storage.end();
+        SATURN_ECS_CHECK_ENTITY(entity);
+        validate_read_access<T>();
+        return backend.has<T>(entity);
     }
 
+    // Mutable access counts as a change to the component
     template<typename T>
     T& get_component(entity_t entity) {
-        component_storage<T>& storage = get_or_emplace_storage<T>();
-        return *storage.find(entity);
+        SATURN_ECS_CHECK_ENTITY(entity);
+        validate_write_access<T>();
+        backend.mark_changed<T>(entity, tick);
+        return backend.get<T>(entity);
     }
 
     template<typename T>
     T const& get_component(entity_t entity) const {
-        component_storage<T> const& storage = get_or_emplace_storage<T>();
-        return *storage.find(entity);
+        SATURN_ECS_CHECK_ENTITY(entity);
+        validate_read_access<T>();
+        return backend.get<T>(entity);
     }
     
 
+    // Calls f(component&) and marks the component as changed
+    template<typename T, typename F>
+    void patch(entity_t entity, F&& f) {
+        f(get_component<T>(entity));
+    }
+
+    // Marks the component as changed without accessing it. Views and groups don't mark the components they yield,
+    // so systems that write to components through them call this for the entities they modify.
+    // Safe to call from multiple threads for different entities.
+    template<typename T>
+    void mark_changed(entity_t entity) {
+        SATURN_ECS_CHECK_ENTITY(entity);
+        validate_write_access<T>();
+        backend.mark_changed<T>(entity, tick);
+    }
+
+    // Returns true if the component changed after [since]. Always true for types without change tracking.
+    template<typename T>
+    bool changed_since(entity_t entity, stl::uint64_t since) const {
+        SATURN_ECS_CHECK_ENTITY(entity);
+        return backend.changed_since<T>(entity, since);
+    }
+
+    // Change tracking is opt-in per component type since it costs a tick per component. Components
+    // that already exist count as changed at the current tick.
+    template<typename T>
+    void enable_change_tracking() {
+        backend.enable_change_tracking<T>(tick);
+    }
+
+    // The tick that is stamped on changed components. Advanced once per frame by the engine.
+    stl::uint64_t get_tick() const {
+        return tick;
+    }
+
+    void advance_tick() {
+        ++tick;
+    }
+
+    // Access validation can't tell whether the components in a view are written to, so views only require read access.
+    // For the same reason views and groups don't stamp change ticks on the references they hand out. A system that
+    // writes to a change tracked component through them must call mark_changed<T>() for every entity it modifies,
+    // otherwise view_changed() and changed_since() miss the write.
     template<typename... Ts>
-    component_view<Ts...> view() {
-        return { get_or_emplace_storage<Ts>() ... };
+    auto view() {
+        validate_read_access<Ts...>();
+        return backend.view<Ts...>();
     }
 
-    stl::tree<entity_t> const& get_entities() const;
+    // Returns the owning group for these component types, creating it the first time. A component type can only
+    // be owned by one group, requesting a different group with an already owned type is an error.
+    // With the archetype backend this returns a view, since entities with the same components are already packed.
+    // Writes through a group are not stamped either, see view().
+    template<typename... Ts>
+    decltype(auto) group() {
+        validate_read_access<Ts...>();
+        return backend.group<Ts...>();
+    }
 
-private:
-    struct storage_data {
-        stl::uint64_t type_id = 0;
-        stl::unique_ptr<component_storage_base> storage;
-    };
+    // Like view<T, Ts...>(), but only yields entities whose T component changed after [since].
+    template<typename T, typename... Ts>
+    changed_view<storage_backend, T, Ts...> view_changed(stl::uint64_t since) {
+        validate_read_access<T, Ts...>();
+        return changed_view<storage_backend, T, Ts...>(backend, since);
+    }
 
-    struct entity_id_generator {
-        entity_t cur = 0;
+    hierarchy const& get_hierarchy() const;
 
-        entity_t next() {
-            return cur++;
-        }
-    } id_generator;
+    // Observers are told when a component of type T is added to or removed from an entity, including removals
+    // by destroy_entity(). They work the same for every storage backend. The registry doesn't own the observers,
+    // and observers are not carried over when a registry is moved.
+    template<typename T>
+    void add_observer(storage_observer* observer) {
+        observers[get_component_type_id<T>()].push_back(observer);
+    }
 
     template<typename T>
-    component_storage<T>& get_or_emplace_storage() {
-        stl::uint64_t const index = get_component_type_id<T>();
-
-        // If the index is not found, we have to register the new component
-        if (index >= storages.size()) {
-            storages.resize(index + 1);
-            storages[index].type_id = index;    
-            storages[index].storage = stl::make_unique<component_storage<T>>();
-        }
-        // Initialize storage if it wasn't created yet
-        if (storages[index].storage == nullptr) {
-            storages[index].type_id = index;
-            storages[index].storage = stl::make_unique<component_storage<T>>();
+    void remove_observer(storage_observer* observer) {
+        auto& list = observers[get_component_type_id<T>()];
+        list.erase(std::remove(list.begin(), list.end(), observer), list.end());
+    }
+
+private:
+    template<typename C>
+    friend struct notify_remove_all;
+
+    void notify_construct(stl::uint64_t type_id, entity_t entity) {
+        for (storage_observer* observer : observers[type_id]) {
+            observer->on_construct(entity);
         }
+    }
 
-        storage_data& storage = storages[index];
-        return *static_cast<component_storage<T>*>(storage.storage.get());
+    void notify_remove(stl::uint64_t type_id, entity_t entity) {
+        for (storage_observer* observer : observers[type_id]) {
+            observer->on_remove(entity);
+        }
     }
 
-    template<typename T>
-    component_storage<T> const& get_or_emplace_storage() const {
-        stl::uint64_t const index = get_component_type_id<T>();
-
-        // If the index is not found, we have to register the new component
-        if (index >= storages.size()) {
-            storages.resize(index + 1);
-            storages[index].type_id = index;    
-            storages[index].storage = stl::make_unique<component_storage<T>>();
+    struct entity_id_generator {
+        // Current version of each entity index. For indices in the free list this is the version
+        // the next entity using this index will get.
+        stl::vector<stl::uint32_t> versions;
+        stl::vector<stl::uint32_t> free_list;
+
+        entity_t next() {
+            if (!free_list.empty()) {
+                stl::uint32_t const index = free_list.back();
+                free_list.pop_back();
+                return make_entity(index, versions[index]);
+            }
+
+            stl::uint32_t const index = static_cast<stl::uint32_t>(versions.size());
+            versions.push_back(0);
+            return make_entity(index, 0);
         }
-        // Initialize storage if it wasn't created yet
-        if (storages[index].storage == nullptr) {
-            storages[index].type_id = index;
-            storages[index].storage = stl::make_unique<component_storage<T>>();
+
+        void release(entity_t entity) {
+            stl::uint32_t const index = entity_index(entity);
+            ++versions[index];
+            free_list.push_back(index);
         }
 
-        storage_data const& storage = storages[index];
-        return *static_cast<component_storage<T> const*>(storage.storage.get());
-    }
+        bool is_alive(entity_t entity) const {
+            stl::uint32_t const index = entity_index(entity);
+            // Entities in the free list already had their version bumped, so this comparison fails for them
+            return index < versions.size() && versions[index] == entity_version(entity);
+        }
+    } id_generator;
 
-    stl::tree<entity_t> entities;
-    mutable stl::vector<storage_data> storages;
+    hierarchy entities;
+    storage_backend backend;
+    std::array<stl::vector<storage_observer*>, component_type_count> observers;
+    // Starts at 1 so that a tick of 0 means 'never seen'
+    stl::uint64_t tick = 1;
 };
 
 } // namespace saturn::ecs
@@ -0,0 +1,120 @@
+#ifndef SATURN_ECS_SPARSE_SET_BACKEND_HPP_
+#define SATURN_ECS_SPARSE_SET_BACKEND_HPP_
+
+#include <saturn/ecs/component_storage.hpp>
+#include <saturn/ecs/component_id.hpp>
+#include <saturn/ecs/component_view.hpp>
+#include <saturn/ecs/group.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/unique_ptr.hpp>
+#include <stl/assert.hpp>
+
+#include <array>
+
+namespace saturn::ecs {
+
+// Component storage backend with one sparse set per component type.
+class sparse_set_backend {
+public:
+    // Creates the storages for all component types
+    sparse_set_backend();
+    sparse_set_backend(sparse_set_backend&&) = default;
+    sparse_set_backend& operator=(sparse_set_backend&&) = default;
+
+    template<typename T, typename... Args>
+    void add(entity_t entity, Args&&... args) {
+        get_storage<T>().construct(entity, std::forward<Args>(args) ...);
+    }
+
+    template<typename T>
+    void remove(entity_t entity) {
+        get_storage<T>().remove(entity);
+    }
+
+    // Removes all components of an entity
+    void remove_all(entity_t entity) {
+        for (auto& storage : storages) {
+            storage->remove(entity);
+        }
+    }
+
+    template<typename T>
+    bool has(entity_t entity) const {
+        return get_storage<T>().contains(entity);
+    }
+
+    template<typename T>
+    T& get(entity_t entity) {
+        return *get_storage<T>().find(entity);
+    }
+
+    template<typename T>
+    T const& get(entity_t entity) const {
+        return *get_storage<T>().find(entity);
+    }
+
+    template<typename T>
+    void enable_change_tracking(stl::uint64_t tick) {
+        get_storage<T>().enable_change_tracking(tick);
+    }
+
+    template<typename T>
+    void mark_changed(entity_t entity, stl::uint64_t tick) {
+        get_storage<T>().mark_changed(entity, tick);
+    }
+
+    template<typename T>
+    bool changed_since(entity_t entity, stl::uint64_t tick) const {
+        return get_storage<T>().changed_since(entity, tick);
+    }
+
+    template<typename... Ts>
+    component_view<Ts...> view() {
+        return { get_storage<Ts>() ... };
+    }
+
+    template<typename... Ts>
+    ecs::group<Ts...>& group() {
+        using group_type = ecs::group<Ts...>;
+
+        // Either all storages are owned by a group of exactly these types in this order, or none is owned yet
+        storage_observer* owner = first_storage<Ts...>().get_owner();
+        STL_ASSERT(((get_storage<Ts>().get_owner() == owner) && ...)
+            && (!owner || static_cast<group_base*>(owner)->type_key() == group_type::static_type_key()),
+            "Component type is already owned by a different group");
+        if (owner) {
+            return *static_cast<group_type*>(owner);
+        }
+
+        auto new_group = stl::make_unique<group_type>(get_storage<Ts>() ...);
+        group_type& result = *new_group;
+        groups.push_back(stl::move(new_group));
+        return result;
+    }
+
+private:
+    template<typename T, typename... Rest>
+    component_storage<T>& first_storage() {
+        return get_storage<T>();
+    }
+
+    // All storages are created up front, so this is a plain array access
+    template<typename T>
+    component_storage<T>& get_storage() {
+        return *static_cast<component_storage<T>*>(storages[get_component_type_id<T>()].get());
+    }
+
+    template<typename T>
+    component_storage<T> const& get_storage() const {
+        return *static_cast<component_storage<T> const*>(storages[get_component_type_id<T>()].get());
+    }
+
+    std::array<stl::unique_ptr<component_storage_base>, component_type_count> storages;
+    // Declared after the storages so groups are destroyed first
+    stl::vector<stl::unique_ptr<group_base>> groups;
+};
+
+} // namespace saturn::ecs
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SATURN_ECS_STORAGE_OBSERVER_HPP_
+#define SATURN_ECS_STORAGE_OBSERVER_HPP_
+
+#include <saturn/ecs/entity.hpp>
+
+namespace saturn::ecs {
+
+// Receives a callback whenever a component is added to or removed from a storage it is attached to.
+class storage_observer {
+public:
+    virtual ~storage_observer() = default;
+
+    // Called after the component was added
+    virtual void on_construct(entity_t entity) = 0;
+    // Called before the component is removed
+    virtual void on_remove(entity_t entity) = 0;
+};
+
+}
+
+#endif
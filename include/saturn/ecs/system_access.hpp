@@ -0,0 +1,129 @@
+#ifndef SATURN_ECS_SYSTEM_ACCESS_HPP_
+#define SATURN_ECS_SYSTEM_ACCESS_HPP_
+
+#include <saturn/ecs/component_id.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/assert.hpp>
+
+#include <bitset>
+#include <typeindex>
+#include <typeinfo>
+
+namespace saturn::ecs {
+
+// Describes which components a system reads and writes, and how it must be ordered relative to other systems.
+// The system_manager uses this to run systems that don't conflict in parallel.
+class system_access {
+public:
+    using component_set = std::bitset<component_type_count>;
+
+    template<typename... Ts>
+    void read() {
+        exclusive = false;
+        (reads.set(get_component_type_id<Ts>()), ...);
+    }
+
+    template<typename... Ts>
+    void write() {
+        exclusive = false;
+        (writes.set(get_component_type_id<Ts>()), ...);
+    }
+
+    // This system must run after system S, if S is registered
+    template<typename S>
+    void run_after() {
+        after.push_back(std::type_index(typeid(S)));
+    }
+
+    // This system must run before system S, if S is registered
+    template<typename S>
+    void run_before() {
+        before.push_back(std::type_index(typeid(S)));
+    }
+
+    // Forces the system to run on the thread calling system_manager::update_all, for example because it uses ImGui.
+    void main_thread_only() {
+        main_thread = true;
+    }
+
+    // Runs the system once per rendered frame instead of once per simulation tick, for example because it draws UI.
+    // Only makes a difference when the simulation runs at a fixed tick rate.
+    void once_per_frame() {
+        per_frame = true;
+    }
+
+    bool can_read(stl::uint64_t type_id) const {
+        return exclusive || reads.test(type_id) || writes.test(type_id);
+    }
+
+    bool can_write(stl::uint64_t type_id) const {
+        return exclusive || writes.test(type_id);
+    }
+
+    // Two systems conflict if one of them writes a component the other one uses
+    bool conflicts_with(system_access const& other) const {
+        if (exclusive || other.exclusive) { return true; }
+        return (writes & (other.reads | other.writes)).any() || (other.writes & reads).any();
+    }
+
+    // Systems that don't declare any component access can touch anything. They never run
+    // concurrently with other systems, and always run on the main thread.
+    bool exclusive = true;
+    bool main_thread = false;
+    bool per_frame = false;
+
+    component_set reads;
+    component_set writes;
+
+    stl::vector<std::type_index> after;
+    stl::vector<std::type_index> before;
+};
+
+// Access declaration of the system running on this thread, or null outside of system updates.
+// Only used when SATURN_ECS_VALIDATE_ACCESS is defined.
+system_access const*& current_system_access();
+
+// Sets the access declaration used for validation on this thread for its lifetime, and restores the previous one
+// afterwards. Systems can nest, since a thread waiting for its parallel iteration runs other tasks in the meantime.
+// Parallel iteration also uses it to give the chunks running on other threads the access of the calling system.
+class system_access_scope {
+public:
+    explicit system_access_scope(system_access const* access) : previous(current_system_access()) {
+        current_system_access() = access;
+    }
+
+    system_access_scope(system_access_scope const&) = delete;
+    system_access_scope& operator=(system_access_scope const&) = delete;
+
+    ~system_access_scope() {
+        current_system_access() = previous;
+    }
+
+private:
+    system_access const* previous;
+};
+
+// Called by the registry on every component access. When SATURN_ECS_VALIDATE_ACCESS is defined,
+// these assert that the running system declared the components it uses. Otherwise they compile to nothing.
+template<typename... Ts>
+void validate_read_access() {
+#ifdef SATURN_ECS_VALIDATE_ACCESS
+    system_access const* access = current_system_access();
+    STL_ASSERT(!access || (access->can_read(get_component_type_id<Ts>()) && ...), 
+        "System reads a component it did not declare");
+#endif
+}
+
+template<typename... Ts>
+void validate_write_access() {
+#ifdef SATURN_ECS_VALIDATE_ACCESS
+    system_access const* access = current_system_access();
+    STL_ASSERT(!access || (access->can_write(get_component_type_id<Ts>()) && ...), 
+        "System writes a component it did not declare");
+#endif
+}
+
+} // namespace saturn::ecs
+
+#endif
@@ -4,28 +4,79 @@
 #include <saturn/core/frame_context.hpp>
 #include <stl/vector.hpp>
 #include <stl/unique_ptr.hpp>
+#include <stl/utility.hpp>
 
 #include <saturn/systems/system.hpp>
+#include <saturn/ecs/system_access.hpp>
+#include <saturn/utility/thread_pool.hpp>
+
+#include <typeindex>
 
 namespace saturn::ecs {
 
+// Runs all systems each frame. Systems declare the components they access (see systems::System::declare_access),
+// from which a dependency graph is built. Systems that conflict run in registration order unless an explicit
+// ordering constraint says otherwise, systems that don't conflict run in parallel on the thread pool.
+// Updating throws std::runtime_error if the run_after/run_before constraints contain a cycle.
 class system_manager {
 public:
     template<typename S, typename... Args>
     void add_system(Args&&... args);
 
-    void startup(ph::VulkanContext& ctx, Scene& scene);
+    void startup(ph::VulkanContext* ctx, Scene& scene);
     void update_all(saturn::FrameContext& ctx);
 
+    // With a fixed tick rate the simulation and the frame are updated separately. update_tick() runs the systems
+    // that update per simulation tick, update_frame() the ones that declared once_per_frame().
+    void update_tick(saturn::FrameContext& ctx);
+    void update_frame(saturn::FrameContext& ctx);
+
+    // When disabled, all systems run on the calling thread, one after another in dependency order.
+    void set_parallel(bool parallel);
+
 private:
-    stl::vector<stl::unique_ptr<systems::System>> systems;
+    struct system_node {
+        stl::unique_ptr<systems::System> system;
+        std::type_index type;
+        system_access access;
+        // Indices of systems that can only start after this one finished
+        stl::vector<stl::size_t> successors;
+        stl::size_t dependency_count = 0;
+        // Readable type name, used for profiling zones
+        char const* name = nullptr;
+    };
+
+    struct frame_state;
+
+    enum class system_filter {
+        all,
+        tick,
+        frame
+    };
+
+    static bool matches(system_node const& node, system_filter filter);
+
+    void update(saturn::FrameContext& ctx, system_filter filter);
+    // Rebuilds the dependency graph. Only done when the set of systems changed.
+    void build_graph();
+    void run_sequential(saturn::FrameContext& ctx, system_filter filter);
+    void run_parallel(saturn::FrameContext& ctx, system_filter filter);
+    void schedule(frame_state& state, stl::size_t index);
+    void run_system(frame_state& state, stl::size_t index);
+
+    stl::vector<system_node> systems;
+    // Topologically sorted system indices
+    stl::vector<stl::size_t> execution_order;
+    bool graph_dirty = true;
+    bool parallel = true;
 };
 
 template<typename S, typename... Args>
 void system_manager::add_system(Args&&... args) {
-    systems.push_back(stl::make_unique<S>(stl::forward<Args>(args) ...));
+    systems.push_back(system_node{ stl::make_unique<S>(stl::forward<Args>(args) ...), std::type_index(typeid(S)), {}, {}, 0, nullptr });
+    graph_dirty = true;
 }
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,89 @@
+#ifndef SATURN_META_COMPONENT_IDS_HPP_
+#define SATURN_META_COMPONENT_IDS_HPP_
+
+#include <stl/types.hpp>
+
+namespace saturn::components {
+
+struct Blueprint;
+struct BlueprintInstance;
+struct Camera;
+struct EditorCamera;
+struct MeshRenderer;
+struct Name;
+struct PointLight;
+struct Rotator;
+struct StaticMesh;
+struct Transform;
+struct WorldTransform;
+
+}
+
+namespace saturn::meta {
+
+// Total amount of component types known to codegen
+constexpr stl::size_t component_count = 11;
+
+// Component ids are assigned by codegen in alphabetical order, so they are the same in every run and every binary
+// built with the same set of components. Using a type that isn't a component is a compile error.
+template<typename T>
+struct component_id;
+
+template<>
+struct component_id<::saturn::components::Blueprint> {
+    static constexpr stl::uint64_t value = 0;
+};
+
+template<>
+struct component_id<::saturn::components::BlueprintInstance> {
+    static constexpr stl::uint64_t value = 1;
+};
+
+template<>
+struct component_id<::saturn::components::Camera> {
+    static constexpr stl::uint64_t value = 2;
+};
+
+template<>
+struct component_id<::saturn::components::EditorCamera> {
+    static constexpr stl::uint64_t value = 3;
+};
+
+template<>
+struct component_id<::saturn::components::MeshRenderer> {
+    static constexpr stl::uint64_t value = 4;
+};
+
+template<>
+struct component_id<::saturn::components::Name> {
+    static constexpr stl::uint64_t value = 5;
+};
+
+template<>
+struct component_id<::saturn::components::PointLight> {
+    static constexpr stl::uint64_t value = 6;
+};
+
+template<>
+struct component_id<::saturn::components::Rotator> {
+    static constexpr stl::uint64_t value = 7;
+};
+
+template<>
+struct component_id<::saturn::components::StaticMesh> {
+    static constexpr stl::uint64_t value = 8;
+};
+
+template<>
+struct component_id<::saturn::components::Transform> {
+    static constexpr stl::uint64_t value = 9;
+};
+
+template<>
+struct component_id<::saturn::components::WorldTransform> {
+    static constexpr stl::uint64_t value = 10;
+};
+
+}
+
+#endif
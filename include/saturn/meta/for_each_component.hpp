@@ -10,13 +10,14 @@
 #include <saturn/components/name.hpp>
 #include <editor/components/editor_camera.hpp>
 #include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
 #include <samples/components/rotator.hpp>
 
 #include <stl/utility.hpp>
 
 namespace saturn::meta {
 
-#define component_list ::saturn::components::Blueprint, ::saturn::components::BlueprintInstance, ::saturn::components::Camera, ::saturn::components::MeshRenderer, ::saturn::components::StaticMesh, ::saturn::components::PointLight, ::saturn::components::Name, ::saturn::components::EditorCamera, ::saturn::components::Transform, ::saturn::components::Rotator 
+#define component_list ::saturn::components::Blueprint, ::saturn::components::BlueprintInstance, ::saturn::components::Camera, ::saturn::components::MeshRenderer, ::saturn::components::StaticMesh, ::saturn::components::PointLight, ::saturn::components::Name, ::saturn::components::EditorCamera, ::saturn::components::Transform, ::saturn::components::WorldTransform, ::saturn::components::Rotator 
 
 namespace detail {
 
@@ -13,6 +13,7 @@
 #include <saturn/components/name.hpp>
 #include <editor/components/editor_camera.hpp>
 #include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
 #include <samples/components/rotator.hpp>
 
 
@@ -76,6 +77,11 @@ inline TypeCategory type_category<components::Transform>() {
     return TypeCategory::Component;
 }
 
+template<>
+inline TypeCategory type_category<components::WorldTransform>() {
+    return TypeCategory::Component;
+}
+
 template<>
 inline TypeCategory type_category<components::Rotator>() {
     return TypeCategory::Component;
@@ -0,0 +1,110 @@
+#ifndef SATURN_AABB_TREE_HPP_
+#define SATURN_AABB_TREE_HPP_
+
+#include <saturn/ecs/entity.hpp>
+#include <saturn/scene/frustum_culling.hpp>
+#include <saturn/utility/bounds.hpp>
+
+#include <glm/vec3.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn {
+
+struct RayHit {
+    ecs::entity_t entity;
+    // Distance along the ray at which it enters the box of the entity, in units of the ray direction
+    float distance;
+};
+
+// Dynamic bounding volume hierarchy over entity boxes. Leaves store fattened boxes, so objects that move a little
+// don't touch the tree at all. When an object leaves its fat box, its leaf is reinserted and the ancestors are
+// refitted and rotated on the way up to keep the tree balanced.
+class AABBTree {
+public:
+    static constexpr stl::int32_t null_node = -1;
+
+    // Leaf boxes are grown by margin on every side
+    explicit AABBTree(float margin = 0.1f);
+
+    // Returns the proxy of the new leaf, which stays valid until it is removed
+    stl::int32_t insert(AABB const& box, ecs::entity_t entity);
+    void remove(stl::int32_t proxy);
+    // Updates the box of a proxy. Returns true if the leaf had to be reinserted.
+    bool move(stl::int32_t proxy, AABB const& box);
+    void clear();
+
+    // The query functions append the entities of all leaves that intersect the shape. Leaves are tested with their
+    // fat boxes, so results can contain entities that are up to margin away from the shape.
+    void query_box(AABB const& box, stl::vector<ecs::entity_t>& result) const;
+    void query_sphere(glm::vec3 center, float radius, stl::vector<ecs::entity_t>& result) const;
+    void query_frustum(Frustum const& frustum, stl::vector<ecs::entity_t>& result) const;
+    // Appends a hit for every leaf the ray enters within max_distance, sorted by distance
+    void query_ray(glm::vec3 origin, glm::vec3 direction, float max_distance, stl::vector<RayHit>& hits) const;
+
+    AABB const& get_fat_box(stl::int32_t proxy) const {
+        return nodes[proxy].box;
+    }
+
+    ecs::entity_t get_entity(stl::int32_t proxy) const {
+        return nodes[proxy].entity;
+    }
+
+    stl::size_t size() const {
+        return leaf_count;
+    }
+
+    // Height of the root, 0 for a tree with a single leaf
+    stl::int32_t height() const {
+        return root == null_node ? 0 : nodes[root].height;
+    }
+
+private:
+    struct Node {
+        AABB box;
+        // Next free node for unused nodes
+        stl::int32_t parent = null_node;
+        stl::int32_t left = null_node;
+        stl::int32_t right = null_node;
+        // Leaves have height 0, unused nodes -1
+        stl::int32_t height = -1;
+        ecs::entity_t entity = ecs::null_entity;
+
+        bool is_leaf() const {
+            return left == null_node;
+        }
+    };
+
+    // Result of testing a node against a query shape
+    enum class Overlap {
+        outside,
+        intersects,
+        // The whole node is inside the shape, so its leaves don't need testing
+        inside
+    };
+
+    stl::int32_t allocate_node();
+    void free_node(stl::int32_t node);
+
+    void insert_leaf(stl::int32_t leaf);
+    void remove_leaf(stl::int32_t leaf);
+    // Refits and rebalances all ancestors of a node, starting with the node itself
+    void refit_upwards(stl::int32_t node);
+    // Rotates the subtree at node if its children differ in height by more than 1. Returns the new subtree root.
+    stl::int32_t balance(stl::int32_t node);
+
+    // Calls test(box) for nodes from the root down, and appends the entities of the leaves that aren't outside
+    template<typename Test>
+    void query(Test&& test, stl::vector<ecs::entity_t>& result) const;
+
+    float margin;
+    stl::vector<Node> nodes;
+    stl::int32_t root = null_node;
+    stl::int32_t free_list = null_node;
+    stl::size_t leaf_count = 0;
+};
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SATURN_DRAW_BATCHING_HPP_
+#define SATURN_DRAW_BATCHING_HPP_
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn {
+
+// Sort key of a draw. Sorting by key orders draws by material, then by mesh, then front to back,
+// so draws that can be merged into one instanced batch end up next to each other.
+// Bits 63-48 hold the material index, bits 47-24 the mesh id and bits 23-0 the quantized view depth.
+using DrawKey = stl::uint64_t;
+
+constexpr stl::uint32_t max_draw_key_material = (1u << 16) - 1;
+constexpr stl::uint32_t max_draw_key_mesh = (1u << 24) - 1;
+
+// Depth is clamped to [0, max_depth] before it is quantized. The material index and mesh id must fit in their bits,
+// remap them with DrawKeyRemap first.
+DrawKey make_draw_key(stl::uint32_t material_index, stl::uint32_t mesh_id, float depth, float max_depth);
+
+// A draw to sort. Index refers to the draw in the caller's own arrays.
+struct DrawItem {
+    DrawKey key;
+    stl::uint32_t index;
+};
+
+// Stable LSD radix sort on the keys, one byte per pass. Passes where all keys share the same byte are skipped,
+// so sorting a scene with few materials and meshes mostly costs the depth passes.
+// Scratch is used as temporary storage and can be reused between calls to avoid allocations.
+void radix_sort(stl::vector<DrawItem>& items, stl::vector<DrawItem>& scratch);
+
+// A run of draws with the same material and mesh. After sorting, the per-instance data of a batch
+// is the contiguous range [first_instance, first_instance + instance_count) of the sorted draws.
+struct DrawBatch {
+    stl::uint32_t material_index;
+    stl::uint32_t mesh_id;
+    stl::uint32_t first_instance;
+    stl::uint32_t instance_count;
+};
+
+// Merges runs of sorted draws with the same material and mesh into batches. Batches are appended to batches.
+void build_batches(stl::vector<DrawItem> const& sorted, stl::vector<DrawBatch>& batches);
+
+// Maps the material indices and mesh ids of one frame's draws to dense indices in order of first use, so draw keys
+// stay within their bits however large asset ids grow. Only the ids used since the last clear() are reset, so a
+// frame costs time proportional to its draws.
+class DrawKeyRemap {
+public:
+    // Forgets the ids of the previous frame
+    void clear();
+
+    // Replaces both ids with their dense indices. Returns false and leaves them unchanged if the frame uses more
+    // distinct materials or meshes than fit in a key.
+    bool remap(stl::uint32_t& material_index, stl::uint32_t& mesh_id);
+
+    // Restores the original ids of a batch built from remapped keys
+    void restore(DrawBatch& batch) const;
+
+private:
+    struct Table {
+        // Indexed by original id, holds the dense index or unused
+        stl::vector<stl::uint32_t> dense;
+        // Indexed by dense index, holds the original id
+        stl::vector<stl::uint32_t> ids;
+    };
+
+    static constexpr stl::uint32_t unused = ~stl::uint32_t(0);
+
+    static bool remap(Table& table, stl::uint32_t& id, stl::uint32_t max_dense);
+
+    Table materials;
+    Table meshes;
+};
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef SATURN_FRUSTUM_CULLING_HPP_
+#define SATURN_FRUSTUM_CULLING_HPP_
+
+#include <saturn/utility/bounds.hpp>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn {
+
+// Six planes with normals pointing into the frustum, stored as (normal, distance).
+// A point p is inside a plane if dot(normal, p) + distance >= 0.
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+// Extracts the frustum planes from a projection * view matrix. The near plane assumes a -1..1 depth range,
+// which is slightly conservative when the projection maps depth to 0..1.
+Frustum extract_frustum(glm::mat4 const& view_projection);
+
+struct CullingStats {
+    // Amount of objects tested against the frustum
+    stl::size_t tested = 0;
+    // Amount of objects that passed
+    stl::size_t visible = 0;
+};
+
+// Culls objects against a frustum. Every object has a fixed index and is stored in world space as structure
+// of arrays, so the test runs on 4 objects at a time and objects only need updating when they move.
+// An object is visible when both its bounding sphere and its bounding box intersect the frustum.
+class FrustumCuller {
+public:
+    // New objects are never visible until they are set
+    void resize(stl::size_t count);
+
+    // Sets the bounds of an object. The bounds are transformed to world space here.
+    void set(stl::uint32_t index, Bounds const& local, glm::mat4 const& world);
+    // Makes an object always visible, for objects without bounds
+    void set_infinite(stl::uint32_t index);
+    // Makes an object never visible, for unused indices
+    void remove(stl::uint32_t index);
+
+    // Appends the indices of all visible objects to visible, in increasing order
+    void cull(Frustum const& frustum, stl::vector<stl::uint32_t>& visible) const;
+
+    stl::size_t size() const {
+        return radius.size();
+    }
+
+private:
+    void set_world(stl::uint32_t index, glm::vec3 center, glm::vec3 extents, float sphere_radius);
+
+    stl::vector<float> center_x;
+    stl::vector<float> center_y;
+    stl::vector<float> center_z;
+    stl::vector<float> extent_x;
+    stl::vector<float> extent_y;
+    stl::vector<float> extent_z;
+    stl::vector<float> radius;
+};
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef SATURN_LIGHT_CLUSTERS_HPP_
+#define SATURN_LIGHT_CLUSTERS_HPP_
+
+#include <saturn/utility/span.hpp>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn {
+
+// Lights are considered to stop affecting anything once intensity / distance^2 drops below this
+constexpr float light_cutoff = 1.0f / 256.0f;
+
+// Distance at which a light with this intensity falls below the cutoff
+float light_range(float intensity, float cutoff = light_cutoff);
+
+struct LightClusterConfig {
+    // Screen tiles in x and y
+    stl::uint32_t tiles_x = 16;
+    stl::uint32_t tiles_y = 9;
+    // Depth slices, distributed exponentially between near and far so clusters stay roughly cubic
+    stl::uint32_t slices = 24;
+    float near = 0.1f;
+    float far = 5000.0f;
+};
+
+// Range of light indices affecting one cluster
+struct ClusterLightRange {
+    stl::uint32_t offset;
+    stl::uint32_t count;
+};
+
+// Bins point lights into a 3D grid of clusters (froxels) over the camera frustum. The output is a compact list
+// of light indices per cluster, so shading a pixel only has to loop over the lights of its cluster.
+// Depth slices are binned in parallel. The projection is expected to be a symmetric perspective projection.
+class LightClusters {
+public:
+    explicit LightClusters(LightClusterConfig const& config = {});
+
+    // Positions are in world space, ranges are the light ranges from light_range(). Light indices in the output
+    // refer to these arrays.
+    void build(Span<glm::vec3 const> positions, Span<float const> ranges, glm::mat4 const& view, glm::mat4 const& projection);
+
+    LightClusterConfig const& get_config() const {
+        return config;
+    }
+
+    stl::uint32_t cluster_count() const {
+        return config.tiles_x * config.tiles_y * config.slices;
+    }
+
+    stl::uint32_t cluster_index(stl::uint32_t x, stl::uint32_t y, stl::uint32_t slice) const {
+        return (slice * config.tiles_y + y) * config.tiles_x + x;
+    }
+
+    // Depth slice of a positive view space depth
+    stl::uint32_t slice_of_depth(float depth) const;
+
+    // The offset and count of every cluster, indexed by cluster_index()
+    Span<ClusterLightRange const> get_cluster_ranges() const {
+        return Span<ClusterLightRange const>(cluster_ranges.data(), cluster_ranges.size());
+    }
+
+    // Light indices of all clusters, stored back to back
+    Span<stl::uint32_t const> get_light_indices() const {
+        return Span<stl::uint32_t const>(light_indices.data(), light_indices.size());
+    }
+
+    Span<stl::uint32_t const> lights_in_cluster(stl::uint32_t cluster) const {
+        ClusterLightRange const& range = cluster_ranges[cluster];
+        return Span<stl::uint32_t const>(light_indices.data() + range.offset, range.count);
+    }
+
+private:
+    // Tile rectangle of a light in one slice, inclusive. Empty if x0 > x1.
+    struct TileRect {
+        stl::int32_t x0, x1, y0, y1;
+    };
+
+    // Per slice working memory, so slices can be binned in parallel
+    struct SliceScratch {
+        stl::vector<stl::uint32_t> lights;
+        stl::vector<TileRect> rects;
+        stl::vector<stl::uint32_t> indices;
+        stl::uint32_t first_index = 0;
+    };
+
+    float slice_near(stl::uint32_t slice) const;
+    void bin_slice(stl::uint32_t slice, float scale_x, float scale_y);
+    TileRect tile_rect(stl::uint32_t light, float slice_min, float slice_max, float scale_x, float scale_y) const;
+
+    LightClusterConfig config;
+    // 1 / log(far / near), used to compute slices
+    float inverse_log_depth_ratio;
+
+    // View space light data of the current build, as structure of arrays
+    stl::vector<float> view_x;
+    stl::vector<float> view_y;
+    stl::vector<float> view_depth;
+    stl::vector<float> range;
+
+    stl::vector<SliceScratch> slice_scratch;
+    stl::vector<ClusterLightRange> cluster_ranges;
+    stl::vector<stl::uint32_t> light_indices;
+};
+
+} // namespace saturn
+
+#endif
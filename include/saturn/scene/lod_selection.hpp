@@ -0,0 +1,30 @@
+#ifndef SATURN_LOD_SELECTION_HPP_
+#define SATURN_LOD_SELECTION_HPP_
+
+#include <saturn/assets/assets.hpp>
+#include <saturn/utility/span.hpp>
+
+#include <stl/types.hpp>
+
+namespace saturn {
+
+struct LodSettings {
+    // Largest error a level may have on screen, as a fraction of the screen height. About a pixel at 1080p.
+    float max_screen_error = 1.0f / 1080.0f;
+    // Switching to a coarser level requires its error to be this fraction below the limit,
+    // so draws close to the limit don't flicker between two levels
+    float hysteresis = 0.25f;
+};
+
+// Fraction of the screen height covered by one unit of an object at a view space depth. Projection scale is
+// element [1][1] of the projection matrix, object scale the largest scale of the object's world transform.
+float lod_screen_scale(float projection_scale, float depth, float object_scale);
+
+// Picks the coarsest level whose error, projected with screen_scale, stays below the limit. Current is the level
+// the object had last frame. Lods must be ordered by increasing error, as returned by assets::get_mesh_lods().
+stl::uint32_t select_lod(Span<assets::MeshLod const> lods, float screen_scale, stl::uint32_t current, 
+    LodSettings const& settings);
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef SATURN_RENDER_SCENE_HPP_
+#define SATURN_RENDER_SCENE_HPP_
+
+#include <saturn/ecs/registry.hpp>
+#include <saturn/scene/frustum_culling.hpp>
+#include <saturn/scene/aabb_tree.hpp>
+#include <saturn/scene/draw_batching.hpp>
+#include <saturn/scene/light_clusters.hpp>
+#include <saturn/scene/lod_selection.hpp>
+
+#include <phobos/renderer/render_graph.hpp>
+
+#include <glm/mat4x4.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn {
+
+// Render data of a scene that is kept between frames. Every entity with a WorldTransform, StaticMesh and MeshRenderer
+// has a draw slot, and every entity with a WorldTransform and PointLight has a light slot. Slots are created and freed
+// by component add and remove events, and keep their index for as long as the entity has the components.
+// Each frame only the slots of changed components are patched.
+// The render scene only reads the registry in update(). Component events are queued until then, so
+// fill_render_graph() can run on another thread while systems modify the registry.
+class RenderScene {
+public:
+    RenderScene() = default;
+    RenderScene(RenderScene const&) = delete;
+    RenderScene& operator=(RenderScene const&) = delete;
+    ~RenderScene();
+
+    // Starts listening to component events of the registry and creates slots for the entities it already has.
+    // The registry must stay alive until the render scene is detached or destroyed.
+    void attach(ecs::registry& registry);
+    void detach();
+
+    // Patches the slots of components that were added or changed since the last update. With new_tick, the transforms
+    // of the previous update become the start point for interpolation. Pass false when only per frame systems ran
+    // since the last update.
+    void update(bool new_tick = true);
+
+    // Copies the materials to the graph. Materials are never removed, so this only copies when new ones were loaded.
+    // Reads the asset storage, so it must not run concurrently with asset loads.
+    void update_materials(ph::RenderGraph& graph);
+
+    // Writes the visible draws, sorted into batches, and the lights to the graph. The graph should be kept between frames.
+    // Nothing is culled if frustum is null.
+    // With a frustum, every draw also picks a level of detail for its mesh from its projected size.
+    // With a frustum, the lights are also binned into clusters using the view and projection of the graph.
+    // Draws and lights that moved in the last tick are placed at alpha between their previous and current transform.
+    void fill_render_graph(ph::RenderGraph& graph, Frustum const* frustum, float alpha = 1.0f);
+
+    void set_lod_settings(LodSettings const& settings) {
+        lod_settings = settings;
+    }
+
+    LodSettings const& get_lod_settings() const {
+        return lod_settings;
+    }
+
+    // Results of the last fill_render_graph() call
+    CullingStats const& get_culling_stats() const {
+        return stats;
+    }
+
+    // Instanced batches of the last fill_render_graph() call. The instance range of a batch indexes
+    // the draw commands and transforms of the render graph.
+    stl::vector<DrawBatch> const& get_draw_batches() const {
+        return draw_batches;
+    }
+
+    // Bounding volume hierarchy over the world space boxes of all draws with mesh bounds. It is kept up to date
+    // by update(), so queries reflect the transforms of the last update.
+    AABBTree const& get_spatial_index() const {
+        return spatial_index;
+    }
+
+    // Light clusters of the last fill_render_graph() call with a frustum. Light indices refer to
+    // the point lights of the render graph.
+    LightClusters const& get_light_clusters() const {
+        return light_clusters;
+    }
+
+private:
+    // Forwards the add and remove events of one component type to the slots that depend on it
+    class slot_observer : public ecs::storage_observer {
+    public:
+        slot_observer(RenderScene& scene, bool affects_draws, bool affects_lights)
+            : scene(scene), affects_draws(affects_draws), affects_lights(affects_lights) {}
+
+        void on_construct(ecs::entity_t entity) override;
+        void on_remove(ecs::entity_t entity) override;
+
+    private:
+        RenderScene& scene;
+        bool affects_draws;
+        bool affects_lights;
+    };
+
+    enum class SlotEvent : stl::uint8_t {
+        create_draw,
+        free_draw,
+        create_light,
+        free_light
+    };
+
+    struct PendingEvent {
+        ecs::entity_t entity;
+        SlotEvent event;
+    };
+
+    struct DrawSlot {
+        // Null for unused slots
+        ecs::entity_t entity = ecs::null_entity;
+        bool dirty = false;
+        // Cleared by the first patch, until then there is no previous transform to interpolate from
+        bool fresh = true;
+        // Set while the transform changed in the last tick, the slot is then in moving_draws
+        bool moving = false;
+        // Set while the mesh is loading, the slot is then in loading_draws
+        bool mesh_loading = false;
+        ph::RenderGraph::DrawCommand draw_cmd;
+        glm::mat4 transform;
+        // Transform before the last tick, equal to transform unless the slot is moving
+        glm::mat4 previous_transform;
+        // Mesh handle id + 1 of the current level of detail, so invalid meshes get id 0
+        stl::uint32_t mesh_id = 0;
+        Span<assets::MeshLod const> lods;
+        // Meshes of the levels of detail, looked up when the slot is patched so filling doesn't touch the asset storage
+        stl::vector<ph::Mesh*> lod_meshes;
+        stl::uint32_t lod = 0;
+        // Largest scale of the world transform, to project mesh errors
+        float lod_scale = 1.0f;
+        // Leaf in the spatial index, null while the mesh has no bounds
+        stl::int32_t proxy = AABBTree::null_node;
+    };
+
+    struct LightSlot {
+        // Null for unused slots
+        ecs::entity_t entity = ecs::null_entity;
+        bool dirty = false;
+        bool fresh = true;
+        bool moving = false;
+        ph::PointLight light;
+        glm::vec3 previous_position;
+    };
+
+    static constexpr stl::uint32_t null_slot = 0xFFFFFFFF;
+
+    void create_draw_slot(ecs::entity_t entity);
+    void free_draw_slot(ecs::entity_t entity);
+    void mark_draw_dirty(ecs::entity_t entity);
+    void patch_draw_slot(stl::uint32_t slot);
+    void set_draw_lod(DrawSlot& draw, stl::uint32_t lod);
+    void apply_pending_events();
+    void settle_moving_slots();
+
+    void create_light_slot(ecs::entity_t entity);
+    void free_light_slot(ecs::entity_t entity);
+    void mark_light_dirty(ecs::entity_t entity);
+    void patch_light_slot(stl::uint32_t slot);
+
+    bool has_draw_components(ecs::entity_t entity) const;
+    bool has_light_components(ecs::entity_t entity) const;
+
+    ecs::registry* registry = nullptr;
+    // Registry tick of the last update
+    stl::uint64_t last_tick = 0;
+
+    // Component events since the last update, in the order they happened
+    stl::vector<PendingEvent> pending_events;
+
+    slot_observer world_transform_observer { *this, true, true };
+    slot_observer static_mesh_observer { *this, true, false };
+    slot_observer mesh_renderer_observer { *this, true, false };
+    slot_observer point_light_observer { *this, false, true };
+
+    stl::vector<DrawSlot> draws;
+    stl::vector<stl::uint32_t> free_draws;
+    stl::vector<stl::uint32_t> dirty_draws;
+    stl::vector<stl::uint32_t> moving_draws;
+    // Draws whose mesh was loading when they were patched. Patched again once loads finish.
+    stl::vector<stl::uint32_t> loading_draws;
+    stl::uint64_t finished_loads = 0;
+    // Draw slot of each entity, indexed by entity index
+    stl::vector<stl::uint32_t> draw_slot_of;
+    stl::size_t live_draws = 0;
+
+    stl::vector<LightSlot> lights;
+    stl::vector<stl::uint32_t> free_lights;
+    stl::vector<stl::uint32_t> dirty_lights;
+    stl::vector<stl::uint32_t> moving_lights;
+    stl::vector<stl::uint32_t> light_slot_of;
+    // Set when the light list in the render graph has to be rebuilt
+    bool lights_changed = false;
+    stl::size_t live_lights = 0;
+    // Positions and ranges of the lights in the render graph, in the same order
+    stl::vector<glm::vec3> light_positions;
+    stl::vector<float> light_ranges;
+    LightClusters light_clusters;
+
+    // World space bounds of every draw slot, indexed by slot
+    FrustumCuller culler;
+    AABBTree spatial_index;
+
+    // Per frame scratch buffers, kept to reuse their memory
+    stl::vector<stl::uint32_t> visible_slots;
+    stl::vector<DrawItem> draw_items;
+    stl::vector<DrawItem> sort_scratch;
+    DrawKeyRemap draw_key_remap;
+    stl::vector<DrawBatch> draw_batches;
+    CullingStats stats;
+    LodSettings lod_settings;
+};
+
+} // namespace saturn
+
+#endif
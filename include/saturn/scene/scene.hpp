@@ -7,6 +7,9 @@
 #include <phobos/present/frame_info.hpp>
 
 #include <saturn/utility/context.hpp>
+#include <saturn/scene/render_scene.hpp>
+
+#include <glm/vec3.hpp>
 
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -29,7 +32,20 @@ public:
     stl::vector<ModelToLoad> models_to_load;
 
     void init_demo_scene(ph::VulkanContext* ctx);
+    // Loads a scene without a Vulkan context. Assets are imported, but nothing is uploaded to the GPU.
+    void init_headless_scene(fs::path const& ecs_path, fs::path const& blueprints_path);
+
     void build_render_graph(ph::FrameInfo& frame, ph::RenderGraph& graph);
+    // Same as above, for when there is no render target to take the aspect ratio from
+    void build_render_graph(ph::RenderGraph& graph, float aspect_ratio);
+
+    // build_render_graph() in two steps, so the second one can run on another thread while systems update.
+    // Copies the camera, materials and changed render data from the registry. With new_tick, the previous state
+    // becomes the start point for interpolation.
+    void sync_render_scene(ph::RenderGraph& graph, float aspect_ratio, bool new_tick = true);
+    // Fills the graph from the state of the last sync, with transforms and the camera placed at alpha between their
+    // previous and current state. Doesn't touch the registry or the asset storage.
+    void prepare_render_graph(ph::RenderGraph& graph, float alpha = 1.0f);
 
     void save_to_file(ecs::registry const& registry, fs::path const& path);
     void load_from_file(ecs::registry& registry, fs::path const& path);
@@ -38,6 +54,50 @@ public:
     void instantiate_blueprint(ecs::entity_t entity, ecs::entity_t blueprint);
     void find_main_camera();
     void load_assets(Context& ctx);
+
+    // Results of the last prepare_render_graph() call. Only read these while no graph is being prepared.
+
+    // Culling results of the last build_render_graph() call
+    CullingStats const& get_culling_stats() const {
+        return render_scene.get_culling_stats();
+    }
+
+    // Instanced batches of the last build_render_graph() call. The instance range of a batch indexes
+    // the draw commands and transforms of the render graph.
+    stl::vector<DrawBatch> const& get_draw_batches() const {
+        return render_scene.get_draw_batches();
+    }
+
+    // Spatial index over the bounds of all entities with a mesh, for frustum, ray, sphere and box queries
+    AABBTree const& get_spatial_index() const {
+        return render_scene.get_spatial_index();
+    }
+
+    // Point lights per cluster of the last build_render_graph() call with a camera
+    LightClusters const& get_light_clusters() const {
+        return render_scene.get_light_clusters();
+    }
+
+private:
+    struct RenderCamera {
+        bool valid = false;
+        glm::vec3 position;
+        glm::vec3 front;
+        glm::vec3 up;
+        float fov = 0.0f;
+        float aspect_ratio = 1.0f;
+    };
+
+    void load_scene(ph::VulkanContext* ctx, fs::path const& ecs_path, fs::path const& blueprints_path);
+
+    // Used by the serializers and importers while loading
+    Context load_context { nullptr, nullptr };
+
+    // Declared after ecs, so it is destroyed first and can detach from the registry
+    RenderScene render_scene;
+    // Camera of the last two syncs
+    RenderCamera camera;
+    RenderCamera previous_camera;
 };
 
 } // namespace saturn
@@ -12,6 +12,7 @@
 #include <saturn/components/name.hpp>
 #include <editor/components/editor_camera.hpp>
 #include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
 #include <samples/components/rotator.hpp>
 
 #include <saturn/ecs/registry.hpp>
@@ -3,6 +3,7 @@
 
 #include <phobos/forward.hpp>
 #include <saturn/core/frame_context.hpp>
+#include <saturn/ecs/system_access.hpp>
 
 namespace saturn::systems {
 
@@ -11,8 +12,13 @@ public:
     System() = default;
     virtual ~System() = default;
 
-    virtual void startup(ph::VulkanContext&, Scene&) {};
+    // The Vulkan context is null in headless runs
+    virtual void startup(ph::VulkanContext*, Scene&) {};
     virtual void update(FrameContext& ctx) = 0;
+
+    // Declare the components this system uses so it can run in parallel with other systems.
+    // Systems that don't override this are exclusive: they run alone, on the main thread.
+    virtual void declare_access(ecs::system_access&) {};
 };
 
 }
@@ -0,0 +1,50 @@
+#ifndef SATURN_TRANSFORM_SYSTEM_HPP_
+#define SATURN_TRANSFORM_SYSTEM_HPP_
+
+#include <saturn/systems/system.hpp>
+#include <saturn/ecs/storage_observer.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+namespace saturn::systems {
+
+// Computes the WorldTransform of every entity with a Transform. A Transform is relative to the nearest ancestor
+// that has one, ancestors without a Transform are skipped. Only entities whose Transform changed, and the
+// subtrees below them, are recomputed. The hierarchy is processed one depth level at a time: a level only depends
+// on the levels above it, so all entities in a level are updated in parallel.
+// The engine runs this after all other systems, right before the render graph is built. It is not registered
+// in the system_manager because it adds components, which can't happen while other systems are running.
+// Entities that lose their Transform also lose their WorldTransform, so they stop being rendered.
+class TransformSystem : public System {
+public:
+    TransformSystem() = default;
+    TransformSystem(TransformSystem const&) = delete;
+    TransformSystem& operator=(TransformSystem const&) = delete;
+    ~TransformSystem() override;
+
+    void startup(ph::VulkanContext*, Scene& scene) override;
+    void update(FrameContext& ctx) override;
+
+private:
+    // Collects the entities whose Transform was removed since the last update
+    class removed_transform_observer : public ecs::storage_observer {
+    public:
+        void on_construct(ecs::entity_t) override {}
+        void on_remove(ecs::entity_t entity) override {
+            entities.push_back(entity);
+        }
+
+        stl::vector<ecs::entity_t> entities;
+    };
+
+    // The registry of the scene passed to startup(), to detach the observer
+    ecs::registry* registry = nullptr;
+    removed_transform_observer removed_transforms;
+    // Registry tick of the previous update. Components stamped after this tick are dirty.
+    stl::uint64_t last_tick = 0;
+};
+
+} // namespace saturn::systems
+
+#endif
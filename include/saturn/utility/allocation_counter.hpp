@@ -0,0 +1,24 @@
+#ifndef SATURN_ALLOCATION_COUNTER_HPP_
+#define SATURN_ALLOCATION_COUNTER_HPP_
+
+#include <stl/types.hpp>
+
+namespace saturn {
+
+// Number of allocations made through the global operator new since the program started. Counting replaces the global
+// operator new and delete, which is only done when SATURN_COUNT_ALLOCATIONS is defined. Otherwise this always
+// returns 0.
+stl::uint64_t get_heap_allocation_count();
+
+// True if this build counts heap allocations
+constexpr bool is_counting_heap_allocations() {
+#ifdef SATURN_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+} // namespace saturn
+
+#endif
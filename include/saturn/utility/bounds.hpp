@@ -0,0 +1,78 @@
+#ifndef SATURN_UTILITY_BOUNDS_HPP_
+#define SATURN_UTILITY_BOUNDS_HPP_
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <stl/types.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace saturn {
+
+// Bounding volumes of a mesh in its local space: an axis aligned box stored as center and half extents,
+// and a sphere around the same center.
+struct Bounds {
+    glm::vec3 center = glm::vec3(0, 0, 0);
+    glm::vec3 extents = glm::vec3(0, 0, 0);
+    float radius = 0.0f;
+};
+
+// Axis aligned box stored as its corners
+struct AABB {
+    glm::vec3 min = glm::vec3(0, 0, 0);
+    glm::vec3 max = glm::vec3(0, 0, 0);
+};
+
+// Box around local bounds after transforming them with a world matrix
+inline AABB transform_bounds(Bounds const& local, glm::mat4 const& world) {
+    glm::vec4 const center = world * glm::vec4(local.center, 1.0f);
+
+    // Every world axis gets the absolute contribution of each local axis
+    float extents[3];
+    for (int row = 0; row < 3; ++row) {
+        extents[row] = std::abs(world[0][row]) * local.extents.x 
+            + std::abs(world[1][row]) * local.extents.y 
+            + std::abs(world[2][row]) * local.extents.z;
+    }
+
+    AABB box;
+    box.min = glm::vec3(center.x - extents[0], center.y - extents[1], center.z - extents[2]);
+    box.max = glm::vec3(center.x + extents[0], center.y + extents[1], center.z + extents[2]);
+    return box;
+}
+
+// Computes the bounds of interleaved vertex data. The position must be the first 3 floats of every vertex.
+inline Bounds compute_bounds(float const* vertices, stl::size_t vertex_count, stl::size_t vertex_size) {
+    if (vertex_count == 0) { return Bounds{}; }
+
+    glm::vec3 min(vertices[0], vertices[1], vertices[2]);
+    glm::vec3 max = min;
+    for (stl::size_t i = 1; i < vertex_count; ++i) {
+        float const* pos = vertices + i * vertex_size;
+        min = glm::vec3(std::min(min.x, pos[0]), std::min(min.y, pos[1]), std::min(min.z, pos[2]));
+        max = glm::vec3(std::max(max.x, pos[0]), std::max(max.y, pos[1]), std::max(max.z, pos[2]));
+    }
+
+    Bounds bounds;
+    bounds.center = glm::vec3((min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f);
+    bounds.extents = glm::vec3((max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f, (max.z - min.z) * 0.5f);
+
+    // The sphere is fitted to the vertices instead of the box corners, which is tighter for most meshes
+    float max_distance_sq = 0.0f;
+    for (stl::size_t i = 0; i < vertex_count; ++i) {
+        float const* pos = vertices + i * vertex_size;
+        float const dx = pos[0] - bounds.center.x;
+        float const dy = pos[1] - bounds.center.y;
+        float const dz = pos[2] - bounds.center.z;
+        max_distance_sq = std::max(max_distance_sq, dx * dx + dy * dy + dz * dz);
+    }
+    bounds.radius = std::sqrt(max_distance_sq);
+    return bounds;
+}
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef SATURN_FRAME_ARENA_HPP_
+#define SATURN_FRAME_ARENA_HPP_
+
+#include <saturn/utility/span.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace saturn {
+
+// Linear allocator for memory that only lives until the end of a frame. Allocating bumps an offset into a block,
+// and reset() frees everything at once. Allocating is thread safe, resetting is not.
+// When a frame needs more than the block holds, the extra memory comes from overflow blocks, and the next reset()
+// grows the block so later frames fit in it again.
+class FrameArena {
+public:
+    explicit FrameArena(stl::size_t block_size = 1 << 20);
+    FrameArena(FrameArena const&) = delete;
+    FrameArena& operator=(FrameArena const&) = delete;
+    ~FrameArena();
+
+    void* allocate(stl::size_t size, stl::size_t alignment = alignof(std::max_align_t));
+
+    // Value-initializes the elements. Destructors are never run, so only trivially destructible types are allowed.
+    template<typename T>
+    Span<T> allocate_array(stl::size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena memory is released without running destructors");
+        T* data = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        for (stl::size_t i = 0; i < count; ++i) {
+            new (data + i) T();
+        }
+        return Span<T>(data, count);
+    }
+
+    // Frees all allocations. Must not be called while other threads allocate.
+    void reset();
+
+    // Bytes allocated since the last reset, including alignment padding. Only exact while no other thread allocates.
+    stl::size_t get_used() const;
+    stl::size_t get_capacity() const {
+        return block_size;
+    }
+
+private:
+    void* allocate_overflow(stl::size_t size, stl::size_t alignment);
+
+    unsigned char* block = nullptr;
+    stl::size_t block_size = 0;
+    std::atomic<stl::size_t> offset = 0;
+
+    std::mutex overflow_mutex;
+    stl::vector<void*> overflow_blocks;
+    stl::size_t overflow_size = 0;
+};
+
+// Standard allocator that takes its memory from a frame arena, for containers of frame temporaries. Deallocation is
+// a no-op, the memory is released when the arena resets. Without an arena it falls back to the heap.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator(FrameArena* arena = nullptr) : arena(arena) {}
+
+    template<typename U>
+    ArenaAllocator(ArenaAllocator<U> const& other) : arena(other.get_arena()) {}
+
+    T* allocate(stl::size_t count) {
+        if (arena) {
+            return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, stl::size_t) {
+        if (!arena) {
+            ::operator delete(ptr);
+        }
+    }
+
+    FrameArena* get_arena() const {
+        return arena;
+    }
+
+    template<typename U>
+    bool operator==(ArenaAllocator<U> const& other) const {
+        return arena == other.get_arena();
+    }
+
+    template<typename U>
+    bool operator!=(ArenaAllocator<U> const& other) const {
+        return arena != other.get_arena();
+    }
+
+private:
+    FrameArena* arena;
+};
+
+} // namespace saturn
+
+#endif
@@ -5,12 +5,24 @@
 
 namespace saturn {
 
+// Refers to a value in a SlotMap. The id is the slot, the version tells apart the values that used the slot over time.
 template<typename T>
 struct Handle {
     stl::int64_t id = -1;
+    stl::uint32_t version = 0;
 };
 
+template<typename T>
+bool operator==(Handle<T> lhs, Handle<T> rhs) {
+    return lhs.id == rhs.id && lhs.version == rhs.version;
+}
+
+template<typename T>
+bool operator!=(Handle<T> lhs, Handle<T> rhs) {
+    return !(lhs == rhs);
+}
+
 } // namespace saturn
 
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,54 @@
+#ifndef SATURN_UTILITY_MAPPED_FILE_HPP_
+#define SATURN_UTILITY_MAPPED_FILE_HPP_
+
+#include <stl/types.hpp>
+
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace saturn {
+
+// Read-only memory mapping of a whole file. The contents are paged in by the OS when they are first touched,
+// instead of being copied into a buffer up front. The mapping is released when the MappedFile is destroyed.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(MappedFile&& rhs);
+    MappedFile& operator=(MappedFile&& rhs);
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+
+    // Returns false if the file doesn't exist, is empty or can't be mapped
+    bool open(fs::path const& path);
+    void close();
+
+    // Hints the OS to start reading the whole file in, so later accesses don't stall on page faults.
+    // Doesn't wait for the reads to finish.
+    void prefetch() const;
+
+    bool is_open() const {
+        return data_ptr != nullptr;
+    }
+
+    // Page aligned start of the file
+    stl::uint8_t const* data() const {
+        return data_ptr;
+    }
+
+    stl::size_t size() const {
+        return byte_size;
+    }
+
+private:
+    stl::uint8_t const* data_ptr = nullptr;
+    stl::size_t byte_size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace saturn
+
+#endif
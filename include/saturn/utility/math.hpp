@@ -4,6 +4,8 @@
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cmath>
+
 namespace glm {
 
 inline mat4 rotate(mat4 const& mat, vec3 euler) {
@@ -14,6 +16,21 @@ inline mat4 rotate(mat4 const& mat, vec3 euler) {
     return result;
 }
 
+// Same result as scale(rotate(translate(mat4(1), position), euler), scale), with the rotation written out
+// instead of going through three matrix products. Angles are in radians.
+inline mat4 compose_transform(vec3 position, vec3 euler, vec3 scale) {
+    float const sx = std::sin(euler.x), cx = std::cos(euler.x);
+    float const sy = std::sin(euler.y), cy = std::cos(euler.y);
+    float const sz = std::sin(euler.z), cz = std::cos(euler.z);
+
+    mat4 result;
+    result[0] = vec4(cz * cy, sz * cy, -sy, 0.0f) * scale.x;
+    result[1] = vec4(cz * sy * sx - sz * cx, sz * sy * sx + cz * cx, cy * sx, 0.0f) * scale.y;
+    result[2] = vec4(cz * sy * cx + sz * sx, sz * sy * cx - cz * sx, cy * cx, 0.0f) * scale.z;
+    result[3] = vec4(position, 1.0f);
+    return result;
+}
+
 } // namespace glm
 
 #endif
\ No newline at end of file
@@ -0,0 +1,161 @@
+#ifndef SATURN_PROFILER_HPP_
+#define SATURN_PROFILER_HPP_
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+#include <stl/unique_ptr.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace saturn {
+
+// One timed scope. Times are in nanoseconds since the profiler was created.
+struct ProfileZone {
+    // Points to a string literal or a string from Profiler::intern()
+    char const* name;
+    stl::uint64_t start;
+    stl::uint64_t end;
+    // Small index per thread, in order of the first zone recorded on it
+    stl::uint32_t thread;
+};
+
+// Time spent in zones with the same name, averaged over a range of frames
+struct ZoneSummary {
+    std::string_view name;
+    double average_ms = 0.0;
+    double max_ms = 0.0;
+    double calls_per_frame = 0.0;
+};
+
+// Collects timing zones from all threads. Every thread writes to its own ring buffer, so recording a zone
+// doesn't take locks, and only the most recent zones of each thread are kept. The buffer of a thread is freed
+// when the thread exits, along with its zones.
+// Use the SATURN_PROFILE_* macros, which compile to nothing unless SATURN_PROFILER is defined.
+class Profiler {
+public:
+    static constexpr stl::size_t zones_per_thread = 1 << 15;
+    static constexpr stl::size_t frame_history = 512;
+
+    static Profiler& get();
+
+    static stl::uint64_t now();
+
+    // Marks the start of a frame. Called by the engine on the main thread.
+    void begin_frame();
+    void record(char const* name, stl::uint64_t start, stl::uint64_t end);
+
+    // Returns a pointer that stays valid for the lifetime of the program, for zone names that aren't literals
+    char const* intern(std::string_view name);
+
+    // Recording can be paused, for example while looking at a capture
+    void set_enabled(bool enabled);
+    bool is_enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // Appends the completely written zones still in the ring buffers. Zones that are overwritten while copying
+    // are dropped.
+    void capture_zones(stl::vector<ProfileZone>& zones) const;
+    // Appends the start times of the most recent frames, oldest first
+    void capture_frames(stl::vector<stl::uint64_t>& frame_starts) const;
+    // Appends the heap allocation count at the start of the same frames, see get_heap_allocation_count()
+    void capture_frame_allocations(stl::vector<stl::uint64_t>& allocation_counts) const;
+
+    // Writes the captured zones in the Chrome trace event format, which chrome://tracing and Perfetto can open
+    bool write_chrome_trace(fs::path const& path) const;
+
+private:
+    // The fields are atomics so a capture can read a slot while its thread overwrites it. Relaxed loads and
+    // stores compile to plain moves.
+    struct ZoneSlot {
+        std::atomic<char const*> name;
+        std::atomic<stl::uint64_t> start;
+        std::atomic<stl::uint64_t> end;
+    };
+
+    struct ThreadBuffer {
+        ZoneSlot zones[zones_per_thread];
+        // Amount of zones whose write has started. Stored before the slot is written, so a capture can tell
+        // which of the slots it copied may have been overwritten.
+        std::atomic<stl::uint64_t> reserved = 0;
+        // Amount of zones that were completely written. The zone at head % size is the next one to be overwritten.
+        std::atomic<stl::uint64_t> head = 0;
+        stl::uint32_t thread = 0;
+    };
+
+    // Frees the buffer of a thread when the thread exits
+    struct ThreadBufferOwner {
+        ThreadBufferOwner() = default;
+        ThreadBufferOwner(ThreadBufferOwner const&) = delete;
+        ThreadBufferOwner& operator=(ThreadBufferOwner const&) = delete;
+        ~ThreadBufferOwner();
+
+        ThreadBuffer* buffer = nullptr;
+    };
+
+    Profiler();
+    ThreadBuffer& thread_buffer();
+    void free_thread_buffer(ThreadBuffer* buffer);
+
+    std::atomic<bool> enabled = true;
+
+    mutable std::mutex threads_mutex;
+    stl::vector<stl::unique_ptr<ThreadBuffer>> threads;
+    // Indices are not reused when a thread exits, so zones of different threads never share one
+    stl::uint32_t next_thread = 0;
+
+    stl::uint64_t frame_starts[frame_history] = {};
+    stl::uint64_t frame_allocations[frame_history] = {};
+    std::atomic<stl::uint64_t> frame_count = 0;
+
+    std::mutex names_mutex;
+    // Node based, so pointers to the strings stay valid
+    std::unordered_set<std::string> names;
+};
+
+// Averages the zones of all complete frames in frame_starts per name, sorted by average time
+void summarize_zones(stl::vector<ProfileZone> const& zones, stl::vector<stl::uint64_t> const& frame_starts,
+    stl::vector<ZoneSummary>& summaries);
+
+// Records a zone from its construction to its destruction
+class ProfileScope {
+public:
+    explicit ProfileScope(char const* name) : name(name), start(Profiler::get().is_enabled() ? Profiler::now() : 0) {}
+    ProfileScope(ProfileScope const&) = delete;
+    ProfileScope& operator=(ProfileScope const&) = delete;
+
+    ~ProfileScope() {
+        if (start != 0) {
+            Profiler::get().record(name, start, Profiler::now());
+        }
+    }
+
+private:
+    char const* name;
+    stl::uint64_t start;
+};
+
+} // namespace saturn
+
+#define SATURN_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SATURN_PROFILE_CONCAT(a, b) SATURN_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef SATURN_PROFILER
+    // Times the rest of the enclosing scope. The name must outlive the profiler, use a literal or Profiler::intern().
+    #define SATURN_PROFILE_SCOPE(name) ::saturn::ProfileScope SATURN_PROFILE_CONCAT(saturn_profile_scope_, __LINE__)(name)
+    #define SATURN_PROFILE_FUNCTION() SATURN_PROFILE_SCOPE(__func__)
+    #define SATURN_PROFILE_BEGIN_FRAME() ::saturn::Profiler::get().begin_frame()
+#else
+    #define SATURN_PROFILE_SCOPE(name) ((void)0)
+    #define SATURN_PROFILE_FUNCTION() ((void)0)
+    #define SATURN_PROFILE_BEGIN_FRAME() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef SATURN_UTILITY_SLOT_MAP_HPP_
+#define SATURN_UTILITY_SLOT_MAP_HPP_
+
+#include <saturn/utility/handle.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+#include <stl/utility.hpp>
+#include <stl/assert.hpp>
+
+#include <new>
+
+namespace saturn {
+
+// Stores values densely and hands out Handle<T>s to them. A handle keeps referring to the same value while other
+// values are added and removed. Every slot has a version that is bumped when its value is removed, so handles
+// to removed values are detected instead of silently referring to whatever reuses the slot.
+// Handle ids are slot indices. Values are stored without gaps in fixed size pages, so pointers to them stay valid
+// while values are added. Erasing moves the last value into the hole.
+template<typename T, typename Value = T>
+class SlotMap {
+public:
+    SlotMap() = default;
+    SlotMap(SlotMap const&) = delete;
+    SlotMap& operator=(SlotMap const&) = delete;
+
+    ~SlotMap() {
+        clear();
+        for (Value* page : pages) {
+            ::operator delete(page);
+        }
+    }
+
+    Handle<T> insert(Value&& value) {
+        stl::uint32_t index;
+        if (!free_slots.empty()) {
+            index = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            index = static_cast<stl::uint32_t>(slots.size());
+            slots.push_back(Slot{});
+        }
+
+        if (count == pages.size() * page_size) {
+            pages.push_back(static_cast<Value*>(::operator new(page_size * sizeof(Value))));
+        }
+        new (&value_at(count)) Value(stl::move(value));
+
+        slots[index].dense_index = static_cast<stl::uint32_t>(count);
+        dense_to_slot.push_back(index);
+        ++count;
+        return { index, slots[index].version };
+    }
+
+    // Returns false if the handle didn't refer to a value
+    bool erase(Handle<T> handle) {
+        if (!contains(handle)) { return false; }
+
+        Slot& slot = slots[handle.id];
+        // Move the last value into the hole, so values stay contiguous
+        stl::uint32_t const last = static_cast<stl::uint32_t>(count - 1);
+        if (slot.dense_index != last) {
+            value_at(slot.dense_index) = stl::move(value_at(last));
+            dense_to_slot[slot.dense_index] = dense_to_slot[last];
+            slots[dense_to_slot[last]].dense_index = slot.dense_index;
+        }
+        value_at(last).~Value();
+        dense_to_slot.pop_back();
+        --count;
+
+        slot.dense_index = npos;
+        ++slot.version;
+        free_slots.push_back(static_cast<stl::uint32_t>(handle.id));
+        return true;
+    }
+
+    // Removes all values. Handles from before the call stay invalid, even after their slot is reused.
+    void clear() {
+        for (stl::size_t i = 0; i < count; ++i) {
+            value_at(i).~Value();
+            Slot& slot = slots[dense_to_slot[i]];
+            slot.dense_index = npos;
+            ++slot.version;
+            free_slots.push_back(dense_to_slot[i]);
+        }
+        dense_to_slot.clear();
+        count = 0;
+    }
+
+    bool contains(Handle<T> handle) const {
+        return handle.id >= 0 && static_cast<stl::size_t>(handle.id) < slots.size()
+            && slots[handle.id].version == handle.version && slots[handle.id].dense_index != npos;
+    }
+
+    // Returns nullptr if the handle doesn't refer to a value
+    Value* get(Handle<T> handle) {
+        if (!contains(handle)) { return nullptr; }
+        return &value_at(slots[handle.id].dense_index);
+    }
+
+    Value const* get(Handle<T> handle) const {
+        if (!contains(handle)) { return nullptr; }
+        return &value_at(slots[handle.id].dense_index);
+    }
+
+    // Values by position, for iterating over all of them. Positions change when values are erased.
+    Value& value_at(stl::size_t dense_index) {
+        STL_ASSERT(dense_index < pages.size() * page_size, "Slot map position out of range");
+        return pages[dense_index / page_size][dense_index % page_size];
+    }
+
+    Value const& value_at(stl::size_t dense_index) const {
+        STL_ASSERT(dense_index < pages.size() * page_size, "Slot map position out of range");
+        return pages[dense_index / page_size][dense_index % page_size];
+    }
+
+    // Handle of the value at a position
+    Handle<T> handle_at(stl::size_t dense_index) const {
+        stl::uint32_t const index = dense_to_slot[dense_index];
+        return { index, slots[index].version };
+    }
+
+    stl::size_t size() const {
+        return count;
+    }
+
+    // One past the largest handle id that was ever handed out
+    stl::size_t slot_count() const {
+        return slots.size();
+    }
+
+private:
+    static constexpr stl::uint32_t npos = static_cast<stl::uint32_t>(-1);
+    static constexpr stl::size_t page_size = 256;
+
+    struct Slot {
+        stl::uint32_t dense_index = npos;
+        stl::uint32_t version = 0;
+    };
+
+    stl::vector<Value*> pages;
+    stl::size_t count = 0;
+    stl::vector<stl::uint32_t> dense_to_slot;
+    stl::vector<Slot> slots;
+    stl::vector<stl::uint32_t> free_slots;
+};
+
+} // namespace saturn
+
+#endif
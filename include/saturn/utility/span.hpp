@@ -0,0 +1,54 @@
+#ifndef SATURN_UTILITY_SPAN_HPP_
+#define SATURN_UTILITY_SPAN_HPP_
+
+#include <stl/types.hpp>
+#include <stl/assert.hpp>
+
+namespace saturn {
+
+// Non-owning view of a contiguous array. Element access is unchecked in release builds,
+// so loops over a span can be vectorized.
+template<typename T>
+class Span {
+public:
+    Span() = default;
+    Span(T* ptr, stl::size_t count) : ptr(ptr), count(count) {}
+
+    T* data() const {
+        return ptr;
+    }
+
+    stl::size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    T& operator[](stl::size_t index) const {
+        STL_ASSERT(index < count, "Span index out of range");
+        return ptr[index];
+    }
+
+    T* begin() const {
+        return ptr;
+    }
+
+    T* end() const {
+        return ptr + count;
+    }
+
+    Span subspan(stl::size_t offset, stl::size_t length) const {
+        STL_ASSERT(offset + length <= count, "Subspan out of range");
+        return Span(ptr + offset, length);
+    }
+
+private:
+    T* ptr = nullptr;
+    stl::size_t count = 0;
+};
+
+} // namespace saturn
+
+#endif
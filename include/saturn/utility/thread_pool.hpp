@@ -0,0 +1,103 @@
+#ifndef SATURN_THREAD_POOL_HPP_
+#define SATURN_THREAD_POOL_HPP_
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+#include <stl/unique_ptr.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace saturn {
+
+// Counts outstanding tasks submitted to a ThreadPool. ThreadPool::wait() blocks until it reaches zero.
+class WaitGroup {
+public:
+    bool done() const {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class ThreadPool;
+
+    std::atomic<stl::size_t> pending = 0;
+};
+
+// Thread pool where every worker has its own task queue. Workers take tasks from the front of their own queue
+// and steal from the back of other queues when they run out of work.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    // The calling thread always participates in wait(), so thread_count - 1 worker threads are spawned.
+    // A thread count of 0 or 1 runs everything on the calling thread.
+    explicit ThreadPool(stl::size_t thread_count = std::thread::hardware_concurrency());
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+    ~ThreadPool();
+
+    // Process-wide pool used by ECS views and systems
+    static ThreadPool& get_default();
+
+    void submit(WaitGroup& group, Task task);
+    // Blocks until all tasks in the group are done. The calling thread executes tasks while waiting.
+    void wait(WaitGroup& group);
+
+    // Runs a single queued task on the calling thread. Returns false if there was no task to run.
+    bool run_pending_task();
+
+    // Calls f(begin, end) for consecutive ranges of [0, count) of at most chunk_size elements and waits for all of them.
+    void parallel_for(stl::size_t count, stl::size_t chunk_size, std::function<void(stl::size_t, stl::size_t)> const& f);
+
+    // In deterministic mode all work runs on the calling thread, in submission order. Used for tests and debugging.
+    void set_deterministic(bool deterministic);
+    bool is_deterministic() const;
+
+    // Number of threads that execute tasks, including the calling thread
+    stl::size_t thread_count() const;
+
+private:
+    struct TaskEntry {
+        Task task;
+        WaitGroup* group = nullptr;
+    };
+
+    // Ring buffer of tasks. It only grows, so once it is large enough queueing a task doesn't allocate.
+    struct WorkQueue {
+        void push_back(TaskEntry&& entry);
+        TaskEntry pop_front();
+        TaskEntry pop_back();
+        bool empty() const {
+            return count == 0;
+        }
+
+        std::mutex mutex;
+        stl::vector<TaskEntry> slots;
+        stl::size_t head = 0;
+        stl::size_t count = 0;
+    };
+
+    void worker_main(stl::size_t index);
+    bool try_pop(stl::size_t index, TaskEntry& entry);
+    bool try_steal(stl::size_t thief, TaskEntry& entry);
+    bool try_run_one(stl::size_t index);
+    static void run(TaskEntry& entry);
+
+    // One queue per worker, plus one for the threads calling wait()
+    stl::vector<stl::unique_ptr<WorkQueue>> queues;
+    stl::vector<std::thread> workers;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake_up;
+    std::atomic<stl::size_t> queued_tasks = 0;
+    std::atomic<stl::size_t> next_queue = 0;
+    std::atomic<bool> stop = false;
+    std::atomic<bool> deterministic = false;
+};
+
+} // namespace saturn
+
+#endif
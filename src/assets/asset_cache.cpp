@@ -0,0 +1,573 @@
+#include <saturn/assets/asset_cache.hpp>
+#include <saturn/utility/mapped_file.hpp>
+#include <saturn/utility/profiler.hpp>
+#include <saturn/utility/span.hpp>
+
+#include <stl/utility.hpp>
+#include <stl/vector.hpp>
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+namespace saturn::assets {
+
+namespace {
+
+// An entry file consists of
+//  - an EntryHeader
+//  - header.file_count file records, the source first: its FileStamp and its path as a length prefixed string
+//  - the payload written by write_model() or write_texture()
+// Arrays in the payload are prefixed with their length and aligned to entry_alignment, so meshes can use them in
+// place once the entry is mapped.
+
+constexpr char entry_magic[4] = { 'S', 'D', 'D', 'C' };
+// Bump when the entry layout changes. Entries of other versions count as outdated.
+constexpr stl::uint32_t entry_format_version = 1;
+constexpr stl::size_t entry_alignment = 16;
+
+// Recorded as the size of missing files, so entries notice when they are added
+constexpr stl::uint64_t missing_file_size = ~stl::uint64_t(0);
+
+enum class EntryKind : stl::uint32_t {
+    Model = 0,
+    Texture = 1
+};
+
+struct EntryHeader {
+    char magic[4];
+    stl::uint32_t format_version;
+    stl::uint64_t importer_key;
+    EntryKind kind;
+    stl::uint32_t file_count;
+};
+
+// Identifies the contents of a file
+struct FileStamp {
+    stl::uint64_t size = missing_file_size;
+    stl::int64_t write_time = 0;
+    stl::uint64_t content_hash = 0;
+};
+
+static_assert(sizeof(EntryHeader) == 24);
+static_assert(sizeof(FileStamp) == 24);
+
+struct AtomicCacheStats {
+    std::atomic<stl::uint64_t> hits { 0 };
+    std::atomic<stl::uint64_t> misses { 0 };
+    std::atomic<stl::uint64_t> invalidations { 0 };
+    std::atomic<stl::uint64_t> stores { 0 };
+    std::atomic<stl::uint64_t> failed_stores { 0 };
+    std::atomic<stl::uint64_t> bytes_read { 0 };
+    std::atomic<stl::uint64_t> bytes_written { 0 };
+};
+
+fs::path cache_directory = "data/cache";
+AtomicCacheStats stats;
+// Makes the names of temporary entry files unique
+std::atomic<stl::uint64_t> next_temp_file { 0 };
+
+// xxHash64
+constexpr stl::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+constexpr stl::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr stl::uint64_t prime3 = 0x165667B19E3779F9ull;
+constexpr stl::uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr stl::uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+stl::uint64_t rotate_left(stl::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+template<typename T>
+T read_unaligned(stl::uint8_t const* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+stl::uint64_t hash_round(stl::uint64_t accumulator, stl::uint64_t input) {
+    return rotate_left(accumulator + input * prime2, 31) * prime1;
+}
+
+stl::uint64_t merge_round(stl::uint64_t hash, stl::uint64_t accumulator) {
+    return (hash ^ hash_round(0, accumulator)) * prime1 + prime4;
+}
+
+FileStamp stat_file(fs::path const& path) {
+    FileStamp stamp;
+    std::error_code error;
+    stl::uint64_t const size = fs::file_size(path, error);
+    if (error) { return stamp; }
+    fs::file_time_type const write_time = fs::last_write_time(path, error);
+    if (error) { return stamp; }
+
+    stamp.size = size;
+    stamp.write_time = static_cast<stl::int64_t>(write_time.time_since_epoch().count());
+    return stamp;
+}
+
+// Fills in the content hash of a stamp. Returns false if the file can't be read.
+bool hash_file(fs::path const& path, FileStamp& stamp) {
+    if (stamp.size == missing_file_size || stamp.size == 0) {
+        stamp.content_hash = 0;
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.open(path)) { return false; }
+    stamp.content_hash = hash_bytes(file.data(), file.size());
+    return true;
+}
+
+// Compares a file with the stamp it had when the entry was written. Files of the same size that were written since
+// are hashed, so touching a file doesn't invalidate the entry.
+bool is_unchanged(fs::path const& path, FileStamp const& recorded) {
+    FileStamp current = stat_file(path);
+    if (current.size != recorded.size) { return false; }
+    if (current.size == missing_file_size || current.write_time == recorded.write_time) { return true; }
+    return hash_file(path, current) && current.content_hash == recorded.content_hash;
+}
+
+// Sources are identified by their absolute path, so the same file is found from every working directory
+std::string get_source_name(fs::path const& source) {
+    std::error_code error;
+    fs::path const absolute = fs::absolute(source, error);
+    return (error ? source : absolute).lexically_normal().generic_string();
+}
+
+fs::path get_entry_path(std::string const& source_name, EntryKind kind) {
+    stl::uint64_t const hash = hash_bytes(source_name.data(), source_name.size(), static_cast<stl::uint64_t>(kind));
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cache", static_cast<unsigned long long>(hash));
+    return cache_directory / name;
+}
+
+// Writes an entry, keeping track of the offset so arrays can be aligned
+class EntryWriter {
+public:
+    explicit EntryWriter(fs::path const& path) : file(path, std::ios::binary | std::ios::trunc) {}
+
+    // Returns false if anything couldn't be written
+    bool close() {
+        file.close();
+        return !file.fail();
+    }
+
+    stl::uint64_t size() const {
+        return offset;
+    }
+
+    void write_bytes(void const* data, stl::size_t size) {
+        file.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+        offset += size;
+    }
+
+    template<typename T>
+    void write(T const& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write_bytes(&value, sizeof(T));
+    }
+
+    void write_string(std::string const& string) {
+        write<stl::uint64_t>(string.size());
+        write_bytes(string.data(), string.size());
+    }
+
+    template<typename T>
+    void write_array(T const* data, stl::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static constexpr char zeros[entry_alignment] = {};
+        write<stl::uint64_t>(count);
+        write_bytes(zeros, (entry_alignment - offset % entry_alignment) % entry_alignment);
+        write_bytes(data, count * sizeof(T));
+    }
+
+private:
+    std::ofstream file;
+    stl::uint64_t offset = 0;
+};
+
+// Reads an entry from its mapping. Reading past the end marks the reader as failed instead, and returns empty values.
+class EntryReader {
+public:
+    EntryReader(stl::uint8_t const* data, stl::size_t size) : data(data), byte_size(size) {}
+
+    bool failed() const {
+        return has_failed;
+    }
+
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value {};
+        if (!advance(sizeof(T))) { return value; }
+        std::memcpy(&value, data + offset - sizeof(T), sizeof(T));
+        return value;
+    }
+
+    std::string read_string() {
+        stl::uint64_t const length = read<stl::uint64_t>();
+        if (!advance(length)) { return {}; }
+        return std::string(reinterpret_cast<char const*>(data + offset - length), length);
+    }
+
+    // Returns an array written by EntryWriter::write_array() in place
+    template<typename T>
+    Span<T const> read_array() {
+        stl::uint64_t const count = read<stl::uint64_t>();
+        if (!advance((entry_alignment - offset % entry_alignment) % entry_alignment)) { return {}; }
+        if (count > (byte_size - offset) / sizeof(T)) {
+            has_failed = true;
+            return {};
+        }
+        Span<T const> const array(reinterpret_cast<T const*>(data + offset), count);
+        offset += count * sizeof(T);
+        return array;
+    }
+
+    template<typename T>
+    stl::vector<T> read_vector() {
+        Span<T const> const array = read_array<T>();
+        stl::vector<T> result(stl::tags::uninitialized, array.size());
+        if (!array.empty()) {
+            std::memcpy(result.data(), array.data(), array.size() * sizeof(T));
+        }
+        return result;
+    }
+
+private:
+    bool advance(stl::uint64_t bytes) {
+        if (has_failed || bytes > byte_size - offset) {
+            has_failed = true;
+            return false;
+        }
+        offset += bytes;
+        return true;
+    }
+
+    stl::uint8_t const* data;
+    stl::size_t byte_size;
+    stl::size_t offset = 0;
+    bool has_failed = false;
+};
+
+// Maps the entry of source and checks that it is up to date. On success, reader is positioned at the payload.
+// Counts misses and invalidations.
+std::shared_ptr<MappedFile const> open_entry(fs::path const& source, EntryKind kind, stl::uint64_t importer_key,
+    EntryReader& reader) {
+    if (cache_directory.empty()) { return nullptr; }
+
+    std::string const source_name = get_source_name(source);
+    MappedFile file;
+    if (!file.open(get_entry_path(source_name, kind))) {
+        stats.misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    reader = EntryReader(file.data(), file.size());
+    EntryHeader const header = reader.read<EntryHeader>();
+    bool up_to_date = !reader.failed() && std::memcmp(header.magic, entry_magic, sizeof(header.magic)) == 0
+        && header.format_version == entry_format_version && header.importer_key == importer_key
+        && header.kind == kind && header.file_count > 0;
+
+    for (stl::uint32_t i = 0; up_to_date && i < header.file_count; ++i) {
+        FileStamp const stamp = reader.read<FileStamp>();
+        std::string const path = reader.read_string();
+        if (reader.failed()) {
+            up_to_date = false;
+        } else if (i == 0) {
+            // Guards against two sources whose paths have the same hash
+            up_to_date = path == source_name && is_unchanged(source, stamp);
+        } else {
+            up_to_date = is_unchanged(path, stamp);
+        }
+    }
+
+    if (!up_to_date) {
+        stats.invalidations.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return std::make_shared<MappedFile const>(stl::move(file));
+}
+
+// Counts the result of reading the payload of an entry opened with open_entry()
+void count_read(bool valid, MappedFile const& file) {
+    if (!valid) {
+        stats.invalidations.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    stats.hits.fetch_add(1, std::memory_order_relaxed);
+    stats.bytes_read.fetch_add(file.size(), std::memory_order_relaxed);
+}
+
+template<typename F>
+bool write_entry(fs::path const& source, EntryKind kind, stl::uint64_t importer_key,
+    stl::vector<fs::path> const& dependencies, F&& write_payload) {
+    if (cache_directory.empty()) { return false; }
+
+    auto fail = [] {
+        stats.failed_stores.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    };
+
+    std::error_code error;
+    fs::create_directories(cache_directory, error);
+    if (error) { return fail(); }
+
+    // Stamped after the import, which read the files recently, so hashing them mostly hits the OS file cache
+    std::string const source_name = get_source_name(source);
+    stl::vector<FileStamp> stamps(stl::tags::reserve, dependencies.size() + 1);
+    for (stl::size_t i = 0; i <= dependencies.size(); ++i) {
+        fs::path const& path = i == 0 ? source : dependencies[i - 1];
+        FileStamp stamp = stat_file(path);
+        if (!hash_file(path, stamp)) { return fail(); }
+        stamps.push_back(stamp);
+    }
+
+    fs::path const entry_path = get_entry_path(source_name, kind);
+    // Unique per write, so threads storing the same source don't write into each other's file. Replacing the entry
+    // only at the end also keeps mappings of the previous one intact.
+    fs::path temp_path = entry_path;
+    temp_path += "." + std::to_string(next_temp_file.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+
+    EntryWriter writer(temp_path);
+    EntryHeader header {};
+    std::memcpy(header.magic, entry_magic, sizeof(header.magic));
+    header.format_version = entry_format_version;
+    header.importer_key = importer_key;
+    header.kind = kind;
+    header.file_count = static_cast<stl::uint32_t>(stamps.size());
+    writer.write(header);
+    for (stl::size_t i = 0; i < stamps.size(); ++i) {
+        writer.write(stamps[i]);
+        writer.write_string(i == 0 ? source_name : dependencies[i - 1].generic_string());
+    }
+    write_payload(writer);
+
+    if (writer.close()) {
+        fs::rename(temp_path, entry_path, error);
+    } else {
+        error = std::make_error_code(std::errc::io_error);
+    }
+    if (error) {
+        fs::remove(temp_path, error);
+        return fail();
+    }
+
+    stats.stores.fetch_add(1, std::memory_order_relaxed);
+    stats.bytes_written.fetch_add(writer.size(), std::memory_order_relaxed);
+    return true;
+}
+
+void write_model(EntryWriter& writer, ImportedModel const& model) {
+    writer.write<stl::uint64_t>(model.meshes.size());
+    for (ImportedMesh const& mesh : model.meshes) {
+        writer.write_string(mesh.name);
+        writer.write<stl::uint64_t>(mesh.vertex_size);
+        writer.write(mesh.material);
+        writer.write(mesh.bounds);
+        Span<float const> const vertices = mesh.vertex_data();
+        Span<stl::uint32_t const> const indices = mesh.index_data();
+        writer.write_array(vertices.data(), vertices.size());
+        writer.write_array(indices.data(), indices.size());
+
+        writer.write<stl::uint64_t>(mesh.lods.size());
+        for (ImportedMeshLod const& lod : mesh.lods) {
+            writer.write(lod.error);
+            writer.write_array(lod.vertices.data(), lod.vertices.size());
+            writer.write_array(lod.indices.data(), lod.indices.size());
+        }
+    }
+
+    writer.write<stl::uint64_t>(model.materials.size());
+    for (ImportedMaterial const& material : model.materials) {
+        writer.write_string(material.name);
+        writer.write_string(material.texture_path.generic_string());
+    }
+
+    writer.write<stl::uint64_t>(model.nodes.size());
+    for (ImportedNode const& node : model.nodes) {
+        writer.write(node.mesh);
+        writer.write_array(node.children.data(), node.children.size());
+    }
+}
+
+void read_model(EntryReader& reader, std::shared_ptr<MappedFile const> const& mapping, ImportedModel& model) {
+    stl::uint64_t const mesh_count = reader.read<stl::uint64_t>();
+    for (stl::uint64_t i = 0; i < mesh_count && !reader.failed(); ++i) {
+        ImportedMesh mesh;
+        mesh.name = reader.read_string();
+        mesh.vertex_size = reader.read<stl::uint64_t>();
+        mesh.material = reader.read<stl::uint32_t>();
+        mesh.bounds = reader.read<Bounds>();
+        mesh.mapping = mapping;
+        mesh.mapped_vertices = reader.read_array<float>();
+        mesh.mapped_indices = reader.read_array<stl::uint32_t>();
+
+        stl::uint64_t const lod_count = reader.read<stl::uint64_t>();
+        for (stl::uint64_t level = 0; level < lod_count && !reader.failed(); ++level) {
+            ImportedMeshLod lod;
+            lod.error = reader.read<float>();
+            lod.vertices = reader.read_vector<float>();
+            lod.indices = reader.read_vector<stl::uint32_t>();
+            mesh.lods.push_back(stl::move(lod));
+        }
+        model.meshes.push_back(stl::move(mesh));
+    }
+
+    stl::uint64_t const material_count = reader.read<stl::uint64_t>();
+    for (stl::uint64_t i = 0; i < material_count && !reader.failed(); ++i) {
+        ImportedMaterial material;
+        material.name = reader.read_string();
+        material.texture_path = reader.read_string();
+        model.materials.push_back(stl::move(material));
+    }
+
+    stl::uint64_t const node_count = reader.read<stl::uint64_t>();
+    for (stl::uint64_t i = 0; i < node_count && !reader.failed(); ++i) {
+        ImportedNode node;
+        node.mesh = reader.read<stl::int64_t>();
+        node.children = reader.read_vector<stl::size_t>();
+        model.nodes.push_back(stl::move(node));
+    }
+}
+
+// Catches entries that were cut short or damaged in ways the reader doesn't notice, before they index out of bounds
+bool is_consistent(ImportedModel const& model) {
+    for (ImportedMesh const& mesh : model.meshes) {
+        if (mesh.vertex_size == 0 || mesh.mapped_vertices.size() % mesh.vertex_size != 0) { return false; }
+    }
+    for (ImportedNode const& node : model.nodes) {
+        if (node.mesh < -1 || node.mesh >= static_cast<stl::int64_t>(model.meshes.size())) { return false; }
+        for (stl::size_t child : node.children) {
+            if (child >= model.nodes.size()) { return false; }
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+void set_asset_cache_directory(fs::path const& directory) {
+    cache_directory = directory;
+}
+
+fs::path const& get_asset_cache_directory() {
+    return cache_directory;
+}
+
+AssetCacheStats get_asset_cache_stats() {
+    AssetCacheStats result;
+    result.hits = stats.hits.load(std::memory_order_relaxed);
+    result.misses = stats.misses.load(std::memory_order_relaxed);
+    result.invalidations = stats.invalidations.load(std::memory_order_relaxed);
+    result.stores = stats.stores.load(std::memory_order_relaxed);
+    result.failed_stores = stats.failed_stores.load(std::memory_order_relaxed);
+    result.bytes_read = stats.bytes_read.load(std::memory_order_relaxed);
+    result.bytes_written = stats.bytes_written.load(std::memory_order_relaxed);
+    return result;
+}
+
+void reset_asset_cache_stats() {
+    stats.hits.store(0, std::memory_order_relaxed);
+    stats.misses.store(0, std::memory_order_relaxed);
+    stats.invalidations.store(0, std::memory_order_relaxed);
+    stats.stores.store(0, std::memory_order_relaxed);
+    stats.failed_stores.store(0, std::memory_order_relaxed);
+    stats.bytes_read.store(0, std::memory_order_relaxed);
+    stats.bytes_written.store(0, std::memory_order_relaxed);
+}
+
+stl::uint64_t hash_bytes(void const* data, stl::size_t size, stl::uint64_t seed) {
+    stl::uint8_t const* it = static_cast<stl::uint8_t const*>(data);
+    stl::uint8_t const* const end = it + size;
+
+    stl::uint64_t hash;
+    if (size >= 32) {
+        stl::uint64_t accumulators[4] = { seed + prime1 + prime2, seed + prime2, seed, seed - prime1 };
+        for (; end - it >= 32; it += 32) {
+            for (int lane = 0; lane < 4; ++lane) {
+                accumulators[lane] = hash_round(accumulators[lane], read_unaligned<stl::uint64_t>(it + lane * 8));
+            }
+        }
+        hash = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7)
+            + rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+        for (stl::uint64_t accumulator : accumulators) {
+            hash = merge_round(hash, accumulator);
+        }
+    } else {
+        hash = seed + prime5;
+    }
+
+    hash += size;
+    for (; end - it >= 8; it += 8) {
+        hash = rotate_left(hash ^ hash_round(0, read_unaligned<stl::uint64_t>(it)), 27) * prime1 + prime4;
+    }
+    if (end - it >= 4) {
+        hash = rotate_left(hash ^ (read_unaligned<stl::uint32_t>(it) * prime1), 23) * prime2 + prime3;
+        it += 4;
+    }
+    for (; it != end; ++it) {
+        hash = rotate_left(hash ^ (*it * prime5), 11) * prime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    hash *= prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+std::optional<ImportedModel> read_cached_model(fs::path const& source, stl::uint64_t importer_key) {
+    SATURN_PROFILE_SCOPE("Read cached model");
+    EntryReader reader(nullptr, 0);
+    std::shared_ptr<MappedFile const> file = open_entry(source, EntryKind::Model, importer_key, reader);
+    if (!file) { return std::nullopt; }
+
+    ImportedModel model;
+    read_model(reader, file, model);
+    bool const valid = !reader.failed() && is_consistent(model);
+    count_read(valid, *file);
+    if (!valid) { return std::nullopt; }
+    return model;
+}
+
+bool write_cached_model(fs::path const& source, stl::uint64_t importer_key, ImportedModel const& model) {
+    SATURN_PROFILE_SCOPE("Write cached model");
+    return write_entry(source, EntryKind::Model, importer_key, model.dependencies, [&model](EntryWriter& writer) {
+        write_model(writer, model);
+    });
+}
+
+std::optional<ImportedTexture> read_cached_texture(fs::path const& source, stl::uint64_t importer_key) {
+    SATURN_PROFILE_SCOPE("Read cached texture");
+    EntryReader reader(nullptr, 0);
+    std::shared_ptr<MappedFile const> file = open_entry(source, EntryKind::Texture, importer_key, reader);
+    if (!file) { return std::nullopt; }
+
+    ImportedTexture texture;
+    texture.width = reader.read<stl::uint32_t>();
+    texture.height = reader.read<stl::uint32_t>();
+    texture.pixels = reader.read_vector<stl::uint8_t>();
+    bool const valid = !reader.failed() && texture.pixels.size() == stl::size_t(texture.width) * texture.height * 4;
+    count_read(valid, *file);
+    if (!valid) { return std::nullopt; }
+    return texture;
+}
+
+bool write_cached_texture(fs::path const& source, stl::uint64_t importer_key, ImportedTexture const& texture) {
+    SATURN_PROFILE_SCOPE("Write cached texture");
+    return write_entry(source, EntryKind::Texture, importer_key, {}, [&texture](EntryWriter& writer) {
+        writer.write(texture.width);
+        writer.write(texture.height);
+        writer.write_array(texture.pixels.data(), texture.pixels.size());
+    });
+}
+
+} // namespace saturn::assets
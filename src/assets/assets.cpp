@@ -1,5 +1,7 @@
 #include <saturn/assets/assets.hpp>
+#include <saturn/assets/render_resources.hpp>
 #include <saturn/assets/importers/simple_mesh.hpp>
+#include <saturn/assets/importers/binary_mesh.hpp>
 #include <saturn/assets/importers/stb_texture_import.hpp>
 #include <saturn/assets/importers/obj.hpp>
 
@@ -10,108 +12,332 @@
 #include <unordered_map>
 #include <stl/assert.hpp>
 #include <stl/utility.hpp>
+#include <stl/unique_ptr.hpp>
 
 #include <saturn/components/blueprint.hpp>
 #include <saturn/scene/scene.hpp>
-
+#include <saturn/utility/profiler.hpp>
+#include <saturn/utility/slot_map.hpp>
+#include <saturn/utility/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <stdexcept>
 #include <string>
 
 namespace saturn::assets {
 
 namespace {
 
-template<typename T, typename IdType = stl::int64_t>
-struct id_generator {
-    static inline IdType cur = 0;
-    static IdType next() {
-        return cur++;
-    }
-};
-
 template<typename T>
 struct AssetData {
     fs::path path;
     T asset;
+    LoadState state = LoadState::Ready;
 };
 
-template<typename T>
-T* _get_internal(std::unordered_map<stl::int64_t, AssetData<T>>& data, Handle<T> handle) {
-    if (handle.id == -1) { return nullptr; }
-    auto it = data.find(handle.id);
-    if (it == data.end()) {
-        return nullptr;
+struct PathHash {
+    stl::size_t operator()(fs::path const& path) const {
+        return fs::hash_value(path);
     }
+};
+
+template<typename T>
+struct AssetStorage {
+    SlotMap<T, AssetData<T>> assets;
+    // Loaded assets by path, and assets that were handed over by name. The first asset added under a name keeps it.
+    std::unordered_map<fs::path, Handle<T>, PathHash> by_path;
+    // Pointers to all assets indexed by handle id, rebuilt when assets are added or removed
+    stl::vector<T*> all;
+    bool all_dirty = true;
+    // Stands in for assets that are loading or failed to load
+    Handle<T> fallback;
+    // Callbacks of assets that are loading, by handle id
+    std::unordered_map<stl::int64_t, stl::vector<LoadCallback<T>>> callbacks;
+};
+
+template<typename T>
+Handle<T> _add_internal(AssetStorage<T>& storage, fs::path const& path, T&& asset, 
+    LoadState state = LoadState::Ready) {
+    Handle<T> handle = storage.assets.insert(AssetData<T>{ path, stl::move(asset), state });
+    storage.by_path.emplace(path, handle);
+    storage.all_dirty = true;
+    return handle;
+}
+
+template<typename T>
+T* _get_internal(AssetStorage<T>& storage, Handle<T> handle) {
+    AssetData<T>* data = storage.assets.get(handle);
+    if (!data) { return nullptr; }
+    if (data->state == LoadState::Ready) { return &data->asset; }
 
-    else return &it->second.asset;
+    AssetData<T>* fallback = storage.assets.get(storage.fallback);
+    return fallback && fallback->state == LoadState::Ready ? &fallback->asset : nullptr;
 }
 
 template<typename T>
-stl::vector<T*> _get_all_internal(std::unordered_map<stl::int64_t, AssetData<T>>& data) {
-    stl::vector<T*> assets(stl::tags::uninitialized, data.size());
-    for (auto&[id, asset] : data) {
-        if (id >= 0) {
-            assets[id] = &asset.asset;
+LoadState _get_load_state_internal(AssetStorage<T>& storage, Handle<T> handle) {
+    AssetData<T> const* data = storage.assets.get(handle);
+    return data ? data->state : LoadState::Failed;
+}
+
+template<typename T>
+Span<T* const> _get_all_internal(AssetStorage<T>& storage) {
+    if (storage.all_dirty) {
+        storage.all.clear();
+        storage.all.resize(storage.assets.slot_count());
+        for (T*& asset : storage.all) {
+            asset = nullptr;
+        }
+        for (stl::size_t i = 0; i < storage.assets.size(); ++i) {
+            storage.all[storage.assets.handle_at(i).id] = &storage.assets.value_at(i).asset;
         }
+        storage.all_dirty = false;
     }
-    return assets;
+    return Span<T* const>(storage.all.data(), storage.all.size());
 }
 
 template<typename T>
-fs::path const& _get_path_internal(std::unordered_map<stl::int64_t, AssetData<T>>& data, Handle<T> handle) {
-    if (handle.id == -1) { return ""; }
+fs::path const& _get_path_internal(AssetStorage<T>& storage, Handle<T> handle) {
+    static fs::path const empty_path;
+    AssetData<T>* data = storage.assets.get(handle);
+    return data ? data->path : empty_path;
+}
 
-    auto it = data.find(handle.id);
-    if (it == data.end()) {
-        return "";
+template<typename T>
+Handle<T> _get_with_path_internal(AssetStorage<T>& storage, fs::path const& path) {
+    auto it = storage.by_path.find(path);
+    if (it == storage.by_path.end() || !storage.assets.contains(it->second)) {
+        return { -1 };
     }
+    return it->second;
+}
 
-    else return it->second.path;
+template<typename T>
+void _add_callback_internal(AssetStorage<T>& storage, Handle<T> handle, LoadCallback<T>&& callback) {
+    if (!callback) { return; }
+    if (_get_load_state_internal(storage, handle) == LoadState::Loading) {
+        storage.callbacks[handle.id].push_back(stl::move(callback));
+    } else {
+        callback(handle);
+    }
 }
 
+// Loads that went from loading to ready or failed, of all asset types
+stl::uint64_t finished_load_count = 0;
+
+// Sets the final state of a loading asset and runs its callbacks
 template<typename T>
-Handle<T> _get_with_path_internal(std::unordered_map<stl::int64_t, AssetData<T>>& data, fs::path const& path) {
-    for (auto const&[id, asset] : data) {
-        if (asset.path == path) {
-            return { id };
-        }
+void _set_loaded_internal(AssetStorage<T>& storage, Handle<T> handle, LoadState state) {
+    AssetData<T>* data = storage.assets.get(handle);
+    if (!data) { return; }
+    data->state = state;
+    ++finished_load_count;
+
+    auto it = storage.callbacks.find(handle.id);
+    if (it == storage.callbacks.end()) { return; }
+    // Callbacks may start new loads, which can rehash the map
+    stl::vector<LoadCallback<T>> callbacks = stl::move(it->second);
+    storage.callbacks.erase(it);
+    for (LoadCallback<T>& callback : callbacks) {
+        callback(handle);
     }
+}
 
-    return { -1 };
+template<typename T>
+void _clear_internal(AssetStorage<T>& storage) {
+    storage.assets.clear();
+    storage.by_path.clear();
+    storage.all_dirty = true;
+    storage.callbacks.clear();
 }
 
+// Headless runs have no Vulkan context, and with it no logger
+void log_loaded(Context& ctx, std::string_view kind, fs::path const& path) {
+    if (!ctx.vulkan) { return; }
+    ctx.vulkan->logger->write_fmt(ph::log::Severity::Info, "Loaded {} {}", kind, path.generic_string());
+}
+
+struct AsyncLoad {
+    // Runs on a loader thread, returns false if the asset couldn't be read
+    std::function<bool()> read;
+    // Runs on the main thread once read returned, with its result
+    std::function<void(Context&, bool)> finish;
+    std::atomic<bool> read_done = false;
+    bool success = false;
+};
+
 } // anonymous namespace
 
 namespace data {
 
-// TODO: Swap the maps out for vectors?
-static std::unordered_map<stl::int64_t, AssetData<ph::Mesh>> meshes;
-static std::unordered_map<stl::int64_t, AssetData<ph::Texture>> textures;
-static std::unordered_map<stl::int64_t, AssetData<Model>> models;
-static std::unordered_map<stl::int64_t, AssetData<ph::Material>> materials;
+static AssetStorage<ph::Mesh> meshes;
+static AssetStorage<ph::Texture> textures;
+static AssetStorage<Model> models;
+static AssetStorage<ph::Material> materials;
+// Indexed by mesh handle id. Kept next to the meshes instead of in them, since ph::Mesh doesn't know about bounds.
+static stl::vector<Bounds> mesh_bounds;
+// Indexed by mesh handle id. Level 0 of every chain is the mesh itself.
+static stl::vector<stl::vector<MeshLod>> mesh_lods;
+
+// Loads that are reading or waiting to be finished. Only touched on the main thread.
+static stl::vector<stl::unique_ptr<AsyncLoad>> async_loads;
+static WaitGroup loader_tasks;
 
 } // namespace data
 
-Handle<ph::Mesh> take_mesh(ph::Mesh& mesh, std::string_view name) {
-    stl::int64_t id = id_generator<ph::Mesh>::next();
+static ThreadPool& get_loader_pool() {
+    // Separate from the default pool, since threads waiting on that one run its queued tasks in the meantime,
+    // and would pick up an import that takes seconds in the middle of a frame
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency() / 2));
+    return pool;
+}
+
+static void start_async_load(std::function<bool()> read, std::function<void(Context&, bool)> finish) {
+    auto load = stl::make_unique<AsyncLoad>();
+    AsyncLoad* const target = load.get();
+    load->read = stl::move(read);
+    load->finish = stl::move(finish);
+    data::async_loads.push_back(stl::move(load));
+
+    // The load stays in the list until it is finished, which only happens after this task is done with it
+    get_loader_pool().submit(data::loader_tasks, [target]() {
+        SATURN_PROFILE_SCOPE("Read asset");
+        target->success = target->read();
+        target->read_done.store(true, std::memory_order_release);
+    });
+}
 
-    data::meshes.emplace(id, AssetData<ph::Mesh>{std::string(name), stl::move(mesh)});
+void finish_async_loads(Context& ctx, float budget_ms) {
+    if (data::async_loads.empty()) { return; }
+    SATURN_PROFILE_SCOPE("Finish asset loads");
+
+    using clock = std::chrono::steady_clock;
+    clock::time_point const start = clock::now();
+
+    // Callbacks can start new loads, those are added to the emptied list
+    stl::vector<stl::unique_ptr<AsyncLoad>> loads = stl::move(data::async_loads);
+    data::async_loads.clear();
+    bool out_of_time = false;
+    for (stl::unique_ptr<AsyncLoad>& load : loads) {
+        if (out_of_time || !load->read_done.load(std::memory_order_acquire)) {
+            data::async_loads.push_back(stl::move(load));
+            continue;
+        }
 
-    return { id };
+        load->finish(ctx, load->success);
+        // At least one load is finished every call, so big assets can't starve
+        out_of_time = std::chrono::duration<float, std::milli>(clock::now() - start).count() >= budget_ms;
+    }
 }
 
-Handle<ph::Mesh> load_mesh(Context& ctx, fs::path const& path) {
-    auto const maybe_already_loaded_handle = _get_with_path_internal(data::meshes, path);
-    if (maybe_already_loaded_handle.id != -1) { return maybe_already_loaded_handle; }
+void wait_for_async_loads(Context& ctx) {
+    while (!data::async_loads.empty()) {
+        get_loader_pool().wait(data::loader_tasks);
+        finish_async_loads(ctx, std::numeric_limits<float>::infinity());
+    }
+}
 
-    stl::int64_t id = id_generator<ph::Mesh>::next();
+stl::size_t get_pending_load_count() {
+    return data::async_loads.size();
+}
+
+stl::uint64_t get_finished_load_count() {
+    return finished_load_count;
+}
+
+static Handle<ph::Mesh> add_mesh(fs::path const& path, ph::Mesh&& mesh, Bounds const& bounds, 
+    LoadState state = LoadState::Ready) {
+    Handle<ph::Mesh> handle = _add_internal(data::meshes, path, stl::move(mesh), state);
+    if (data::mesh_bounds.size() < data::meshes.assets.slot_count()) {
+        data::mesh_bounds.resize(data::meshes.assets.slot_count());
+        data::mesh_lods.resize(data::meshes.assets.slot_count());
+    }
+
+    data::mesh_bounds[handle.id] = bounds;
+    data::mesh_lods[handle.id].clear();
+    data::mesh_lods[handle.id].push_back(MeshLod{ handle, 0.0f });
+    return handle;
+}
+
+// Binary meshes are mapped, anything else is read as a text mesh
+static std::optional<ImportedMesh> read_mesh_file(fs::path const& path) {
+    if (path.extension() == importers::binary_mesh_extension) {
+        return importers::read_binary_mesh(path);
+    }
+    return importers::read_simple_mesh(path);
+}
+
+// Turns a mesh that is loading into a loaded one
+static void finish_mesh(Context& ctx, Handle<ph::Mesh> handle, ImportedMesh const& mesh) {
+    AssetData<ph::Mesh>* data = data::meshes.assets.get(handle);
+    if (!data || data->state == LoadState::Ready) { return; }
+
+    data->asset = create_mesh(ctx, mesh);
+    data::mesh_bounds[handle.id] = mesh.bounds;
+    _set_loaded_internal(data::meshes, handle, LoadState::Ready);
+    log_loaded(ctx, "mesh", data->path);
+}
+
+Handle<ph::Mesh> take_mesh(ph::Mesh& mesh, std::string_view name, Bounds const& bounds) {
+    return add_mesh(std::string(name), stl::move(mesh), bounds);
+}
+
+Handle<ph::Mesh> load_mesh(Context& ctx, fs::path const& path) {
+    SATURN_PROFILE_SCOPE("Load mesh");
+    Handle<ph::Mesh> handle = _get_with_path_internal(data::meshes, path);
+    if (handle.id != -1 && get_load_state(handle) != LoadState::Loading) { return handle; }
+
+    std::optional<ImportedMesh> mesh = read_mesh_file(path);
+    if (handle.id != -1) {
+        // Loading asynchronously, finish it right away. The asynchronous load won't touch it anymore.
+        if (mesh) {
+            finish_mesh(ctx, handle, *mesh);
+        } else {
+            _set_loaded_internal(data::meshes, handle, LoadState::Failed);
+        }
+        return handle;
+    }
 
-    std::optional<ph::Mesh> mesh = importers::import_simple_mesh(ctx, path);
     if (!mesh) { return { -1 }; }
-    data::meshes.emplace(id, AssetData<ph::Mesh>{path, stl::move(*mesh)});
+    handle = add_mesh(path, create_mesh(ctx, *mesh), mesh->bounds);
+
+    log_loaded(ctx, "mesh", path);
 
-    ctx.vulkan->logger->write_fmt(ph::log::Severity::Info, "Loaded mesh {}", path.generic_string());
+    return handle;
+}
+
+Handle<ph::Mesh> load_mesh_async(Context&, fs::path const& path, LoadCallback<ph::Mesh> on_done) {
+    Handle<ph::Mesh> handle = _get_with_path_internal(data::meshes, path);
+    if (handle.id == -1) {
+        handle = add_mesh(path, ph::Mesh(), Bounds{}, LoadState::Loading);
+
+        auto mesh = std::make_shared<std::optional<ImportedMesh>>();
+        start_async_load([mesh, path]() {
+            *mesh = read_mesh_file(path);
+            return mesh->has_value();
+        }, [mesh, handle](Context& ctx, bool success) {
+            if (success) {
+                finish_mesh(ctx, handle, **mesh);
+            } else if (get_load_state(handle) == LoadState::Loading) {
+                _set_loaded_internal(data::meshes, handle, LoadState::Failed);
+            }
+        });
+    }
+
+    _add_callback_internal(data::meshes, handle, stl::move(on_done));
+    return handle;
+}
+
+LoadState get_load_state(Handle<ph::Mesh> handle) {
+    return _get_load_state_internal(data::meshes, handle);
+}
 
-    return { id };
+void set_default_mesh(Handle<ph::Mesh> handle) {
+    data::meshes.fallback = handle;
 }
 
 ph::Mesh* get_mesh(Handle<ph::Mesh> handle) {
@@ -122,21 +348,99 @@ fs::path const& get_mesh_path(Handle<ph::Mesh> handle) {
     return _get_path_internal(data::meshes, handle);
 }
 
+Bounds const* get_mesh_bounds(Handle<ph::Mesh> handle) {
+    if (get_load_state(handle) != LoadState::Ready) { return nullptr; }
+    return &data::mesh_bounds[handle.id];
+}
+
+void add_mesh_lod(Handle<ph::Mesh> mesh, Handle<ph::Mesh> lod, float error) {
+    STL_ASSERT(data::meshes.assets.contains(mesh), "Invalid mesh handle");
+    stl::vector<MeshLod>& lods = data::mesh_lods[mesh.id];
+    STL_ASSERT(error >= lods.back().error, "Levels of detail must be added in order of increasing error");
+    lods.push_back(MeshLod{ lod, error });
+}
 
+Span<MeshLod const> get_mesh_lods(Handle<ph::Mesh> handle) {
+    if (get_load_state(handle) != LoadState::Ready) { return {}; }
+    stl::vector<MeshLod> const& lods = data::mesh_lods[handle.id];
+    return Span<MeshLod const>(lods.data(), lods.size());
+}
+
+// Turns a texture that is loading into a loaded one
+static void finish_texture(Context& ctx, Handle<ph::Texture> handle, ImportedTexture const& texture) {
+    AssetData<ph::Texture>* data = data::textures.assets.get(handle);
+    if (!data || data->state == LoadState::Ready) { return; }
+
+    data->asset = create_texture(ctx, texture);
+    _set_loaded_internal(data::textures, handle, LoadState::Ready);
+    log_loaded(ctx, "texture", data->path);
+}
 
 Handle<ph::Texture> load_texture(Context& ctx, fs::path const& path) {
+    SATURN_PROFILE_SCOPE("Load texture");
     // If the path was already loaded at some point, don't load it again
-    auto const maybe_already_loaded_handle = _get_with_path_internal(data::textures, path);
-    if (maybe_already_loaded_handle.id != -1) { return maybe_already_loaded_handle; }
+    Handle<ph::Texture> handle = _get_with_path_internal(data::textures, path);
+    if (handle.id != -1 && get_load_state(handle) != LoadState::Loading) { return handle; }
+
+    std::optional<ImportedTexture> texture = importers::read_texture(path);
+    if (handle.id != -1) {
+        // Loading asynchronously, finish it right away. The asynchronous load won't touch it anymore.
+        if (texture) {
+            finish_texture(ctx, handle, *texture);
+        } else {
+            _set_loaded_internal(data::textures, handle, LoadState::Failed);
+        }
+        return handle;
+    }
+
+    if (!texture) { return { -1 }; }
+    handle = _add_internal(data::textures, path, create_texture(ctx, *texture));
+
+    log_loaded(ctx, "texture", path);
+
+    return handle;
+}
+
+Handle<ph::Texture> load_texture_async(Context&, fs::path const& path, LoadCallback<ph::Texture> on_done) {
+    Handle<ph::Texture> handle = _get_with_path_internal(data::textures, path);
+    if (handle.id == -1) {
+        handle = _add_internal(data::textures, path, ph::Texture(), LoadState::Loading);
+
+        auto texture = std::make_shared<std::optional<ImportedTexture>>();
+        start_async_load([texture, path]() {
+            *texture = importers::read_texture(path);
+            return texture->has_value();
+        }, [texture, handle](Context& ctx, bool success) {
+            if (success) {
+                finish_texture(ctx, handle, **texture);
+            } else if (get_load_state(handle) == LoadState::Loading) {
+                _set_loaded_internal(data::textures, handle, LoadState::Failed);
+            }
+        });
+    }
 
-    stl::int64_t id = id_generator<ph::Texture>::next();
+    _add_callback_internal(data::textures, handle, stl::move(on_done));
+    return handle;
+}
 
-    ph::Texture tex = importers::import_with_stb(ctx, path);
-    data::textures.emplace(id, AssetData<ph::Texture>{path, stl::move(tex)});
+Handle<ph::Texture> take_texture(Context& ctx, ImportedTexture const& texture, fs::path const& path) {
+    Handle<ph::Texture> handle = _get_with_path_internal(data::textures, path);
+    if (handle.id != -1) {
+        finish_texture(ctx, handle, texture);
+        return handle;
+    }
+
+    handle = _add_internal(data::textures, path, create_texture(ctx, texture));
+    log_loaded(ctx, "texture", path);
+    return handle;
+}
 
-    ctx.vulkan->logger->write_fmt(ph::log::Severity::Info, "Loaded texture {}", path.generic_string());
+LoadState get_load_state(Handle<ph::Texture> handle) {
+    return _get_load_state_internal(data::textures, handle);
+}
 
-    return { id };
+void set_default_texture(Handle<ph::Texture> handle) {
+    data::textures.fallback = handle;
 }
 
 ph::Texture* get_texture(Handle<ph::Texture> handle) {
@@ -148,39 +452,77 @@ fs::path const& get_texture_path(Handle<ph::Texture> handle) {
 }
 
 Handle<Model> load_model(ecs::entity_t root, Context& ctx, fs::path const& path) {
+    SATURN_PROFILE_SCOPE("Load model");
     auto const maybe_already_loaded_handle = _get_with_path_internal(data::models, path);
     if (maybe_already_loaded_handle.id != -1) { return maybe_already_loaded_handle; }
 
-    stl::int64_t id = id_generator<Model>::next();
-
     Model model = importers::import_obj_model(root, ctx, path);
-    // set correct ID
-    ctx.scene->blueprints.get_component<components::Blueprint>(model.blueprint).model.id = id;
-    data::models.emplace(id, AssetData<Model>{path, model});
+    ecs::entity_t const blueprint = model.blueprint;
+    Handle<Model> handle = _add_internal(data::models, path, stl::move(model));
+    // set correct handle
+    ctx.scene->blueprints.get_component<components::Blueprint>(blueprint).model = handle;
 
-    ctx.vulkan->logger->write_fmt(ph::log::Severity::Info, "Loaded model {}", path.generic_string());
+    log_loaded(ctx, "model", path);
 
-    return { id };
+    return handle;
 }
 
 Handle<Model> load_model(Context& ctx, fs::path const& path) {
+    SATURN_PROFILE_SCOPE("Load model");
     auto const maybe_already_loaded_handle = _get_with_path_internal(data::models, path);
     if (maybe_already_loaded_handle.id != -1) { return maybe_already_loaded_handle; }
 
-    stl::int64_t id = id_generator<Model>::next();
-
     Model model = importers::import_obj_model(ctx, path);
-    // set correct ID
-    ctx.scene->blueprints.get_component<components::Blueprint>(model.blueprint).model.id = id;
-    data::models.emplace(id, AssetData<Model>{path, model});
+    ecs::entity_t const blueprint = model.blueprint;
+    Handle<Model> handle = _add_internal(data::models, path, stl::move(model));
+    // set correct handle
+    ctx.scene->blueprints.get_component<components::Blueprint>(blueprint).model = handle;
+
+    log_loaded(ctx, "model", path);
 
-    ctx.vulkan->logger->write_fmt(ph::log::Severity::Info, "Loaded model {}", path.generic_string());
+    return handle;
+}
+
+Handle<Model> load_model_async(Context& ctx, fs::path const& path, LoadCallback<Model> on_done) {
+    Handle<Model> handle = _get_with_path_internal(data::models, path);
+    if (handle.id == -1) {
+        // The root exists right away, so the model can be placed while it loads
+        Model model = importers::create_model_root(ctx, path);
+        ecs::entity_t const blueprint = model.blueprint;
+        handle = _add_internal(data::models, path, stl::move(model), LoadState::Loading);
+        ctx.scene->blueprints.get_component<components::Blueprint>(blueprint).model = handle;
+
+        auto imported = std::make_shared<ImportedModel>();
+        start_async_load([imported, path]() {
+            try {
+                *imported = importers::read_obj_model(path, get_loader_pool());
+                return true;
+            } catch (std::runtime_error const&) {
+                return false;
+            }
+        }, [imported, handle](Context& ctx, bool success) {
+            AssetData<Model>* data = data::models.assets.get(handle);
+            if (!data) { return; }
+            if (success) {
+                importers::create_model(ctx, *imported, data->asset, false);
+                log_loaded(ctx, "model", data->path);
+            }
+            _set_loaded_internal(data::models, handle, success ? LoadState::Ready : LoadState::Failed);
+        });
+    }
 
-    return { id };
+    _add_callback_internal(data::models, handle, stl::move(on_done));
+    return handle;
+}
+
+LoadState get_load_state(Handle<Model> handle) {
+    return _get_load_state_internal(data::models, handle);
 }
 
 Model* get_model(Handle<Model> handle) {
-    return _get_internal(data::models, handle);
+    // Loading models resolve to their blueprint root, which is filled in once they are loaded
+    AssetData<Model>* data = data::models.assets.get(handle);
+    return data ? &data->asset : nullptr;
 }
 
 fs::path const& get_model_path(Handle<Model> handle) {
@@ -188,19 +530,13 @@ fs::path const& get_model_path(Handle<Model> handle) {
 }
 
 Handle<ph::Material> take_material(ph::Material& material, std::string_view name) {
-    stl::int64_t id = id_generator<ph::Material>::next();
-
-    data::materials.emplace(id, AssetData<ph::Material>{std::string(name), stl::move(material)});
-
-    return { id };
+    return _add_internal(data::materials, std::string(name), stl::move(material));
 }
 
-Handle<ph::Material> load_material(Context& ctx, fs::path const& path) {
+Handle<ph::Material> load_material(Context&, fs::path const& path) {
     auto const maybe_already_loaded_handle = _get_with_path_internal(data::materials, path);
     if (maybe_already_loaded_handle.id != -1) { return maybe_already_loaded_handle; }
 
-    stl::int64_t id = id_generator<ph::Material>::next();
-
     // TODO: No mtl importer yet
 
     return { -1 };
@@ -214,18 +550,41 @@ fs::path const& get_material_path(Handle<ph::Material> handle) {
     return _get_path_internal(data::materials, handle);
 }
 
-stl::vector<ph::Material*> get_all_materials() {
+Span<ph::Material* const> get_all_materials() {
     return _get_all_internal(data::materials);
 }
 
+stl::size_t get_material_count() {
+    return data::materials.assets.size();
+}
+
 void destroy_all_assets() {
-    for (auto&[id, mesh] : data::meshes) {
-        mesh.asset.destroy();
+    // Loads that are still reading would otherwise write into loads that were dropped
+    if (!data::async_loads.empty()) {
+        get_loader_pool().wait(data::loader_tasks);
+        data::async_loads.clear();
     }
 
-    for (auto&[id, texture] : data::textures) {
-        texture.asset.destroy();
+    // Placeholders of assets that never loaded have no GPU resources
+    for (stl::size_t i = 0; i < data::meshes.assets.size(); ++i) {
+        AssetData<ph::Mesh>& mesh = data::meshes.assets.value_at(i);
+        if (mesh.state == LoadState::Ready) {
+            mesh.asset.destroy();
+        }
+    }
+
+    for (stl::size_t i = 0; i < data::textures.assets.size(); ++i) {
+        AssetData<ph::Texture>& texture = data::textures.assets.value_at(i);
+        if (texture.state == LoadState::Ready) {
+            texture.asset.destroy();
+        }
     }
+
+    // Invalidates all handles, so lookups after this return nothing instead of destroyed GPU resources
+    _clear_internal(data::meshes);
+    _clear_internal(data::textures);
+    _clear_internal(data::models);
+    _clear_internal(data::materials);
 }
 
-}
\ No newline at end of file
+}
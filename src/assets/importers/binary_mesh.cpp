@@ -0,0 +1,179 @@
+#include <saturn/assets/importers/binary_mesh.hpp>
+#include <saturn/assets/importers/simple_mesh.hpp>
+#include <saturn/assets/importers/obj.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/utility.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace saturn::assets::importers {
+
+static stl::uint64_t align_offset(stl::uint64_t offset) {
+    return (offset + binary_mesh_alignment - 1) / binary_mesh_alignment * binary_mesh_alignment;
+}
+
+// Checks that a blob of count elements of element_size bytes at offset lies inside the file
+static bool blob_fits(stl::uint64_t offset, stl::uint64_t count, stl::uint64_t element_size, stl::size_t file_size) {
+    if (offset % binary_mesh_alignment != 0 || offset > file_size) { return false; }
+    return count <= (file_size - offset) / element_size;
+}
+
+static bool is_valid_layout(BinaryMeshHeader const& header, BinaryMeshAttribute const* attributes) {
+    if (header.attribute_count == 0 || attributes[0].attribute != VertexAttribute::Position
+        || attributes[0].components != 3) {
+        return false;
+    }
+
+    stl::uint64_t total_components = 0;
+    for (stl::uint32_t i = 0; i < header.attribute_count; ++i) {
+        total_components += attributes[i].components;
+    }
+    return total_components == header.vertex_size;
+}
+
+std::optional<ImportedMesh> read_binary_mesh(fs::path const& path) {
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(BinaryMeshHeader)) {
+        return std::nullopt;
+    }
+
+    BinaryMeshHeader header;
+    std::memcpy(&header, file.data(), sizeof(BinaryMeshHeader));
+    if (std::memcmp(header.magic, binary_mesh_magic, sizeof(header.magic)) != 0
+        || header.version != binary_mesh_version || header.vertex_count == 0) {
+        return std::nullopt;
+    }
+
+    // The attributes directly follow the header
+    if (!blob_fits(sizeof(BinaryMeshHeader), header.attribute_count, sizeof(BinaryMeshAttribute), file.size())) {
+        return std::nullopt;
+    }
+    auto const* attributes = reinterpret_cast<BinaryMeshAttribute const*>(file.data() + sizeof(BinaryMeshHeader));
+    if (!is_valid_layout(header, attributes)) {
+        return std::nullopt;
+    }
+
+    stl::uint64_t const vertex_bytes = stl::uint64_t(header.vertex_size) * sizeof(float);
+    if (!blob_fits(header.vertex_offset, header.vertex_count, vertex_bytes, file.size())
+        || !blob_fits(header.index_offset, header.index_count, sizeof(stl::uint32_t), file.size())) {
+        return std::nullopt;
+    }
+
+    // Start reading the file in on this thread, so creating the mesh on the main thread doesn't stall on it
+    file.prefetch();
+
+    ImportedMesh mesh;
+    mesh.name = path.generic_string();
+    mesh.vertex_size = header.vertex_size;
+    mesh.bounds.center = glm::vec3(header.bounds_center[0], header.bounds_center[1], header.bounds_center[2]);
+    mesh.bounds.extents = glm::vec3(header.bounds_extents[0], header.bounds_extents[1], header.bounds_extents[2]);
+    mesh.bounds.radius = header.bounds_radius;
+
+    mesh.mapped_vertices = Span<float const>(reinterpret_cast<float const*>(file.data() + header.vertex_offset),
+        header.vertex_count * header.vertex_size);
+    mesh.mapped_indices = Span<stl::uint32_t const>(
+        reinterpret_cast<stl::uint32_t const*>(file.data() + header.index_offset), header.index_count);
+    mesh.mapping = std::make_shared<MappedFile const>(stl::move(file));
+    return mesh;
+}
+
+static stl::vector<BinaryMeshAttribute> get_vertex_layout(stl::size_t vertex_size) {
+    stl::vector<BinaryMeshAttribute> layout;
+    layout.push_back({ VertexAttribute::Position, 3 });
+    if (vertex_size == 3 + 3 + 2) {
+        layout.push_back({ VertexAttribute::Normal, 3 });
+        layout.push_back({ VertexAttribute::TexCoord, 2 });
+    } else if (vertex_size > 3) {
+        layout.push_back({ VertexAttribute::Custom, static_cast<stl::uint32_t>(vertex_size - 3) });
+    }
+    return layout;
+}
+
+static void write_padding(std::ofstream& file, stl::uint64_t offset) {
+    static constexpr char zeros[binary_mesh_alignment] = {};
+    stl::uint64_t const position = static_cast<stl::uint64_t>(file.tellp());
+    file.write(zeros, static_cast<std::streamsize>(offset - position));
+}
+
+bool write_binary_mesh(ImportedMesh const& mesh, fs::path const& path) {
+    Span<float const> const vertices = mesh.vertex_data();
+    Span<stl::uint32_t const> const indices = mesh.index_data();
+    if (mesh.vertex_size < 3 || vertices.empty()) { return false; }
+
+    stl::vector<BinaryMeshAttribute> const layout = get_vertex_layout(mesh.vertex_size);
+
+    BinaryMeshHeader header {};
+    std::memcpy(header.magic, binary_mesh_magic, sizeof(header.magic));
+    header.version = binary_mesh_version;
+    header.vertex_size = static_cast<stl::uint32_t>(mesh.vertex_size);
+    header.attribute_count = static_cast<stl::uint32_t>(layout.size());
+    header.vertex_count = vertices.size() / mesh.vertex_size;
+    if (header.vertex_count * mesh.vertex_size != vertices.size()) { return false; }
+    header.index_count = indices.size();
+    header.vertex_offset = align_offset(sizeof(BinaryMeshHeader) + layout.size() * sizeof(BinaryMeshAttribute));
+    header.index_offset = align_offset(header.vertex_offset + header.vertex_count * mesh.vertex_size * sizeof(float));
+    for (int axis = 0; axis < 3; ++axis) {
+        header.bounds_center[axis] = mesh.bounds.center[axis];
+        header.bounds_extents[axis] = mesh.bounds.extents[axis];
+    }
+    header.bounds_radius = mesh.bounds.radius;
+
+    // Write to a temporary file first. Replacing a file that is mapped somewhere else would change the data under
+    // that mapping, or cut it short.
+    fs::path temp_path = path;
+    temp_path += ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.good()) { return false; }
+
+        file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        file.write(reinterpret_cast<char const*>(layout.data()), layout.size() * sizeof(BinaryMeshAttribute));
+        write_padding(file, header.vertex_offset);
+        file.write(reinterpret_cast<char const*>(vertices.data()), vertices.size() * sizeof(float));
+        write_padding(file, header.index_offset);
+        file.write(reinterpret_cast<char const*>(indices.data()), indices.size() * sizeof(stl::uint32_t));
+        if (!file.good()) {
+            file.close();
+            std::error_code error;
+            fs::remove(temp_path, error);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temp_path, path, error);
+    return !error;
+}
+
+stl::size_t convert_to_binary_mesh(fs::path const& source, fs::path const& destination) {
+    if (source.extension() != ".obj") {
+        std::optional<ImportedMesh> mesh = read_simple_mesh(source);
+        return mesh && write_binary_mesh(*mesh, destination) ? 1 : 0;
+    }
+
+    ImportedModel model;
+    try {
+        model = read_obj_model(source);
+    } catch (std::runtime_error const&) {
+        return 0;
+    }
+
+    if (model.meshes.size() == 1) {
+        return write_binary_mesh(model.meshes[0], destination) ? 1 : 0;
+    }
+
+    stl::size_t written = 0;
+    for (stl::size_t i = 0; i < model.meshes.size(); ++i) {
+        fs::path mesh_path = destination.parent_path() / destination.stem();
+        mesh_path += "_" + std::to_string(i) + binary_mesh_extension;
+        written += write_binary_mesh(model.meshes[i], mesh_path) ? 1 : 0;
+    }
+    return written;
+}
+
+}
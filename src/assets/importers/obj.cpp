@@ -1,5 +1,10 @@
 #include <saturn/assets/importers/obj.hpp>
+#include <saturn/assets/importers/obj_parser.hpp>
+#include <saturn/assets/asset_cache.hpp>
 #include <saturn/assets/assets.hpp>
+#include <saturn/assets/mesh_lod.hpp>
+#include <saturn/assets/render_resources.hpp>
+#include <saturn/assets/importers/stb_texture_import.hpp>
 #include <saturn/scene/scene.hpp>
 
 #include <saturn/components/static_mesh.hpp>
@@ -12,131 +17,178 @@
 #include <phobos/renderer/material.hpp>
 #include <phobos/renderer/texture.hpp>
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
 #include <stl/vector.hpp>
 #include <stl/types.hpp>
+#include <stl/utility.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
 
 namespace saturn::assets::importers {
 
 using ModelMaterials = stl::vector<Handle<ph::Material>>;
 
-static void add_mesh(Context& ctx, ModelMaterials const& materials, Model model, aiMesh const* mesh, aiScene const* scene) {
-    ph::Mesh::CreateInfo info;
-    info.ctx = ctx.vulkan;
+// LOD weights of the normal and texture coordinates, so simplification keeps shading creases and UV seams
+static constexpr float lod_attribute_weights[] = { 0.5f, 0.5f, 0.5f, 1.0f, 1.0f };
+
+// Bump when the output of an importer changes, so models cached by older versions are imported again
+static constexpr stl::uint32_t obj_parser_version = 2;
+static constexpr stl::uint32_t assimp_importer_version = 2;
+
+static LodChainSettings get_lod_settings() {
+    LodChainSettings settings;
+    settings.attribute_weights = Span<float const>(lod_attribute_weights, std::size(lod_attribute_weights));
+    return settings;
+}
+
+// Identifies the importer that reads path and the settings it uses, for the asset cache
+static stl::uint64_t get_importer_key(fs::path const& path) {
+    bool const native = path.extension() == ".obj";
+    std::string_view const importer = native ? "obj_parser" : "assimp";
+    stl::uint32_t const version = native ? obj_parser_version : assimp_importer_version;
+    LodChainSettings const settings = get_lod_settings();
+    stl::uint64_t const max_levels = settings.max_levels;
+
+    stl::uint64_t key = hash_bytes(importer.data(), importer.size());
+    key = hash_bytes(&version, sizeof(version), key);
+    key = hash_bytes(&max_levels, sizeof(max_levels), key);
+    key = hash_bytes(&settings.reduction, sizeof(settings.reduction), key);
+    key = hash_bytes(&settings.max_error, sizeof(settings.max_error), key);
+    return hash_bytes(lod_attribute_weights, sizeof(lod_attribute_weights), key);
+}
+
+// Generates simplified versions of a mesh
+static void read_mesh_lods(ImportedMesh& mesh) {
+    MeshData const data { mesh.vertices.data(), mesh.vertices.size() / mesh.vertex_size, mesh.vertex_size };
+    stl::vector<MeshLodData> lods = generate_lod_chain(data, 
+        Span<stl::uint32_t const>(mesh.indices.data(), mesh.indices.size()), get_lod_settings());
+
+    for (MeshLodData& lod : lods) {
+        ImportedMeshLod imported;
+        imported.indices = stl::move(lod.indices);
+        imported.error = lod.error;
+        compact_vertices(data, imported.indices, imported.vertices);
+        mesh.lods.push_back(stl::move(imported));
+    }
+}
+
+static ImportedMesh read_mesh(aiMesh const* mesh) {
+    ImportedMesh result;
+    result.name = mesh->mName.C_Str();
+    result.material = mesh->mMaterialIndex;
     // Position, Normal, TexCoord
-    info.vertex_size = 3 + 3 + 2;
-    info.vertex_count = mesh->mNumVertices;
-    stl::vector<float> vertices(stl::tags::uninitialized, info.vertex_size * mesh->mNumVertices);
+    result.vertex_size = 3 + 3 + 2;
+    result.vertices = stl::vector<float>(stl::tags::uninitialized, result.vertex_size * mesh->mNumVertices);
+    bool const has_tex_coords = mesh->HasTextureCoords(0);
     for (stl::size_t i = 0; i < mesh->mNumVertices; ++i) {
-        stl::size_t const index = i * info.vertex_size;
+        stl::size_t const index = i * result.vertex_size;
+        float* vertex = result.vertices.data() + index;
         // Write data
 
         // Position
-        vertices[index] = mesh->mVertices[i].x;
-        vertices[index + 1] = mesh->mVertices[i].y;
-        vertices[index + 2] = mesh->mVertices[i].z;
+        vertex[0] = mesh->mVertices[i].x;
+        vertex[1] = mesh->mVertices[i].y;
+        vertex[2] = mesh->mVertices[i].z;
         // Normal
-        vertices[index + 3] = mesh->mNormals[i].x;
-        vertices[index + 4] = mesh->mNormals[i].y;
-        vertices[index + 5] = mesh->mNormals[i].z;
+        vertex[3] = mesh->mNormals[i].x;
+        vertex[4] = mesh->mNormals[i].y;
+        vertex[5] = mesh->mNormals[i].z;
         // TexCoord
-        vertices[index + 6] = mesh->mTextureCoords[0][i].x;
-        vertices[index + 7] = mesh->mTextureCoords[0][i].y;
+        vertex[6] = has_tex_coords ? mesh->mTextureCoords[0][i].x : 0.0f;
+        vertex[7] = has_tex_coords ? mesh->mTextureCoords[0][i].y : 0.0f;
     }
 
-    info.vertices = vertices.data();
-
     // Assume each face has 3 indices (aka a triangle) when reserving memory
-    stl::vector<stl::uint32_t> indices(stl::tags::reserve, mesh->mNumFaces * 3);
+    result.indices = stl::vector<stl::uint32_t>(stl::tags::reserve, mesh->mNumFaces * 3);
     for (stl::size_t i = 0; i < mesh->mNumFaces; ++i) {
         aiFace const& face = mesh->mFaces[i];
         for (stl::size_t j = 0; j < face.mNumIndices; ++j) {
-            indices.push_back(face.mIndices[j]);
+            result.indices.push_back(face.mIndices[j]);
         }
     }
 
-    info.index_count = indices.size();
-    info.indices = indices.data();
-    
-    // Create the mesh
-    ph::Mesh loaded_mesh(info);
-    // Send it to the asset system to store there
-    Handle<ph::Mesh> handle = assets::take_mesh(loaded_mesh, mesh->mName.C_Str());
-
-    // Finally add the loaded mesh to the blueprint
-    using namespace components;
-    ecs::registry& blueprints = ctx.scene->blueprints;
-
-    blueprints.get_component<StaticMesh>(model.blueprint) = StaticMesh{ handle };
-    // Add the material for this mesh
-    Handle<ph::Material> material = materials[mesh->mMaterialIndex];
-    blueprints.get_component<MeshRenderer>(model.blueprint) = MeshRenderer{ material };
-    blueprints.get_component<Name>(model.blueprint) = Name{ mesh->mName.C_Str() };
+    result.bounds = compute_bounds(result.vertices.data(), mesh->mNumVertices, result.vertex_size);
+    return result;
 }
 
-static void process_node(Context& ctx, ModelMaterials const& materials, Model cur_entity, aiNode const* node, aiScene const* scene) {
-    using namespace components;
-    for (size_t i = 0; i < node->mNumMeshes; ++i) {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        // Create an entity for this mesh. We need these components added before add_mesh will work
-        ctx.scene->blueprints.add_component<Transform>(cur_entity.blueprint);
-        ctx.scene->blueprints.add_component<StaticMesh>(cur_entity.blueprint);
-        ctx.scene->blueprints.add_component<MeshRenderer>(cur_entity.blueprint);
-        ctx.scene->blueprints.add_component<Name>(cur_entity.blueprint);
-        add_mesh(ctx, materials, cur_entity, mesh, scene);
-        break;
+static stl::size_t read_node(ImportedModel& model, aiNode const* node) {
+    stl::size_t const index = model.nodes.size();
+    model.nodes.emplace_back();
+    // Only the first mesh of a node is imported
+    if (node->mNumMeshes > 0) {
+        model.nodes[index].mesh = node->mMeshes[0];
     }
 
     for (size_t i = 0; i < node->mNumChildren; ++i) {
-        ecs::entity_t child_entity = ctx.scene->blueprints.create_blueprint_entity(cur_entity.blueprint);
-        process_node(ctx, materials, { child_entity }, node->mChildren[i], scene);
+        stl::size_t const child = read_node(model, node->mChildren[i]);
+        model.nodes[index].children.push_back(child);
     }
+    return index;
 }
 
-static ModelMaterials load_materials(Context& ctx, fs::path const& cwd, aiScene const* scene) {
-    ModelMaterials materials(stl::tags::reserve, scene->mNumMaterials);
-
+static void read_materials(ImportedModel& model, fs::path const& cwd, aiScene const* scene) {
     for (stl::size_t i = 0; i < scene->mNumMaterials; ++i) {
         aiMaterial* mat = scene->mMaterials[i];
+        ImportedMaterial material;
+        material.name = mat->GetName().C_Str();
         // Only process the material if there is a diffuse texture. 
         if (mat->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
             // Get diffuse texture
             aiString texture_path;
             mat->GetTexture(aiTextureType_DIFFUSE, 0, &texture_path);
-            fs::path path = cwd / fs::path(texture_path.C_Str());
+            material.texture_path = cwd / fs::path(texture_path.C_Str());
+        }
+        // Pushed either way to make sure indices match
+        model.materials.push_back(stl::move(material));
+    }
+}
 
-            // Load the texture
-            Handle<ph::Texture> texture = load_texture(ctx, path);
-            // Assign it to the material
-            ph::Material material;
-            material.texture = get_texture(texture);
+// Opens files like the default IO system, and remembers every file besides the model that Assimp looked for or
+// opened, like material libraries. Files it only checked for are included, since creating them changes the import.
+class RecordingIOSystem : public Assimp::DefaultIOSystem {
+public:
+    explicit RecordingIOSystem(fs::path const& model) : model(model.lexically_normal()) {}
 
-            // Send the material to the asset system
-            Handle<ph::Material> handle = take_material(material, mat->GetName().C_Str());
+    bool Exists(char const* file) const override {
+        record(file);
+        return DefaultIOSystem::Exists(file);
+    }
 
-            materials.push_back(handle);
-        } else {
-            // To make sure indices match
-            materials.push_back(Handle<ph::Material>{-1});
-        }
+    Assimp::IOStream* Open(char const* file, char const* mode) override {
+        record(file);
+        return DefaultIOSystem::Open(file, mode);
     }
 
-    return materials;
-}
+    stl::vector<fs::path> take_files() {
+        return stl::move(files);
+    }
 
-Model import_obj_model(Context& ctx, fs::path const& path) {
-    using namespace saturn::components;
-    // A model is simply a blueprint entity
-    ecs::entity_t blueprint_root = ctx.scene->blueprints.create_blueprint_entity();
-    ctx.scene->blueprints.add_component<Name>(blueprint_root, path.stem().generic_string());
+private:
+    void record(char const* file) const {
+        fs::path const path = fs::path(file).lexically_normal();
+        if (path != model && std::find(files.begin(), files.end(), path) == files.end()) {
+            files.push_back(path);
+        }
+    }
+
+    fs::path model;
+    mutable stl::vector<fs::path> files;
+};
 
+ImportedModel read_assimp_model(fs::path const& path) {
     constexpr int postprocess = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals;
     Assimp::Importer importer;
+    // The importer owns and deletes the IO system
+    RecordingIOSystem* const io = new RecordingIOSystem(path);
+    importer.SetIOHandler(io);
     aiScene const* scene = importer.ReadFile(path.generic_string(), postprocess);
     
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
@@ -144,54 +196,169 @@ Model import_obj_model(Context& ctx, fs::path const& path) {
         throw std::runtime_error("Failed to load model at path " + path.generic_string());
     }
 
-    Model model { blueprint_root };
-
-    ModelMaterials materials = load_materials(ctx, path.parent_path(), scene);
-    process_node(ctx, materials, model, scene->mRootNode, scene);
+    ImportedModel model;
+    read_materials(model, path.parent_path(), scene);
+    for (stl::size_t i = 0; i < scene->mNumMeshes; ++i) {
+        model.meshes.push_back(read_mesh(scene->mMeshes[i]));
+    }
+    read_node(model, scene->mRootNode);
+    model.dependencies = io->take_files();
 
     importer.FreeScene();
     return model;
 }
 
-static void process_node_into_tree(Context& ctx, ModelMaterials const& materials, 
-    Model cur_entity, aiNode const* node, aiScene const* scene) {
+static void read_model_lods(ImportedModel& model, ThreadPool& pool) {
+    pool.parallel_for(model.meshes.size(), 1, [&model](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t i = begin; i < end; ++i) {
+            read_mesh_lods(model.meshes[i]);
+        }
+    });
+}
 
-    for (size_t i = 0; i < node->mNumMeshes; ++i) {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        // Create an entity for this mesh
-        add_mesh(ctx, materials, cur_entity, mesh, scene);
-        break;
+// Textures are cached on their own rather than as part of the model, so models sharing a texture share the entry
+static void read_model_textures(ImportedModel& model, ThreadPool& pool) {
+    pool.parallel_for(model.materials.size(), 1, [&model](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t i = begin; i < end; ++i) {
+            ImportedMaterial& material = model.materials[i];
+            if (material.texture_path.empty()) { continue; }
+            if (std::optional<ImportedTexture> texture = read_texture(material.texture_path)) {
+                material.texture = stl::move(*texture);
+            }
+        }
+    });
+}
+
+ImportedModel read_obj_model(fs::path const& path, ThreadPool& pool) {
+    stl::uint64_t const importer_key = get_importer_key(path);
+    std::optional<ImportedModel> model = read_cached_model(path, importer_key);
+    if (!model) {
+        model = path.extension() == ".obj" ? parse_obj(path, pool) : read_assimp_model(path);
+        read_model_lods(*model, pool);
+        write_cached_model(path, importer_key, *model);
     }
 
-    auto it = ctx.scene->blueprints.get_entities().find(cur_entity.blueprint)->children.begin();
-    for (size_t i = 0; i < node->mNumChildren; ++i) {
-        ecs::entity_t child_entity = it->data;
-        process_node_into_tree(ctx, materials, { child_entity }, node->mChildren[i], scene);
-        ++it;
+    read_model_textures(*model, pool);
+    return stl::move(*model);
+}
+
+static ModelMaterials create_materials(Context& ctx, ImportedModel const& model) {
+    ModelMaterials materials(stl::tags::reserve, model.materials.size());
+
+    for (ImportedMaterial const& imported : model.materials) {
+        if (imported.texture.pixels.empty()) {
+            // To make sure indices match
+            materials.push_back(Handle<ph::Material>{-1});
+            continue;
+        }
+
+        // Textures shared between materials and models are only created once
+        Handle<ph::Texture> texture = take_texture(ctx, imported.texture, imported.texture_path);
+        // Assign it to the material
+        ph::Material material;
+        material.texture = get_texture(texture);
+
+        // Send the material to the asset system
+        materials.push_back(take_material(material, imported.name));
     }
+
+    return materials;
 }
 
-Model import_obj_model(ecs::entity_t blueprint_root, Context& ctx, fs::path const& path) {
+static Handle<ph::Mesh> create_mesh_with_lods(Context& ctx, ImportedMesh const& mesh) {
+    // Send it to the asset system to store there
+    ph::Mesh loaded_mesh = create_mesh(ctx, mesh);
+    Handle<ph::Mesh> handle = assets::take_mesh(loaded_mesh, mesh.name, mesh.bounds);
+
+    for (stl::size_t level = 0; level < mesh.lods.size(); ++level) {
+        ph::Mesh lod_mesh = create_mesh(ctx, mesh.lods[level], mesh.vertex_size);
+        Handle<ph::Mesh> lod_handle = assets::take_mesh(lod_mesh, mesh.name + "_lod" + std::to_string(level + 1), 
+            mesh.bounds);
+        assets::add_mesh_lod(handle, lod_handle, mesh.lods[level].error);
+    }
+    return handle;
+}
+
+static void set_mesh_components(Context& ctx, ModelMaterials const& materials, stl::vector<Handle<ph::Mesh>> const& meshes,
+    ImportedModel const& model, stl::size_t mesh_index, ecs::entity_t entity) {
+    using namespace components;
+    ecs::registry& blueprints = ctx.scene->blueprints;
+    ImportedMesh const& mesh = model.meshes[mesh_index];
+
+    blueprints.get_component<StaticMesh>(entity) = StaticMesh{ meshes[mesh_index] };
+    // Add the material for this mesh
+    Handle<ph::Material> material = mesh.material < materials.size() ? materials[mesh.material] : Handle<ph::Material>{-1};
+    blueprints.get_component<MeshRenderer>(entity) = MeshRenderer{ material };
+    blueprints.get_component<Name>(entity) = Name{ mesh.name };
+}
+
+static void create_node(Context& ctx, ModelMaterials const& materials, stl::vector<Handle<ph::Mesh>> const& meshes,
+    ImportedModel const& model, stl::size_t node_index, ecs::entity_t entity, bool existing_tree) {
+    using namespace components;
+    ImportedNode const& node = model.nodes[node_index];
+    ecs::registry& blueprints = ctx.scene->blueprints;
+
+    if (node.mesh >= 0) {
+        if (!existing_tree) {
+            // We need these components added before the mesh can be set
+            blueprints.add_component<Transform>(entity);
+            blueprints.add_component<StaticMesh>(entity);
+            blueprints.add_component<MeshRenderer>(entity);
+            blueprints.add_component<Name>(entity);
+        }
+        set_mesh_components(ctx, materials, meshes, model, node.mesh, entity);
+    }
+
+    if (existing_tree) {
+        ecs::hierarchy const& hierarchy = blueprints.get_hierarchy();
+        ecs::entity_t child_entity = hierarchy.first_child(entity);
+        for (stl::size_t child : node.children) {
+            create_node(ctx, materials, meshes, model, child, child_entity, existing_tree);
+            child_entity = hierarchy.next_sibling(child_entity);
+        }
+    } else {
+        for (stl::size_t child : node.children) {
+            ecs::entity_t child_entity = blueprints.create_blueprint_entity(entity);
+            create_node(ctx, materials, meshes, model, child, child_entity, existing_tree);
+        }
+    }
+}
+
+Model create_model_root(Context& ctx, fs::path const& path) {
     using namespace saturn::components;
-    ctx.scene->blueprints.get_component<Name>(blueprint_root).name = path.stem().generic_string();
-    ctx.scene->blueprints.get_component<Blueprint>(blueprint_root).model.id = blueprint_root;
+    // A model is simply a blueprint entity
+    ecs::entity_t blueprint_root = ctx.scene->blueprints.create_blueprint_entity();
+    ctx.scene->blueprints.add_component<Name>(blueprint_root, path.stem().generic_string());
+    return Model{ blueprint_root };
+}
 
-    constexpr int postprocess = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals;
-    Assimp::Importer importer;
-    aiScene const* scene = importer.ReadFile(path.generic_string(), postprocess);
-    
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
-        !scene->mRootNode) {
-        throw std::runtime_error("Failed to load model at path " + path.generic_string());
+void create_model(Context& ctx, ImportedModel const& imported, Model model, bool existing_tree) {
+    ModelMaterials materials = create_materials(ctx, imported);
+
+    stl::vector<Handle<ph::Mesh>> meshes(stl::tags::reserve, imported.meshes.size());
+    for (ImportedMesh const& mesh : imported.meshes) {
+        meshes.push_back(create_mesh_with_lods(ctx, mesh));
     }
 
-    Model model { blueprint_root };
+    if (!imported.nodes.empty()) {
+        create_node(ctx, materials, meshes, imported, 0, model.blueprint, existing_tree);
+    }
+}
 
-    ModelMaterials materials = load_materials(ctx, path.parent_path(), scene);
-    process_node_into_tree(ctx, materials, model, scene->mRootNode, scene);
+Model import_obj_model(Context& ctx, fs::path const& path) {
+    Model model = create_model_root(ctx, path);
+    create_model(ctx, read_obj_model(path), model, false);
+    return model;
+}
 
-    importer.FreeScene();
+Model import_obj_model(ecs::entity_t blueprint_root, Context& ctx, fs::path const& path) {
+    using namespace saturn::components;
+    ctx.scene->blueprints.get_component<Name>(blueprint_root).name = path.stem().generic_string();
+    ctx.scene->blueprints.get_component<Blueprint>(blueprint_root).model.id = blueprint_root;
+
+    Model model { blueprint_root };
+    create_model(ctx, read_obj_model(path), model, true);
     return model;
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,912 @@
+#include <saturn/assets/importers/obj_parser.hpp>
+#include <saturn/utility/mapped_file.hpp>
+#include <saturn/utility/profiler.hpp>
+
+#include <stl/vector.hpp>
+#include <stl/types.hpp>
+#include <stl/utility.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace saturn::assets::importers {
+
+namespace {
+
+constexpr stl::uint32_t no_index = std::numeric_limits<stl::uint32_t>::max();
+
+// Target size of the chunks the file is split into. Large enough to keep the per chunk overhead low, small enough
+// that there are several chunks per thread to balance the load.
+constexpr stl::size_t chunk_bytes = 8 << 20;
+// Meshes with fewer corners are welded on a single thread
+constexpr stl::size_t parallel_weld_corners = 1 << 18;
+constexpr stl::size_t weld_partition_bits = 6;
+constexpr stl::size_t weld_block_size = 1 << 16;
+
+// Position, normal, texture coordinates, like the Assimp importer
+constexpr stl::size_t vertex_size = 3 + 3 + 2;
+
+// Corners without a normal get the flat normal of their triangle, like aiProcess_GenNormals. Until it is generated,
+// their normal index is the triangle's index in the mesh with this bit set, so corners of different triangles
+// aren't welded. Files with this many normals are rejected.
+constexpr stl::uint32_t face_normal_bit = stl::uint32_t(1) << 31;
+
+// Indices of a face corner into the position, texture coordinate and normal arrays of the whole file. Texture
+// coordinate and normal are no_index if the face doesn't have them.
+struct Corner {
+    stl::uint32_t position;
+    stl::uint32_t tex_coord;
+    stl::uint32_t normal;
+};
+
+bool operator==(Corner const& lhs, Corner const& rhs) {
+    return lhs.position == rhs.position && lhs.tex_coord == rhs.tex_coord && lhs.normal == rhs.normal;
+}
+
+stl::uint64_t hash_corner(Corner const& corner) {
+    stl::uint64_t hash = corner.position * 0x9E3779B97F4A7C15ull;
+    hash ^= (corner.tex_coord + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+    hash ^= (corner.normal + 0x8CB92BA72F3D8DD7ull) * 0x165667B19E3779F9ull;
+    return hash ^ (hash >> 29);
+}
+
+enum class Attribute : stl::uint32_t {
+    Position = 0,
+    TexCoord = 1,
+    Normal = 2
+};
+
+// Negative OBJ indices count back from the last element defined before the face. Chunks are parsed before the number
+// of elements in earlier chunks is known, so these are resolved once it is.
+struct RelativeIndex {
+    stl::size_t corner;
+    Attribute attribute;
+    // Index counted from the first element of the chunk. Negative for elements of earlier chunks.
+    stl::int64_t index;
+};
+
+enum class StatementType {
+    Object,
+    Group,
+    UseMaterial,
+    MaterialLibrary
+};
+
+// Statement that changes which mesh the following faces belong to
+struct Statement {
+    StatementType type;
+    // Number of triangles in the chunk before the statement
+    stl::size_t triangle;
+    std::string name;
+};
+
+// Line aligned part of the file, parsed independently of the others
+struct Chunk {
+    char const* begin = nullptr;
+    char const* end = nullptr;
+
+    stl::vector<float> positions;
+    stl::vector<float> tex_coords;
+    stl::vector<float> normals;
+    // Three corners per triangle
+    stl::vector<Corner> corners;
+    stl::vector<RelativeIndex> relative_indices;
+    stl::vector<Statement> statements;
+    // Offsets of the chunk's elements in the arrays of the whole file
+    stl::size_t position_offset = 0;
+    stl::size_t tex_coord_offset = 0;
+    stl::size_t normal_offset = 0;
+    // Set instead of throwing, since the chunks are parsed in thread pool tasks
+    bool invalid = false;
+};
+
+struct PolygonCorner {
+    Corner corner;
+    stl::int64_t relative[3];
+    stl::uint32_t relative_mask;
+};
+
+// Consecutive triangles of a chunk that belong to the same mesh
+struct MeshSegment {
+    stl::size_t chunk;
+    stl::size_t first_triangle;
+    stl::size_t end_triangle;
+};
+
+struct ObjMesh {
+    std::string name;
+    stl::uint32_t material = 0;
+    stl::vector<MeshSegment> segments;
+    stl::size_t triangle_count = 0;
+};
+
+struct ObjObject {
+    std::string name;
+    stl::vector<stl::size_t> meshes;
+};
+
+// Position, texture coordinate and normal arrays of the whole file
+struct VertexAttributes {
+    stl::vector<float> positions;
+    stl::vector<float> tex_coords;
+    stl::vector<float> normals;
+};
+
+constexpr double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+char const* skip_spaces(char const* it, char const* end) {
+    while (it != end && is_space(*it)) { ++it; }
+    return it;
+}
+
+std::string_view trim(char const* begin, char const* end) {
+    begin = skip_spaces(begin, end);
+    while (end != begin && is_space(end[-1])) { --end; }
+    return std::string_view(begin, end - begin);
+}
+
+// Parses a decimal number like strtof, but without locale handling or support for hexadecimal, infinity and NaN.
+// Digits past the 19th only shift the exponent, which is well below float precision.
+// Returns nullptr if there is no number at it.
+char const* parse_float(char const* it, char const* end, float& result) {
+    bool negative = false;
+    if (it != end && (*it == '-' || *it == '+')) {
+        negative = *it == '-';
+        ++it;
+    }
+
+    stl::uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool any_digits = false;
+    for (; it != end && is_digit(*it); ++it) {
+        any_digits = true;
+        if (significant_digits < 19) {
+            mantissa = mantissa * 10 + (*it - '0');
+            significant_digits += mantissa != 0;
+        } else {
+            ++exponent;
+        }
+    }
+
+    if (it != end && *it == '.') {
+        ++it;
+        for (; it != end && is_digit(*it); ++it) {
+            any_digits = true;
+            if (significant_digits < 19) {
+                mantissa = mantissa * 10 + (*it - '0');
+                significant_digits += mantissa != 0;
+                --exponent;
+            }
+        }
+    }
+    if (!any_digits) { return nullptr; }
+
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        char const* exponent_it = it + 1;
+        bool negative_exponent = false;
+        if (exponent_it != end && (*exponent_it == '-' || *exponent_it == '+')) {
+            negative_exponent = *exponent_it == '-';
+            ++exponent_it;
+        }
+        if (exponent_it != end && is_digit(*exponent_it)) {
+            int value = 0;
+            for (; exponent_it != end && is_digit(*exponent_it); ++exponent_it) {
+                // Anything this large is out of float range anyway
+                if (value < 10000) { value = value * 10 + (*exponent_it - '0'); }
+            }
+            exponent += negative_exponent ? -value : value;
+            it = exponent_it;
+        }
+    }
+
+    double value = static_cast<double>(mantissa);
+    if (mantissa != 0 && exponent > 0) {
+        value *= exponent <= 22 ? powers_of_ten[exponent] : std::pow(10.0, exponent);
+    } else if (mantissa != 0 && exponent < 0) {
+        value /= exponent >= -22 ? powers_of_ten[-exponent] : std::pow(10.0, -exponent);
+    }
+    result = static_cast<float>(negative ? -value : value);
+    return it;
+}
+
+char const* parse_index(char const* it, char const* end, stl::int64_t& result) {
+    bool const negative = it != end && *it == '-';
+    if (negative) { ++it; }
+    if (it == end || !is_digit(*it)) { return nullptr; }
+
+    stl::int64_t value = 0;
+    for (; it != end && is_digit(*it); ++it) {
+        // Clamped so it can't overflow, it's rejected as out of range later
+        value = std::min<stl::int64_t>(value * 10 + (*it - '0'), stl::int64_t(1) << 40);
+    }
+    result = negative ? -value : value;
+    return it;
+}
+
+// Reads up to count floats into values. Missing values are filled with 0, as long as at least min_count are present.
+bool read_floats(char const* it, char const* end, stl::vector<float>& values, stl::size_t count, stl::size_t min_count) {
+    for (stl::size_t i = 0; i < count; ++i) {
+        float value = 0.0f;
+        it = skip_spaces(it, end);
+        char const* const next = parse_float(it, end, value);
+        if (!next) {
+            if (i < min_count) { return false; }
+            value = 0.0f;
+        } else {
+            it = next;
+        }
+        values.push_back(value);
+    }
+    return true;
+}
+
+stl::size_t element_count(Chunk const& chunk, Attribute attribute) {
+    switch (attribute) {
+        case Attribute::Position: return chunk.positions.size() / 3;
+        case Attribute::TexCoord: return chunk.tex_coords.size() / 2;
+        case Attribute::Normal: return chunk.normals.size() / 3;
+    }
+    return 0;
+}
+
+bool set_corner_index(Chunk const& chunk, PolygonCorner& corner, Attribute attribute, stl::int64_t value) {
+    stl::uint32_t* const indices[] = { &corner.corner.position, &corner.corner.tex_coord, &corner.corner.normal };
+    stl::uint32_t const slot = static_cast<stl::uint32_t>(attribute);
+    if (value > 0) {
+        if (value - 1 >= no_index) { return false; }
+        *indices[slot] = static_cast<stl::uint32_t>(value - 1);
+    } else if (value < 0) {
+        corner.relative[slot] = static_cast<stl::int64_t>(element_count(chunk, attribute)) + value;
+        corner.relative_mask |= 1u << slot;
+        *indices[slot] = 0;
+    } else {
+        // OBJ indices start at 1
+        return false;
+    }
+    return true;
+}
+
+void emit_corner(Chunk& chunk, PolygonCorner const& corner) {
+    chunk.corners.push_back(corner.corner);
+    for (stl::uint32_t slot = 0; slot < 3; ++slot) {
+        if (corner.relative_mask & (1u << slot)) {
+            chunk.relative_indices.push_back({ chunk.corners.size() - 1, Attribute(slot), corner.relative[slot] });
+        }
+    }
+}
+
+// Parses the corners of a face and triangulates it as a fan
+bool read_face(Chunk& chunk, char const* it, char const* end, stl::vector<PolygonCorner>& polygon) {
+    polygon.clear();
+    while (true) {
+        it = skip_spaces(it, end);
+        if (it == end || *it == '#') { break; }
+
+        PolygonCorner corner { { no_index, no_index, no_index }, { 0, 0, 0 }, 0 };
+        stl::int64_t value = 0;
+        it = parse_index(it, end, value);
+        if (!it || !set_corner_index(chunk, corner, Attribute::Position, value)) { return false; }
+
+        if (it != end && *it == '/') {
+            ++it;
+            // The texture coordinate is left out in v//vn
+            if (it != end && *it != '/') {
+                it = parse_index(it, end, value);
+                if (!it || !set_corner_index(chunk, corner, Attribute::TexCoord, value)) { return false; }
+            }
+            if (it != end && *it == '/') {
+                ++it;
+                it = parse_index(it, end, value);
+                if (!it || !set_corner_index(chunk, corner, Attribute::Normal, value)) { return false; }
+            }
+        }
+        polygon.push_back(corner);
+    }
+
+    // Points and lines can't be part of a triangle mesh, and are skipped like the Assimp importer's triangle meshes do
+    for (stl::size_t i = 1; i + 1 < polygon.size(); ++i) {
+        emit_corner(chunk, polygon[0]);
+        emit_corner(chunk, polygon[i]);
+        emit_corner(chunk, polygon[i + 1]);
+    }
+    return true;
+}
+
+// Returns the rest of the line if it starts with the keyword, followed by whitespace or the end of the line
+bool match_keyword(char const* it, char const* end, std::string_view keyword, std::string_view& rest) {
+    if (static_cast<stl::size_t>(end - it) < keyword.size() || std::memcmp(it, keyword.data(), keyword.size()) != 0) {
+        return false;
+    }
+    it += keyword.size();
+    if (it != end && !is_space(*it)) { return false; }
+    rest = trim(it, end);
+    return true;
+}
+
+void parse_line(Chunk& chunk, char const* it, char const* end, stl::vector<PolygonCorner>& polygon) {
+    std::string_view rest;
+    bool valid = true;
+    if (match_keyword(it, end, "v", rest)) {
+        valid = read_floats(rest.data(), rest.data() + rest.size(), chunk.positions, 3, 3);
+    } else if (match_keyword(it, end, "vt", rest)) {
+        valid = read_floats(rest.data(), rest.data() + rest.size(), chunk.tex_coords, 2, 1);
+    } else if (match_keyword(it, end, "vn", rest)) {
+        valid = read_floats(rest.data(), rest.data() + rest.size(), chunk.normals, 3, 3);
+    } else if (match_keyword(it, end, "f", rest)) {
+        valid = read_face(chunk, rest.data(), rest.data() + rest.size(), polygon);
+    } else if (match_keyword(it, end, "o", rest)) {
+        chunk.statements.push_back({ StatementType::Object, chunk.corners.size() / 3, std::string(rest) });
+    } else if (match_keyword(it, end, "g", rest)) {
+        chunk.statements.push_back({ StatementType::Group, chunk.corners.size() / 3, std::string(rest) });
+    } else if (match_keyword(it, end, "usemtl", rest)) {
+        chunk.statements.push_back({ StatementType::UseMaterial, chunk.corners.size() / 3, std::string(rest) });
+    } else if (match_keyword(it, end, "mtllib", rest)) {
+        chunk.statements.push_back({ StatementType::MaterialLibrary, chunk.corners.size() / 3, std::string(rest) });
+    }
+    // Comments, smoothing groups and anything else are ignored
+
+    if (!valid) { chunk.invalid = true; }
+}
+
+void parse_chunk(Chunk& chunk) {
+    // Rough guess of the line count, so the arrays don't have to grow as often
+    stl::size_t const expected_lines = static_cast<stl::size_t>(chunk.end - chunk.begin) / 32;
+    chunk.positions = stl::vector<float>(stl::tags::reserve, expected_lines);
+    chunk.corners = stl::vector<Corner>(stl::tags::reserve, expected_lines);
+
+    stl::vector<PolygonCorner> polygon;
+    char const* it = chunk.begin;
+    while (it != chunk.end) {
+        char const* line_end = static_cast<char const*>(std::memchr(it, '\n', chunk.end - it));
+        if (!line_end) { line_end = chunk.end; }
+
+        char const* const line = skip_spaces(it, line_end);
+        if (line != line_end) {
+            parse_line(chunk, line, line_end, polygon);
+        }
+        it = line_end == chunk.end ? line_end : line_end + 1;
+    }
+}
+
+// Splits the file into chunks that start at the beginning of a line
+stl::vector<Chunk> split_into_chunks(char const* data, stl::size_t size) {
+    stl::vector<Chunk> chunks;
+    char const* const end = data + size;
+    char const* begin = data;
+    while (begin != end) {
+        char const* chunk_end = end;
+        if (static_cast<stl::size_t>(end - begin) > chunk_bytes) {
+            char const* const newline = static_cast<char const*>(std::memchr(begin + chunk_bytes, '\n',
+                end - begin - chunk_bytes));
+            chunk_end = newline ? newline + 1 : end;
+        }
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = chunk_end;
+        chunks.push_back(stl::move(chunk));
+        begin = chunk_end;
+    }
+    return chunks;
+}
+
+// Copies the vertex attributes of all chunks into one array each, and turns the chunk's corners into indices into
+// those arrays
+VertexAttributes merge_chunks(stl::vector<Chunk>& chunks, ThreadPool& pool) {
+    SATURN_PROFILE_SCOPE("Merge OBJ chunks");
+    stl::size_t position_count = 0;
+    stl::size_t tex_coord_count = 0;
+    stl::size_t normal_count = 0;
+    for (Chunk& chunk : chunks) {
+        chunk.position_offset = position_count;
+        chunk.tex_coord_offset = tex_coord_count;
+        chunk.normal_offset = normal_count;
+        position_count += chunk.positions.size() / 3;
+        tex_coord_count += chunk.tex_coords.size() / 2;
+        normal_count += chunk.normals.size() / 3;
+    }
+    if (normal_count >= face_normal_bit) {
+        chunks.front().invalid = true;
+        return VertexAttributes{};
+    }
+
+    VertexAttributes attributes;
+    attributes.positions = stl::vector<float>(stl::tags::uninitialized, position_count * 3);
+    attributes.tex_coords = stl::vector<float>(stl::tags::uninitialized, tex_coord_count * 2);
+    attributes.normals = stl::vector<float>(stl::tags::uninitialized, normal_count * 3);
+
+    pool.parallel_for(chunks.size(), 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t index = begin; index < end; ++index) {
+            Chunk& chunk = chunks[index];
+            std::copy(chunk.positions.begin(), chunk.positions.end(),
+                attributes.positions.begin() + chunk.position_offset * 3);
+            std::copy(chunk.tex_coords.begin(), chunk.tex_coords.end(),
+                attributes.tex_coords.begin() + chunk.tex_coord_offset * 2);
+            std::copy(chunk.normals.begin(), chunk.normals.end(),
+                attributes.normals.begin() + chunk.normal_offset * 3);
+            chunk.positions = stl::vector<float>();
+            chunk.tex_coords = stl::vector<float>();
+            chunk.normals = stl::vector<float>();
+
+            stl::size_t const offsets[] = { chunk.position_offset, chunk.tex_coord_offset, chunk.normal_offset };
+            for (RelativeIndex const& relative : chunk.relative_indices) {
+                stl::uint32_t const slot = static_cast<stl::uint32_t>(relative.attribute);
+                stl::int64_t const absolute = static_cast<stl::int64_t>(offsets[slot]) + relative.index;
+                if (absolute < 0 || absolute >= no_index) {
+                    chunk.invalid = true;
+                    break;
+                }
+                Corner& corner = chunk.corners[relative.corner];
+                stl::uint32_t* const indices[] = { &corner.position, &corner.tex_coord, &corner.normal };
+                *indices[slot] = static_cast<stl::uint32_t>(absolute);
+            }
+            chunk.relative_indices = stl::vector<RelativeIndex>();
+
+            for (Corner const& corner : chunk.corners) {
+                if (corner.position >= position_count
+                    || (corner.tex_coord != no_index && corner.tex_coord >= tex_coord_count)
+                    || (corner.normal != no_index && corner.normal >= normal_count)) {
+                    chunk.invalid = true;
+                    break;
+                }
+            }
+        }
+    });
+    return attributes;
+}
+
+void parse_mtl(fs::path const& path, fs::path const& texture_directory, ImportedModel& model,
+    std::unordered_map<std::string, stl::uint32_t>& material_indices) {
+    model.dependencies.push_back(path);
+    // Like the Assimp importer, a missing material library only means the materials are missing
+    std::ifstream file(path);
+    if (!file.good()) { return; }
+
+    stl::size_t current = no_index;
+    std::string line;
+    while (std::getline(file, line)) {
+        char const* const end = line.data() + line.size();
+        char const* const it = skip_spaces(line.data(), end);
+        std::string_view rest;
+        if (match_keyword(it, end, "newmtl", rest)) {
+            std::string name(rest);
+            auto existing = material_indices.find(name);
+            if (existing != material_indices.end()) {
+                current = existing->second;
+                continue;
+            }
+            current = model.materials.size();
+            material_indices.emplace(name, static_cast<stl::uint32_t>(current));
+            ImportedMaterial material;
+            material.name = stl::move(name);
+            model.materials.push_back(stl::move(material));
+        } else if (match_keyword(it, end, "map_Kd", rest) && current != no_index && !rest.empty()) {
+            // Options like -bm 1.0 come before the file name
+            if (rest[0] == '-') {
+                stl::size_t const last_space = rest.find_last_of(" \t");
+                rest = last_space == std::string_view::npos ? std::string_view() : rest.substr(last_space + 1);
+            }
+            if (!rest.empty()) {
+                model.materials[current].texture_path = texture_directory / fs::path(std::string(rest));
+            }
+        }
+    }
+}
+
+// Groups the triangles of all chunks into meshes, following the object, group and material statements in file order
+class MeshBuilder {
+public:
+    MeshBuilder(ImportedModel& model, fs::path const& directory) : model(model), directory(directory) {
+        // Material 0 is used by faces without a material
+        ImportedMaterial default_material;
+        default_material.name = "DefaultMaterial";
+        model.materials.push_back(stl::move(default_material));
+        material_indices.emplace(model.materials[0].name, 0);
+    }
+
+    void add_chunk(stl::size_t index, Chunk const& chunk) {
+        stl::size_t triangle = 0;
+        for (Statement const& statement : chunk.statements) {
+            add_triangles(index, triangle, statement.triangle);
+            triangle = statement.triangle;
+            apply(statement);
+        }
+        add_triangles(index, triangle, chunk.corners.size() / 3);
+    }
+
+    stl::vector<ObjMesh> meshes;
+    stl::vector<ObjObject> objects;
+
+private:
+    void add_triangles(stl::size_t chunk, stl::size_t first, stl::size_t end) {
+        if (first == end) { return; }
+        if (current_object == no_index) {
+            start_object("defaultobject");
+        }
+        if (current_mesh == no_index) {
+            ObjObject& object = objects[current_object];
+            ObjMesh mesh;
+            mesh.name = object.meshes.empty() ? object.name : object.name + "_" + model.materials[current_material].name;
+            mesh.material = current_material;
+            current_mesh = meshes.size();
+            object.meshes.push_back(current_mesh);
+            meshes.push_back(stl::move(mesh));
+        }
+
+        ObjMesh& mesh = meshes[current_mesh];
+        mesh.segments.push_back({ chunk, first, end });
+        mesh.triangle_count += end - first;
+    }
+
+    void start_object(std::string const& name) {
+        current_object = objects.size();
+        current_mesh = no_index;
+        ObjObject object;
+        object.name = name;
+        objects.push_back(stl::move(object));
+    }
+
+    void apply(Statement const& statement) {
+        switch (statement.type) {
+            case StatementType::Object:
+                start_object(statement.name);
+                break;
+            case StatementType::Group:
+                // Repeating the current group doesn't start a new one
+                if (current_object == no_index || objects[current_object].name != statement.name) {
+                    start_object(statement.name);
+                }
+                break;
+            case StatementType::UseMaterial: {
+                auto it = material_indices.find(statement.name);
+                stl::uint32_t const material = it == material_indices.end() ? 0 : it->second;
+                if (material != current_material) {
+                    current_material = material;
+                    current_mesh = no_index;
+                }
+                break;
+            }
+            case StatementType::MaterialLibrary:
+                parse_mtl(directory / fs::path(statement.name), directory, model, material_indices);
+                break;
+        }
+    }
+
+    ImportedModel& model;
+    fs::path directory;
+    std::unordered_map<std::string, stl::uint32_t> material_indices;
+    stl::size_t current_object = no_index;
+    stl::size_t current_mesh = no_index;
+    stl::uint32_t current_material = 0;
+};
+
+// Copies the corners of a mesh out of the chunks, and tags the corners without a normal with their triangle
+stl::vector<Corner> gather_corners(ObjMesh const& mesh, stl::vector<Chunk> const& chunks, ThreadPool& pool) {
+    stl::vector<Corner> corners(stl::tags::uninitialized, mesh.triangle_count * 3);
+    stl::vector<stl::size_t> offsets(stl::tags::uninitialized, mesh.segments.size());
+    stl::size_t offset = 0;
+    for (stl::size_t i = 0; i < mesh.segments.size(); ++i) {
+        offsets[i] = offset;
+        offset += (mesh.segments[i].end_triangle - mesh.segments[i].first_triangle) * 3;
+    }
+
+    pool.parallel_for(mesh.segments.size(), 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t i = begin; i < end; ++i) {
+            MeshSegment const& segment = mesh.segments[i];
+            Corner const* const source = chunks[segment.chunk].corners.data();
+            std::copy(source + segment.first_triangle * 3, source + segment.end_triangle * 3,
+                corners.begin() + offsets[i]);
+            stl::size_t const end_corner = offsets[i] + (segment.end_triangle - segment.first_triangle) * 3;
+            for (stl::size_t corner = offsets[i]; corner < end_corner; ++corner) {
+                if (corners[corner].normal == no_index) {
+                    corners[corner].normal = face_normal_bit | static_cast<stl::uint32_t>(corner / 3);
+                }
+            }
+        }
+    });
+    return corners;
+}
+
+void write_vertex(float* vertex, Corner const& corner, VertexAttributes const& attributes) {
+    float const* const position = attributes.positions.data() + stl::size_t(corner.position) * 3;
+    vertex[0] = position[0];
+    vertex[1] = position[1];
+    vertex[2] = position[2];
+
+    if (!(corner.normal & face_normal_bit)) {
+        float const* const normal = attributes.normals.data() + stl::size_t(corner.normal) * 3;
+        vertex[3] = normal[0];
+        vertex[4] = normal[1];
+        vertex[5] = normal[2];
+    } else {
+        // Generated afterwards
+        vertex[3] = vertex[4] = vertex[5] = 0.0f;
+    }
+
+    if (corner.tex_coord != no_index) {
+        float const* const tex_coord = attributes.tex_coords.data() + stl::size_t(corner.tex_coord) * 2;
+        vertex[6] = tex_coord[0];
+        // Flipped like aiProcess_FlipUVs does
+        vertex[7] = 1.0f - tex_coord[1];
+    } else {
+        vertex[6] = vertex[7] = 0.0f;
+    }
+}
+
+// Corner of a mesh, sorted into its weld partition
+struct PartitionedCorner {
+    Corner corner;
+    // Position of the corner in the mesh
+    stl::uint32_t index;
+};
+
+// Open addressing hash map from the distinct corners of a weld partition to their vertex index in the partition.
+// The keys are stored in the slots, so a lookup usually touches a single cache line.
+class WeldMap {
+public:
+    explicit WeldMap(stl::size_t corner_count) {
+        stl::size_t capacity = 16;
+        while (capacity < corner_count * 2) { capacity *= 2; }
+        slots = stl::vector<Slot>(capacity, Slot{ Corner{ no_index, no_index, no_index }, no_index });
+        mask = capacity - 1;
+    }
+
+    // Returns the vertex of the corner, adding a vertex if it's the first corner with these indices
+    stl::uint32_t insert(stl::uint64_t hash, Corner const& corner) {
+        stl::size_t slot = hash & mask;
+        while (slots[slot].vertex != no_index) {
+            if (slots[slot].corner == corner) { return slots[slot].vertex; }
+            slot = (slot + 1) & mask;
+        }
+        stl::uint32_t const vertex = static_cast<stl::uint32_t>(vertices.size());
+        slots[slot] = Slot{ corner, vertex };
+        vertices.push_back(corner);
+        return vertex;
+    }
+
+    // Corner of every vertex, in the order they were added
+    stl::vector<Corner> vertices;
+
+private:
+    struct Slot {
+        Corner corner;
+        stl::uint32_t vertex;
+    };
+
+    stl::vector<Slot> slots;
+    stl::size_t mask = 0;
+};
+
+// Gives the vertices that didn't get a normal from the file the normal of their triangle. Welding kept those
+// vertices apart per triangle, so every triangle writes only its own vertices. Degenerate triangles get a zero normal.
+void generate_normals(ImportedMesh& mesh, stl::vector<stl::uint8_t> const& needs_normal, ThreadPool& pool) {
+    SATURN_PROFILE_SCOPE("Generate OBJ normals");
+    float* const vertices = mesh.vertices.data();
+    pool.parallel_for(mesh.indices.size() / 3, weld_block_size, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t triangle = begin; triangle < end; ++triangle) {
+            stl::uint32_t const* const indices = mesh.indices.data() + triangle * 3;
+            if (!needs_normal[indices[0]] && !needs_normal[indices[1]] && !needs_normal[indices[2]]) { continue; }
+
+            float const* const a = vertices + stl::size_t(indices[0]) * vertex_size;
+            float const* const b = vertices + stl::size_t(indices[1]) * vertex_size;
+            float const* const c = vertices + stl::size_t(indices[2]) * vertex_size;
+            float const ab[] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+            float const ac[] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+            float normal[] = {
+                ab[1] * ac[2] - ab[2] * ac[1],
+                ab[2] * ac[0] - ab[0] * ac[2],
+                ab[0] * ac[1] - ab[1] * ac[0]
+            };
+            float const length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if (length > 0.0f) {
+                normal[0] /= length;
+                normal[1] /= length;
+                normal[2] /= length;
+            }
+
+            for (stl::size_t corner = 0; corner < 3; ++corner) {
+                if (!needs_normal[indices[corner]]) { continue; }
+                float* const vertex = vertices + stl::size_t(indices[corner]) * vertex_size;
+                vertex[3] = normal[0];
+                vertex[4] = normal[1];
+                vertex[5] = normal[2];
+            }
+        }
+    });
+}
+
+// Turns the corners of a mesh into a vertex and index buffer, with one vertex per distinct corner.
+// Corners are partitioned by hash, and each partition is welded by one task. The partitions are filled in corner
+// order, so the result doesn't depend on how the tasks are scheduled.
+void weld_mesh(ImportedMesh& mesh, stl::vector<Corner> const& corners, VertexAttributes const& attributes,
+    ThreadPool& pool) {
+    SATURN_PROFILE_SCOPE("Weld OBJ mesh");
+    stl::size_t const corner_count = corners.size();
+    stl::size_t const partition_bits = corner_count < parallel_weld_corners ? 0 : weld_partition_bits;
+    stl::size_t const partition_count = stl::size_t(1) << partition_bits;
+    stl::size_t const block_count = (corner_count + weld_block_size - 1) / weld_block_size;
+    auto partition_of = [partition_bits](stl::uint64_t hash) -> stl::size_t {
+        return partition_bits == 0 ? 0 : static_cast<stl::size_t>(hash >> (64 - partition_bits));
+    };
+
+    // Count the corners of every partition per block, then turn the counts into offsets so every block can scatter
+    // its corners without synchronization
+    stl::vector<stl::size_t> block_offsets(block_count * partition_count, 0);
+    pool.parallel_for(block_count, 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t block = begin; block < end; ++block) {
+            stl::size_t* const counts = block_offsets.data() + block * partition_count;
+            stl::size_t const last = std::min(corner_count, (block + 1) * weld_block_size);
+            for (stl::size_t i = block * weld_block_size; i < last; ++i) {
+                ++counts[partition_of(hash_corner(corners[i]))];
+            }
+        }
+    });
+
+    stl::vector<stl::size_t> partition_begin(stl::tags::uninitialized, partition_count + 1);
+    stl::size_t offset = 0;
+    for (stl::size_t partition = 0; partition < partition_count; ++partition) {
+        partition_begin[partition] = offset;
+        for (stl::size_t block = 0; block < block_count; ++block) {
+            stl::size_t const count = block_offsets[block * partition_count + partition];
+            block_offsets[block * partition_count + partition] = offset;
+            offset += count;
+        }
+    }
+    partition_begin[partition_count] = offset;
+
+    stl::vector<PartitionedCorner> partitioned(stl::tags::uninitialized, corner_count);
+    pool.parallel_for(block_count, 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t block = begin; block < end; ++block) {
+            stl::size_t* const offsets = block_offsets.data() + block * partition_count;
+            stl::size_t const last = std::min(corner_count, (block + 1) * weld_block_size);
+            for (stl::size_t i = block * weld_block_size; i < last; ++i) {
+                Corner const& corner = corners[i];
+                partitioned[offsets[partition_of(hash_corner(corner))]++] = { corner, static_cast<stl::uint32_t>(i) };
+            }
+        }
+    });
+
+    // Weld every partition on its own, with vertex indices local to the partition
+    mesh.indices = stl::vector<stl::uint32_t>(stl::tags::uninitialized, corner_count);
+    stl::vector<stl::vector<Corner>> partition_vertices(partition_count);
+    pool.parallel_for(partition_count, 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t partition = begin; partition < end; ++partition) {
+            stl::size_t const first = partition_begin[partition];
+            stl::size_t const last = partition_begin[partition + 1];
+            WeldMap map(last - first);
+            for (stl::size_t i = first; i < last; ++i) {
+                PartitionedCorner const& corner = partitioned[i];
+                mesh.indices[corner.index] = map.insert(hash_corner(corner.corner), corner.corner);
+            }
+            partition_vertices[partition] = stl::move(map.vertices);
+        }
+    });
+
+    stl::vector<stl::size_t> vertex_offsets(stl::tags::uninitialized, partition_count);
+    stl::size_t vertex_count = 0;
+    for (stl::size_t partition = 0; partition < partition_count; ++partition) {
+        vertex_offsets[partition] = vertex_count;
+        vertex_count += partition_vertices[partition].size();
+    }
+
+    mesh.vertex_size = vertex_size;
+    mesh.vertices = stl::vector<float>(stl::tags::uninitialized, vertex_count * vertex_size);
+    stl::vector<stl::uint8_t> needs_normal(stl::tags::uninitialized, vertex_count);
+    std::atomic<bool> any_missing_normals = false;
+    pool.parallel_for(partition_count, 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t partition = begin; partition < end; ++partition) {
+            stl::uint32_t const vertex_offset = static_cast<stl::uint32_t>(vertex_offsets[partition]);
+            if (vertex_offset != 0) {
+                for (stl::size_t i = partition_begin[partition]; i < partition_begin[partition + 1]; ++i) {
+                    mesh.indices[partitioned[i].index] += vertex_offset;
+                }
+            }
+
+            bool missing_normals = false;
+            stl::vector<Corner> const& vertices = partition_vertices[partition];
+            for (stl::size_t i = 0; i < vertices.size(); ++i) {
+                write_vertex(mesh.vertices.data() + (vertex_offset + i) * vertex_size, vertices[i], attributes);
+                bool const generated = (vertices[i].normal & face_normal_bit) != 0;
+                needs_normal[vertex_offset + i] = generated;
+                missing_normals |= generated;
+            }
+            if (missing_normals) { any_missing_normals.store(true, std::memory_order_relaxed); }
+        }
+    });
+
+    if (any_missing_normals.load(std::memory_order_relaxed)) {
+        generate_normals(mesh, needs_normal, pool);
+    }
+    mesh.bounds = compute_bounds(mesh.vertices.data(), vertex_count, vertex_size);
+}
+
+} // namespace
+
+ImportedModel parse_obj(fs::path const& path, ThreadPool& pool) {
+    SATURN_PROFILE_SCOPE("Parse OBJ");
+    MappedFile file;
+    if (!file.open(path)) {
+        throw std::runtime_error("Failed to open model at path " + path.generic_string());
+    }
+    file.prefetch();
+
+    char const* const data = reinterpret_cast<char const*>(file.data());
+    stl::vector<Chunk> chunks = split_into_chunks(data, file.size());
+    {
+        SATURN_PROFILE_SCOPE("Parse OBJ chunks");
+        pool.parallel_for(chunks.size(), 1, [&chunks](stl::size_t begin, stl::size_t end) {
+            for (stl::size_t i = begin; i < end; ++i) {
+                parse_chunk(chunks[i]);
+            }
+        });
+    }
+
+    VertexAttributes const attributes = merge_chunks(chunks, pool);
+    for (Chunk const& chunk : chunks) {
+        if (chunk.invalid) {
+            throw std::runtime_error("Invalid OBJ data in model at path " + path.generic_string());
+        }
+    }
+
+    ImportedModel model;
+    MeshBuilder builder(model, path.parent_path());
+    for (stl::size_t i = 0; i < chunks.size(); ++i) {
+        builder.add_chunk(i, chunks[i]);
+    }
+
+    for (ObjMesh const& mesh : builder.meshes) {
+        if (mesh.triangle_count * 3 > no_index) {
+            throw std::runtime_error("Mesh " + mesh.name + " has too many triangles in model at path "
+                + path.generic_string());
+        }
+    }
+
+    stl::vector<stl::vector<Corner>> mesh_corners(stl::tags::reserve, builder.meshes.size());
+    for (ObjMesh const& mesh : builder.meshes) {
+        mesh_corners.push_back(gather_corners(mesh, chunks, pool));
+    }
+    chunks.clear();
+
+    model.meshes.resize(builder.meshes.size());
+    pool.parallel_for(builder.meshes.size(), 1, [&](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t i = begin; i < end; ++i) {
+            ImportedMesh& mesh = model.meshes[i];
+            mesh.name = builder.meshes[i].name;
+            mesh.material = builder.meshes[i].material;
+            weld_mesh(mesh, mesh_corners[i], attributes, pool);
+            mesh_corners[i] = stl::vector<Corner>();
+        }
+    });
+
+    // The root holds one child per object, which holds the first mesh of the object
+    model.nodes.resize(builder.objects.size() + 1);
+    for (stl::size_t i = 0; i < builder.objects.size(); ++i) {
+        ObjObject const& object = builder.objects[i];
+        model.nodes[0].children.push_back(i + 1);
+        if (!object.meshes.empty()) {
+            model.nodes[i + 1].mesh = static_cast<stl::int64_t>(object.meshes[0]);
+        }
+    }
+    return model;
+}
+
+}
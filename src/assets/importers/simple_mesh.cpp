@@ -1,7 +1,5 @@
 #include <saturn/assets/importers/simple_mesh.hpp>
 
-#include <phobos/renderer/mesh.hpp>
-
 #include <fstream>
 #include <stl/types.hpp>
 #include <stl/vector.hpp>
@@ -9,8 +7,8 @@
 #include <numeric>
 
 namespace saturn::assets::importers {
-    
-std::optional<ph::Mesh> import_simple_mesh(Context& ctx, fs::path const& path) {
+
+std::optional<ImportedMesh> read_simple_mesh(fs::path const& path) {
     std::ifstream file(path);
     if (!file.good()) {
         return std::nullopt;
@@ -20,26 +18,24 @@ std::optional<ph::Mesh> import_simple_mesh(Context& ctx, fs::path const& path) {
     stl::size_t vertex_count = 0;
 
     file >> total_values >> vertex_count;
+    if (!file.good() || vertex_count == 0) {
+        return std::nullopt;
+    }
 
-    stl::size_t const values_per_vertex = total_values / vertex_count;
-    stl::vector<float> vertices(stl::tags::uninitialized, total_values);
+    ImportedMesh mesh;
+    mesh.name = path.generic_string();
+    mesh.vertex_size = total_values / vertex_count;
+    mesh.vertices = stl::vector<float>(stl::tags::uninitialized, total_values);
 
     for (stl::size_t i = 0; i < total_values; ++i) {
-        file >> vertices[i];
+        file >> mesh.vertices[i];
     }
 
-    stl::vector<stl::uint32_t> indices(stl::tags::uninitialized, vertex_count);
-    std::iota(indices.begin(), indices.end(), 0);
-
-    ph::Mesh::CreateInfo info;
-    info.ctx = ctx.vulkan;
-    info.index_count = vertex_count;
-    info.vertex_size = values_per_vertex;
-    info.vertices = vertices.data();
-    info.vertex_count = vertex_count;
-    info.indices = indices.data();
-    info.index_count = vertex_count;
-    return { ph::Mesh(info) };
+    mesh.bounds = compute_bounds(mesh.vertices.data(), vertex_count, mesh.vertex_size);
+
+    mesh.indices = stl::vector<stl::uint32_t>(stl::tags::uninitialized, vertex_count);
+    std::iota(mesh.indices.begin(), mesh.indices.end(), 0);
+    return mesh;
 }
 
-}
\ No newline at end of file
+}
@@ -1,25 +1,43 @@
 #include <saturn/assets/importers/stb_texture_import.hpp>
+#include <saturn/assets/asset_cache.hpp>
 
 #include <stb/stb_image.h>
-#include <phobos/renderer/texture.hpp>
+
+#include <cstring>
 
 namespace saturn::assets::importers {
 
-ph::Texture import_with_stb(Context& ctx, fs::path const& path) {
+// Bump when the decoded output changes, so textures cached by older versions are decoded again
+static constexpr stl::uint32_t stb_importer_version = 1;
+
+std::optional<ImportedTexture> read_with_stb(fs::path const& path) {
     int w, h, channels;
-    uint8_t* img = stbi_load(path.generic_string().c_str(), &w, &h, &channels, STBI_rgb_alpha);
-    ph::Texture::CreateInfo tex_info;
-    tex_info.ctx = ctx.vulkan;
-    tex_info.channels = 4;
-    tex_info.format = vk::Format::eR8G8B8A8Srgb;
-    tex_info.width = w;
-    tex_info.height = h;
-    tex_info.data = img;
-
-    ph::Texture texture(tex_info);
+    stl::uint8_t* img = stbi_load(path.generic_string().c_str(), &w, &h, &channels, STBI_rgb_alpha);
+    if (!img) {
+        return std::nullopt;
+    }
+
+    ImportedTexture texture;
+    texture.width = w;
+    texture.height = h;
+    texture.pixels = stl::vector<stl::uint8_t>(stl::tags::uninitialized, static_cast<stl::size_t>(w) * h * 4);
+    std::memcpy(texture.pixels.data(), img, texture.pixels.size());
     stbi_image_free(img);
 
     return texture;
 }
 
+std::optional<ImportedTexture> read_texture(fs::path const& path) {
+    stl::uint64_t const importer_key = hash_bytes(&stb_importer_version, sizeof(stb_importer_version));
+    if (std::optional<ImportedTexture> cached = read_cached_texture(path, importer_key)) {
+        return cached;
+    }
+
+    std::optional<ImportedTexture> texture = read_with_stb(path);
+    if (texture) {
+        write_cached_texture(path, importer_key, *texture);
+    }
+    return texture;
+}
+
 }
\ No newline at end of file
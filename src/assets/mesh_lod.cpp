@@ -0,0 +1,435 @@
+#include <saturn/assets/mesh_lod.hpp>
+#include <saturn/utility/bounds.hpp>
+
+#include <stl/assert.hpp>
+#include <stl/utility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace saturn::assets {
+
+namespace {
+
+// Quadrics are stored as the upper triangle of A, then b, then c, so Q(v) = v^T A v + 2 b.v + c
+constexpr stl::size_t max_dimension = 16;
+
+constexpr stl::size_t quadric_size(stl::size_t dimension) {
+    return dimension * (dimension + 1) / 2 + dimension + 1;
+}
+
+double evaluate_quadric(double const* q, double const* v, stl::size_t dimension) {
+    double result = 0.0;
+    stl::size_t entry = 0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        // Off diagonal entries appear twice in the full matrix
+        result += q[entry++] * v[i] * v[i];
+        for (stl::size_t j = i + 1; j < dimension; ++j) {
+            result += 2.0 * q[entry++] * v[i] * v[j];
+        }
+    }
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        result += 2.0 * q[entry++] * v[i];
+    }
+    return result + q[entry];
+}
+
+// Adds the quadric of the plane through 3 points to q, which is the squared distance to that plane in n dimensions
+// (Garland and Heckbert, Simplifying Surfaces with Color and Texture using Quadric Error Metrics)
+void add_triangle_quadric(double* q, double const* p0, double const* p1, double const* p2, stl::size_t dimension, 
+    double weight) {
+    double e1[max_dimension];
+    double e2[max_dimension];
+    double length1 = 0.0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        e1[i] = p1[i] - p0[i];
+        length1 += e1[i] * e1[i];
+    }
+    if (length1 <= 0.0) { return; }
+    length1 = std::sqrt(length1);
+    double dot = 0.0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        e1[i] /= length1;
+        e2[i] = p2[i] - p0[i];
+        dot += e1[i] * e2[i];
+    }
+    double length2 = 0.0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        e2[i] -= dot * e1[i];
+        length2 += e2[i] * e2[i];
+    }
+    if (length2 <= 0.0) { return; }
+    length2 = std::sqrt(length2);
+    double p0_e1 = 0.0;
+    double p0_e2 = 0.0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        e2[i] /= length2;
+        p0_e1 += p0[i] * e1[i];
+        p0_e2 += p0[i] * e2[i];
+    }
+
+    // A = I - e1 e1^T - e2 e2^T, b = (p0.e1) e1 + (p0.e2) e2 - p0, c = p0.p0 - (p0.e1)^2 - (p0.e2)^2
+    stl::size_t entry = 0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        for (stl::size_t j = i; j < dimension; ++j) {
+            q[entry++] += weight * ((i == j ? 1.0 : 0.0) - e1[i] * e1[j] - e2[i] * e2[j]);
+        }
+    }
+    double p0_p0 = 0.0;
+    for (stl::size_t i = 0; i < dimension; ++i) {
+        q[entry++] += weight * (p0_e1 * e1[i] + p0_e2 * e2[i] - p0[i]);
+        p0_p0 += p0[i] * p0[i];
+    }
+    q[entry] += weight * (p0_p0 - p0_e1 * p0_e1 - p0_e2 * p0_e2);
+}
+
+struct Collapse {
+    double cost;
+    // Vertex that is removed, and the vertex it is merged into
+    stl::uint32_t from;
+    stl::uint32_t to;
+    // Versions of both vertices when this was computed. The collapse is stale if either one changed.
+    stl::uint32_t from_version;
+    stl::uint32_t to_version;
+
+    // Inverted so the standard max heap functions give the cheapest collapse
+    bool operator<(Collapse const& rhs) const {
+        return cost > rhs.cost;
+    }
+};
+
+stl::uint64_t edge_key(stl::uint32_t a, stl::uint32_t b) {
+    return a < b ? (stl::uint64_t(a) << 32) | b : (stl::uint64_t(b) << 32) | a;
+}
+
+class Simplifier {
+public:
+    Simplifier(MeshData const& mesh, Span<stl::uint32_t const> indices, Span<float const> attribute_weights);
+
+    float run(stl::size_t target_index_count, float max_error, stl::vector<stl::uint32_t>& result);
+
+private:
+    void gather_neighbors(stl::uint32_t vertex, stl::vector<stl::uint32_t>& neighbors) const;
+    void push_collapse(stl::uint32_t a, stl::uint32_t b);
+    bool is_valid(Collapse const& collapse);
+    void collapse(Collapse const& collapse);
+
+    MeshData const& mesh;
+    stl::size_t dimension = 3;
+    // Position is scaled to the unit sphere, attributes are weighted
+    stl::vector<double> points;
+    stl::vector<double> quadrics;
+
+    stl::vector<stl::uint32_t> triangles;
+    stl::vector<bool> triangle_alive;
+    stl::size_t live_triangles = 0;
+    // Triangles around each vertex. Can contain dead triangles.
+    stl::vector<stl::vector<stl::uint32_t>> vertex_triangles;
+    stl::vector<bool> vertex_alive;
+    stl::vector<bool> vertex_locked;
+    stl::vector<stl::uint32_t> vertex_version;
+
+    stl::vector<Collapse> heap;
+    // Scratch buffers
+    stl::vector<stl::uint32_t> neighbors;
+    stl::vector<stl::uint32_t> other_neighbors;
+
+    float radius = 1.0f;
+};
+
+Simplifier::Simplifier(MeshData const& mesh, Span<stl::uint32_t const> indices, Span<float const> attribute_weights) 
+    : mesh(mesh) {
+    STL_ASSERT(mesh.vertex_size >= 3 && indices.size() % 3 == 0, "Invalid mesh data");
+
+    // Attributes with weight 0 don't need a dimension
+    stl::vector<stl::size_t> attributes;
+    for (stl::size_t i = 0; i < attribute_weights.size() && 3 + i < mesh.vertex_size; ++i) {
+        if (attribute_weights[i] != 0.0f && 3 + attributes.size() < max_dimension) {
+            attributes.push_back(i);
+        }
+    }
+    dimension = 3 + attributes.size();
+
+    Bounds const bounds = compute_bounds(mesh.vertices, mesh.vertex_count, mesh.vertex_size);
+    radius = bounds.radius > 0.0f ? bounds.radius : 1.0f;
+    points.resize(mesh.vertex_count * dimension);
+    for (stl::size_t v = 0; v < mesh.vertex_count; ++v) {
+        float const* vertex = mesh.vertices + v * mesh.vertex_size;
+        double* point = points.data() + v * dimension;
+        point[0] = (vertex[0] - bounds.center.x) / radius;
+        point[1] = (vertex[1] - bounds.center.y) / radius;
+        point[2] = (vertex[2] - bounds.center.z) / radius;
+        for (stl::size_t a = 0; a < attributes.size(); ++a) {
+            point[3 + a] = double(vertex[3 + attributes[a]]) * attribute_weights[attributes[a]];
+        }
+    }
+
+    triangles.resize(indices.size());
+    std::copy(indices.begin(), indices.end(), triangles.begin());
+    stl::size_t const triangle_count = indices.size() / 3;
+    triangle_alive.resize(triangle_count, true);
+    live_triangles = triangle_count;
+
+    vertex_triangles.resize(mesh.vertex_count);
+    vertex_alive.resize(mesh.vertex_count, true);
+    vertex_locked.resize(mesh.vertex_count, false);
+    vertex_version.resize(mesh.vertex_count, 0);
+
+    // Edges used by one triangle are on a border, edges used by more than two are non-manifold.
+    // Both would tear the mesh if their vertices moved.
+    std::unordered_map<stl::uint64_t, stl::uint32_t> edge_use;
+    for (stl::uint32_t t = 0; t < triangle_count; ++t) {
+        for (stl::uint32_t corner = 0; corner < 3; ++corner) {
+            stl::uint32_t const a = triangles[t * 3 + corner];
+            stl::uint32_t const b = triangles[t * 3 + (corner + 1) % 3];
+            ++edge_use[edge_key(a, b)];
+        }
+    }
+    for (auto const& [key, count] : edge_use) {
+        if (count != 2) {
+            vertex_locked[key >> 32] = true;
+            vertex_locked[key & 0xFFFFFFFF] = true;
+        }
+    }
+
+    stl::size_t const stride = quadric_size(dimension);
+    quadrics.resize(mesh.vertex_count * stride, 0.0);
+    for (stl::uint32_t t = 0; t < triangle_count; ++t) {
+        stl::uint32_t const* corners = triangles.data() + t * 3;
+        double const* p0 = points.data() + corners[0] * dimension;
+        double const* p1 = points.data() + corners[1] * dimension;
+        double const* p2 = points.data() + corners[2] * dimension;
+
+        // Weighted by area, so large triangles resist being changed more than small ones
+        double const ux = p1[0] - p0[0], uy = p1[1] - p0[1], uz = p1[2] - p0[2];
+        double const vx = p2[0] - p0[0], vy = p2[1] - p0[1], vz = p2[2] - p0[2];
+        double const cx = uy * vz - uz * vy, cy = uz * vx - ux * vz, cz = ux * vy - uy * vx;
+        double const area = 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+
+        for (stl::uint32_t corner = 0; corner < 3; ++corner) {
+            add_triangle_quadric(quadrics.data() + corners[corner] * stride, p0, p1, p2, dimension, area);
+            vertex_triangles[corners[corner]].push_back(t);
+        }
+    }
+
+    for (stl::uint32_t t = 0; t < triangle_count; ++t) {
+        for (stl::uint32_t corner = 0; corner < 3; ++corner) {
+            stl::uint32_t const a = triangles[t * 3 + corner];
+            stl::uint32_t const b = triangles[t * 3 + (corner + 1) % 3];
+            // Every interior edge is in two triangles, only add it once
+            if (a < b || edge_use[edge_key(a, b)] == 1) {
+                push_collapse(a, b);
+            }
+        }
+    }
+}
+
+void Simplifier::gather_neighbors(stl::uint32_t vertex, stl::vector<stl::uint32_t>& result) const {
+    result.clear();
+    for (stl::uint32_t t : vertex_triangles[vertex]) {
+        if (!triangle_alive[t]) { continue; }
+        for (stl::uint32_t corner = 0; corner < 3; ++corner) {
+            stl::uint32_t const other = triangles[t * 3 + corner];
+            if (other != vertex) {
+                result.push_back(other);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    result.resize(std::unique(result.begin(), result.end()) - result.begin());
+}
+
+void Simplifier::push_collapse(stl::uint32_t a, stl::uint32_t b) {
+    if (vertex_locked[a] && vertex_locked[b]) { return; }
+
+    stl::size_t const stride = quadric_size(dimension);
+    double merged[quadric_size(max_dimension)];
+    double const* qa = quadrics.data() + a * stride;
+    double const* qb = quadrics.data() + b * stride;
+    for (stl::size_t i = 0; i < stride; ++i) {
+        merged[i] = qa[i] + qb[i];
+    }
+
+    // Only collapse onto existing vertices, so the attributes of the result are always valid
+    double const infinity = std::numeric_limits<double>::infinity();
+    double const cost_a_to_b = vertex_locked[a] ? infinity : evaluate_quadric(merged, points.data() + b * dimension, dimension);
+    double const cost_b_to_a = vertex_locked[b] ? infinity : evaluate_quadric(merged, points.data() + a * dimension, dimension);
+
+    Collapse collapse;
+    if (cost_a_to_b <= cost_b_to_a) {
+        collapse = { std::max(cost_a_to_b, 0.0), a, b, vertex_version[a], vertex_version[b] };
+    } else {
+        collapse = { std::max(cost_b_to_a, 0.0), b, a, vertex_version[b], vertex_version[a] };
+    }
+    heap.push_back(collapse);
+    std::push_heap(heap.begin(), heap.end());
+}
+
+bool Simplifier::is_valid(Collapse const& collapse) {
+    // Link condition: the vertices may only share the neighbors of the triangles on their edge, or the collapse
+    // creates non-manifold geometry
+    gather_neighbors(collapse.from, neighbors);
+    gather_neighbors(collapse.to, other_neighbors);
+    stl::size_t shared = 0;
+    for (stl::uint32_t neighbor : neighbors) {
+        if (std::binary_search(other_neighbors.begin(), other_neighbors.end(), neighbor)) {
+            ++shared;
+        }
+    }
+    if (shared > 2) { return false; }
+
+    // Reject collapses that flip a triangle over
+    float const* target = mesh.vertices + collapse.to * mesh.vertex_size;
+    for (stl::uint32_t t : vertex_triangles[collapse.from]) {
+        if (!triangle_alive[t]) { continue; }
+        stl::uint32_t const* corners = triangles.data() + t * 3;
+        if (corners[0] == collapse.to || corners[1] == collapse.to || corners[2] == collapse.to) { continue; }
+
+        float const* p[3];
+        float const* moved[3];
+        for (stl::uint32_t corner = 0; corner < 3; ++corner) {
+            p[corner] = mesh.vertices + corners[corner] * mesh.vertex_size;
+            moved[corner] = corners[corner] == collapse.from ? target : p[corner];
+        }
+        auto normal = [](float const* const* v, float* n) {
+            float const ux = v[1][0] - v[0][0], uy = v[1][1] - v[0][1], uz = v[1][2] - v[0][2];
+            float const vx = v[2][0] - v[0][0], vy = v[2][1] - v[0][1], vz = v[2][2] - v[0][2];
+            n[0] = uy * vz - uz * vy;
+            n[1] = uz * vx - ux * vz;
+            n[2] = ux * vy - uy * vx;
+        };
+        float before[3];
+        float after[3];
+        normal(p, before);
+        normal(moved, after);
+        if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0f) { return false; }
+    }
+    return true;
+}
+
+void Simplifier::collapse(Collapse const& collapse) {
+    stl::uint32_t const from = collapse.from;
+    stl::uint32_t const to = collapse.to;
+
+    for (stl::uint32_t t : vertex_triangles[from]) {
+        if (!triangle_alive[t]) { continue; }
+        stl::uint32_t* corners = triangles.data() + t * 3;
+        if (corners[0] == to || corners[1] == to || corners[2] == to) {
+            // Triangles on the collapsed edge become degenerate
+            triangle_alive[t] = false;
+            --live_triangles;
+            continue;
+        }
+        for (stl::uint32_t corner = 0; corner < 3; ++corner) {
+            if (corners[corner] == from) { corners[corner] = to; }
+        }
+        vertex_triangles[to].push_back(t);
+    }
+
+    stl::vector<stl::uint32_t>& around = vertex_triangles[to];
+    around.resize(std::remove_if(around.begin(), around.end(), [this](stl::uint32_t t) { 
+        return !triangle_alive[t]; 
+    }) - around.begin());
+    vertex_triangles[from].clear();
+    vertex_alive[from] = false;
+
+    stl::size_t const stride = quadric_size(dimension);
+    double* q_to = quadrics.data() + to * stride;
+    double const* q_from = quadrics.data() + from * stride;
+    for (stl::size_t i = 0; i < stride; ++i) {
+        q_to[i] += q_from[i];
+    }
+    ++vertex_version[to];
+
+    // The costs of all edges of the merged vertex changed
+    gather_neighbors(to, neighbors);
+    for (stl::uint32_t neighbor : neighbors) {
+        push_collapse(to, neighbor);
+    }
+}
+
+float Simplifier::run(stl::size_t target_index_count, float max_error, stl::vector<stl::uint32_t>& result) {
+    // Costs are squared distances in the scaled space
+    double const max_cost = double(max_error) * max_error;
+    double worst_cost = 0.0;
+
+    while (live_triangles * 3 > target_index_count && !heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        Collapse const next = heap.back();
+        heap.pop_back();
+
+        if (!vertex_alive[next.from] || !vertex_alive[next.to] 
+            || vertex_version[next.from] != next.from_version || vertex_version[next.to] != next.to_version) {
+            continue;
+        }
+        // All remaining collapses are at least this expensive
+        if (next.cost > max_cost) { break; }
+        if (!is_valid(next)) { continue; }
+
+        collapse(next);
+        worst_cost = std::max(worst_cost, next.cost);
+    }
+
+    result.clear();
+    for (stl::size_t t = 0; t < triangle_alive.size(); ++t) {
+        if (triangle_alive[t]) {
+            result.push_back(triangles[t * 3]);
+            result.push_back(triangles[t * 3 + 1]);
+            result.push_back(triangles[t * 3 + 2]);
+        }
+    }
+    return static_cast<float>(std::sqrt(worst_cost)) * radius;
+}
+
+} // anonymous namespace
+
+float simplify_mesh(MeshData const& mesh, Span<stl::uint32_t const> indices, SimplifySettings const& settings,
+    stl::vector<stl::uint32_t>& result) {
+    Simplifier simplifier(mesh, indices, settings.attribute_weights);
+    return simplifier.run(settings.target_index_count, settings.max_error, result);
+}
+
+stl::vector<MeshLodData> generate_lod_chain(MeshData const& mesh, Span<stl::uint32_t const> indices, 
+    LodChainSettings const& settings) {
+    stl::vector<MeshLodData> lods;
+    Span<stl::uint32_t const> previous = indices;
+    float previous_error = 0.0f;
+    for (stl::size_t level = 0; level < settings.max_levels; ++level) {
+        SimplifySettings simplify;
+        simplify.target_index_count = static_cast<stl::size_t>(previous.size() / 3 * settings.reduction) * 3;
+        simplify.max_error = settings.max_error;
+        simplify.attribute_weights = settings.attribute_weights;
+
+        MeshLodData lod;
+        float const error = simplify_mesh(mesh, previous, simplify, lod.indices);
+        if (lod.indices.size() > previous.size() * 9 / 10) { break; }
+
+        // Every level is simplified from the previous one, so the errors add up
+        lod.error = previous_error + error;
+        previous_error = lod.error;
+        lods.push_back(stl::move(lod));
+        previous = Span<stl::uint32_t const>(lods.back().indices.data(), lods.back().indices.size());
+    }
+    return lods;
+}
+
+void compact_vertices(MeshData const& mesh, stl::vector<stl::uint32_t>& indices, stl::vector<float>& vertices) {
+    constexpr stl::uint32_t unused = 0xFFFFFFFF;
+    stl::vector<stl::uint32_t> remap(mesh.vertex_count, unused);
+    vertices.clear();
+    stl::uint32_t next = 0;
+    for (stl::uint32_t& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = next++;
+            float const* vertex = mesh.vertices + index * mesh.vertex_size;
+            for (stl::size_t i = 0; i < mesh.vertex_size; ++i) {
+                vertices.push_back(vertex[i]);
+            }
+        }
+        index = remap[index];
+    }
+}
+
+} // namespace saturn::assets
@@ -0,0 +1,52 @@
+#include <saturn/assets/render_resources.hpp>
+
+namespace saturn::assets {
+
+ph::Mesh create_mesh(Context const& ctx, ph::Mesh::CreateInfo const& info) {
+    if (!ctx.vulkan) { return ph::Mesh(); }
+    return ph::Mesh(info);
+}
+
+ph::Texture create_texture(Context const& ctx, ph::Texture::CreateInfo const& info) {
+    if (!ctx.vulkan) { return ph::Texture(); }
+    return ph::Texture(info);
+}
+
+// The create infos only read from the data pointers, but don't all declare them const
+
+ph::Mesh create_mesh(Context const& ctx, ImportedMesh const& mesh) {
+    ph::Mesh::CreateInfo info;
+    info.ctx = ctx.vulkan;
+    info.vertex_size = mesh.vertex_size;
+    Span<float const> const vertices = mesh.vertex_data();
+    Span<stl::uint32_t const> const indices = mesh.index_data();
+    info.vertices = const_cast<float*>(vertices.data());
+    info.vertex_count = vertices.size() / mesh.vertex_size;
+    info.indices = const_cast<stl::uint32_t*>(indices.data());
+    info.index_count = indices.size();
+    return create_mesh(ctx, info);
+}
+
+ph::Mesh create_mesh(Context const& ctx, ImportedMeshLod const& lod, stl::size_t vertex_size) {
+    ph::Mesh::CreateInfo info;
+    info.ctx = ctx.vulkan;
+    info.vertex_size = vertex_size;
+    info.vertices = const_cast<float*>(lod.vertices.data());
+    info.vertex_count = lod.vertices.size() / vertex_size;
+    info.indices = const_cast<stl::uint32_t*>(lod.indices.data());
+    info.index_count = lod.indices.size();
+    return create_mesh(ctx, info);
+}
+
+ph::Texture create_texture(Context const& ctx, ImportedTexture const& texture) {
+    ph::Texture::CreateInfo info;
+    info.ctx = ctx.vulkan;
+    info.channels = 4;
+    info.format = vk::Format::eR8G8B8A8Srgb;
+    info.width = texture.width;
+    info.height = texture.height;
+    info.data = const_cast<stl::uint8_t*>(texture.pixels.data());
+    return create_texture(ctx, info);
+}
+
+} // namespace saturn::assets
@@ -14,6 +14,17 @@ static bool is_component(cppast::cpp_entity const& entity) {
     return cppast::has_attribute(entity, "component").has_value();
 }
 
+// Check for an attribute named 'ignore' in the serialize scope, [[serialize::ignore]]. Works on components and fields.
+static bool is_serialize_ignored(cppast::cpp_entity const& entity) {
+    if (auto attr_opt = cppast::has_attribute(entity, "ignore"); attr_opt.has_value()) {
+        auto const& attr = attr_opt.value();
+        if (auto scope_opt = attr.scope(); scope_opt.has_value()){
+            return scope_opt.value() == "serialize";
+        }
+    }
+    return false;
+}
+
 static bool is_field(cppast::cpp_entity const& entity, cppast::visitor_info const& info) {
     return entity.kind() == cppast::cpp_entity_kind::member_variable_t 
            && info.access == cppast::cpp_access_specifier_kind::cpp_public;
@@ -26,15 +37,8 @@ struct ast_visitor {
         field.name = field_data.name();
         field.type = cppast::to_string(field_data.type());
 
-        // Check if attributes named 'ignore'. This is essentially serialize::ignore and editor::ignore
-        if (auto attr_opt = cppast::has_attribute(entity, "ignore"); attr_opt.has_value()) {
-            auto const& attr = attr_opt.value();
-            if (auto scope_opt = attr.scope(); scope_opt.has_value()){
-                auto const& scope = scope_opt.value();
-                if (scope == "serialize") {
-                    field.flags |= FieldFlags::SerializeIgnore;
-                }
-            }
+        if (is_serialize_ignored(entity)) {
+            field.flags |= FieldFlags::SerializeIgnore;
         }
     }
     
@@ -56,6 +60,7 @@ struct ast_visitor {
                 cur_component_meta.name = entity.name();
                 cur_component_meta.unscoped_name = entity.name();
                 cur_component_meta.filename = filename;
+                cur_component_meta.serialized = !is_serialize_ignored(entity);
             }
         } else if (info.event == cppast::visitor_info::container_entity_exit) {
             --depth;
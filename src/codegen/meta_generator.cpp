@@ -1,8 +1,9 @@
-#include <saturn/codegen/serialization_generator.hpp>
+#include <saturn/codegen/meta_generator.hpp>
 
 #include <mustache/mustache.hpp>
 #include <saturn/codegen/utility.hpp>
 #include <fstream>
+#include <algorithm>
 
 namespace saturn::codegen {
 
@@ -27,6 +28,37 @@ void generate_meta_files(VisitResult const& data) {
     std::string generated = must.render(info);
     std::ofstream out("include/saturn/meta/for_each_component.hpp");
     out << generated;
+
+    generate_component_ids(data);
+}
+
+void generate_component_ids(VisitResult const& data) {
+    std::string tpl = read_file("templates/component_ids.hpp.mst");
+    mustache::mustache must(tpl);
+
+    // Components are visited on multiple threads, so their order is not stable. Sort them by name
+    // so the generated ids are the same every run.
+    std::vector<ComponentMeta const*> sorted;
+    for (auto const& component : data.components) {
+        sorted.push_back(&component);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](ComponentMeta const* lhs, ComponentMeta const* rhs) {
+        return lhs->name < rhs->name;
+    });
+
+    mustache::data info;
+    info["component_count"] = std::to_string(sorted.size());
+    auto& types = info["component_types"] = mustache::data::type::list;
+    for (stl::size_t i = 0; i < sorted.size(); ++i) {
+        mustache::data type_data;
+        type_data["component_name"] = sorted[i]->name;
+        type_data["component_id"] = std::to_string(i);
+        types.push_back(type_data);
+    }
+
+    std::string generated = must.render(info);
+    std::ofstream out("include/saturn/meta/component_ids.hpp");
+    out << generated;
 }
 
 }
\ No newline at end of file
@@ -18,7 +18,9 @@ static void gen_header(VisitResult const& data) {
 
     for (auto const& component : data.components) {
         includes.push_back({"component_filename", component.filename});
-        funcs.push_back({"component_name", component.name});
+        if (component.serialized) {
+            funcs.push_back({"component_name", component.name});
+        }
     }
 
     std::string generated = must.render(info);
@@ -36,6 +38,7 @@ static void gen_src(VisitResult const& data) {
 
     auto& impls = info["serializer_impl"] = mustache::data::type::list;
     for (auto const& component : data.components) {
+        if (!component.serialized) { continue; }
         mustache::data component_info;
         component_info["component_name"] = component.name;
         auto& deserialize_fields = component_info["deserialize_field"] = mustache::data::type::list;
@@ -51,7 +54,9 @@ static void gen_src(VisitResult const& data) {
 
     auto& entity_info = info["entity_serialize"] = mustache::data::type::list;
     for (auto const& component : data.components) {
-        entity_info.push_back({"component_name", component.name});
+        if (component.serialized) {
+            entity_info.push_back({"component_name", component.name});
+        }
     }
 
     std::string generated = must.render(info);
@@ -17,9 +17,11 @@
 #include <mimas/mimas.h>
 
 #include <saturn/assets/assets.hpp>
+#include <saturn/utility/profiler.hpp>
 
 #include <saturn/scene/scene.hpp>
 #include <saturn/ecs/system_manager.hpp>
+#include <saturn/systems/transform_system.hpp>
 
 #include <saturn/meta/reflect.hpp>
 #include <saturn/components/transform.hpp>
@@ -72,13 +74,26 @@ void Engine::run() {
     present_manager.add_color_attachment("color1");
     present_manager.add_depth_attachment("depth1");
 
-    systems.startup(*vulkan_context, demo_scene);
+    systems.startup(vulkan_context, demo_scene);
+    // Runs after all other systems so world transforms include this frame's changes
+    systems::TransformSystem transform_system;
+    transform_system.startup(vulkan_context, demo_scene);
+
+    // The graphs are kept between frames, the scene only updates the parts that changed
+    FramePipeline pipeline(demo_scene, systems, transform_system, frame_settings);
+    for (stl::size_t i = 0; i < FramePipeline::graph_count; ++i) {
+        pipeline.get_graph(i).clear_color = vk::ClearColorValue(std::array<float, 4>{{0, 0, 0, 1}});
+    }
 
     while(window_context->is_open()) { 
+        SATURN_PROFILE_BEGIN_FRAME();
         window_context->poll_events();
         InputEventManager::process_events();
 
-        present_manager.wait_for_available_frame();
+        {
+            SATURN_PROFILE_SCOPE("Wait for frame");
+            present_manager.wait_for_available_frame();
+        }
 
         imgui_renderer.begin_frame();
 
@@ -86,8 +101,8 @@ void Engine::run() {
 
         float delta_time = ImGui::GetIO().DeltaTime;
 
-        FrameContext frame_ctx { vulkan_context, demo_scene, demo_scene.ecs, frame, delta_time };
-        systems.update_all(frame_ctx);
+        FrameContext frame_ctx { vulkan_context, demo_scene, demo_scene.ecs, &frame, delta_time };
+        pipeline.simulate(frame_ctx, delta_time);
 
         auto& color_attachment = present_manager.get_attachment("color1");
         auto& depth_attachment = present_manager.get_attachment("depth1");
@@ -95,20 +110,23 @@ void Engine::run() {
         frame.offscreen_target = 
             ph::RenderTarget(vulkan_context, vulkan_context->default_render_pass, {color_attachment, depth_attachment});
 
-        ph::RenderGraph render_graph;
-        render_graph.clear_color = vk::ClearColorValue(std::array<float, 4>{{0, 0, 0, 1}});
-
-        demo_scene.build_render_graph(frame, render_graph);
+        float const aspect_ratio = (float)color_attachment.get_width() / (float)color_attachment.get_height();
+        ph::RenderGraph& render_graph = pipeline.build_render_graph(aspect_ratio);
 
         // Render the frame
-        renderer.render_frame(frame, render_graph);
-        imgui_renderer.render_frame(frame);
+        {
+            SATURN_PROFILE_SCOPE("Render");
+            renderer.render_frame(frame, render_graph);
+            imgui_renderer.render_frame(frame);
+        }
 
         // Present to swapchain
+        SATURN_PROFILE_SCOPE("Present");
         present_manager.present_frame(frame);
     }
 
     // Wait until the VkDevice is idle before we can start shutting down
+    pipeline.finish();
     vulkan_context->device.waitIdle();
 
     // Serialize to file on exit
@@ -0,0 +1,181 @@
+#include <saturn/core/frame_pipeline.hpp>
+
+#include <saturn/scene/scene.hpp>
+#include <saturn/assets/assets.hpp>
+#include <saturn/utility/profiler.hpp>
+
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace saturn {
+
+SimulationClock::SimulationClock(float tick_rate, stl::uint32_t max_ticks_per_frame) 
+    : tick_delta_time(tick_rate > 0.0f ? 1.0f / tick_rate : 0.0f), max_ticks(std::max(max_ticks_per_frame, 1u)) {
+
+}
+
+stl::uint32_t SimulationClock::advance(float frame_time) {
+    last_frame_time = frame_time;
+    if (!is_fixed()) { return 1; }
+
+    accumulator += frame_time;
+    stl::uint32_t ticks = static_cast<stl::uint32_t>(accumulator / tick_delta_time);
+    if (ticks > max_ticks) {
+        ticks = max_ticks;
+    }
+    accumulator -= static_cast<double>(ticks) * tick_delta_time;
+    // Time that couldn't be simulated because of the tick limit is dropped
+    if (accumulator >= tick_delta_time) {
+        accumulator = std::fmod(accumulator, static_cast<double>(tick_delta_time));
+    }
+    simulated_time += static_cast<double>(ticks) * tick_delta_time;
+    return ticks;
+}
+
+void SimulationClock::on_sync() {
+    previous_synced_time = synced_time;
+    synced_time = simulated_time;
+}
+
+float SimulationClock::get_alpha() const {
+    if (!is_fixed() || synced_time <= previous_synced_time) { return 1.0f; }
+
+    double const frame_time = simulated_time - tick_delta_time + accumulator;
+    double const alpha = (frame_time - previous_synced_time) / (synced_time - previous_synced_time);
+    return static_cast<float>(std::clamp(alpha, 0.0, 1.0));
+}
+
+FramePipeline::FramePipeline(Scene& scene, ecs::system_manager& systems, systems::TransformSystem& transform_system,
+    FrameSettings const& settings) 
+    : scene(scene), systems(systems), transform_system(transform_system), settings(settings), 
+    clock(settings.tick_rate, settings.max_ticks_per_frame) {
+
+    if (settings.pipelined) {
+        worker = std::thread([this]() { worker_main(); });
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    if (!worker.joinable()) { return; }
+
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    wake_worker.notify_one();
+    worker.join();
+}
+
+void FramePipeline::simulate(FrameContext const& ctx, float frame_time) {
+    // Temporaries of the previous frame are dead by now
+    arena.reset();
+
+    // Before the systems, so they see loaded assets and callbacks the same frame. Callbacks get a registry tick of
+    // their own, otherwise their changes would be stamped with the tick that TransformSystem and the render scene
+    // already saw at the end of the last frame, and they would never pick them up.
+    ctx.ecs.advance_tick();
+    Context load_ctx { ctx.vulkan, &ctx.scene };
+    assets::finish_async_loads(load_ctx, settings.asset_load_budget_ms);
+
+    stl::uint32_t const ticks = clock.advance(frame_time);
+    if (!clock.is_fixed()) {
+        // Components changed this frame are stamped with the new tick
+        ctx.ecs.advance_tick();
+
+        FrameContext frame_ctx { ctx.vulkan, ctx.scene, ctx.ecs, ctx.render_info, frame_time, &arena };
+        systems.update_all(frame_ctx);
+        {
+            SATURN_PROFILE_SCOPE("TransformSystem");
+            transform_system.update(frame_ctx);
+        }
+        ++pending_ticks;
+        return;
+    }
+
+    for (stl::uint32_t tick = 0; tick < ticks; ++tick) {
+        SATURN_PROFILE_SCOPE("Simulation tick");
+        ctx.ecs.advance_tick();
+
+        FrameContext tick_ctx { ctx.vulkan, ctx.scene, ctx.ecs, ctx.render_info, clock.get_tick_delta(), &arena };
+        systems.update_tick(tick_ctx);
+        SATURN_PROFILE_SCOPE("TransformSystem");
+        transform_system.update(tick_ctx);
+    }
+    pending_ticks += ticks;
+
+    // Per frame systems get a registry tick of their own, so their changes are synced in frames without ticks too
+    ctx.ecs.advance_tick();
+    FrameContext frame_ctx { ctx.vulkan, ctx.scene, ctx.ecs, ctx.render_info, frame_time, &arena };
+    systems.update_frame(frame_ctx);
+    SATURN_PROFILE_SCOPE("TransformSystem");
+    transform_system.update(frame_ctx);
+}
+
+ph::RenderGraph& FramePipeline::build_render_graph(float aspect_ratio) {
+    // Frames without ticks keep interpolating between the same two states
+    bool new_tick = pending_ticks > 0;
+    if (new_tick) {
+        clock.on_sync();
+    }
+    pending_ticks = 0;
+    float const alpha = settings.interpolate ? clock.get_alpha() : 1.0f;
+
+    if (!settings.pipelined) {
+        scene.sync_render_scene(graphs[front], aspect_ratio, new_tick);
+        scene.prepare_render_graph(graphs[front], alpha);
+        return graphs[front];
+    }
+
+    if (started) {
+        SATURN_PROFILE_SCOPE("Wait for render graph");
+        finish();
+    } else {
+        // Nothing was prepared during the previous frame, so the first graph is prepared right away
+        scene.sync_render_scene(graphs[back], aspect_ratio, new_tick);
+        scene.prepare_render_graph(graphs[back], alpha);
+        new_tick = false;
+        started = true;
+    }
+
+    std::swap(front, back);
+    scene.sync_render_scene(graphs[back], aspect_ratio, new_tick);
+    start_prepare(alpha);
+    return graphs[front];
+}
+
+void FramePipeline::finish() {
+    std::unique_lock lock(mutex);
+    prepare_done.wait(lock, [this]() { return !preparing; });
+}
+
+void FramePipeline::start_prepare(float alpha) {
+    {
+        std::lock_guard lock(mutex);
+        STL_ASSERT(!preparing, "The previous graph is still being prepared");
+        prepare_alpha = alpha;
+        preparing = true;
+    }
+    wake_worker.notify_one();
+}
+
+void FramePipeline::worker_main() {
+    std::unique_lock lock(mutex);
+    while (true) {
+        wake_worker.wait(lock, [this]() { return preparing || stop; });
+        if (!preparing) { return; }
+
+        stl::size_t const graph = back;
+        float const alpha = prepare_alpha;
+        lock.unlock();
+        scene.prepare_render_graph(graphs[graph], alpha);
+        lock.lock();
+
+        preparing = false;
+        prepare_done.notify_all();
+    }
+}
+
+} // namespace saturn
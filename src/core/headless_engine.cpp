@@ -0,0 +1,163 @@
+#include <saturn/core/headless_engine.hpp>
+
+#include <saturn/scene/scene.hpp>
+#include <saturn/assets/assets.hpp>
+#include <saturn/systems/transform_system.hpp>
+#include <saturn/utility/profiler.hpp>
+#include <saturn/utility/allocation_counter.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <string>
+
+namespace saturn {
+
+void NullRenderer::render_frame(ph::RenderGraph const& graph) {
+    draw_count = graph.draw_commands.size();
+    light_count = graph.point_lights.size();
+}
+
+HeadlessEngine::HeadlessEngine(HeadlessSettings const& settings) : settings(settings) {
+
+}
+
+static bool is_texture_path(fs::path const& path) {
+    std::string const extension = path.extension().generic_string();
+    return extension == ".png" || extension == ".jpg" || extension == ".tga";
+}
+
+// Starts an asynchronous load for every asset in paths, and counts the results in stats
+static void start_asset_loads(Context& ctx, stl::vector<fs::path> const& paths, HeadlessStats& stats) {
+    auto count = [&stats](assets::LoadState state) {
+        if (state == assets::LoadState::Ready) {
+            ++stats.assets_loaded;
+        } else {
+            ++stats.assets_failed;
+        }
+    };
+
+    for (fs::path const& root : paths) {
+        stl::vector<fs::path> files;
+        if (fs::is_directory(root)) {
+            for (fs::directory_entry const& entry : fs::recursive_directory_iterator(root)) {
+                fs::path const& path = entry.path();
+                bool const is_asset = path.extension() == ".obj" || path.extension() == ".smesh" 
+                    || is_texture_path(path);
+                if (entry.is_regular_file() && is_asset) {
+                    files.push_back(path);
+                }
+            }
+        } else {
+            files.push_back(root);
+        }
+
+        for (fs::path const& path : files) {
+            if (path.extension() == ".obj") {
+                assets::load_model_async(ctx, path, [count](Handle<assets::Model> handle) {
+                    count(assets::get_load_state(handle));
+                });
+            } else if (is_texture_path(path)) {
+                assets::load_texture_async(ctx, path, [count](Handle<ph::Texture> handle) {
+                    count(assets::get_load_state(handle));
+                });
+            } else {
+                assets::load_mesh_async(ctx, path, [count](Handle<ph::Mesh> handle) {
+                    count(assets::get_load_state(handle));
+                });
+            }
+        }
+    }
+}
+
+HeadlessStats HeadlessEngine::run() {
+    using clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration<double, std::milli>;
+
+    stop_requested.store(false, std::memory_order_relaxed);
+
+    assets::set_asset_cache_directory(settings.asset_cache_path);
+    assets::reset_asset_cache_stats();
+
+    Scene scene;
+    scene.init_headless_scene(settings.ecs_path, settings.blueprints_path);
+
+    systems.startup(nullptr, scene);
+    // Runs after all other systems so world transforms include this frame's changes
+    systems::TransformSystem transform_system;
+    transform_system.startup(nullptr, scene);
+
+    // The graphs are kept between frames, the scene only updates the parts that changed
+    FramePipeline pipeline(scene, systems, transform_system, settings.frame);
+    NullRenderer renderer;
+
+    HeadlessStats stats;
+    stats.min_frame_ms = std::numeric_limits<double>::max();
+    clock::time_point const start = clock::now();
+    clock::time_point last_frame = start;
+
+    Context load_ctx { nullptr, &scene };
+    start_asset_loads(load_ctx, settings.asset_paths, stats);
+    bool loading = assets::get_pending_load_count() > 0;
+    stl::uint64_t steady_allocations = 0;
+
+    while (!stop_requested.load(std::memory_order_relaxed)) {
+        SATURN_PROFILE_BEGIN_FRAME();
+        clock::time_point const frame_start = clock::now();
+        stl::uint64_t const allocations_before = get_heap_allocation_count();
+        float const delta_time = settings.fixed_timestep 
+            ? settings.fixed_delta_time 
+            : std::chrono::duration<float>(frame_start - last_frame).count();
+        last_frame = frame_start;
+
+        FrameContext frame_ctx { nullptr, scene, scene.ecs, nullptr, delta_time };
+        pipeline.simulate(frame_ctx, delta_time);
+
+        renderer.render_frame(pipeline.build_render_graph(settings.aspect_ratio));
+
+        clock::time_point const frame_end = clock::now();
+        double const frame_ms = milliseconds(frame_end - frame_start).count();
+        stats.min_frame_ms = std::min(stats.min_frame_ms, frame_ms);
+        stats.max_frame_ms = std::max(stats.max_frame_ms, frame_ms);
+        if (stats.frames > 0) {
+            stl::uint64_t const allocations = get_heap_allocation_count() - allocations_before;
+            steady_allocations += allocations;
+            stats.max_frame_allocations = std::max(stats.max_frame_allocations, allocations);
+        }
+        ++stats.frames;
+
+        stats.total_seconds = std::chrono::duration<double>(frame_end - start).count();
+        if (loading && assets::get_pending_load_count() == 0) {
+            stats.asset_load_seconds = stats.total_seconds;
+            loading = false;
+        }
+        if (settings.max_frames != 0 && stats.frames >= settings.max_frames) { break; }
+        if (settings.max_seconds > 0.0 && stats.total_seconds >= settings.max_seconds) { break; }
+    }
+
+    if (stats.frames == 0) {
+        stats.min_frame_ms = 0.0;
+    } else {
+        stats.average_frame_ms = stats.total_seconds * 1000.0 / stats.frames;
+    }
+    if (stats.frames > 1) {
+        stats.average_frame_allocations = static_cast<double>(steady_allocations) / (stats.frames - 1);
+    }
+    pipeline.finish();
+    if (loading) {
+        assets::wait_for_async_loads(load_ctx);
+        stats.asset_load_seconds = std::chrono::duration<double>(clock::now() - start).count();
+    }
+    stats.draws = renderer.get_draw_count();
+    stats.lights = renderer.get_light_count();
+    stats.asset_cache = assets::get_asset_cache_stats();
+
+    if (!settings.trace_path.empty()) {
+        Profiler::get().write_chrome_trace(settings.trace_path);
+    }
+
+    // Nothing was uploaded to a GPU, so unlike Engine there are no assets to destroy
+    return stats;
+}
+
+} // namespace saturn
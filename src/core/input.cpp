@@ -1,4 +1,5 @@
 #include <saturn/core/input.hpp>
+#include <saturn/utility/profiler.hpp>
 
 #include <phobos/core/window_context.hpp>
 
@@ -299,6 +300,7 @@ void InputEventManager::mouse_button_callback(Mimas_Window* win, Mimas_Key butto
 }
 
 void InputEventManager::process_events() {
+    SATURN_PROFILE_SCOPE("Input");
     process_keyboard_events();
     process_mouse_events();
  //   JoystickInputManager::update_key_data();
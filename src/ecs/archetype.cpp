@@ -0,0 +1,113 @@
+#include <saturn/ecs/archetype.hpp>
+
+#include <stl/assert.hpp>
+#include <stl/utility.hpp>
+
+namespace saturn::ecs {
+
+static stl::size_t align_up(stl::size_t value, stl::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+archetype::archetype(stl::vector<component_type_info const*> types) : types(stl::move(types)) {
+    compute_layout();
+}
+
+archetype::~archetype() {
+    for (stl::uint32_t row = 0; row < row_count; ++row) {
+        for (stl::uint32_t column = 0; column < types.size(); ++column) {
+            types[column]->destroy(component_at(column, row));
+        }
+    }
+
+    for (std::byte* chunk : chunks) {
+        ::operator delete(chunk, std::align_val_t{column_alignment});
+    }
+}
+
+stl::uint32_t archetype::column_of(stl::uint64_t type_id) const {
+    // Archetypes rarely have more than a handful of types, a linear search beats anything fancier here
+    for (stl::uint32_t i = 0; i < types.size(); ++i) {
+        if (types[i]->id == type_id) { return i; }
+    }
+    return npos;
+}
+
+stl::uint32_t archetype::allocate_row(entity_t entity) {
+    if (row_count == chunks.size() * chunk_capacity) {
+        void* memory = ::operator new(bytes_per_chunk, std::align_val_t{column_alignment});
+        chunks.push_back(static_cast<std::byte*>(memory));
+    }
+
+    stl::uint32_t const row = row_count++;
+    chunk_entities(row / chunk_capacity)[row % chunk_capacity] = entity;
+    return row;
+}
+
+entity_t archetype::remove_row(stl::uint32_t row) {
+    for (stl::uint32_t column = 0; column < types.size(); ++column) {
+        types[column]->destroy(component_at(column, row));
+    }
+    return remove_moved_row(row);
+}
+
+entity_t archetype::remove_moved_row(stl::uint32_t row) {
+    STL_ASSERT(row < row_count, "Row out of range");
+    stl::uint32_t const last = row_count - 1;
+    entity_t moved = entity_at(row);
+
+    if (row != last) {
+        // Fill the hole with the last row so the chunks stay packed
+        for (stl::uint32_t column = 0; column < types.size(); ++column) {
+            types[column]->relocate(component_at(column, row), component_at(column, last));
+        }
+        moved = entity_at(last);
+        chunk_entities(row / chunk_capacity)[row % chunk_capacity] = moved;
+    }
+
+    --row_count;
+    // Release the last chunk once it's empty
+    if (row_count == (chunks.size() - 1) * chunk_capacity) {
+        ::operator delete(chunks.back(), std::align_val_t{column_alignment});
+        chunks.pop_back();
+    }
+
+    return moved;
+}
+
+void archetype::compute_layout() {
+    stl::size_t row_bytes = sizeof(entity_t);
+    for (component_type_info const* type : types) {
+        row_bytes += type->size;
+    }
+
+    column_offsets.resize(types.size());
+    // Start with an upper bound and shrink until the padding between columns fits as well
+    stl::size_t capacity = chunk_bytes / row_bytes;
+    while (capacity > 0) {
+        stl::size_t offset = capacity * sizeof(entity_t);
+        for (stl::size_t i = 0; i < types.size(); ++i) {
+            offset = align_up(offset, column_alignment);
+            column_offsets[i] = offset;
+            offset += capacity * types[i]->size;
+        }
+        if (offset <= chunk_bytes) { break; }
+        --capacity;
+    }
+
+    // Components larger than a chunk get a chunk holding a single row
+    if (capacity == 0) {
+        capacity = 1;
+        stl::size_t offset = sizeof(entity_t);
+        for (stl::size_t i = 0; i < types.size(); ++i) {
+            offset = align_up(offset, column_alignment);
+            column_offsets[i] = offset;
+            offset += types[i]->size;
+        }
+        bytes_per_chunk = align_up(offset, column_alignment);
+    }
+
+    chunk_capacity = static_cast<stl::uint32_t>(capacity);
+}
+
+} // namespace saturn::ecs
@@ -0,0 +1,109 @@
+#include <saturn/ecs/archetype_backend.hpp>
+
+#include <stl/utility.hpp>
+
+namespace saturn::ecs {
+
+archetype_backend::archetype_backend() {
+    archetypes.push_back(stl::make_unique<archetype>(stl::vector<component_type_info const*>{}));
+}
+
+void archetype_backend::remove_all(entity_t entity) {
+    location* loc = find_location(entity);
+    if (!loc) { return; }
+
+    entity_t const moved = loc->table->remove_row(loc->row);
+    if (moved != entity) {
+        locations[entity_index(moved)].row = loc->row;
+    }
+    *loc = location{};
+}
+
+archetype_backend::location& archetype_backend::get_location(entity_t entity) {
+    if (location* loc = find_location(entity)) {
+        return *loc;
+    }
+
+    stl::uint32_t const index = entity_index(entity);
+    if (index >= locations.size()) {
+        locations.resize(index + 1);
+    }
+
+    location& loc = locations[index];
+    loc.entity = entity;
+    loc.table = archetypes[0].get();
+    loc.row = loc.table->allocate_row(entity);
+    return loc;
+}
+
+archetype* archetype_backend::find_add_target(archetype* source, component_type_info const* type) {
+    auto edge = source->add_edges.find(type->id);
+    if (edge != source->add_edges.end()) {
+        return edge->second;
+    }
+
+    stl::vector<component_type_info const*> types = source->get_types();
+    types.push_back(type);
+    std::sort(types.begin(), types.end(), [](component_type_info const* lhs, component_type_info const* rhs) {
+        return lhs->id < rhs->id;
+    });
+
+    archetype* target = find_or_create_archetype(stl::move(types));
+    source->add_edges[type->id] = target;
+    target->remove_edges[type->id] = source;
+    return target;
+}
+
+archetype* archetype_backend::find_remove_target(archetype* source, stl::uint64_t type_id) {
+    auto edge = source->remove_edges.find(type_id);
+    if (edge != source->remove_edges.end()) {
+        return edge->second;
+    }
+
+    stl::vector<component_type_info const*> types;
+    for (component_type_info const* type : source->get_types()) {
+        if (type->id != type_id) {
+            types.push_back(type);
+        }
+    }
+
+    archetype* target = find_or_create_archetype(stl::move(types));
+    source->remove_edges[type_id] = target;
+    target->add_edges[type_id] = source;
+    return target;
+}
+
+archetype* archetype_backend::find_or_create_archetype(stl::vector<component_type_info const*> types) {
+    // Only hit when an edge is missing, which stops happening once the set of archetypes is stable
+    for (auto& table : archetypes) {
+        if (table->get_types() == types) {
+            return table.get();
+        }
+    }
+
+    archetypes.push_back(stl::make_unique<archetype>(stl::move(types)));
+    return archetypes.back().get();
+}
+
+stl::uint32_t archetype_backend::move_entity(entity_t entity, location& loc, archetype* target) {
+    archetype* source = loc.table;
+    stl::uint32_t const new_row = target->allocate_row(entity);
+
+    auto const& target_types = target->get_types();
+    for (stl::uint32_t column = 0; column < target_types.size(); ++column) {
+        stl::uint32_t const source_column = source->column_of(target_types[column]->id);
+        if (source_column == archetype::npos) { continue; }
+        target_types[column]->relocate(target->component_at(column, new_row), source->component_at(source_column, loc.row));
+    }
+
+    entity_t const moved = source->remove_moved_row(loc.row);
+    if (moved != entity) {
+        locations[entity_index(moved)].row = loc.row;
+    }
+
+    loc.table = target;
+    loc.row = new_row;
+    return new_row;
+}
+
+} // namespace saturn::ecs
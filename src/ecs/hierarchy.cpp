@@ -0,0 +1,144 @@
+#include <saturn/ecs/hierarchy.hpp>
+
+namespace saturn::ecs {
+
+void hierarchy::insert(entity_t entity, entity_t parent) {
+    stl::uint32_t const index = entity_index(entity);
+    if (index >= nodes.size()) {
+        nodes.resize(index + 1);
+    }
+    STL_ASSERT(nodes[index].self == null_entity, "Entity index is already in the hierarchy");
+    nodes[index] = links{};
+    nodes[index].self = entity;
+
+    if (root_entity == null_entity) {
+        root_entity = entity;
+    } else {
+        link(entity, parent);
+    }
+    depth_order_dirty = true;
+}
+
+void hierarchy::erase(entity_t entity) {
+    if (entity == root_entity) {
+        // Everything is a descendant of the root
+        nodes.clear();
+        root_entity = null_entity;
+        depth_order_dirty = true;
+        return;
+    }
+
+    unlink(entity);
+
+    // The subtree is detached now, so clearing the links while walking it is safe as long as
+    // we read the links of a node before clearing it.
+    entity_t current = entity;
+    while (current != null_entity) {
+        links& current_node = node(current);
+        if (current_node.first_child != null_entity) {
+            entity_t const child = current_node.first_child;
+            current_node.first_child = null_entity;
+            current = child;
+            continue;
+        }
+
+        // Leaf, remove it and continue with its sibling or parent
+        entity_t const next = current_node.next_sibling;
+        entity_t const up = current_node.parent;
+        current_node = links{};
+        current = current == entity ? null_entity : (next != null_entity ? next : up);
+    }
+    depth_order_dirty = true;
+}
+
+void hierarchy::reparent(entity_t entity, entity_t new_parent) {
+    STL_ASSERT(entity != root_entity, "Cannot reparent the root entity");
+    STL_ASSERT(!is_ancestor_of(entity, new_parent), "Cannot make an entity a child of its own descendant");
+    unlink(entity);
+    link(entity, new_parent);
+    depth_order_dirty = true;
+}
+
+bool hierarchy::is_ancestor_of(entity_t ancestor, entity_t entity) const {
+    for (entity_t current = entity; current != null_entity; current = parent(current)) {
+        if (current == ancestor) { return true; }
+    }
+    return false;
+}
+
+Span<entity_t const> hierarchy::depth_sorted() const {
+    if (depth_order_dirty) { rebuild_depth_order(); }
+    return Span<entity_t const>(depth_order.data(), depth_order.size());
+}
+
+stl::size_t hierarchy::depth_count() const {
+    if (depth_order_dirty) { rebuild_depth_order(); }
+    return level_offsets.empty() ? 0 : level_offsets.size() - 1;
+}
+
+Span<entity_t const> hierarchy::depth_level(stl::size_t depth) const {
+    if (depth_order_dirty) { rebuild_depth_order(); }
+    STL_ASSERT(depth + 1 < level_offsets.size(), "Depth level out of range");
+    stl::size_t const begin = level_offsets[depth];
+    return Span<entity_t const>(depth_order.data() + begin, level_offsets[depth + 1] - begin);
+}
+
+void hierarchy::link(entity_t entity, entity_t parent) {
+    links& parent_node = node(parent);
+    links& entity_node = node(entity);
+    entity_node.parent = parent;
+    entity_node.prev_sibling = parent_node.last_child;
+    entity_node.next_sibling = null_entity;
+
+    if (parent_node.last_child != null_entity) {
+        node(parent_node.last_child).next_sibling = entity;
+    } else {
+        parent_node.first_child = entity;
+    }
+    parent_node.last_child = entity;
+}
+
+void hierarchy::unlink(entity_t entity) {
+    links& entity_node = node(entity);
+    links& parent_node = node(entity_node.parent);
+
+    if (entity_node.prev_sibling != null_entity) {
+        node(entity_node.prev_sibling).next_sibling = entity_node.next_sibling;
+    } else {
+        parent_node.first_child = entity_node.next_sibling;
+    }
+
+    if (entity_node.next_sibling != null_entity) {
+        node(entity_node.next_sibling).prev_sibling = entity_node.prev_sibling;
+    } else {
+        parent_node.last_child = entity_node.prev_sibling;
+    }
+
+    entity_node.parent = null_entity;
+    entity_node.prev_sibling = null_entity;
+    entity_node.next_sibling = null_entity;
+}
+
+void hierarchy::rebuild_depth_order() const {
+    depth_order.clear();
+    level_offsets.clear();
+    depth_order_dirty = false;
+    if (root_entity == null_entity) { return; }
+
+    // The output array doubles as the BFS queue: level d + 1 is the children of level d, in order.
+    depth_order.push_back(root_entity);
+    level_offsets.push_back(0);
+    stl::size_t level_begin = 0;
+    while (level_begin < depth_order.size()) {
+        stl::size_t const level_end = depth_order.size();
+        level_offsets.push_back(level_end);
+        for (stl::size_t i = level_begin; i < level_end; ++i) {
+            for (entity_t child = first_child(depth_order[i]); child != null_entity; child = next_sibling(child)) {
+                depth_order.push_back(child);
+            }
+        }
+        level_begin = level_end;
+    }
+}
+
+} // namespace saturn::ecs
@@ -6,11 +6,10 @@
 
 #include <saturn/components/blueprint.hpp>
 #include <saturn/components/blueprint_instance.hpp>
+#include <saturn/components/transform.hpp>
 
 #include <fstream>
 
-#include <stl/tuple.hpp>
-
 namespace saturn::ecs {
 
 namespace {
@@ -29,17 +28,54 @@ struct component_copy {
 
 }
 
+// Tells the observers of every component the entity has that it is about to be removed
+template<typename C>
+struct notify_remove_all {
+    void operator()(registry& ecs, entity_t entity) {
+        stl::uint64_t const type_id = get_component_type_id<C>();
+        if (!ecs.observers[type_id].empty() && ecs.backend.has<C>(entity)) {
+            ecs.notify_remove(type_id, entity);
+        }
+    }
+};
+
 registry::registry() {
 
 }
 
 entity_t registry::create_entity(entity_t parent) {
     entity_t id = id_generator.next();
-    auto parent_it = entities.find(parent);
-    entities.insert(parent_it, id);
+    entities.insert(id, parent);
     return id;
 }
 
+void registry::destroy_entity(entity_t entity) {
+    SATURN_ECS_CHECK_ENTITY(entity);
+    STL_ASSERT(entity != 0, "Cannot destroy the root entity");
+
+    entities.traverse(entity, [this](entity_t destroyed) {
+        meta::for_each_component<notify_remove_all>(*this, destroyed);
+        backend.remove_all(destroyed);
+        id_generator.release(destroyed);
+    });
+
+    entities.erase(entity);
+}
+
+void registry::set_parent(entity_t entity, entity_t parent) {
+    SATURN_ECS_CHECK_ENTITY(entity);
+    SATURN_ECS_CHECK_ENTITY(parent);
+    entities.reparent(entity, parent);
+    // The world transform depends on the parent, so the moved subtree has to be recomputed
+    if (backend.has<components::Transform>(entity)) {
+        backend.mark_changed<components::Transform>(entity, tick);
+    }
+}
+
+bool registry::is_alive(entity_t entity) const {
+    return id_generator.is_alive(entity);
+}
+
 entity_t registry::create_blueprint_entity(entity_t parent) {
     entity_t entity = create_entity(parent);
     add_component<components::Blueprint>(entity, entity);
@@ -47,26 +83,27 @@ entity_t registry::create_blueprint_entity(entity_t parent) {
 }
 
 entity_t registry::import_blueprint(registry& source, entity_t other) {
-    auto copy_fun = [this, &source](entity_t src_entity, stl::tree<entity_t>::const_traverse_info info, entity_t parent) 
-        -> stl::tuple<entity_t> {
-        
-        auto id = create_entity(parent);
+    // Copies of the entities on the path from [other] to the entity being copied
+    stl::vector<entity_t> parents;
+    entity_t imported_root = null_entity;
+
+    auto copy_fun = [this, &source, &parents, &imported_root](entity_t src_entity) {
+        auto id = create_entity(parents.empty() ? 0 : parents.back());
         // do the copy
         meta::for_each_component<component_copy>(source, *this, src_entity, id);
         // Add a blueprint instance component referring to the old entity (= the blueprint)
         add_component<components::BlueprintInstance>(id, src_entity);
 
-        return { id };
+        if (imported_root == null_entity) { imported_root = id; }
+        parents.push_back(id);
     };
 
-    auto entity_it = source.get_entities().find(other);
-    source.get_entities().traverse_from(entity_it, copy_fun, 0);
+    source.get_hierarchy().traverse(other, copy_fun, [&parents](entity_t) { parents.pop_back(); });
 
-    // Return the latest created child of the root entity, aka the root of the entity that was just created
-    return entities.root()->children.back().data;
+    return imported_root;
 }
 
-stl::tree<entity_t> const& registry::get_entities() const {
+hierarchy const& registry::get_hierarchy() const {
     return entities;
 }
 
@@ -0,0 +1,22 @@
+#include <saturn/ecs/sparse_set_backend.hpp>
+
+#include <saturn/meta/for_each_component.hpp>
+
+namespace saturn::ecs {
+
+namespace {
+
+template<typename C>
+struct create_storage {
+    void operator()(std::array<stl::unique_ptr<component_storage_base>, component_type_count>& storages) {
+        storages[get_component_type_id<C>()] = stl::make_unique<component_storage<C>>();
+    }
+};
+
+}
+
+sparse_set_backend::sparse_set_backend() {
+    meta::for_each_component<create_storage>(storages);
+}
+
+} // namespace saturn::ecs
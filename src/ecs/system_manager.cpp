@@ -1,17 +1,297 @@
 #include <saturn/ecs/system_manager.hpp>
 
+#include <saturn/utility/profiler.hpp>
+
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __GNUG__
+    #include <cxxabi.h>
+    #include <cstdlib>
+#endif
+
 namespace saturn::ecs {
 
-void system_manager::startup(ph::VulkanContext& ctx, Scene& scene) {
-    for (auto& sys : systems) {
-        sys->startup(ctx, scene);
+system_access const*& current_system_access() {
+    static thread_local system_access const* access = nullptr;
+    return access;
+}
+
+namespace {
+
+bool contains_type(stl::vector<std::type_index> const& types, std::type_index type) {
+    return std::find(types.begin(), types.end(), type) != types.end();
+}
+
+char const* system_name(std::type_index type) {
+    std::string name = type.name();
+#ifdef __GNUG__
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        name = demangled;
+    }
+    std::free(demangled);
+#endif
+    return Profiler::get().intern(name);
+}
+
+}
+
+// Per-frame bookkeeping for run_parallel. The arrays come from the frame arena when there is one.
+struct system_manager::frame_state {
+    frame_state(system_manager& manager, saturn::FrameContext& ctx, system_filter filter, ThreadPool& pool, 
+        stl::size_t system_count) : manager(manager), ctx(ctx), filter(filter), pool(pool) {
+
+        if (ctx.arena) {
+            remaining = ctx.arena->allocate_array<std::atomic<stl::size_t>>(system_count).data();
+            main_thread_queue = ctx.arena->allocate_array<stl::size_t>(system_count).data();
+        } else {
+            owned_remaining = std::make_unique<std::atomic<stl::size_t>[]>(system_count);
+            owned_queue = std::make_unique<stl::size_t[]>(system_count);
+            remaining = owned_remaining.get();
+            main_thread_queue = owned_queue.get();
+        }
+    }
+
+    system_manager& manager;
+    saturn::FrameContext& ctx;
+    system_filter filter;
+    ThreadPool& pool;
+    WaitGroup tasks;
+    // Number of unfinished dependencies of each system
+    std::atomic<stl::size_t>* remaining;
+    std::atomic<stl::size_t> finished = 0;
+
+    // Systems that are ready to run but have to run on the main thread. Every system is queued at most
+    // once per update, so this never holds more than the system count.
+    std::mutex main_thread_mutex;
+    stl::size_t* main_thread_queue;
+    stl::size_t queue_begin = 0;
+    stl::size_t queue_end = 0;
+
+    std::unique_ptr<std::atomic<stl::size_t>[]> owned_remaining;
+    std::unique_ptr<stl::size_t[]> owned_queue;
+};
+
+void system_manager::startup(ph::VulkanContext* ctx, Scene& scene) {
+    for (auto& node : systems) {
+        node.system->startup(ctx, scene);
     }
 }
 
 void system_manager::update_all(saturn::FrameContext& ctx) {
-    for (auto& sys : systems) {
-        sys->update(ctx);
+    SATURN_PROFILE_SCOPE("Systems");
+    update(ctx, system_filter::all);
+}
+
+void system_manager::update_tick(saturn::FrameContext& ctx) {
+    SATURN_PROFILE_SCOPE("Tick systems");
+    update(ctx, system_filter::tick);
+}
+
+void system_manager::update_frame(saturn::FrameContext& ctx) {
+    SATURN_PROFILE_SCOPE("Frame systems");
+    update(ctx, system_filter::frame);
+}
+
+bool system_manager::matches(system_node const& node, system_filter filter) {
+    switch (filter) {
+    case system_filter::tick: return !node.access.per_frame;
+    case system_filter::frame: return node.access.per_frame;
+    default: return true;
+    }
+}
+
+void system_manager::update(saturn::FrameContext& ctx, system_filter filter) {
+    if (graph_dirty) {
+        build_graph();
+    }
+
+    ThreadPool& pool = ThreadPool::get_default();
+    if (!parallel || pool.is_deterministic() || pool.thread_count() <= 1) {
+        run_sequential(ctx, filter);
+    } else {
+        run_parallel(ctx, filter);
+    }
+}
+
+void system_manager::set_parallel(bool parallel) {
+    this->parallel = parallel;
+}
+
+void system_manager::build_graph() {
+    for (auto& node : systems) {
+        node.access = system_access{};
+        node.system->declare_access(node.access);
+        if (!node.name) {
+            node.name = system_name(node.type);
+        }
+        node.successors.clear();
+        node.dependency_count = 0;
     }
+
+    auto add_edge = [this](stl::size_t from, stl::size_t to) {
+        systems[from].successors.push_back(to);
+        ++systems[to].dependency_count;
+    };
+
+    // Whether an explicit constraint makes system first run before system second
+    auto constrained_before = [this](stl::size_t first, stl::size_t second) {
+        return contains_type(systems[second].access.after, systems[first].type) 
+            || contains_type(systems[first].access.before, systems[second].type);
+    };
+
+    for (stl::size_t i = 0; i < systems.size(); ++i) {
+        for (stl::size_t j = i + 1; j < systems.size(); ++j) {
+            bool const forward = constrained_before(i, j);
+            bool const backward = constrained_before(j, i);
+            if (forward && backward) {
+                throw std::runtime_error(std::string("Systems ") + systems[i].name + " and " + systems[j].name 
+                    + " are constrained to run before each other");
+            }
+            if (forward) {
+                add_edge(i, j);
+            } else if (backward) {
+                add_edge(j, i);
+            }
+        }
+    }
+
+    // Kahn's algorithm over the explicit constraints. Ties are broken by registration order, so the sequential
+    // order matches the old behaviour when no constraints are declared.
+    execution_order.clear();
+    stl::vector<stl::size_t> remaining(systems.size());
+    for (stl::size_t i = 0; i < systems.size(); ++i) {
+        remaining[i] = systems[i].dependency_count;
+    }
+
+    stl::vector<bool> done(systems.size(), false);
+    while (execution_order.size() < systems.size()) {
+        stl::size_t next = systems.size();
+        for (stl::size_t i = 0; i < systems.size(); ++i) {
+            if (!done[i] && remaining[i] == 0) {
+                next = i;
+                break;
+            }
+        }
+
+        // A shorter order would leave run_parallel waiting forever for the systems that are missing
+        if (next == systems.size()) {
+            std::string message = "System ordering constraints contain a cycle between";
+            for (stl::size_t i = 0; i < systems.size(); ++i) {
+                if (!done[i]) { message += std::string(" ") + systems[i].name; }
+            }
+            throw std::runtime_error(message);
+        }
+
+        done[next] = true;
+        execution_order.push_back(next);
+        for (stl::size_t successor : systems[next].successors) {
+            --remaining[successor];
+        }
+    }
+
+    // Conflicting systems without a constraint between them run in the order found above, which is registration
+    // order where the constraints allow it. Every edge then points forward in execution_order, so these edges can't
+    // close a cycle together with the constraints.
+    stl::vector<stl::size_t> position(systems.size());
+    for (stl::size_t i = 0; i < execution_order.size(); ++i) {
+        position[execution_order[i]] = i;
+    }
+    for (stl::size_t i = 0; i < systems.size(); ++i) {
+        for (stl::size_t j = i + 1; j < systems.size(); ++j) {
+            if (constrained_before(i, j) || constrained_before(j, i)) { continue; }
+            if (systems[i].access.conflicts_with(systems[j].access)) {
+                if (position[i] < position[j]) {
+                    add_edge(i, j);
+                } else {
+                    add_edge(j, i);
+                }
+            }
+        }
+    }
+
+    graph_dirty = false;
+}
+
+void system_manager::run_sequential(saturn::FrameContext& ctx, system_filter filter) {
+    for (stl::size_t index : execution_order) {
+        system_node& node = systems[index];
+        if (!matches(node, filter)) { continue; }
+        system_access_scope scope(&node.access);
+        SATURN_PROFILE_SCOPE(node.name);
+        node.system->update(ctx);
+    }
+}
+
+void system_manager::run_parallel(saturn::FrameContext& ctx, system_filter filter) {
+    frame_state state(*this, ctx, filter, ThreadPool::get_default(), systems.size());
+    for (stl::size_t i = 0; i < systems.size(); ++i) {
+        state.remaining[i].store(systems[i].dependency_count, std::memory_order_relaxed);
+    }
+
+    for (stl::size_t i = 0; i < systems.size(); ++i) {
+        if (systems[i].dependency_count == 0) {
+            schedule(state, i);
+        }
+    }
+
+    // The calling thread runs exclusive and main thread systems, and helps out with pool tasks otherwise.
+    while (state.finished.load(std::memory_order_acquire) < systems.size()) {
+        stl::size_t index = systems.size();
+        {
+            std::lock_guard lock(state.main_thread_mutex);
+            if (state.queue_begin != state.queue_end) {
+                index = state.main_thread_queue[state.queue_begin++];
+            }
+        }
+
+        if (index != systems.size()) {
+            run_system(state, index);
+        } else if (!state.pool.run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+
+    state.pool.wait(state.tasks);
+}
+
+void system_manager::schedule(frame_state& state, stl::size_t index) {
+    system_access const& access = systems[index].access;
+    if (access.exclusive || access.main_thread) {
+        std::lock_guard lock(state.main_thread_mutex);
+        state.main_thread_queue[state.queue_end++] = index;
+        return;
+    }
+
+    // Small enough for the inline storage of std::function, so scheduling a system doesn't allocate
+    state.pool.submit(state.tasks, [&state, index] {
+        state.manager.run_system(state, index);
+    });
 }
 
-}
\ No newline at end of file
+void system_manager::run_system(frame_state& state, stl::size_t index) {
+    system_node& node = systems[index];
+    // Systems that are filtered out still release their successors
+    if (matches(node, state.filter)) {
+        system_access_scope scope(&node.access);
+        SATURN_PROFILE_SCOPE(node.name);
+        node.system->update(state.ctx);
+    }
+
+    for (stl::size_t successor : node.successors) {
+        if (state.remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(state, successor);
+        }
+    }
+    state.finished.fetch_add(1, std::memory_order_release);
+}
+
+}
@@ -54,20 +54,34 @@ static void do_movement(saturn::FrameContext& ctx, Transform& transform, Camera&
     transform.position -= horizontal * speed * right;
 }
 
-void CameraSystem::startup(ph::VulkanContext&, saturn::Scene& scene) {
+void CameraSystem::startup(ph::VulkanContext*, saturn::Scene& scene) {
     // Add the editor camera controller to the main scene camera. This is no longer needed since it's embedded in the scene's json
 //    scene.ecs.add_component<EditorCamera>(scene.main_camera);
 }
 
+void CameraSystem::declare_access(saturn::ecs::system_access& access) {
+    access.write<Transform, Camera>();
+    access.read<EditorCamera>();
+}
+
 void CameraSystem::update(saturn::FrameContext& ctx) {
-    for (auto[transform, camera, controller] : ctx.scene.ecs.view<Transform, Camera, EditorCamera>()) {
-        if (saturn::RawInput::get_mouse_button(saturn::MouseButton::Right).down) {
+    auto cameras = ctx.scene.ecs.view<Transform, Camera, EditorCamera>();
+    for (auto it = cameras.begin(); it != cameras.end(); ++it) {
+        auto[transform, camera, controller] = *it;
+        bool const freelook = saturn::RawInput::get_mouse_button(saturn::MouseButton::Right).down;
+        bool const movement = saturn::RawInput::get_mouse_button(saturn::MouseButton::Middle).down;
+
+        if (freelook) {
             do_freelook(ctx, transform, camera, controller);
         }
 
-        if (saturn::RawInput::get_mouse_button(saturn::MouseButton::Middle).down) {
+        if (movement) {
             do_movement(ctx, transform, camera, controller);
         }
+
+        if (freelook || movement) {
+            ctx.scene.ecs.mark_changed<Transform>(it.get_entity());
+        }
     }
 }
 
@@ -3,12 +3,15 @@
 
 #include <phobos/util/cmdbuf_util.hpp>
 
+#include <stl/assert.hpp>
+
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_vulkan.h>
 
 #include <editor/widgets/entity_tree.hpp>
 #include <editor/widgets/file_dialog.hpp>
 #include <editor/widgets/main_menu_bar.hpp>
+#include <editor/widgets/profiler_widget.hpp>
 
 
 namespace editor {
@@ -17,21 +20,31 @@ EditorSystem::EditorSystem(LogWindow* log_window) : log_window(log_window) {
 
 }
 
-void EditorSystem::startup(ph::VulkanContext& ctx, saturn::Scene& scene) {
+void EditorSystem::startup(ph::VulkanContext* ctx, saturn::Scene& scene) {
+    STL_ASSERT(ctx, "The editor needs a Vulkan context");
     ImGuiIO io = ImGui::GetIO();
     editor_font = io.Fonts->AddFontFromFileTTF("data/fonts/heebo/Heebo-Regular.ttf", 16.0f);
 
     // Upload font textures
-    vk::CommandBuffer cmd_buf = ph::begin_single_time_command_buffer(ctx);
+    vk::CommandBuffer cmd_buf = ph::begin_single_time_command_buffer(*ctx);
     
     ImGui_ImplVulkan_CreateFontsTexture(cmd_buf);
 
-    ph::end_single_time_command_buffer(ctx, cmd_buf);
-    ctx.device.waitIdle();
+    ph::end_single_time_command_buffer(*ctx, cmd_buf);
+    ctx->device.waitIdle();
     ImGui_ImplVulkan_DestroyFontUploadObjects();
 
     scene_tree = stl::make_unique<EntityTree>("Scene Tree", scene.ecs);
     blueprints_tree = stl::make_unique<EntityTree>("Blueprints", scene.blueprints);
+
+    widgets.push_back(stl::make_unique<ProfilerWidget>());
+}
+
+void EditorSystem::declare_access(saturn::ecs::system_access& access) {
+    // The editor can touch any component, so it stays exclusive. It draws with ImGui, which needs
+    // exactly one update per frame.
+    access.main_thread_only();
+    access.once_per_frame();
 }
 
 void EditorSystem::update(saturn::FrameContext& ctx) {
@@ -64,8 +77,8 @@ void EditorSystem::update(saturn::FrameContext& ctx) {
 
     static bool show_scene = true;
     if (ImGui::Begin("Scene", &show_scene, ImGuiWindowFlags_HorizontalScrollbar)) {
-        auto& img = ctx.render_info.present_manager->get_attachment("color1");
-        auto& depth = ctx.render_info.present_manager->get_attachment("depth1");
+        auto& img = ctx.render_info->present_manager->get_attachment("color1");
+        auto& depth = ctx.render_info->present_manager->get_attachment("depth1");
         auto const size = ImGui::GetContentRegionAvail();
         img.resize(size.x, size.y);
         depth.resize(size.x, size.y);
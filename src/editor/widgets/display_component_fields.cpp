@@ -47,6 +47,10 @@ void display_component_fields(saturn::components::Transform& component) {
     dispatcher("rotation##Transform", &component.rotation);
     dispatcher("scale##Transform", &component.scale);
 }
+void display_component_fields(saturn::components::WorldTransform& component) {
+    display_field dispatcher;
+    dispatcher("matrix##WorldTransform", &component.matrix);
+}
 void display_component_fields(saturn::components::Rotator& component) {
     display_field dispatcher;
     dispatcher("speed##Rotator", &component.speed);
@@ -22,6 +22,15 @@ void display_field::operator()(std::string_view name, saturn::color3* value) {
     ImGui::ColorEdit3(name.data(), &value->r);
 }
 
+// Matrices are derived data, so they are displayed read-only
+void display_field::operator()(std::string_view name, glm::mat4* value) {
+    ImGui::TextUnformatted(fmt::format("{}:", remove_component_tag(name)).c_str());
+    glm::mat4 const& m = *value;
+    for (int row = 0; row < 4; ++row) {
+        ImGui::Text("%8.3f %8.3f %8.3f %8.3f", m[0][row], m[1][row], m[2][row], m[3][row]);
+    }
+}
+
 void display_field::operator()(std::string_view name, saturn::ecs::entity_t* value) {
     // ignore
 }
@@ -2,12 +2,11 @@
 
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
-#include <unordered_map>
-
-#include <stl/tuple.hpp>
 
 #include <saturn/components/name.hpp>
 
+#include <stl/vector.hpp>
+
 using namespace saturn::components;
 
 namespace editor {
@@ -16,63 +15,41 @@ EntityTree::EntityTree(const char* name, saturn::ecs::registry& ecs) : name(name
 
 }
 
-using expanded_map_t = std::unordered_map<saturn::ecs::entity_t, bool>;
-
-static stl::tuple<saturn::ecs::registry*, expanded_map_t*, saturn::ecs::entity_t*, EntityDragDropData*> display_tree(
-    saturn::ecs::entity_t entity, stl::tree<saturn::ecs::entity_t>::const_traverse_info info, 
-    saturn::ecs::registry* ecs, expanded_map_t* expanded, saturn::ecs::entity_t* selected_entity, EntityDragDropData* payload) {
-
-    // Skip root entity
-    if (entity == 0) { return stl::make_tuple(ecs, expanded, selected_entity, payload); }
-
-    // If the parent was not expanded, skip this entity
-    if (info.parent.leaf() != nullptr && (*expanded)[info.parent->data] == false) {
-        return stl::make_tuple(ecs, expanded, selected_entity, payload);
-    }
+// Displays a single entity. Returns true if its children should be displayed as well.
+static bool display_entity(saturn::ecs::registry& ecs, saturn::ecs::entity_t entity, 
+    saturn::ecs::entity_t& selected_entity, EntityDragDropData& payload) {
 
     // display this entity
     std::string name = "no_name";
-    if (ecs->has_component<Name>(entity)) {
-        name = ecs->get_component<Name>(entity).name;
+    if (ecs.has_component<Name>(entity)) {
+        name = ecs.get_component<Name>(entity).name;
     }
 
     // If the entity has no children, display it as a leaf
     ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
-    if (info.it->children.empty()) {
+    if (!ecs.get_hierarchy().has_children(entity)) {
         flags |= ImGuiTreeNodeFlags_Leaf;
     }
 
     // If the entity ID matches the selected entity ID, highlight it
-    if (entity != 0 && entity == *selected_entity) {
+    if (entity != 0 && entity == selected_entity) {
         flags |= ImGuiTreeNodeFlags_Selected;
     }
 
-    if (ImGui::TreeNodeEx(name.c_str(), flags)) {
-        (*expanded)[entity] = true;
-        
-        if (ImGui::IsItemClicked()) {
-            *selected_entity = entity;
-        }
+    bool const expanded = ImGui::TreeNodeEx(name.c_str(), flags);
+    if (expanded && ImGui::IsItemClicked()) {
+        selected_entity = entity;
     }
 
     if (ImGui::BeginDragDropSource()) {
-        payload->entity = entity;
-        payload->registry = ecs;
-        ImGui::SetDragDropPayload("payload_entity", payload, sizeof(EntityDragDropData));
+        payload.entity = entity;
+        payload.registry = &ecs;
+        ImGui::SetDragDropPayload("payload_entity", &payload, sizeof(EntityDragDropData));
         ImGui::Text("drag drop in progress");
         ImGui::EndDragDropSource();
     }
 
-
-    // Continue iterating with the same parameters
-    return stl::make_tuple(ecs, expanded, selected_entity, payload);
-}
-
-static void tree_post_callback(saturn::ecs::entity_t entity, stl::tree<saturn::ecs::entity_t>::const_traverse_info,
-    saturn::ecs::registry*, expanded_map_t* expanded, saturn::ecs::entity_t*, EntityDragDropData*) {
-    if (entity != 0 && (*expanded)[entity]) {
-        ImGui::TreePop();
-    }
+    return expanded;
 }
 
 void EntityTree::show(saturn::FrameContext& ctx) {
@@ -82,14 +59,25 @@ void EntityTree::show(saturn::FrameContext& ctx) {
         std::string drag_drop_name = name + "drag_drop";
         ImGui::BeginChild(drag_drop_name.c_str());
     
-        auto scene_root = ecs->get_entities().root();
-        expanded_map_t expanded_entities;
-        // Set root node to expanded state
-        expanded_entities[0] = true;
         auto const& color = ImGui::GetStyleColorVec4(ImGuiCol_HeaderHovered);
         ImGui::PushStyleColor(ImGuiCol_Header, color);
-        // Display all entities
-        ecs->get_entities().traverse(display_tree, tree_post_callback, ecs, &expanded_entities, &selected_entity, &current_payload);
+        // Display all entities. The root entity itself is not displayed, and children of collapsed entities are skipped.
+        saturn::ecs::hierarchy const& hierarchy = ecs->get_hierarchy();
+        if (!hierarchy.empty()) {
+            saturn::ecs::entity_t const root = hierarchy.root();
+            // Whether each entity on the current path was expanded, and so needs a TreePop
+            stl::vector<bool> expanded;
+            hierarchy.traverse(root, 
+                [this, root, &expanded](saturn::ecs::entity_t entity) {
+                    bool const open = entity == root || display_entity(*ecs, entity, selected_entity, current_payload);
+                    expanded.push_back(open && entity != root);
+                    return open;
+                },
+                [&expanded](saturn::ecs::entity_t) {
+                    if (expanded.back()) { ImGui::TreePop(); }
+                    expanded.pop_back();
+                });
+        }
         ImGui::PopStyleColor();
 
         ImGui::EndChild();
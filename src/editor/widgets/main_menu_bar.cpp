@@ -20,7 +20,8 @@ static void show_dev_menu(saturn::FrameContext& ctx) {
 
         if (!path.empty()) {
             saturn::Context load_context { ctx.vulkan, &ctx.scene };
-            saturn::assets::load_model(load_context, path);
+            // Importing can take seconds, so it happens in the background. Meshes show up once they are loaded.
+            saturn::assets::load_model_async(load_context, path);
         }
     }
 }
@@ -0,0 +1,91 @@
+#include <editor/widgets/profiler_widget.hpp>
+
+#include <saturn/utility/allocation_counter.hpp>
+
+#include <imgui/imgui.h>
+
+#include <algorithm>
+#include <cstdio>
+
+namespace editor {
+
+static constexpr float refresh_interval = 0.25f;
+
+void ProfilerWidget::refresh() {
+    saturn::Profiler const& profiler = saturn::Profiler::get();
+    zones.clear();
+    frame_starts.clear();
+    frame_allocations.clear();
+    profiler.capture_zones(zones);
+    profiler.capture_frames(frame_starts);
+    profiler.capture_frame_allocations(frame_allocations);
+    saturn::summarize_zones(zones, frame_starts, summaries);
+
+    frame_times.clear();
+    max_frame_time = 0.0f;
+    for (stl::size_t i = 1; i < frame_starts.size(); ++i) {
+        float const ms = static_cast<float>(frame_starts[i] - frame_starts[i - 1]) / 1e6f;
+        frame_times.push_back(ms);
+        max_frame_time = std::max(max_frame_time, ms);
+    }
+
+    allocations_per_frame = 0.0f;
+    if (frame_allocations.size() > 1) {
+        stl::uint64_t const total = frame_allocations.back() - frame_allocations.front();
+        allocations_per_frame = static_cast<float>(total) / static_cast<float>(frame_allocations.size() - 1);
+    }
+}
+
+void ProfilerWidget::show(saturn::FrameContext& ctx) {
+    if (ImGui::Begin("Profiler", get_shown_pointer())) {
+        saturn::Profiler& profiler = saturn::Profiler::get();
+
+        bool recording = profiler.is_enabled();
+        if (ImGui::Checkbox("Record", &recording)) {
+            profiler.set_enabled(recording);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Save trace")) {
+            profiler.write_chrome_trace("profile.json");
+        }
+
+        time_since_refresh += ctx.delta_time;
+        if (recording && (time_since_refresh >= refresh_interval || frame_times.empty())) {
+            refresh();
+            time_since_refresh = 0.0f;
+        }
+
+        if (!frame_times.empty()) {
+            float average = 0.0f;
+            for (float ms : frame_times) { average += ms; }
+            average /= static_cast<float>(frame_times.size());
+
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "avg %.2f ms, max %.2f ms", average, max_frame_time);
+            ImGui::PlotHistogram("##frame_times", frame_times.data(), static_cast<int>(frame_times.size()), 0, 
+                overlay, 0.0f, max_frame_time * 1.1f, ImVec2(ImGui::GetContentRegionAvail().x, 80.0f));
+            if (saturn::is_counting_heap_allocations()) {
+                ImGui::Text("Heap allocations per frame: %.1f", allocations_per_frame);
+            }
+        }
+
+        // Zones averaged over all frames in the history, slowest first
+        ImGui::Columns(4, "##profiler_zones");
+        ImGui::Text("Zone"); ImGui::NextColumn();
+        ImGui::Text("Avg ms / frame"); ImGui::NextColumn();
+        ImGui::Text("Max ms"); ImGui::NextColumn();
+        ImGui::Text("Calls / frame"); ImGui::NextColumn();
+        ImGui::Separator();
+        for (saturn::ZoneSummary const& summary : summaries) {
+            ImGui::Text("%.*s", static_cast<int>(summary.name.size()), summary.name.data()); ImGui::NextColumn();
+            ImGui::Text("%.3f", summary.average_ms); ImGui::NextColumn();
+            ImGui::Text("%.3f", summary.max_ms); ImGui::NextColumn();
+            ImGui::Text("%.1f", summary.calls_per_frame); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+
+    ImGui::End();
+}
+
+}
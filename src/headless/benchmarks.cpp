@@ -0,0 +1,596 @@
+#include <headless/benchmarks.hpp>
+
+#include <saturn/assets/assets.hpp>
+#include <saturn/assets/importers/binary_mesh.hpp>
+#include <saturn/assets/importers/obj.hpp>
+#include <saturn/assets/importers/obj_parser.hpp>
+#include <saturn/assets/importers/simple_mesh.hpp>
+#include <saturn/components/mesh_renderer.hpp>
+#include <saturn/components/static_mesh.hpp>
+#include <saturn/components/transform.hpp>
+#include <saturn/ecs/registry.hpp>
+#include <saturn/scene/aabb_tree.hpp>
+#include <saturn/scene/frustum_culling.hpp>
+#include <saturn/utility/context.hpp>
+#include <saturn/utility/thread_pool.hpp>
+
+#ifdef SATURN_BUILD_SAMPLES
+    #include <samples/simd_rotator_system.hpp>
+#endif
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <phobos/renderer/material.hpp>
+#include <phobos/renderer/texture.hpp>
+
+#include <stl/vector.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+using namespace saturn::components;
+
+namespace headless {
+
+// Seed of every generated benchmark input
+static constexpr stl::uint32_t benchmark_seed = 1234;
+
+template<typename F>
+static double time_seconds(F&& f) {
+    auto const start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Prints and returns the time per item in nanoseconds of running f [passes] times over [count] items
+template<typename F>
+static double report_per_item(char const* name, stl::size_t count, int passes, F&& f, char const* item = "entity") {
+    double const seconds = time_seconds([&f, passes]() {
+        for (int pass = 0; pass < passes; ++pass) { f(); }
+    });
+    double const nanoseconds = seconds * 1e9 / (static_cast<double>(count) * passes);
+    std::cout << name << ": " << nanoseconds << " ns per " << item << "\n";
+    return nanoseconds;
+}
+
+int benchmark_obj(fs::path const& path) {
+    std::error_code error;
+    double const megabytes = static_cast<double>(fs::file_size(path, error)) / (1024.0 * 1024.0);
+    if (error) {
+        std::cerr << "Failed to open " << path.generic_string() << "\n";
+        return 1;
+    }
+
+    auto report = [megabytes](char const* name, auto&& read) {
+        stl::size_t meshes = 0;
+        double const seconds = time_seconds([&read, &meshes]() { meshes = read().meshes.size(); });
+        std::cout << name << ": " << megabytes << " MB in " << seconds << " s = " << megabytes / seconds
+                  << " MB/s, " << meshes << " meshes\n";
+    };
+
+    try {
+        report("Native", [&path]() {
+            return saturn::assets::importers::parse_obj(path, saturn::ThreadPool::get_default());
+        });
+        report("Assimp", [&path]() { return saturn::assets::importers::read_assimp_model(path); });
+    } catch (std::runtime_error const& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int benchmark_groups(stl::size_t count) {
+    saturn::ecs::registry ecs;
+    std::mt19937 random(benchmark_seed);
+    std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+    stl::vector<saturn::ecs::entity_t> entities(stl::tags::reserve, count);
+    for (stl::size_t i = 0; i < count; ++i) {
+        saturn::ecs::entity_t const entity = ecs.create_entity();
+        Transform transform;
+        transform.position = glm::vec3{ distribution(random), distribution(random), distribution(random) };
+        ecs.add_component<Transform>(entity, transform);
+        entities.push_back(entity);
+    }
+    // Half of the entities get a mesh, in random order like a scene that was edited for a while
+    std::shuffle(entities.begin(), entities.end(), random);
+    stl::size_t const matching = count / 2;
+    for (stl::size_t i = 0; i < matching; ++i) {
+        ecs.add_component<StaticMesh>(entities[i], StaticMesh{ { static_cast<stl::int64_t>(i % 64) } });
+        ecs.add_component<MeshRenderer>(entities[i], MeshRenderer{ { static_cast<stl::int64_t>(i % 8) } });
+    }
+    if (matching == 0) {
+        std::cerr << "The groups benchmark needs at least 2 entities\n";
+        return 1;
+    }
+
+    // The sums are compared at the end, which also keeps the compiler from dropping the loops
+    auto sum = [](auto&& iterable, double& total) {
+        for (auto [transform, mesh, renderer] : iterable) {
+            total += transform.position.x + static_cast<double>(mesh.mesh.id + renderer.material.id);
+        }
+    };
+
+    // The view is timed first, since creating the group sorts the storages
+    constexpr int passes = 20;
+    double view_sum = 0.0;
+    auto view = ecs.view<Transform, StaticMesh, MeshRenderer>();
+    report_per_item("View", matching, passes, [&sum, &view, &view_sum]() { sum(view, view_sum); });
+
+    double const create_seconds = time_seconds([&ecs]() { ecs.group<Transform, StaticMesh, MeshRenderer>(); });
+    std::cout << "Creating the group: " << create_seconds * 1000.0 << " ms\n";
+    double group_sum = 0.0;
+    auto&& group = ecs.group<Transform, StaticMesh, MeshRenderer>();
+    report_per_item("Group", matching, passes, [&sum, &group, &group_sum]() { sum(group, group_sum); });
+
+    if (std::abs(view_sum - group_sum) > 1e-6 * std::max(1.0, std::abs(view_sum))) {
+        std::cerr << "The group iterates different components than the view\n";
+        return 1;
+    }
+    return 0;
+}
+
+int benchmark_parallel(stl::size_t count) {
+    saturn::ecs::registry ecs;
+    std::mt19937 random(benchmark_seed);
+    std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+    for (stl::size_t i = 0; i < count; ++i) {
+        Transform transform;
+        transform.position = glm::vec3{ distribution(random), distribution(random), distribution(random) };
+        ecs.add_component<Transform>(ecs.create_entity(), transform);
+    }
+    if (count == 0) {
+        std::cerr << "The parallel benchmark needs at least 1 entity\n";
+        return 1;
+    }
+
+    // A few transcendental calls per entity, so the loop isn't only bound by memory bandwidth. The kernel only
+    // reads the position, so every run writes the same rotations and the results can be compared.
+    auto kernel = [](Transform& transform) {
+        glm::vec3 const& p = transform.position;
+        transform.rotation = glm::vec3{ std::sin(p.x) * std::cos(p.y), std::atan2(p.z, p.x), std::sqrt(std::abs(p.y)) };
+    };
+    auto view = ecs.view<Transform>();
+    auto checksum = [&view]() {
+        double total = 0.0;
+        for (auto [transform] : view) {
+            total += transform.rotation.x + transform.rotation.y + transform.rotation.z;
+        }
+        return total;
+    };
+
+    constexpr int passes = 20;
+    double const serial = report_per_item("Serial", count, passes, [&view, &kernel]() {
+        for (auto [transform] : view) { kernel(transform); }
+    });
+    double const expected = checksum();
+
+    // Powers of two up to the number of hardware threads, and the number of hardware threads itself
+    stl::size_t const max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (stl::size_t threads = 1;; threads = std::min(threads * 2, max_threads)) {
+        saturn::ThreadPool pool(threads);
+        // The archetype backend ignores the chunk size and splits the work by archetype chunk
+        constexpr stl::size_t chunk_size = 1024;
+        std::string const name = std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+        double const parallel = report_per_item(name.c_str(), count, passes, [&view, &kernel, &pool]() {
+            view.par_each(kernel, chunk_size, pool);
+        });
+        std::cout << "    " << serial / parallel << "x the serial loop\n";
+        if (checksum() != expected) {
+            std::cerr << "par_each on " << name << " gives a different result than the serial loop\n";
+            return 1;
+        }
+        if (threads == max_threads) { break; }
+    }
+    return 0;
+}
+
+int benchmark_assets(stl::size_t count) {
+    if (count == 0) {
+        std::cerr << "The assets benchmark needs at least 1 asset\n";
+        return 1;
+    }
+
+    // Textures are added from decoded pixels under a path, so no files are read. Loading a path that was added
+    // looks it up without reading it, which is what every load of an asset that is already loaded does.
+    saturn::Context ctx { nullptr, nullptr };
+    saturn::assets::ImportedTexture pixel;
+    pixel.width = 1;
+    pixel.height = 1;
+    pixel.pixels.resize(4, 255);
+    stl::vector<fs::path> paths(stl::tags::reserve, count);
+    for (stl::size_t i = 0; i < count; ++i) {
+        paths.push_back(fs::path("benchmark") / ("texture" + std::to_string(i) + ".tga"));
+    }
+    stl::vector<saturn::Handle<ph::Texture>> handles(stl::tags::reserve, count);
+    report_per_item("Adding", count, 1, [&ctx, &pixel, &paths, &handles]() {
+        for (fs::path const& path : paths) { handles.push_back(saturn::assets::take_texture(ctx, pixel, path)); }
+    }, "asset");
+
+    // Look the assets up in random order, the way a scene refers to them
+    stl::vector<stl::size_t> order(stl::tags::reserve, count);
+    for (stl::size_t i = 0; i < count; ++i) { order.push_back(i); }
+    std::shuffle(order.begin(), order.end(), std::mt19937(benchmark_seed));
+
+    constexpr int passes = 10;
+    stl::size_t wrong = 0;
+    report_per_item("Load by path", count, passes, [&ctx, &paths, &handles, &order, &wrong]() {
+        for (stl::size_t i : order) { wrong += saturn::assets::load_texture(ctx, paths[i]).id != handles[i].id; }
+    }, "asset");
+    report_per_item("Get", count, passes, [&handles, &order, &wrong]() {
+        for (stl::size_t i : order) { wrong += saturn::assets::get_texture(handles[i]) == nullptr; }
+    }, "asset");
+    report_per_item("Get path", count, passes, [&paths, &handles, &order, &wrong]() {
+        for (stl::size_t i : order) { wrong += saturn::assets::get_texture_path(handles[i]) != paths[i]; }
+    }, "asset");
+
+    // Renderers iterate all materials every frame
+    for (stl::size_t i = 0; i < count; ++i) {
+        ph::Material material;
+        saturn::assets::take_material(material, "material" + std::to_string(i));
+    }
+    report_per_item("All materials, first call", count, 1, [&wrong, count]() {
+        wrong += saturn::assets::get_all_materials().size() != count;
+    }, "asset");
+    report_per_item("All materials, cached", count, passes, [&wrong, count]() {
+        wrong += saturn::assets::get_all_materials().size() != count;
+    }, "asset");
+
+    saturn::assets::destroy_all_assets();
+    if (wrong != 0) {
+        std::cerr << wrong << " lookups returned the wrong asset\n";
+        return 1;
+    }
+    return 0;
+}
+
+int benchmark_mesh_load(stl::size_t triangle_count) {
+    if (triangle_count == 0) {
+        std::cerr << "The mesh load benchmark needs at least 1 triangle\n";
+        return 1;
+    }
+
+    std::error_code error;
+    fs::path const directory = fs::temp_directory_path(error) / "saturn_mesh_load_benchmark";
+    fs::remove_all(directory, error);
+    fs::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create " << directory.generic_string() << "\n";
+        return 1;
+    }
+
+    // Triangles of 8 floats per vertex like the OBJ importer creates, printed with enough digits to read back the
+    // same floats, and converted with the same function as SaturnHeadless --convert-mesh
+    fs::path const text_path = directory / "mesh.txt";
+    fs::path const binary_path = directory / "mesh.smesh";
+    {
+        std::mt19937 random(benchmark_seed);
+        std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+        stl::size_t const value_count = triangle_count * 3 * 8;
+        std::ofstream file(text_path);
+        file.precision(9);
+        file << value_count << " " << triangle_count * 3 << "\n";
+        for (stl::size_t i = 0; i < value_count; ++i) { file << distribution(random) << " "; }
+    }
+    if (saturn::assets::importers::convert_to_binary_mesh(text_path, binary_path) != 1) {
+        std::cerr << "Failed to write " << text_path.generic_string() << " or convert it\n";
+        return 1;
+    }
+
+    // Uploading reads every vertex, so the timings include summing them. Otherwise mapping the binary file would
+    // only count setting up the mapping, and the reads from disk would happen later in the upload.
+    auto report = [](char const* name, fs::path const& path, auto&& read, double& total) {
+        double const megabytes = static_cast<double>(fs::file_size(path)) / (1024.0 * 1024.0);
+        constexpr int passes = 5;
+        bool loaded = true;
+        double const seconds = time_seconds([&read, &loaded, &total]() {
+            for (int pass = 0; pass < passes; ++pass) {
+                std::optional<saturn::assets::ImportedMesh> const mesh = read();
+                loaded = loaded && mesh;
+                if (!mesh) { continue; }
+                for (float value : mesh->vertex_data()) { total += value; }
+                for (stl::uint32_t index : mesh->index_data()) { total += index; }
+            }
+        }) / passes;
+        std::cout << name << ": " << megabytes << " MB in " << seconds * 1000.0 << " ms\n";
+        return loaded ? seconds : -1.0;
+    };
+
+    double text_total = 0.0;
+    double binary_total = 0.0;
+    double const text_seconds = report("Text", text_path, [&text_path]() {
+        return saturn::assets::importers::read_simple_mesh(text_path);
+    }, text_total);
+    double const binary_seconds = report("Binary", binary_path, [&binary_path]() {
+        return saturn::assets::importers::read_binary_mesh(binary_path);
+    }, binary_total);
+    fs::remove_all(directory, error);
+
+    if (text_seconds < 0.0 || binary_seconds < 0.0) {
+        std::cerr << "Failed to read the generated meshes\n";
+        return 1;
+    }
+    std::cout << "The binary mesh loads " << text_seconds / binary_seconds << "x as fast\n";
+    if (text_total != binary_total) {
+        std::cerr << "The binary mesh has different vertices or indices than the text mesh\n";
+        return 1;
+    }
+    return 0;
+}
+
+static int benchmark_aabb_tree(stl::size_t count) {
+    using saturn::AABB;
+    using saturn::ecs::entity_t;
+
+    // The world grows with the count, so the boxes are about as dense at every size
+    std::mt19937 random(benchmark_seed);
+    float const half_size = 2.0f * std::cbrt(static_cast<float>(count));
+    std::uniform_real_distribution<float> coordinate(-half_size, half_size);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    auto random_point = [&random, &coordinate]() {
+        // Braced initialization, so the values are generated in order on every compiler
+        return glm::vec3{ coordinate(random), coordinate(random), coordinate(random) };
+    };
+    auto random_direction = [&random, &unit]() {
+        glm::vec3 direction{ unit(random), unit(random), unit(random) };
+        float const length = std::sqrt(direction.x * direction.x + direction.y * direction.y
+            + direction.z * direction.z);
+        return length > 1e-3f ? direction * (1.0f / length) : glm::vec3(0, 0, 1);
+    };
+
+    std::uniform_real_distribution<float> extent(0.25f, 1.0f);
+    stl::vector<AABB> boxes(stl::tags::reserve, count);
+    for (stl::size_t i = 0; i < count; ++i) {
+        glm::vec3 const center = random_point();
+        glm::vec3 const extents{ extent(random), extent(random), extent(random) };
+        boxes.push_back(AABB{ center - extents, center + extents });
+    }
+
+    saturn::AABBTree tree;
+    stl::vector<stl::int32_t> proxies(stl::tags::reserve, count);
+    double const insert_seconds = time_seconds([&tree, &boxes, &proxies]() {
+        for (stl::size_t i = 0; i < boxes.size(); ++i) {
+            proxies.push_back(tree.insert(boxes[i], static_cast<entity_t>(i)));
+        }
+    });
+    std::cout << count << " entities\n    Inserting: " << insert_seconds * 1000.0 << " ms, height " << tree.height()
+              << "\n";
+
+    // Most boxes take a small step like objects moving between frames, which stays inside the fat box. Every tenth
+    // box moves further and has to be reinserted.
+    std::uniform_real_distribution<float> step(-0.05f, 0.05f);
+    for (stl::size_t i = 0; i < count; ++i) {
+        glm::vec3 const offset = glm::vec3{ step(random), step(random), step(random) } * (i % 10 == 0 ? 20.0f : 1.0f);
+        boxes[i] = AABB{ boxes[i].min + offset, boxes[i].max + offset };
+    }
+    stl::size_t reinserted = 0;
+    double const move_seconds = time_seconds([&tree, &boxes, &proxies, &reinserted]() {
+        for (stl::size_t i = 0; i < boxes.size(); ++i) { reinserted += tree.move(proxies[i], boxes[i]); }
+    });
+    std::cout << "    Moving: " << move_seconds * 1e9 / static_cast<double>(count) << " ns per entity, " << reinserted
+              << " reinserted, height " << tree.height() << "\n";
+
+    // The brute force reference tests the same fat boxes as the tree, so both must find the same entities
+    stl::vector<AABB> fat_boxes(stl::tags::reserve, count);
+    for (stl::int32_t proxy : proxies) { fat_boxes.push_back(tree.get_fat_box(proxy)); }
+
+    constexpr stl::size_t query_count = 100;
+    stl::size_t mismatches = 0;
+    auto compare = [&mismatches](char const* name, auto const& queries, auto&& tree_query, auto&& brute_force) {
+        stl::vector<stl::vector<entity_t>> tree_results(stl::tags::reserve, queries.size());
+        stl::vector<stl::vector<entity_t>> brute_force_results(stl::tags::reserve, queries.size());
+        double const tree_seconds = time_seconds([&]() {
+            for (auto const& query : queries) {
+                tree_results.emplace_back();
+                tree_query(query, tree_results.back());
+            }
+        });
+        double const brute_force_seconds = time_seconds([&]() {
+            for (auto const& query : queries) {
+                brute_force_results.emplace_back();
+                brute_force(query, brute_force_results.back());
+            }
+        });
+
+        stl::size_t hits = 0;
+        for (stl::size_t i = 0; i < queries.size(); ++i) {
+            std::sort(tree_results[i].begin(), tree_results[i].end());
+            std::sort(brute_force_results[i].begin(), brute_force_results[i].end());
+            mismatches += !std::equal(tree_results[i].begin(), tree_results[i].end(),
+                brute_force_results[i].begin(), brute_force_results[i].end());
+            hits += brute_force_results[i].size();
+        }
+        double const per_query = 1e6 / static_cast<double>(queries.size());
+        std::cout << "    " << name << " queries: " << tree_seconds * per_query << " us, brute force "
+                  << brute_force_seconds * per_query << " us, " << hits / queries.size() << " hits per query\n";
+    };
+
+    stl::vector<saturn::Frustum> frustums(stl::tags::reserve, query_count);
+    for (stl::size_t i = 0; i < query_count; ++i) {
+        glm::vec3 const eye = random_point();
+        glm::vec3 const target = eye + random_direction();
+        frustums.push_back(saturn::extract_frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 30.0f)
+            * glm::lookAt(eye, target, glm::vec3(0, 1, 0))));
+    }
+    compare("Frustum", frustums, [&tree](saturn::Frustum const& frustum, stl::vector<entity_t>& result) {
+        tree.query_frustum(frustum, result);
+    }, [&fat_boxes](saturn::Frustum const& frustum, stl::vector<entity_t>& result) {
+        for (stl::size_t i = 0; i < fat_boxes.size(); ++i) {
+            glm::vec3 const center = (fat_boxes[i].min + fat_boxes[i].max) * 0.5f;
+            glm::vec3 const extents = (fat_boxes[i].max - fat_boxes[i].min) * 0.5f;
+            bool outside = false;
+            for (glm::vec4 const& plane : frustum.planes) {
+                float const distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+                outside = outside || distance + std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y
+                    + std::abs(plane.z) * extents.z < 0.0f;
+            }
+            if (!outside) { result.push_back(static_cast<entity_t>(i)); }
+        }
+    });
+
+    struct Ray {
+        glm::vec3 origin;
+        glm::vec3 direction;
+    };
+    float const ray_length = 2.0f * half_size;
+    stl::vector<Ray> rays(stl::tags::reserve, query_count);
+    for (stl::size_t i = 0; i < query_count; ++i) {
+        glm::vec3 const origin = random_point();
+        rays.push_back(Ray{ origin, random_direction() });
+    }
+    compare("Ray", rays, [&tree, ray_length](Ray const& ray, stl::vector<entity_t>& result) {
+        stl::vector<saturn::RayHit> hits;
+        tree.query_ray(ray.origin, ray.direction, ray_length, hits);
+        for (saturn::RayHit const& hit : hits) { result.push_back(hit.entity); }
+    }, [&fat_boxes, ray_length](Ray const& ray, stl::vector<entity_t>& result) {
+        // Sorted by distance like the tree results
+        stl::vector<saturn::RayHit> hits;
+        for (stl::size_t i = 0; i < fat_boxes.size(); ++i) {
+            float near = 0.0f;
+            float far = ray_length;
+            for (int axis = 0; axis < 3; ++axis) {
+                float const inverse = 1.0f / ray.direction[axis];
+                float t0 = (fat_boxes[i].min[axis] - ray.origin[axis]) * inverse;
+                float t1 = (fat_boxes[i].max[axis] - ray.origin[axis]) * inverse;
+                if (t0 > t1) { std::swap(t0, t1); }
+                near = t0 > near ? t0 : near;
+                far = t1 < far ? t1 : far;
+            }
+            if (near <= far) { hits.push_back({ static_cast<entity_t>(i), near }); }
+        }
+        std::sort(hits.begin(), hits.end(), [](saturn::RayHit const& lhs, saturn::RayHit const& rhs) {
+            return lhs.distance < rhs.distance;
+        });
+        for (saturn::RayHit const& hit : hits) { result.push_back(hit.entity); }
+    });
+
+    struct Sphere {
+        glm::vec3 center;
+        float radius;
+    };
+    stl::vector<Sphere> spheres(stl::tags::reserve, query_count);
+    for (stl::size_t i = 0; i < query_count; ++i) { spheres.push_back(Sphere{ random_point(), 5.0f }); }
+    compare("Sphere", spheres, [&tree](Sphere const& sphere, stl::vector<entity_t>& result) {
+        tree.query_sphere(sphere.center, sphere.radius, result);
+    }, [&fat_boxes](Sphere const& sphere, stl::vector<entity_t>& result) {
+        for (stl::size_t i = 0; i < fat_boxes.size(); ++i) {
+            float closest_sq = 0.0f;
+            for (int axis = 0; axis < 3; ++axis) {
+                float const closest = std::max(std::max(fat_boxes[i].min[axis] - sphere.center[axis],
+                    sphere.center[axis] - fat_boxes[i].max[axis]), 0.0f);
+                closest_sq += closest * closest;
+            }
+            if (closest_sq <= sphere.radius * sphere.radius) { result.push_back(static_cast<entity_t>(i)); }
+        }
+    });
+
+    stl::vector<AABB> query_boxes(stl::tags::reserve, query_count);
+    for (stl::size_t i = 0; i < query_count; ++i) {
+        glm::vec3 const center = random_point();
+        query_boxes.push_back(AABB{ center - glm::vec3(5, 5, 5), center + glm::vec3(5, 5, 5) });
+    }
+    compare("Box", query_boxes, [&tree](AABB const& box, stl::vector<entity_t>& result) {
+        tree.query_box(box, result);
+    }, [&fat_boxes](AABB const& box, stl::vector<entity_t>& result) {
+        for (stl::size_t i = 0; i < fat_boxes.size(); ++i) {
+            AABB const& other = fat_boxes[i];
+            if (box.min.x <= other.max.x && box.max.x >= other.min.x && box.min.y <= other.max.y
+                    && box.max.y >= other.min.y && box.min.z <= other.max.z && box.max.z >= other.min.z) {
+                result.push_back(static_cast<entity_t>(i));
+            }
+        }
+    });
+
+    if (mismatches != 0) {
+        std::cerr << mismatches << " queries found different entities than brute force\n";
+        return 1;
+    }
+    return 0;
+}
+
+int benchmark_aabb_tree() {
+    for (stl::size_t count : { 10'000, 100'000, 1'000'000 }) {
+        if (benchmark_aabb_tree(count) != 0) { return 1; }
+    }
+    return 0;
+}
+
+#ifdef SATURN_BUILD_SAMPLES
+
+int benchmark_rotator(stl::size_t count) {
+    saturn::ecs::registry ecs;
+    std::mt19937 random(benchmark_seed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (stl::size_t i = 0; i < count; ++i) {
+        saturn::ecs::entity_t const entity = ecs.create_entity();
+        ecs.add_component<Transform>(entity);
+        // Braced initialization, so the values are generated in order on every compiler
+        ecs.add_component<Rotator>(entity, Rotator{ distribution(random),
+            glm::vec3{ distribution(random), distribution(random), distribution(random) } });
+    }
+    auto&& group = ecs.group<Transform, Rotator>();
+
+    // Both kernels must give the same result. Run each once from the same start and compare.
+    stl::vector<Transform> start;
+    stl::vector<Transform> scalar_result;
+    auto snapshot = [&group](stl::vector<Transform>& out) {
+        out.clear();
+        group.each_chunk([&out](auto, saturn::Span<Transform> transforms, auto) {
+            for (Transform const& transform : transforms) { out.push_back(transform); }
+        });
+    };
+    auto restore = [&group](stl::vector<Transform> const& in) {
+        stl::size_t next = 0;
+        group.each_chunk([&in, &next](auto, saturn::Span<Transform> transforms, auto) {
+            for (Transform& transform : transforms) { transform = in[next++]; }
+        });
+    };
+    auto run = [&group](auto kernel) {
+        group.each_chunk([kernel](auto, saturn::Span<Transform> transforms, saturn::Span<Rotator> rotators) {
+            kernel(transforms, rotators);
+        });
+    };
+
+    snapshot(start);
+    run(samples::rotate_scalar);
+    snapshot(scalar_result);
+    restore(start);
+    run(samples::rotate_simd);
+    stl::size_t next = 0;
+    bool same = true;
+    group.each_chunk([&](auto, saturn::Span<Transform> transforms, auto) {
+        for (Transform const& transform : transforms) {
+            glm::vec3 const difference = transform.rotation - scalar_result[next++].rotation;
+            same = same && std::abs(difference.x) + std::abs(difference.y) + std::abs(difference.z) < 1e-5f;
+        }
+    });
+    if (!same) {
+        std::cerr << "The SIMD rotator kernel gives a different result than the scalar kernel\n";
+        return 1;
+    }
+
+    constexpr int passes = 200;
+    report_per_item("Scalar", count, passes, [&run]() { run(samples::rotate_scalar); });
+    report_per_item("SIMD", count, passes, [&run]() { run(samples::rotate_simd); });
+    return 0;
+}
+
+#else
+
+int benchmark_rotator(stl::size_t) {
+    std::cerr << "The rotator benchmark requires a build with SATURN_BUILD_SAMPLES\n";
+    return 1;
+}
+
+#endif
+
+}
@@ -0,0 +1,1184 @@
+#include <headless/checks.hpp>
+
+#include <saturn/assets/assets.hpp>
+#include <saturn/assets/asset_cache.hpp>
+#include <saturn/assets/importers/binary_mesh.hpp>
+#include <saturn/assets/importers/obj.hpp>
+#include <saturn/assets/importers/obj_parser.hpp>
+#include <saturn/components/mesh_renderer.hpp>
+#include <saturn/components/static_mesh.hpp>
+#include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
+#include <saturn/core/frame_pipeline.hpp>
+#include <saturn/ecs/system_manager.hpp>
+#include <saturn/scene/scene.hpp>
+#include <saturn/scene/draw_batching.hpp>
+#include <saturn/scene/frustum_culling.hpp>
+#include <saturn/scene/light_clusters.hpp>
+#include <saturn/scene/lod_selection.hpp>
+#include <saturn/scene/render_scene.hpp>
+#include <saturn/systems/transform_system.hpp>
+#include <saturn/utility/bounds.hpp>
+#include <saturn/utility/math.hpp>
+
+#include <stl/types.hpp>
+#include <stl/vector.hpp>
+
+#include <phobos/renderer/mesh.hpp>
+#include <phobos/renderer/texture.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+using namespace saturn;
+
+namespace headless {
+
+// Seed of every generated check input
+static constexpr stl::uint32_t check_seed = 4321;
+
+// Results closer than this to a plane may go either way, since the optimized paths add in a different order
+static constexpr float boundary_epsilon = 1e-3f;
+
+static float signed_distance(glm::vec4 const& plane, glm::vec3 const& point) {
+    return plane.x * point.x + plane.y * point.y + plane.z * point.z + plane.w;
+}
+
+// Points on the boundary count as outside
+static bool inside_frustum(Frustum const& frustum, glm::vec3 const& point) {
+    for (glm::vec4 const& plane : frustum.planes) {
+        if (signed_distance(plane, point) < boundary_epsilon) { return false; }
+    }
+    return true;
+}
+
+// Half-space dot(normal, p) + w >= 0 with a unit normal, in double precision for the exact distance tests
+struct HalfSpace {
+    double x, y, z, w;
+};
+
+static HalfSpace make_half_space(double x, double y, double z, double w) {
+    double const length = std::sqrt(x * x + y * y + z * z);
+    return HalfSpace{ x / length, y / length, z / length, w / length };
+}
+
+static double signed_distance(HalfSpace const& plane, double const* point) {
+    return plane.x * point[0] + plane.y * point[1] + plane.z * point[2] + plane.w;
+}
+
+// Distance from a point to the convex intersection of the half-spaces, which must not be empty. The closest point
+// lies on a face, edge or corner, so this projects onto every combination of up to 3 planes and keeps the closest
+// projection that is inside all half-spaces.
+static double distance_to_polytope(HalfSpace const* planes, stl::size_t count, double const* point) {
+    constexpr double tolerance = 1e-6;
+    auto inside = [planes, count](double const* p) {
+        for (stl::size_t i = 0; i < count; ++i) {
+            if (signed_distance(planes[i], p) < -tolerance) { return false; }
+        }
+        return true;
+    };
+    if (inside(point)) { return 0.0; }
+
+    double best = 1e300;
+    // Projects onto the planes selected by the bits of mask: p = point - sum(lambda_i * n_i), with the lambdas
+    // solved from the Gram matrix of the normals
+    for (stl::uint32_t mask = 1; mask < (1u << count); ++mask) {
+        HalfSpace const* selected[3];
+        stl::size_t k = 0;
+        for (stl::size_t i = 0; i < count; ++i) {
+            if (mask & (1u << i)) {
+                if (k == 3) { k = 4; break; }
+                selected[k++] = &planes[i];
+            }
+        }
+        if (k > 3) { continue; }
+
+        double gram[3][4] = {};
+        for (stl::size_t i = 0; i < k; ++i) {
+            for (stl::size_t j = 0; j < k; ++j) {
+                gram[i][j] = selected[i]->x * selected[j]->x + selected[i]->y * selected[j]->y
+                    + selected[i]->z * selected[j]->z;
+            }
+            gram[i][3] = signed_distance(*selected[i], point);
+        }
+        // Gaussian elimination with partial pivoting, parallel planes don't have a common projection
+        bool singular = false;
+        for (stl::size_t column = 0; column < k && !singular; ++column) {
+            stl::size_t pivot = column;
+            for (stl::size_t row = column + 1; row < k; ++row) {
+                if (std::abs(gram[row][column]) > std::abs(gram[pivot][column])) { pivot = row; }
+            }
+            if (std::abs(gram[pivot][column]) < 1e-9) { singular = true; break; }
+            std::swap(gram[column], gram[pivot]);
+            for (stl::size_t row = 0; row < k; ++row) {
+                if (row == column) { continue; }
+                double const factor = gram[row][column] / gram[column][column];
+                for (stl::size_t c = column; c < 4; ++c) { gram[row][c] -= factor * gram[column][c]; }
+            }
+        }
+        if (singular) { continue; }
+
+        double projected[3] = { point[0], point[1], point[2] };
+        for (stl::size_t i = 0; i < k; ++i) {
+            double const lambda = gram[i][3] / gram[i][i];
+            projected[0] -= lambda * selected[i]->x;
+            projected[1] -= lambda * selected[i]->y;
+            projected[2] -= lambda * selected[i]->z;
+        }
+        if (inside(projected)) {
+            double const dx = projected[0] - point[0];
+            double const dy = projected[1] - point[1];
+            double const dz = projected[2] - point[2];
+            best = std::min(best, std::sqrt(dx * dx + dy * dy + dz * dz));
+        }
+    }
+    return best;
+}
+
+int check_culling() {
+    std::mt19937 random(check_seed);
+    auto uniform = [&random](float min, float max) { return std::uniform_real_distribution<float>(min, max)(random); };
+    // Braced initialization, so the components are generated in order on every compiler
+    auto uniform_vec3 = [&uniform](float min, float max) {
+        return glm::vec3{ uniform(min, max), uniform(min, max), uniform(min, max) };
+    };
+
+    // Not a multiple of 4, so the scalar tail of the culler is covered too
+    constexpr stl::uint32_t object_count = 10003;
+    constexpr stl::uint32_t camera_count = 16;
+
+    enum class Kind { bounded, infinite, removed };
+    stl::vector<Kind> kinds;
+    stl::vector<Bounds> bounds;
+    stl::vector<glm::mat4> worlds;
+    FrustumCuller culler;
+    culler.resize(object_count);
+    for (stl::uint32_t i = 0; i < object_count; ++i) {
+        Bounds local;
+        local.center = uniform_vec3(-1, 1);
+        local.extents = uniform_vec3(0.1f, 2);
+        local.radius = std::sqrt(local.extents.x * local.extents.x + local.extents.y * local.extents.y
+            + local.extents.z * local.extents.z);
+        glm::mat4 const world = glm::compose_transform(uniform_vec3(-100, 100), uniform_vec3(-3.14f, 3.14f),
+            uniform_vec3(0.2f, 3));
+        Kind const kind = i % 97 == 0 ? Kind::removed : (i % 101 == 0 ? Kind::infinite : Kind::bounded);
+        if (kind == Kind::bounded) {
+            culler.set(i, local, world);
+        } else if (kind == Kind::infinite) {
+            culler.set_infinite(i);
+        }
+        kinds.push_back(kind);
+        bounds.push_back(local);
+        worlds.push_back(world);
+    }
+
+    stl::size_t total_visible = 0;
+    stl::size_t mismatches = 0;
+    stl::size_t wrongly_culled = 0;
+    stl::vector<stl::uint32_t> visible;
+    for (stl::uint32_t camera = 0; camera < camera_count; ++camera) {
+        glm::vec3 const eye = uniform_vec3(-50, 50);
+        glm::vec3 const target = uniform_vec3(-50, 50);
+        glm::mat4 const view_projection = glm::perspective(glm::radians(uniform(30, 90)), 16.0f / 9.0f, 0.1f, 120.0f)
+            * glm::lookAt(eye, target, glm::vec3(0, 1, 0));
+        Frustum const frustum = extract_frustum(view_projection);
+
+        visible.clear();
+        culler.cull(frustum, visible);
+        total_visible += visible.size();
+        if (!std::is_sorted(visible.begin(), visible.end())) {
+            std::cerr << "Culling: visible indices are not in increasing order\n";
+            return 1;
+        }
+
+        stl::size_t next_visible = 0;
+        for (stl::uint32_t i = 0; i < object_count; ++i) {
+            bool const culled_visible = next_visible < visible.size() && visible[next_visible] == i;
+            if (culled_visible) { ++next_visible; }
+
+            if (kinds[i] != Kind::bounded) {
+                mismatches += culled_visible != (kinds[i] == Kind::infinite);
+                continue;
+            }
+
+            // Reference: the box around the transformed bounds and the scaled sphere, tested plane by plane
+            AABB const box = transform_bounds(bounds[i], worlds[i]);
+            glm::vec3 const center((box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f,
+                (box.min.z + box.max.z) * 0.5f);
+            float max_scale = 0.0f;
+            for (int column = 0; column < 3; ++column) {
+                max_scale = std::max(max_scale, glm::length(glm::vec3(worlds[i][column])));
+            }
+            float const radius = bounds[i].radius * max_scale;
+            float margin = 1e30f;
+            for (glm::vec4 const& plane : frustum.planes) {
+                float const distance = signed_distance(plane, center);
+                float const projected = (box.max.x - center.x) * std::abs(plane.x)
+                    + (box.max.y - center.y) * std::abs(plane.y) + (box.max.z - center.z) * std::abs(plane.z);
+                margin = std::min(margin, std::min(distance + radius, distance + projected));
+            }
+            if (std::abs(margin) > boundary_epsilon && culled_visible != (margin >= 0.0f)) {
+                ++mismatches;
+            }
+
+            // A culled object must not have any of its box corners or its center inside the frustum
+            if (!culled_visible) {
+                bool any_inside = inside_frustum(frustum, glm::vec3(worlds[i] * glm::vec4(bounds[i].center, 1.0f)));
+                for (int corner = 0; corner < 8 && !any_inside; ++corner) {
+                    glm::vec3 const offset((corner & 1) ? bounds[i].extents.x : -bounds[i].extents.x,
+                        (corner & 2) ? bounds[i].extents.y : -bounds[i].extents.y,
+                        (corner & 4) ? bounds[i].extents.z : -bounds[i].extents.z);
+                    glm::vec4 const corner_position = worlds[i] * glm::vec4(bounds[i].center + offset, 1.0f);
+                    any_inside = inside_frustum(frustum, glm::vec3(corner_position));
+                }
+                wrongly_culled += any_inside;
+            }
+        }
+    }
+
+    std::cout << "Culling: " << object_count << " objects, " << camera_count << " cameras, "
+              << total_visible / camera_count << " visible on average, " << mismatches << " differ from the reference, "
+              << wrongly_culled << " culled while inside the frustum\n";
+    return mismatches == 0 && wrongly_culled == 0 ? 0 : 1;
+}
+
+int check_light_clusters() {
+    std::mt19937 random(check_seed);
+    auto uniform = [&random](float min, float max) { return std::uniform_real_distribution<float>(min, max)(random); };
+    auto uniform_vec3 = [&uniform](float min, float max) {
+        return glm::vec3{ uniform(min, max), uniform(min, max), uniform(min, max) };
+    };
+
+    // Not a multiple of 4, so the scalar tail of the binning is covered too
+    constexpr stl::uint32_t light_count = 503;
+    constexpr float distance_epsilon = 1e-3f;
+
+    LightClusters clusters;
+    LightClusterConfig const& config = clusters.get_config();
+    stl::size_t missing = 0;
+    stl::size_t invalid = 0;
+    stl::size_t listings = 0;
+    stl::size_t beyond_range = 0;
+    // Twice: with the projection as glm builds it, and flipped in y like the engine does for Vulkan
+    for (int flip = 0; flip < 2; ++flip) {
+        glm::vec3 const eye = uniform_vec3(-20, 20);
+        glm::mat4 const view = glm::lookAt(eye, eye + uniform_vec3(-1, 1), glm::vec3(0, 1, 0));
+        glm::mat4 projection = glm::perspective(glm::radians(uniform(40, 90)), 16.0f / 9.0f, config.near, config.far);
+        if (flip) {
+            projection[1][1] *= -1.0f;
+        }
+
+        stl::vector<glm::vec3> positions;
+        stl::vector<float> ranges;
+        for (stl::uint32_t i = 0; i < light_count; ++i) {
+            // Mostly close lights, which cover several clusters, and some far away or behind the camera
+            float const spread = i % 5 == 0 ? 400.0f : 60.0f;
+            positions.push_back(eye + uniform_vec3(-spread, spread));
+            ranges.push_back(light_range(uniform(0.01f, 2.0f)));
+        }
+        clusters.build(Span<glm::vec3 const>(positions.data(), positions.size()),
+            Span<float const>(ranges.data(), ranges.size()), view, projection);
+
+        // Which lights each cluster lists
+        stl::vector<stl::uint8_t> listed(clusters.cluster_count() * light_count, 0);
+        for (stl::uint32_t cluster = 0; cluster < clusters.cluster_count(); ++cluster) {
+            for (stl::uint32_t light : clusters.lights_in_cluster(cluster)) {
+                if (light >= light_count || listed[cluster * light_count + light]) {
+                    ++invalid;
+                    continue;
+                }
+                listed[cluster * light_count + light] = 1;
+                ++listings;
+            }
+        }
+
+        double const scale_x = projection[0][0];
+        double const scale_y = projection[1][1];
+        for (stl::uint32_t light = 0; light < light_count; ++light) {
+            glm::vec4 const view_position = view * glm::vec4(positions[light], 1.0f);
+            double const center[3] = { view_position.x, view_position.y, view_position.z };
+            double const radius = ranges[light];
+            for (stl::uint32_t slice = 0; slice < config.slices; ++slice) {
+                double const depth_ratio = static_cast<double>(config.far) / config.near;
+                double const near = config.near * std::pow(depth_ratio, static_cast<double>(slice) / config.slices);
+                double const far = config.near * std::pow(depth_ratio, static_cast<double>(slice + 1) / config.slices);
+                for (stl::uint32_t y = 0; y < config.tiles_y; ++y) {
+                    for (stl::uint32_t x = 0; x < config.tiles_x; ++x) {
+                        // The froxel in view space, where the camera looks down -z and depth = -z
+                        double const ndc_x0 = 2.0 * x / config.tiles_x - 1.0;
+                        double const ndc_x1 = 2.0 * (x + 1) / config.tiles_x - 1.0;
+                        double const ndc_y0 = 2.0 * y / config.tiles_y - 1.0;
+                        double const ndc_y1 = 2.0 * (y + 1) / config.tiles_y - 1.0;
+                        HalfSpace const froxel[6] = {
+                            make_half_space(0, 0, -1, -near),
+                            make_half_space(0, 0, 1, far),
+                            make_half_space(scale_x, 0, ndc_x0, 0),
+                            make_half_space(-scale_x, 0, -ndc_x1, 0),
+                            make_half_space(0, scale_y, ndc_y0, 0),
+                            make_half_space(0, -scale_y, -ndc_y1, 0),
+                        };
+
+                        // Most clusters are rejected by a single plane
+                        bool reaches = true;
+                        for (HalfSpace const& plane : froxel) {
+                            reaches = reaches && signed_distance(plane, center) >= -radius;
+                        }
+                        double const distance = reaches ? distance_to_polytope(froxel, 6, center) : 1e300;
+
+                        bool const is_listed = listed[clusters.cluster_index(x, y, slice) * light_count + light];
+                        if (!is_listed && distance < radius - distance_epsilon) { ++missing; }
+                        if (is_listed && distance > radius + distance_epsilon) { ++beyond_range; }
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Light clusters: " << light_count << " lights, " << clusters.cluster_count() << " clusters, "
+              << listings / 2 << " listings per build, " << missing << " missing, " << invalid << " invalid, "
+              << beyond_range << " listed beyond their range\n";
+    return missing == 0 && invalid == 0 ? 0 : 1;
+}
+
+// The level select_lod should pick, written as its definition: the coarsest level that fits the limit, where
+// levels coarser than the current one have to fit the limit reduced by the hysteresis. Errors increase with the
+// level, so all finer levels fit too.
+static stl::uint32_t reference_lod(stl::vector<assets::MeshLod> const& lods, float screen_scale, stl::uint32_t current,
+    LodSettings const& settings) {
+    stl::uint32_t selected = 0;
+    for (stl::uint32_t level = 0; level < lods.size(); ++level) {
+        float const limit = level > current ? settings.max_screen_error * (1.0f - settings.hysteresis)
+            : settings.max_screen_error;
+        if (lods[level].error * screen_scale <= limit) { selected = level; }
+    }
+    return selected;
+}
+
+int check_lod() {
+    std::mt19937 random(check_seed);
+    auto uniform = [&random](float min, float max) { return std::uniform_real_distribution<float>(min, max)(random); };
+
+    constexpr stl::uint32_t object_count = 200;
+    constexpr stl::uint32_t steps = 400;
+    constexpr float min_depth = 0.5f;
+    constexpr float max_depth = 4000.0f;
+    // Relative tolerance of the error comparisons, select_lod computes the screen scale in a different order
+    constexpr float error_epsilon = 1e-4f;
+
+    LodSettings const settings;
+    stl::size_t mismatches = 0;
+    stl::size_t over_limit = 0;
+    stl::size_t wrong_direction = 0;
+    stl::size_t inside_hysteresis = 0;
+    stl::size_t flickers = 0;
+    stl::size_t switches = 0;
+    for (stl::uint32_t object = 0; object < object_count; ++object) {
+        stl::vector<assets::MeshLod> lods(2 + random() % 5);
+        float error = uniform(0.001f, 0.05f);
+        for (stl::size_t level = 1; level < lods.size(); ++level) {
+            lods[level].error = error;
+            error *= uniform(1.5f, 4.0f);
+        }
+        float const object_scale = uniform(0.5f, 3.0f);
+        // Half of the projections are flipped in y like the engine's
+        float projection_scale = 1.0f / std::tan(glm::radians(uniform(40.0f, 90.0f)) * 0.5f);
+        if (object % 2) { projection_scale = -projection_scale; }
+
+        Span<assets::MeshLod const> const lod_span(lods.data(), lods.size());
+        stl::uint32_t current = 0;
+        stl::vector<float> switch_depths;
+        // Away from the camera and back, geometric steps
+        for (stl::uint32_t step = 0; step <= 2 * steps; ++step) {
+            bool const moving_away = step <= steps;
+            float const t = static_cast<float>(moving_away ? step : 2 * steps - step) / steps;
+            float const depth = min_depth * std::pow(max_depth / min_depth, t);
+
+            float const screen_scale = lod_screen_scale(projection_scale, depth, object_scale);
+            // Independent of lod_screen_scale: the screen height spans 2 NDC units
+            float const expected_scale = std::abs(projection_scale) * object_scale / (2.0f * depth);
+            if (std::abs(screen_scale - expected_scale) > error_epsilon * expected_scale) { ++mismatches; }
+
+            stl::uint32_t const selected = select_lod(lod_span, screen_scale, current, settings);
+            mismatches += selected != reference_lod(lods, screen_scale, current, settings);
+            over_limit += lods[selected].error * screen_scale > settings.max_screen_error * (1.0f + error_epsilon);
+            wrong_direction += moving_away ? selected < current : selected > current;
+            if (selected > current) {
+                float const margin = settings.max_screen_error * (1.0f - settings.hysteresis);
+                inside_hysteresis += lods[selected].error * screen_scale > margin * (1.0f + error_epsilon);
+            }
+            if (selected != current) {
+                ++switches;
+                if (moving_away) { switch_depths.push_back(depth); }
+            }
+            current = selected;
+        }
+
+        // Jitter by half a percent around every switch distance. With the hysteresis the level may change once,
+        // but not flip back.
+        for (float depth : switch_depths) {
+            current = select_lod(lod_span, lod_screen_scale(projection_scale, depth * 0.99f, object_scale), 0, settings);
+            stl::uint32_t changes = 0;
+            for (int frame = 0; frame < 64; ++frame) {
+                float const jittered = depth * (frame % 2 ? 1.005f : 0.995f);
+                stl::uint32_t const selected = select_lod(lod_span,
+                    lod_screen_scale(projection_scale, jittered, object_scale), current, settings);
+                changes += selected != current;
+                current = selected;
+            }
+            flickers += changes > 1;
+        }
+    }
+
+    std::cout << "LOD selection: " << object_count << " objects, " << switches << " level switches, " << mismatches
+              << " differ from the reference, " << over_limit << " over the error limit, " << wrong_direction
+              << " in the wrong direction, " << inside_hysteresis << " inside the hysteresis margin, " << flickers
+              << " flickering\n";
+    return mismatches == 0 && over_limit == 0 && wrong_direction == 0 && inside_hysteresis == 0 && flickers == 0
+        ? 0 : 1;
+}
+
+// Number of key bytes radix_sort has to sort by, the ones that aren't the same in all keys
+static stl::uint32_t varying_key_bytes(stl::vector<DrawItem> const& items) {
+    DrawKey differing = 0;
+    for (DrawItem const& item : items) { differing |= item.key ^ items[0].key; }
+    stl::uint32_t bytes = 0;
+    for (stl::uint32_t shift = 0; shift < 64; shift += 8) { bytes += ((differing >> shift) & 0xFF) != 0; }
+    return bytes;
+}
+
+// Sorts the items with radix_sort, and returns whether the result is the same as sorting them with std::stable_sort
+static bool radix_sort_matches(stl::vector<DrawItem>& items, stl::vector<DrawItem>& scratch) {
+    stl::vector<DrawItem> reference = items;
+    std::stable_sort(reference.begin(), reference.end(),
+        [](DrawItem const& lhs, DrawItem const& rhs) { return lhs.key < rhs.key; });
+    radix_sort(items, scratch);
+    return std::equal(items.begin(), items.end(), reference.begin(), reference.end(),
+        [](DrawItem const& lhs, DrawItem const& rhs) { return lhs.key == rhs.key && lhs.index == rhs.index; });
+}
+
+// A draw of the batching check, with the ids before remapping
+struct BatchedDraw {
+    stl::uint32_t material;
+    stl::uint32_t mesh;
+};
+
+// Counts the batches that differ from the runs of equal material and mesh in the sorted draws, looked up by their
+// original ids
+static stl::size_t wrong_batches(stl::vector<DrawItem> const& sorted, stl::vector<BatchedDraw> const& draws,
+    stl::vector<DrawBatch> const& batches) {
+    stl::size_t wrong = 0;
+    stl::size_t batch = 0;
+    for (stl::size_t i = 0; i < sorted.size(); ) {
+        BatchedDraw const& draw = draws[sorted[i].index];
+        stl::size_t end = i + 1;
+        while (end < sorted.size() && draws[sorted[end].index].material == draw.material
+            && draws[sorted[end].index].mesh == draw.mesh) {
+            ++end;
+        }
+        if (batch >= batches.size()) {
+            ++wrong;
+        } else {
+            DrawBatch const& actual = batches[batch];
+            wrong += actual.material_index != draw.material || actual.mesh_id != draw.mesh
+                || actual.first_instance != i || actual.instance_count != end - i;
+        }
+        ++batch;
+        i = end;
+    }
+    // Batches past the last run
+    if (batches.size() > batch) { wrong += batches.size() - batch; }
+    return wrong;
+}
+
+int check_batching() {
+    std::mt19937 random(check_seed);
+    auto uniform = [&random](float min, float max) { return std::uniform_real_distribution<float>(min, max)(random); };
+
+    constexpr stl::uint32_t sort_cases = 400;
+    constexpr stl::uint32_t frames = 100;
+    constexpr float max_depth = 1000.0f;
+
+    // Scratch is reused between sorts like in the render scene, so it is often larger than the items
+    stl::vector<DrawItem> scratch;
+    stl::vector<DrawItem> items;
+
+    // Generated keys. Every byte either has the same value in all keys or takes one of a few values, so most sorts
+    // skip passes, about half of them run an odd amount of passes, and equal keys test that the sort is stable.
+    stl::size_t sort_mismatches = 0;
+    stl::size_t skipped_pass_sorts = 0;
+    stl::size_t odd_pass_sorts = 0;
+    for (stl::uint32_t sort_case = 0; sort_case < sort_cases; ++sort_case) {
+        stl::uint32_t const count = sort_case < 4 ? sort_case : 1 + random() % 3000;
+        stl::uint32_t const varying_bytes = random() & 0xFF;
+        DrawKey const constant_key = (static_cast<DrawKey>(random()) << 32) | random();
+        stl::uint32_t const byte_values = 1 + random() % 8;
+
+        items.clear();
+        for (stl::uint32_t i = 0; i < count; ++i) {
+            DrawKey key = constant_key;
+            for (stl::uint32_t byte = 0; byte < 8; ++byte) {
+                if (!(varying_bytes & (1u << byte))) { continue; }
+                key &= ~(DrawKey(0xFF) << (byte * 8));
+                key |= static_cast<DrawKey>(random() % byte_values * 37 % 256) << (byte * 8);
+            }
+            items.push_back({ key, i });
+        }
+
+        if (count > 1) {
+            stl::uint32_t const passes = varying_key_bytes(items);
+            skipped_pass_sorts += passes < 8;
+            odd_pass_sorts += passes % 2;
+        }
+        sort_mismatches += !radix_sort_matches(items, scratch);
+    }
+
+    // Frames of draws with asset ids beyond the bits of a key, remapped, sorted and merged into batches like the
+    // render scene does. The restored batches have to match the runs of the draws' original ids.
+    DrawKeyRemap remap;
+    stl::vector<BatchedDraw> draws;
+    stl::vector<DrawBatch> batches;
+    stl::size_t batch_count = 0;
+    stl::size_t batch_mismatches = 0;
+    stl::size_t remap_failures = 0;
+    for (stl::uint32_t frame = 0; frame < frames; ++frame) {
+        stl::uint32_t const count = 1 + random() % 2000;
+        stl::uint32_t const materials = 1 + random() % 20;
+        stl::uint32_t const meshes = 1 + random() % 50;
+        // Sparse ids, so the dense indices differ from them. Mesh ids don't fit in a key without the remap.
+        stl::uint32_t const material_offset = random() % 100000;
+        stl::uint32_t const mesh_offset = max_draw_key_mesh + random() % 100000;
+
+        remap.clear();
+        draws.clear();
+        items.clear();
+        for (stl::uint32_t i = 0; i < count; ++i) {
+            BatchedDraw draw;
+            draw.material = material_offset + static_cast<stl::uint32_t>(random() % materials) * 31;
+            draw.mesh = mesh_offset + static_cast<stl::uint32_t>(random() % meshes) * 7;
+            draws.push_back(draw);
+            stl::uint32_t material = draw.material;
+            stl::uint32_t mesh = draw.mesh;
+            if (!remap.remap(material, mesh)) {
+                ++remap_failures;
+                continue;
+            }
+            // Depths outside [0, max_depth] are clamped
+            items.push_back({ make_draw_key(material, mesh, uniform(-10.0f, max_depth * 1.1f), max_depth), i });
+        }
+
+        sort_mismatches += !radix_sort_matches(items, scratch);
+        batches.clear();
+        build_batches(items, batches);
+        for (DrawBatch& batch : batches) {
+            remap.restore(batch);
+        }
+        batch_count += batches.size();
+        batch_mismatches += wrong_batches(items, draws, batches);
+    }
+
+    // One more material than a key can hold. The remap has to refuse it and leave the ids unchanged, which makes
+    // the render scene fall back to unsorted draws. After clear() the next frame has to fit again.
+    stl::size_t overflow_failures = 0;
+    remap.clear();
+    for (stl::uint32_t material = 0; material <= max_draw_key_material; ++material) {
+        stl::uint32_t remapped_material = material * 2;
+        stl::uint32_t mesh = 5;
+        overflow_failures += !remap.remap(remapped_material, mesh) || remapped_material != material || mesh != 0;
+    }
+    {
+        stl::uint32_t material = (max_draw_key_material + 1) * 2;
+        stl::uint32_t mesh = 5;
+        overflow_failures += remap.remap(material, mesh) || material != (max_draw_key_material + 1) * 2 || mesh != 5;
+    }
+    remap.clear();
+    {
+        stl::uint32_t material = (max_draw_key_material + 1) * 2;
+        stl::uint32_t mesh = 7;
+        overflow_failures += !remap.remap(material, mesh) || material != 0 || mesh != 0;
+        DrawBatch batch { material, mesh, 0, 1 };
+        remap.restore(batch);
+        overflow_failures += batch.material_index != (max_draw_key_material + 1) * 2 || batch.mesh_id != 7;
+    }
+
+    std::cout << "Draw batching: " << sort_cases + frames << " sorts, " << skipped_pass_sorts
+              << " with skipped passes, " << odd_pass_sorts << " with an odd amount of passes, " << sort_mismatches
+              << " differ from std::stable_sort, " << batch_count << " batches, " << batch_mismatches
+              << " wrong, " << remap_failures << " failed remaps, " << overflow_failures
+              << " wrong results around the remap limit\n";
+    return sort_mismatches == 0 && batch_mismatches == 0 && remap_failures == 0 && overflow_failures == 0 ? 0 : 1;
+}
+
+// Vertices of [triangle_count] random triangles of 8 floats each, like the meshes the OBJ importer creates
+static stl::vector<float> random_triangles(std::mt19937& random, stl::size_t triangle_count) {
+    std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+    stl::vector<float> vertices(stl::tags::reserve, triangle_count * 3 * 8);
+    for (stl::size_t i = 0; i < triangle_count * 3 * 8; ++i) {
+        vertices.push_back(distribution(random));
+    }
+    return vertices;
+}
+
+// Text mesh, see read_simple_mesh(). Printed with enough digits to read back the same floats.
+static bool write_text_mesh(fs::path const& path, stl::vector<float> const& vertices) {
+    std::ofstream file(path);
+    file.precision(9);
+    file << vertices.size() << " " << vertices.size() / 8 << "\n";
+    for (float value : vertices) { file << value << " "; }
+    return file.good();
+}
+
+// Uncompressed 32 bit TGA, which the texture importer reads without a compression library
+static bool write_tga(fs::path const& path, stl::uint32_t width, stl::uint32_t height, std::mt19937& random) {
+    std::ofstream file(path, std::ios::binary);
+    unsigned char header[18] = {};
+    header[2] = 2;
+    header[12] = static_cast<unsigned char>(width & 0xFF);
+    header[13] = static_cast<unsigned char>(width >> 8);
+    header[14] = static_cast<unsigned char>(height & 0xFF);
+    header[15] = static_cast<unsigned char>(height >> 8);
+    header[16] = 32;
+    // 8 alpha bits, rows stored top to bottom
+    header[17] = 0x28;
+    file.write(reinterpret_cast<char const*>(header), sizeof(header));
+    for (stl::uint32_t i = 0; i < width * height * 4; ++i) {
+        file.put(static_cast<char>(random() & 0xFF));
+    }
+    return file.good();
+}
+
+// Model with one object per triangle
+static bool write_obj(fs::path const& path, stl::vector<float> const& vertices) {
+    std::ofstream file(path);
+    file.precision(9);
+    for (stl::size_t triangle = 0; triangle < vertices.size() / 24; ++triangle) {
+        file << "o part" << triangle << "\n";
+        for (stl::size_t corner = 0; corner < 3; ++corner) {
+            float const* vertex = vertices.data() + (triangle * 3 + corner) * 8;
+            file << "v " << vertex[0] << " " << vertex[1] << " " << vertex[2] << "\n";
+        }
+        stl::size_t const first = triangle * 3 + 1;
+        file << "f " << first << " " << first + 1 << " " << first + 2 << "\n";
+    }
+    return file.good();
+}
+
+// An asset requested by check_async_loads
+template<typename T>
+struct RequestedAsset {
+    Handle<T> handle;
+    bool should_load = true;
+    // Meshes only, the bounds of the generated vertices
+    Bounds bounds;
+    // Asynchronous load calls made for the asset, each with a callback
+    stl::size_t requests = 0;
+    stl::size_t callbacks = 0;
+    // Callbacks that ran while the asset was still loading
+    stl::size_t early_callbacks = 0;
+};
+
+template<typename T>
+static assets::LoadCallback<T> count_callback(stl::vector<RequestedAsset<T>>& requested, stl::size_t index) {
+    ++requested[index].requests;
+    return [&requested, index](Handle<T> handle) {
+        ++requested[index].callbacks;
+        requested[index].early_callbacks += assets::get_load_state(handle) == assets::LoadState::Loading;
+    };
+}
+
+static bool same_bounds(Bounds const& a, Bounds const& b) {
+    constexpr float epsilon = 1e-4f;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (std::abs(a.center[axis] - b.center[axis]) > epsilon
+            || std::abs(a.extents[axis] - b.extents[axis]) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int check_async_loads() {
+    constexpr stl::size_t text_mesh_count = 240;
+    constexpr stl::size_t binary_mesh_count = 60;
+    constexpr stl::size_t texture_count = 60;
+    constexpr stl::size_t model_count = 30;
+    // Of each kind, this many are missing or unreadable files
+    constexpr stl::size_t broken_count = 8;
+    constexpr double timeout_seconds = 60.0;
+
+    std::error_code error;
+    fs::path const directory = fs::temp_directory_path(error) / "saturn_async_load_check";
+    fs::remove_all(directory, error);
+    fs::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Failed to create " << directory.generic_string() << "\n";
+        return 1;
+    }
+    // The generated files would only fill the cache, and cached loads would skip the importers
+    assets::set_asset_cache_directory({});
+
+    std::mt19937 random(check_seed);
+    std::uniform_int_distribution<stl::size_t> triangle_count(1, 64);
+    std::uniform_int_distribution<stl::uint32_t> texture_size(1, 64);
+    stl::vector<RequestedAsset<ph::Mesh>> meshes;
+    stl::vector<RequestedAsset<ph::Texture>> textures;
+    stl::vector<RequestedAsset<assets::Model>> models;
+    stl::vector<fs::path> mesh_paths;
+    stl::vector<fs::path> texture_paths;
+    stl::vector<fs::path> model_paths;
+    bool written = true;
+
+    for (stl::size_t i = 0; i < text_mesh_count + binary_mesh_count; ++i) {
+        bool const binary = i >= text_mesh_count;
+        fs::path const path = directory / ("mesh" + std::to_string(i) + (binary ? ".smesh" : ".txt"));
+        stl::vector<float> const vertices = random_triangles(random, triangle_count(random));
+        RequestedAsset<ph::Mesh> mesh;
+        mesh.bounds = compute_bounds(vertices.data(), vertices.size() / 8, 8);
+        // Half of the broken files hold text that isn't a mesh, the others are missing
+        constexpr stl::size_t broken_every = text_mesh_count / broken_count;
+        mesh.should_load = i % broken_every != 0;
+        if (!mesh.should_load) {
+            if (i / broken_every % 2 == 0) {
+                std::ofstream(path) << "not a mesh";
+            }
+        } else if (binary) {
+            assets::ImportedMesh imported;
+            imported.vertex_size = 8;
+            imported.vertices = vertices;
+            imported.indices = stl::vector<stl::uint32_t>(stl::tags::uninitialized, vertices.size() / 8);
+            std::iota(imported.indices.begin(), imported.indices.end(), 0);
+            imported.bounds = mesh.bounds;
+            written = written && assets::importers::write_binary_mesh(imported, path);
+        } else {
+            written = written && write_text_mesh(path, vertices);
+        }
+        meshes.push_back(mesh);
+        mesh_paths.push_back(path);
+    }
+
+    for (stl::size_t i = 0; i < texture_count; ++i) {
+        fs::path const path = directory / ("texture" + std::to_string(i) + ".tga");
+        RequestedAsset<ph::Texture> texture;
+        constexpr stl::size_t broken_every = texture_count / broken_count;
+        texture.should_load = i % broken_every != 0;
+        if (texture.should_load) {
+            // Braced initialization, so the sizes are generated in order on every compiler
+            stl::uint32_t const size[2] = { texture_size(random), texture_size(random) };
+            written = written && write_tga(path, size[0], size[1], random);
+        } else if (i / broken_every % 2 == 0) {
+            std::ofstream(path) << "not an image";
+        }
+        textures.push_back(texture);
+        texture_paths.push_back(path);
+    }
+
+    for (stl::size_t i = 0; i < model_count; ++i) {
+        fs::path const path = directory / ("model" + std::to_string(i) + ".obj");
+        RequestedAsset<assets::Model> model;
+        // Broken models are missing, Assimp reads almost any text as an empty OBJ
+        model.should_load = i % (model_count / broken_count) != 0;
+        if (model.should_load) {
+            written = written && write_obj(path, random_triangles(random, triangle_count(random) % 4 + 1));
+        }
+        models.push_back(model);
+        model_paths.push_back(path);
+    }
+
+    if (!written) {
+        std::cerr << "Failed to write the generated assets to " << directory.generic_string() << "\n";
+        return 1;
+    }
+
+    Scene scene;
+    // The first entity of a registry is the root of its hierarchy, scene files always start with it
+    scene.ecs.create_entity();
+    scene.blueprints.create_blueprint_entity();
+    Context ctx { nullptr, &scene };
+    ph::Mesh placeholder;
+    Handle<ph::Mesh> const default_mesh = assets::take_mesh(placeholder, "async_check_default_mesh", Bounds{});
+    assets::set_default_mesh(default_mesh);
+    assets::ImportedTexture blank;
+    blank.width = 1;
+    blank.height = 1;
+    blank.pixels.resize(4, 255);
+    Handle<ph::Texture> const default_texture = assets::take_texture(ctx, blank, "async_check_default_texture");
+    assets::set_default_texture(default_texture);
+
+    ecs::hierarchy const& blueprint_tree = scene.blueprints.get_hierarchy();
+    // Each check returns true if the asset still resolves to its placeholder
+    auto mesh_is_placeholder = [default_mesh](Handle<ph::Mesh> handle) {
+        return assets::get_mesh(handle) == assets::get_mesh(default_mesh) && !assets::get_mesh_bounds(handle)
+            && assets::get_mesh_lods(handle).empty();
+    };
+    auto texture_is_placeholder = [default_texture](Handle<ph::Texture> handle) {
+        return assets::get_texture(handle) == assets::get_texture(default_texture);
+    };
+    auto model_is_placeholder = [&blueprint_tree](Handle<assets::Model> handle) {
+        assets::Model const* model = assets::get_model(handle);
+        return model && !blueprint_tree.has_children(model->blueprint);
+    };
+
+    // Callbacks of a few meshes spawn an entity that draws the mesh, the way gameplay code places a loaded asset.
+    // The transform system and the render scene have to pick those entities up.
+    struct SpawnedEntity {
+        stl::size_t mesh;
+        ecs::entity_t entity;
+    };
+    stl::vector<SpawnedEntity> spawned;
+    auto spawn_callback = [&scene, &spawned](stl::size_t index) {
+        return [&scene, &spawned, index](Handle<ph::Mesh> handle) {
+            ecs::entity_t const entity = scene.ecs.create_entity();
+            components::Transform transform;
+            transform.position = glm::vec3(100.0f * static_cast<float>(index), 0.0f, 0.0f);
+            scene.ecs.add_component<components::Transform>(entity, transform);
+            scene.ecs.add_component<components::StaticMesh>(entity, components::StaticMesh{ handle });
+            scene.ecs.add_component<components::MeshRenderer>(entity, components::MeshRenderer{ { 0 } });
+            spawned.push_back(SpawnedEntity{ index, entity });
+        };
+    };
+
+    // Start all loads in one go, the way a scene with hundreds of assets does. Every fourth asset is requested a
+    // second time, which must return the same handle, and a few meshes are loaded synchronously while loading.
+    stl::size_t wrong_placeholders = 0;
+    stl::size_t wrong_handles = 0;
+    stl::size_t spawn_requests = 0;
+    for (stl::size_t i = 0; i < meshes.size(); ++i) {
+        Handle<ph::Mesh> const handle = assets::load_mesh_async(ctx, mesh_paths[i], count_callback(meshes, i));
+        meshes[i].handle = handle;
+        wrong_placeholders += assets::get_load_state(handle) != assets::LoadState::Loading
+            || !mesh_is_placeholder(handle);
+        if (i % 4 == 0) {
+            wrong_handles += assets::load_mesh_async(ctx, mesh_paths[i], count_callback(meshes, i)).id != handle.id;
+        }
+        if (i % 16 == 5) {
+            wrong_handles += assets::load_mesh(ctx, mesh_paths[i]).id != handle.id;
+        }
+        if (i % 16 == 9) {
+            wrong_handles += assets::load_mesh_async(ctx, mesh_paths[i], spawn_callback(i)).id != handle.id;
+            ++spawn_requests;
+        }
+    }
+    for (stl::size_t i = 0; i < textures.size(); ++i) {
+        Handle<ph::Texture> const handle = assets::load_texture_async(ctx, texture_paths[i],
+            count_callback(textures, i));
+        textures[i].handle = handle;
+        wrong_placeholders += assets::get_load_state(handle) != assets::LoadState::Loading
+            || !texture_is_placeholder(handle);
+        if (i % 4 == 0) {
+            wrong_handles += assets::load_texture_async(ctx, texture_paths[i], count_callback(textures, i)).id
+                != handle.id;
+        }
+    }
+    for (stl::size_t i = 0; i < models.size(); ++i) {
+        Handle<assets::Model> const handle = assets::load_model_async(ctx, model_paths[i], count_callback(models, i));
+        models[i].handle = handle;
+        wrong_placeholders += assets::get_load_state(handle) != assets::LoadState::Loading
+            || !model_is_placeholder(handle);
+        if (i % 4 == 0) {
+            wrong_handles += assets::load_model_async(ctx, model_paths[i], count_callback(models, i)).id
+                != handle.id;
+        }
+    }
+
+    // Run frames through a FramePipeline, which finishes loads at the start of every frame. Assets whose callbacks
+    // didn't run yet must still be loading and resolve to their placeholders.
+    auto check_unfinished = [&wrong_placeholders](auto const& requested, auto is_placeholder) {
+        for (auto const& asset : requested) {
+            if (asset.callbacks > 0) { continue; }
+            wrong_placeholders += assets::get_load_state(asset.handle) != assets::LoadState::Loading
+                || !is_placeholder(asset.handle);
+        }
+    };
+
+    ecs::system_manager systems;
+    systems::TransformSystem transform_system;
+    transform_system.startup(nullptr, scene);
+    FramePipeline pipeline(scene, systems, transform_system);
+    // The scene only attaches its own render scene when it loads a scene file
+    RenderScene render_scene;
+    render_scene.attach(scene.ecs);
+
+    using clock = std::chrono::steady_clock;
+    float const budget_ms = FrameSettings{}.asset_load_budget_ms;
+    clock::time_point const start = clock::now();
+    stl::size_t frames = 0;
+    double max_frame_ms = 0.0;
+    bool timed_out = false;
+    while (assets::get_pending_load_count() > 0) {
+        clock::time_point const frame_start = clock::now();
+        FrameContext frame_ctx { nullptr, scene, scene.ecs, nullptr, 1.0f / 60.0f };
+        pipeline.simulate(frame_ctx, frame_ctx.delta_time);
+        max_frame_ms = std::max(max_frame_ms,
+            std::chrono::duration<double, std::milli>(clock::now() - frame_start).count());
+        render_scene.update();
+        ++frames;
+
+        check_unfinished(meshes, mesh_is_placeholder);
+        check_unfinished(textures, texture_is_placeholder);
+        check_unfinished(models, model_is_placeholder);
+
+        if (std::chrono::duration<double>(clock::now() - start).count() > timeout_seconds) {
+            timed_out = true;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double const load_seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    // Every callback ran once, after its load finished, and the handles resolve to the loaded assets, or to the
+    // placeholders if the load failed
+    stl::size_t wrong_callbacks = 0;
+    stl::size_t wrong_states = 0;
+    stl::size_t wrong_assets = 0;
+    stl::size_t failed = 0;
+    auto check_finished = [&](auto const& requested, auto is_placeholder, auto is_loaded) {
+        for (auto const& asset : requested) {
+            wrong_callbacks += asset.callbacks != asset.requests || asset.early_callbacks != 0;
+            assets::LoadState const expected = asset.should_load ? assets::LoadState::Ready : assets::LoadState::Failed;
+            wrong_states += assets::get_load_state(asset.handle) != expected;
+            wrong_assets += asset.should_load ? !is_loaded(asset) : !is_placeholder(asset.handle);
+            failed += !asset.should_load;
+        }
+    };
+    check_finished(meshes, mesh_is_placeholder, [default_mesh](RequestedAsset<ph::Mesh> const& mesh) {
+        Bounds const* bounds = assets::get_mesh_bounds(mesh.handle);
+        return assets::get_mesh(mesh.handle) != assets::get_mesh(default_mesh) && bounds
+            && same_bounds(*bounds, mesh.bounds);
+    });
+    check_finished(textures, texture_is_placeholder, [default_texture](RequestedAsset<ph::Texture> const& texture) {
+        return assets::get_texture(texture.handle) != assets::get_texture(default_texture);
+    });
+    check_finished(models, model_is_placeholder, [&blueprint_tree](RequestedAsset<assets::Model> const& model) {
+        return blueprint_tree.has_children(assets::get_model(model.handle)->blueprint);
+    });
+
+    // Spawned entities got a WorldTransform, and the ones with a loaded mesh a draw in the spatial index
+    stl::size_t wrong_spawns = spawned.size() != spawn_requests;
+    for (SpawnedEntity const& entity : spawned) {
+        components::WorldTransform const* world = scene.ecs.has_component<components::WorldTransform>(entity.entity)
+            ? &scene.ecs.get_component<components::WorldTransform>(entity.entity) : nullptr;
+        glm::vec3 const position = scene.ecs.get_component<components::Transform>(entity.entity).position;
+        if (!world || std::abs(world->matrix[3].x - position.x) > 1e-3f) {
+            ++wrong_spawns;
+            continue;
+        }
+        if (!meshes[entity.mesh].should_load) { continue; }
+        // The generated vertices are within 10 units of the origin
+        AABB const around { position - glm::vec3(20.0f, 20.0f, 20.0f), position + glm::vec3(20.0f, 20.0f, 20.0f) };
+        stl::vector<ecs::entity_t> found;
+        render_scene.get_spatial_index().query_box(around, found);
+        wrong_spawns += std::find(found.begin(), found.end(), entity.entity) == found.end();
+    }
+
+    fs::remove_all(directory, error);
+
+    stl::size_t const total = meshes.size() + textures.size() + models.size();
+    std::cout << "Async loads: " << total << " assets (" << failed << " broken) in " << load_seconds << " s over "
+              << frames << " frames, at most " << max_frame_ms << " ms per frame with a load budget of " << budget_ms
+              << " ms, " << wrong_placeholders << " placeholders wrong while loading, " << wrong_handles
+              << " repeated loads with a different handle, " << wrong_callbacks << " wrong callback counts, "
+              << wrong_states << " wrong load states, " << wrong_assets << " handles resolving to the wrong asset, "
+              << wrong_spawns << " entities spawned by callbacks that weren't transformed or drawn"
+              << (timed_out ? ", timed out" : "") << "\n";
+    return !timed_out && wrong_placeholders == 0 && wrong_handles == 0 && wrong_callbacks == 0 && wrong_states == 0
+        && wrong_assets == 0 && wrong_spawns == 0 ? 0 : 1;
+}
+
+static bool write_file(fs::path const& path, std::string const& contents) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+    return file.good();
+}
+
+// Compares the meshes of two imports of a model, ignoring the levels of detail
+static bool same_meshes(assets::ImportedModel const& model, assets::ImportedModel const& reference) {
+    if (model.meshes.size() != reference.meshes.size()) { return false; }
+    for (stl::size_t i = 0; i < model.meshes.size(); ++i) {
+        Span<float const> const vertices = model.meshes[i].vertex_data();
+        Span<float const> const reference_vertices = reference.meshes[i].vertex_data();
+        Span<stl::uint32_t const> const indices = model.meshes[i].index_data();
+        Span<stl::uint32_t const> const reference_indices = reference.meshes[i].index_data();
+        if (vertices.size() != reference_vertices.size() || indices.size() != reference_indices.size()
+            || !std::equal(vertices.begin(), vertices.end(), reference_vertices.begin())
+            || !std::equal(indices.begin(), indices.end(), reference_indices.begin())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Outcome of looking up a model in the asset cache, in the terms of AssetCacheStats
+enum class CacheLookup {
+    Hit,
+    Miss,
+    Outdated,
+    // The cache counted nothing
+    None
+};
+
+static char const* cache_lookup_name(CacheLookup lookup) {
+    switch (lookup) {
+        case CacheLookup::Hit: return "a hit";
+        case CacheLookup::Miss: return "a miss";
+        case CacheLookup::Outdated: return "an outdated entry";
+        default: return "no counted lookup";
+    }
+}
+
+static CacheLookup get_cache_lookup(assets::AssetCacheStats const& before, assets::AssetCacheStats const& after) {
+    if (after.hits > before.hits) { return CacheLookup::Hit; }
+    if (after.invalidations > before.invalidations) { return CacheLookup::Outdated; }
+    if (after.misses > before.misses) { return CacheLookup::Miss; }
+    return CacheLookup::None;
+}
+
+int check_asset_cache() {
+    std::error_code error;
+    fs::path const directory = fs::temp_directory_path(error) / "saturn_asset_cache_check";
+    fs::path const cache_directory = directory / "cache";
+    fs::remove_all(directory, error);
+    fs::create_directories(cache_directory, error);
+    if (error) {
+        std::cerr << "Failed to create " << cache_directory.generic_string() << "\n";
+        return 1;
+    }
+    assets::set_asset_cache_directory(cache_directory);
+
+    // later.mtl doesn't exist at first. Creating it changes the import, so the parser records it as well.
+    fs::path const model_path = directory / "model.obj";
+    fs::path const library_path = directory / "model.mtl";
+    fs::path const missing_library_path = directory / "later.mtl";
+    std::string const model = "mtllib model.mtl\nmtllib later.mtl\no quad\nusemtl red\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n";
+    if (!write_file(model_path, model) || !write_file(library_path, "newmtl red\nKd 1 0 0\n")) {
+        std::cerr << "Failed to write the model files to " << directory.generic_string() << "\n";
+        return 1;
+    }
+
+    ThreadPool& pool = ThreadPool::get_default();
+    stl::size_t steps = 0;
+    stl::size_t failures = 0;
+    auto fail = [&failures](char const* step, std::string const& problem) {
+        std::cerr << "Asset cache, " << step << ": " << problem << "\n";
+        ++failures;
+    };
+    // Imports the model through the cache and checks how the cache answered, and that the result is the same as
+    // importing the current files without the cache
+    auto import_step = [&](char const* step, CacheLookup expected) {
+        ++steps;
+        assets::AssetCacheStats const before = assets::get_asset_cache_stats();
+        try {
+            assets::ImportedModel const imported = assets::importers::read_obj_model(model_path, pool);
+            CacheLookup const lookup = get_cache_lookup(before, assets::get_asset_cache_stats());
+            if (lookup != expected) {
+                fail(step, std::string("expected ") + cache_lookup_name(expected) + ", got "
+                    + cache_lookup_name(lookup));
+            }
+            if (!same_meshes(imported, assets::importers::parse_obj(model_path, pool))) {
+                fail(step, "the model differs from a fresh import");
+            }
+        } catch (std::runtime_error const& e) {
+            fail(step, e.what());
+        }
+    };
+    // The model has a single entry, textures would have their own
+    auto entry_path = [&cache_directory]() {
+        fs::path entry;
+        stl::size_t count = 0;
+        std::error_code error;
+        for (fs::directory_entry const& file : fs::directory_iterator(cache_directory, error)) {
+            if (file.path().extension() == ".cache") {
+                entry = file.path();
+                ++count;
+            }
+        }
+        return count == 1 ? entry : fs::path();
+    };
+
+    import_step("first import", CacheLookup::Miss);
+    import_step("second import", CacheLookup::Hit);
+
+    // Same contents with a later write time
+    fs::last_write_time(model_path, fs::last_write_time(model_path, error) + std::chrono::hours(1), error);
+    import_step("touched model", CacheLookup::Hit);
+
+    write_file(model_path, model + "v 0 2 0\nf 4 3 5\n");
+    import_step("changed model", CacheLookup::Outdated);
+    import_step("import after changing the model", CacheLookup::Hit);
+
+    write_file(library_path, "newmtl red\nKd 0 1 0\nNs 10\n");
+    import_step("changed material library", CacheLookup::Outdated);
+
+    write_file(missing_library_path, "newmtl blue\nKd 0 0 1\n");
+    import_step("created missing material library", CacheLookup::Outdated);
+    import_step("import after changing the libraries", CacheLookup::Hit);
+
+    // A different importer version or LOD settings give a different importer key
+    {
+        ++steps;
+        assets::AssetCacheStats const before = assets::get_asset_cache_stats();
+        char const other_settings[] = "other importer settings";
+        bool const found = assets::read_cached_model(model_path,
+            assets::hash_bytes(other_settings, sizeof(other_settings))).has_value();
+        CacheLookup const lookup = get_cache_lookup(before, assets::get_asset_cache_stats());
+        if (found || lookup != CacheLookup::Outdated) {
+            fail("other importer key", std::string("expected an outdated entry, got ") + cache_lookup_name(lookup));
+        }
+    }
+
+    fs::path entry = entry_path();
+    if (entry.empty()) {
+        fail("corrupted entries", "expected a single entry in " + cache_directory.generic_string());
+    } else {
+        fs::resize_file(entry, fs::file_size(entry, error) / 2, error);
+        import_step("truncated entry", CacheLookup::Outdated);
+
+        std::fstream file(entry, std::ios::binary | std::ios::in | std::ios::out);
+        file << "garbage";
+        file.close();
+        import_step("overwritten entry", CacheLookup::Outdated);
+
+        fs::remove(entry, error);
+        import_step("deleted entry", CacheLookup::Miss);
+        import_step("import after the corrupted entries", CacheLookup::Hit);
+    }
+
+    // The Assimp importer reads the same libraries through its own file system
+    ++steps;
+    try {
+        assets::ImportedModel const imported = assets::importers::read_assimp_model(model_path);
+        for (fs::path const& library : { library_path, missing_library_path }) {
+            bool const recorded = std::any_of(imported.dependencies.begin(), imported.dependencies.end(),
+                [&library](fs::path const& dependency) {
+                    std::error_code error;
+                    return fs::equivalent(dependency, library, error);
+                });
+            if (!recorded) {
+                fail("Assimp import", library.filename().generic_string() + " is missing from the dependencies");
+            }
+        }
+    } catch (std::runtime_error const& e) {
+        fail("Assimp import", e.what());
+    }
+
+    fs::remove_all(directory, error);
+
+    std::cout << "Asset cache: " << steps << " steps, " << failures << " failed\n";
+    return failures == 0 ? 0 : 1;
+}
+
+}
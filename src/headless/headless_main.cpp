@@ -0,0 +1,167 @@
+#include <saturn/core/headless_engine.hpp>
+#include <saturn/assets/importers/binary_mesh.hpp>
+#include <headless/benchmarks.hpp>
+#include <headless/checks.hpp>
+#include <saturn/utility/allocation_counter.hpp>
+
+#ifdef SATURN_BUILD_SAMPLES
+    #include <samples/rotator_system.hpp>
+    #include <samples/simd_rotator_system.hpp>
+#endif
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Usage: SaturnHeadless [--frames N] [--seconds S] [--real-clock] [--scene ecs.json] [--blueprints blueprints.json]
+//                      [--trace trace.json] [--pipelined] [--tick-rate HZ] [--no-interpolation]
+//                      [--load path]... [--asset-cache DIR | --no-asset-cache] [--simd-rotator]
+//        SaturnHeadless --convert-mesh source.txt|source.obj destination.smesh
+//        SaturnHeadless --benchmark-obj model.obj
+//        SaturnHeadless --benchmark-groups entity_count
+//        SaturnHeadless --benchmark-parallel entity_count
+//        SaturnHeadless --benchmark-assets asset_count
+//        SaturnHeadless --benchmark-mesh-load triangle_count
+//        SaturnHeadless --benchmark-aabb-tree
+//        SaturnHeadless --benchmark-rotator entity_count
+//        SaturnHeadless --check-culling
+//        SaturnHeadless --check-light-clusters
+//        SaturnHeadless --check-lod
+//        SaturnHeadless --check-batching
+//        SaturnHeadless --check-async-loads
+//        SaturnHeadless --check-asset-cache
+int main(int argc, char** argv) {
+    if (argc == 3 && !std::strcmp(argv[1], "--benchmark-obj")) {
+        return headless::benchmark_obj(argv[2]);
+    }
+
+    if (argc == 3 && !std::strcmp(argv[1], "--benchmark-groups")) {
+        return headless::benchmark_groups(std::strtoull(argv[2], nullptr, 10));
+    }
+
+    if (argc == 3 && !std::strcmp(argv[1], "--benchmark-parallel")) {
+        return headless::benchmark_parallel(std::strtoull(argv[2], nullptr, 10));
+    }
+
+    if (argc == 3 && !std::strcmp(argv[1], "--benchmark-assets")) {
+        return headless::benchmark_assets(std::strtoull(argv[2], nullptr, 10));
+    }
+
+    if (argc == 3 && !std::strcmp(argv[1], "--benchmark-mesh-load")) {
+        return headless::benchmark_mesh_load(std::strtoull(argv[2], nullptr, 10));
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--benchmark-aabb-tree")) {
+        return headless::benchmark_aabb_tree();
+    }
+
+    if (argc == 3 && !std::strcmp(argv[1], "--benchmark-rotator")) {
+        return headless::benchmark_rotator(std::strtoull(argv[2], nullptr, 10));
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--check-culling")) {
+        return headless::check_culling();
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--check-light-clusters")) {
+        return headless::check_light_clusters();
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--check-lod")) {
+        return headless::check_lod();
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--check-batching")) {
+        return headless::check_batching();
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--check-async-loads")) {
+        return headless::check_async_loads();
+    }
+
+    if (argc == 2 && !std::strcmp(argv[1], "--check-asset-cache")) {
+        return headless::check_asset_cache();
+    }
+
+    if (argc == 4 && !std::strcmp(argv[1], "--convert-mesh")) {
+        std::size_t const written = saturn::assets::importers::convert_to_binary_mesh(argv[2], argv[3]);
+        if (written == 0) {
+            std::cerr << "Failed to convert " << argv[2] << "\n";
+            return 1;
+        }
+        std::cout << "Wrote " << written << " binary mesh file(s)\n";
+        return 0;
+    }
+
+    saturn::HeadlessSettings settings;
+    bool simd_rotator = false;
+    for (int i = 1; i < argc; ++i) {
+        bool const has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--frames") && has_value) {
+            settings.max_frames = std::strtoull(argv[++i], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--seconds") && has_value) {
+            settings.max_seconds = std::strtod(argv[++i], nullptr);
+        } else if (!std::strcmp(argv[i], "--real-clock")) {
+            settings.fixed_timestep = false;
+        } else if (!std::strcmp(argv[i], "--scene") && has_value) {
+            settings.ecs_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--blueprints") && has_value) {
+            settings.blueprints_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--trace") && has_value) {
+            settings.trace_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--pipelined")) {
+            settings.frame.pipelined = true;
+        } else if (!std::strcmp(argv[i], "--tick-rate") && has_value) {
+            settings.frame.tick_rate = std::strtof(argv[++i], nullptr);
+        } else if (!std::strcmp(argv[i], "--no-interpolation")) {
+            settings.frame.interpolate = false;
+        } else if (!std::strcmp(argv[i], "--load") && has_value) {
+            settings.asset_paths.push_back(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--asset-cache") && has_value) {
+            settings.asset_cache_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--no-asset-cache")) {
+            settings.asset_cache_path.clear();
+        } else if (!std::strcmp(argv[i], "--simd-rotator")) {
+            simd_rotator = true;
+        } else {
+            std::cerr << "Unknown argument " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    saturn::HeadlessEngine engine(settings);
+#ifdef SATURN_BUILD_SAMPLES
+    if (simd_rotator) {
+        engine.get_systems().add_system<samples::SimdRotatorSystem>();
+    } else {
+        engine.get_systems().add_system<samples::RotatorSystem>();
+    }
+#else
+    (void)simd_rotator;
+#endif
+    saturn::HeadlessStats const stats = engine.run();
+
+    std::cout << "Frames: " << stats.frames << "\n"
+              << "Time: " << stats.total_seconds << " s\n"
+              << "Frame time (min / avg / max): " << stats.min_frame_ms << " / " << stats.average_frame_ms 
+              << " / " << stats.max_frame_ms << " ms\n"
+              << "Draws: " << stats.draws << ", lights: " << stats.lights << "\n";
+    if (saturn::is_counting_heap_allocations()) {
+        std::cout << "Heap allocations per frame (avg / max): " << stats.average_frame_allocations << " / "
+                  << stats.max_frame_allocations << "\n";
+    } else {
+        std::cout << "Heap allocations per frame: not counted, configure with SATURN_COUNT_ALLOCATIONS\n";
+    }
+    if (!settings.asset_paths.empty()) {
+        std::cout << "Assets loaded: " << stats.assets_loaded << ", failed: " << stats.assets_failed 
+                  << ", in " << stats.asset_load_seconds << " s\n";
+    }
+    if (!settings.asset_cache_path.empty()) {
+        saturn::assets::AssetCacheStats const& cache = stats.asset_cache;
+        std::cout << "Asset cache hits: " << cache.hits << ", misses: " << cache.misses << ", outdated: "
+                  << cache.invalidations << ", stored: " << cache.stores << " (" << cache.failed_stores 
+                  << " failed), read " << cache.bytes_read / 1024 << " KB, wrote " << cache.bytes_written / 1024 
+                  << " KB\n";
+    }
+    return 0;
+}
@@ -7,10 +7,20 @@ using namespace saturn::components;
 
 namespace samples {
 
+void RotatorSystem::declare_access(saturn::ecs::system_access& access) {
+    access.write<Transform>();
+    access.read<Rotator>();
+}
+
 void RotatorSystem::update(saturn::FrameContext& ctx) {
-    for (auto[transform, rotator] : ctx.ecs.view<Transform, Rotator>()) {
-        transform.rotation += rotator.axes * rotator.speed;
-    }
+    // Every entity only touches its own components, so this can run in parallel
+    ctx.ecs.view<Transform, Rotator>().par_chunks([&ctx](auto& chunk) {
+        for (auto it = chunk.begin(); it != chunk.end(); ++it) {
+            auto [transform, rotator] = *it;
+            transform.rotation += rotator.axes * rotator.speed;
+            ctx.ecs.mark_changed<Transform>(it.get_entity());
+        }
+    });
 }
 
 }
\ No newline at end of file
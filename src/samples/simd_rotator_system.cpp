@@ -0,0 +1,78 @@
+#include <samples/simd_rotator_system.hpp>
+
+#include <cstddef>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define SATURN_SAMPLES_SSE
+    #include <xmmintrin.h>
+#endif
+
+using namespace saturn::components;
+
+namespace samples {
+
+// The kernel loads a Rotator as 4 floats, and the rotation of a Transform together with scale.x as 4 floats.
+static_assert(sizeof(Rotator) == 4 * sizeof(float), "Rotator layout changed, update the SIMD kernel");
+static_assert(offsetof(Transform, scale) == offsetof(Transform, rotation) + 3 * sizeof(float),
+    "Transform layout changed, update the SIMD kernel");
+
+void rotate_scalar(saturn::Span<Transform> transforms, saturn::Span<Rotator> rotators) {
+    STL_ASSERT(transforms.size() == rotators.size(), "Span sizes differ");
+    for (stl::size_t i = 0; i < transforms.size(); ++i) {
+        transforms[i].rotation += rotators[i].axes * rotators[i].speed;
+    }
+}
+
+void rotate_simd(saturn::Span<Transform> transforms, saturn::Span<Rotator> rotators) {
+    STL_ASSERT(transforms.size() == rotators.size(), "Span sizes differ");
+    stl::size_t i = 0;
+#ifdef SATURN_SAMPLES_SSE
+    for (; i + 4 <= transforms.size(); i += 4) {
+        // After the transpose each register holds one field of 4 rotators.
+        float const* rotator_data = reinterpret_cast<float const*>(rotators.data() + i);
+        __m128 speed = _mm_loadu_ps(rotator_data);
+        __m128 axis_x = _mm_loadu_ps(rotator_data + 4);
+        __m128 axis_y = _mm_loadu_ps(rotator_data + 8);
+        __m128 axis_z = _mm_loadu_ps(rotator_data + 12);
+        _MM_TRANSPOSE4_PS(speed, axis_x, axis_y, axis_z);
+
+        // Transforms are strided. The fourth lane holds scale.x, which is written back unchanged.
+        Transform* const transform = transforms.data() + i;
+        __m128 rot_x = _mm_loadu_ps(&transform[0].rotation.x);
+        __m128 rot_y = _mm_loadu_ps(&transform[1].rotation.x);
+        __m128 rot_z = _mm_loadu_ps(&transform[2].rotation.x);
+        __m128 scale_x = _mm_loadu_ps(&transform[3].rotation.x);
+        _MM_TRANSPOSE4_PS(rot_x, rot_y, rot_z, scale_x);
+
+        rot_x = _mm_add_ps(rot_x, _mm_mul_ps(axis_x, speed));
+        rot_y = _mm_add_ps(rot_y, _mm_mul_ps(axis_y, speed));
+        rot_z = _mm_add_ps(rot_z, _mm_mul_ps(axis_z, speed));
+
+        _MM_TRANSPOSE4_PS(rot_x, rot_y, rot_z, scale_x);
+        _mm_storeu_ps(&transform[0].rotation.x, rot_x);
+        _mm_storeu_ps(&transform[1].rotation.x, rot_y);
+        _mm_storeu_ps(&transform[2].rotation.x, rot_z);
+        _mm_storeu_ps(&transform[3].rotation.x, scale_x);
+    }
+#endif
+    // Scalar tail, and the whole span on targets without SSE
+    rotate_scalar(transforms.subspan(i, transforms.size() - i), rotators.subspan(i, rotators.size() - i));
+}
+
+void SimdRotatorSystem::declare_access(saturn::ecs::system_access& access) {
+    access.write<Transform>();
+    access.read<Rotator>();
+}
+
+void SimdRotatorSystem::update(saturn::FrameContext& ctx) {
+    saturn::ecs::registry& ecs = ctx.ecs;
+    ecs.group<Transform, Rotator>().each_chunk([&ecs](saturn::Span<saturn::ecs::entity_t const> entities,
+            saturn::Span<Transform> transforms, saturn::Span<Rotator> rotators) {
+        rotate_simd(transforms, rotators);
+        for (saturn::ecs::entity_t entity : entities) {
+            ecs.mark_changed<Transform>(entity);
+        }
+    });
+}
+
+}
@@ -0,0 +1,366 @@
+#include <saturn/scene/aabb_tree.hpp>
+
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace saturn {
+
+// A balanced tree over 2^32 leaves is less than 64 levels deep, and traversals never hold more than
+// one entry per level plus one
+static constexpr stl::size_t max_traversal_depth = 64;
+
+static AABB merge(AABB const& a, AABB const& b) {
+    AABB result;
+    result.min = glm::vec3(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+    result.max = glm::vec3(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+    return result;
+}
+
+static bool contains(AABB const& outer, AABB const& inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+        && outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+static bool overlaps(AABB const& a, AABB const& b) {
+    return a.min.x <= b.max.x && a.max.x >= b.min.x 
+        && a.min.y <= b.max.y && a.max.y >= b.min.y 
+        && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+// Insertion cost metric. Proportional to the surface area, which is what the chance of a query hitting a box depends on.
+static float area(AABB const& box) {
+    float const x = box.max.x - box.min.x;
+    float const y = box.max.y - box.min.y;
+    float const z = box.max.z - box.min.z;
+    return x * y + y * z + z * x;
+}
+
+AABBTree::AABBTree(float margin) : margin(margin) {
+
+}
+
+stl::int32_t AABBTree::allocate_node() {
+    if (free_list != null_node) {
+        stl::int32_t const node = free_list;
+        free_list = nodes[node].parent;
+        nodes[node] = Node{};
+        nodes[node].height = 0;
+        return node;
+    }
+
+    nodes.emplace_back();
+    nodes.back().height = 0;
+    return static_cast<stl::int32_t>(nodes.size() - 1);
+}
+
+void AABBTree::free_node(stl::int32_t node) {
+    nodes[node] = Node{};
+    nodes[node].parent = free_list;
+    free_list = node;
+}
+
+stl::int32_t AABBTree::insert(AABB const& box, ecs::entity_t entity) {
+    stl::int32_t const leaf = allocate_node();
+    glm::vec3 const fat(margin, margin, margin);
+    nodes[leaf].box.min = box.min - fat;
+    nodes[leaf].box.max = box.max + fat;
+    nodes[leaf].entity = entity;
+    insert_leaf(leaf);
+    ++leaf_count;
+    return leaf;
+}
+
+void AABBTree::remove(stl::int32_t proxy) {
+    STL_ASSERT(proxy >= 0 && proxy < static_cast<stl::int32_t>(nodes.size()) && nodes[proxy].is_leaf() 
+        && nodes[proxy].height == 0, "Invalid proxy");
+    remove_leaf(proxy);
+    free_node(proxy);
+    --leaf_count;
+}
+
+bool AABBTree::move(stl::int32_t proxy, AABB const& box) {
+    STL_ASSERT(proxy >= 0 && proxy < static_cast<stl::int32_t>(nodes.size()) && nodes[proxy].is_leaf() 
+        && nodes[proxy].height == 0, "Invalid proxy");
+    if (contains(nodes[proxy].box, box)) { return false; }
+
+    remove_leaf(proxy);
+    glm::vec3 const fat(margin, margin, margin);
+    nodes[proxy].box.min = box.min - fat;
+    nodes[proxy].box.max = box.max + fat;
+    insert_leaf(proxy);
+    return true;
+}
+
+void AABBTree::clear() {
+    nodes.clear();
+    root = null_node;
+    free_list = null_node;
+    leaf_count = 0;
+}
+
+void AABBTree::insert_leaf(stl::int32_t leaf) {
+    if (root == null_node) {
+        root = leaf;
+        nodes[leaf].parent = null_node;
+        return;
+    }
+
+    // Walk down to the sibling that increases the total area the least. The cost of descending into a child is
+    // the area the child grows by, plus the growth of all ancestors that was already committed to.
+    AABB const leaf_box = nodes[leaf].box;
+    stl::int32_t index = root;
+    while (!nodes[index].is_leaf()) {
+        Node const& node = nodes[index];
+        float const node_area = area(node.box);
+        float const combined_area = area(merge(node.box, leaf_box));
+
+        // Cost of making a new parent for this node and the leaf
+        float const cost = 2.0f * combined_area;
+        float const inheritance_cost = 2.0f * (combined_area - node_area);
+
+        auto descend_cost = [&](stl::int32_t child) {
+            Node const& child_node = nodes[child];
+            float const merged = area(merge(leaf_box, child_node.box));
+            if (child_node.is_leaf()) {
+                return merged + inheritance_cost;
+            }
+            return merged - area(child_node.box) + inheritance_cost;
+        };
+
+        float const cost_left = descend_cost(node.left);
+        float const cost_right = descend_cost(node.right);
+        if (cost < cost_left && cost < cost_right) { break; }
+
+        index = cost_left < cost_right ? node.left : node.right;
+    }
+
+    stl::int32_t const sibling = index;
+    stl::int32_t const old_parent = nodes[sibling].parent;
+    // May reallocate the node array, so no references are held across this
+    stl::int32_t const new_parent = allocate_node();
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].box = merge(leaf_box, nodes[sibling].box);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].left = sibling;
+    nodes[new_parent].right = leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    if (old_parent == null_node) {
+        root = new_parent;
+    } else if (nodes[old_parent].left == sibling) {
+        nodes[old_parent].left = new_parent;
+    } else {
+        nodes[old_parent].right = new_parent;
+    }
+
+    refit_upwards(nodes[leaf].parent);
+}
+
+void AABBTree::remove_leaf(stl::int32_t leaf) {
+    if (leaf == root) {
+        root = null_node;
+        return;
+    }
+
+    stl::int32_t const parent = nodes[leaf].parent;
+    stl::int32_t const grandparent = nodes[parent].parent;
+    stl::int32_t const sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    // The sibling takes the place of the parent
+    nodes[sibling].parent = grandparent;
+    free_node(parent);
+    nodes[leaf].parent = null_node;
+    if (grandparent == null_node) {
+        root = sibling;
+        return;
+    }
+
+    if (nodes[grandparent].left == parent) {
+        nodes[grandparent].left = sibling;
+    } else {
+        nodes[grandparent].right = sibling;
+    }
+    refit_upwards(grandparent);
+}
+
+void AABBTree::refit_upwards(stl::int32_t node) {
+    while (node != null_node) {
+        node = balance(node);
+
+        Node& current = nodes[node];
+        current.height = 1 + std::max(nodes[current.left].height, nodes[current.right].height);
+        current.box = merge(nodes[current.left].box, nodes[current.right].box);
+        node = current.parent;
+    }
+}
+
+stl::int32_t AABBTree::balance(stl::int32_t a) {
+    Node& node_a = nodes[a];
+    if (node_a.is_leaf() || node_a.height < 2) { return a; }
+
+    stl::int32_t const b = node_a.left;
+    stl::int32_t const c = node_a.right;
+    stl::int32_t const difference = nodes[c].height - nodes[b].height;
+    if (difference >= -1 && difference <= 1) { return a; }
+
+    // Rotate the higher child up. It takes the place of a, and a gets the lower grandchild.
+    bool const right_heavy = difference > 1;
+    stl::int32_t const up = right_heavy ? c : b;
+    stl::int32_t const other = right_heavy ? b : c;
+    Node& node_up = nodes[up];
+    stl::int32_t const f = node_up.left;
+    stl::int32_t const g = node_up.right;
+
+    node_up.left = a;
+    node_up.parent = node_a.parent;
+    node_a.parent = up;
+    if (node_up.parent == null_node) {
+        root = up;
+    } else if (nodes[node_up.parent].left == a) {
+        nodes[node_up.parent].left = up;
+    } else {
+        nodes[node_up.parent].right = up;
+    }
+
+    // The higher grandchild stays with up, the lower one replaces up as a child of a
+    stl::int32_t const keep = nodes[f].height > nodes[g].height ? f : g;
+    stl::int32_t const give = keep == f ? g : f;
+    node_up.right = keep;
+    if (right_heavy) {
+        node_a.right = give;
+    } else {
+        node_a.left = give;
+    }
+    nodes[give].parent = a;
+
+    node_a.box = merge(nodes[other].box, nodes[give].box);
+    node_a.height = 1 + std::max(nodes[other].height, nodes[give].height);
+    node_up.box = merge(node_a.box, nodes[keep].box);
+    node_up.height = 1 + std::max(node_a.height, nodes[keep].height);
+    return up;
+}
+
+template<typename Test>
+void AABBTree::query(Test&& test, stl::vector<ecs::entity_t>& result) const {
+    if (root == null_node) { return; }
+
+    struct Entry {
+        stl::int32_t node;
+        // Set when an ancestor was fully inside the shape
+        bool inside;
+    };
+    Entry stack[max_traversal_depth];
+    stl::size_t count = 0;
+    stack[count++] = { root, false };
+
+    while (count > 0) {
+        Entry const entry = stack[--count];
+        Node const& node = nodes[entry.node];
+
+        bool inside = entry.inside;
+        if (!inside) {
+            Overlap const overlap = test(node.box);
+            if (overlap == Overlap::outside) { continue; }
+            inside = overlap == Overlap::inside;
+        }
+
+        if (node.is_leaf()) {
+            result.push_back(node.entity);
+            continue;
+        }
+
+        STL_ASSERT(count + 2 <= max_traversal_depth, "AABB tree is too deep");
+        stack[count++] = { node.right, inside };
+        stack[count++] = { node.left, inside };
+    }
+}
+
+void AABBTree::query_box(AABB const& box, stl::vector<ecs::entity_t>& result) const {
+    query([&box](AABB const& node) {
+        if (!overlaps(node, box)) { return Overlap::outside; }
+        return contains(box, node) ? Overlap::inside : Overlap::intersects;
+    }, result);
+}
+
+void AABBTree::query_sphere(glm::vec3 center, float radius, stl::vector<ecs::entity_t>& result) const {
+    float const radius_sq = radius * radius;
+    query([center, radius_sq](AABB const& node) {
+        // Distance from the center to the closest and the farthest point of the box
+        float closest_sq = 0.0f;
+        float farthest_sq = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            float const min_delta = node.min[axis] - center[axis];
+            float const max_delta = center[axis] - node.max[axis];
+            float const closest = std::max(std::max(min_delta, max_delta), 0.0f);
+            float const farthest = std::max(std::abs(min_delta), std::abs(max_delta));
+            closest_sq += closest * closest;
+            farthest_sq += farthest * farthest;
+        }
+        if (closest_sq > radius_sq) { return Overlap::outside; }
+        return farthest_sq <= radius_sq ? Overlap::inside : Overlap::intersects;
+    }, result);
+}
+
+void AABBTree::query_frustum(Frustum const& frustum, stl::vector<ecs::entity_t>& result) const {
+    query([&frustum](AABB const& node) {
+        glm::vec3 const center = (node.min + node.max) * 0.5f;
+        glm::vec3 const extents = (node.max - node.min) * 0.5f;
+        Overlap overlap = Overlap::inside;
+        for (glm::vec4 const& plane : frustum.planes) {
+            float const distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            float const projected_extent = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y 
+                + std::abs(plane.z) * extents.z;
+            if (distance + projected_extent < 0.0f) { return Overlap::outside; }
+            if (distance - projected_extent < 0.0f) { overlap = Overlap::intersects; }
+        }
+        return overlap;
+    }, result);
+}
+
+void AABBTree::query_ray(glm::vec3 origin, glm::vec3 direction, float max_distance, stl::vector<RayHit>& hits) const {
+    if (root == null_node) { return; }
+
+    // Division by zero gives infinities, which the slab test handles
+    glm::vec3 const inverse_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    auto entry_distance = [&](AABB const& box) {
+        float near = 0.0f;
+        float far = max_distance;
+        for (int axis = 0; axis < 3; ++axis) {
+            float t0 = (box.min[axis] - origin[axis]) * inverse_direction[axis];
+            float t1 = (box.max[axis] - origin[axis]) * inverse_direction[axis];
+            if (t0 > t1) { std::swap(t0, t1); }
+            // Written so NaNs from 0 * infinity keep the current interval
+            near = t0 > near ? t0 : near;
+            far = t1 < far ? t1 : far;
+        }
+        return near <= far ? near : -1.0f;
+    };
+
+    stl::size_t const first_hit = hits.size();
+    stl::int32_t stack[max_traversal_depth];
+    stl::size_t count = 0;
+    stack[count++] = root;
+    while (count > 0) {
+        Node const& node = nodes[stack[--count]];
+        float const distance = entry_distance(node.box);
+        if (distance < 0.0f) { continue; }
+
+        if (node.is_leaf()) {
+            hits.push_back({ node.entity, distance });
+            continue;
+        }
+
+        STL_ASSERT(count + 2 <= max_traversal_depth, "AABB tree is too deep");
+        stack[count++] = node.right;
+        stack[count++] = node.left;
+    }
+
+    std::sort(hits.begin() + first_hit, hits.end(), [](RayHit const& lhs, RayHit const& rhs) {
+        return lhs.distance < rhs.distance;
+    });
+}
+
+} // namespace saturn
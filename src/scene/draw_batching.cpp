@@ -0,0 +1,122 @@
+#include <saturn/scene/draw_batching.hpp>
+
+#include <stl/assert.hpp>
+#include <stl/utility.hpp>
+
+#include <algorithm>
+#include <initializer_list>
+
+namespace saturn {
+
+static constexpr stl::uint32_t depth_bits = 24;
+static constexpr stl::uint32_t mesh_bits = 24;
+static constexpr stl::uint32_t max_depth_value = (1u << depth_bits) - 1;
+
+DrawKey make_draw_key(stl::uint32_t material_index, stl::uint32_t mesh_id, float depth, float max_depth) {
+    STL_ASSERT(material_index <= max_draw_key_material, "Material index does not fit in a draw key");
+    STL_ASSERT(mesh_id <= max_draw_key_mesh, "Mesh id does not fit in a draw key");
+
+    float const normalized = std::clamp(depth / max_depth, 0.0f, 1.0f);
+    stl::uint32_t const quantized_depth = static_cast<stl::uint32_t>(normalized * max_depth_value);
+
+    return (static_cast<DrawKey>(material_index) << (mesh_bits + depth_bits))
+        | (static_cast<DrawKey>(mesh_id) << depth_bits)
+        | quantized_depth;
+}
+
+void radix_sort(stl::vector<DrawItem>& items, stl::vector<DrawItem>& scratch) {
+    stl::size_t const count = items.size();
+    if (count <= 1) { return; }
+    scratch.resize(count);
+
+    DrawItem* source = items.data();
+    DrawItem* destination = scratch.data();
+    for (stl::uint32_t shift = 0; shift < 64; shift += 8) {
+        stl::size_t offsets[256] = {};
+        for (stl::size_t i = 0; i < count; ++i) {
+            ++offsets[(source[i].key >> shift) & 0xFF];
+        }
+
+        // All keys have the same byte, this pass wouldn't change the order
+        if (offsets[(source[0].key >> shift) & 0xFF] == count) { continue; }
+
+        stl::size_t total = 0;
+        for (stl::size_t& offset : offsets) {
+            stl::size_t const bucket_size = offset;
+            offset = total;
+            total += bucket_size;
+        }
+
+        for (stl::size_t i = 0; i < count; ++i) {
+            destination[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+
+    // After an odd amount of passes the result is in the scratch buffer
+    if (source != items.data()) {
+        std::copy(source, source + count, items.data());
+    }
+}
+
+void build_batches(stl::vector<DrawItem> const& sorted, stl::vector<DrawBatch>& batches) {
+    for (stl::size_t i = 0; i < sorted.size(); ) {
+        // Material and mesh bits, the depth doesn't matter for batching
+        DrawKey const state = sorted[i].key >> depth_bits;
+        stl::size_t end = i + 1;
+        while (end < sorted.size() && (sorted[end].key >> depth_bits) == state) {
+            ++end;
+        }
+
+        DrawBatch batch;
+        batch.material_index = static_cast<stl::uint32_t>(state >> mesh_bits);
+        batch.mesh_id = static_cast<stl::uint32_t>(state & max_draw_key_mesh);
+        batch.first_instance = i;
+        batch.instance_count = end - i;
+        batches.push_back(batch);
+
+        i = end;
+    }
+}
+
+void DrawKeyRemap::clear() {
+    for (Table* table : { &materials, &meshes }) {
+        for (stl::uint32_t id : table->ids) {
+            table->dense[id] = unused;
+        }
+        table->ids.clear();
+    }
+}
+
+bool DrawKeyRemap::remap(stl::uint32_t& material_index, stl::uint32_t& mesh_id) {
+    stl::uint32_t material = material_index;
+    stl::uint32_t mesh = mesh_id;
+    if (!remap(materials, material, max_draw_key_material) || !remap(meshes, mesh, max_draw_key_mesh)) {
+        return false;
+    }
+    material_index = material;
+    mesh_id = mesh;
+    return true;
+}
+
+void DrawKeyRemap::restore(DrawBatch& batch) const {
+    STL_ASSERT(batch.material_index < materials.ids.size() && batch.mesh_id < meshes.ids.size(),
+        "Batch was not built from remapped keys");
+    batch.material_index = materials.ids[batch.material_index];
+    batch.mesh_id = meshes.ids[batch.mesh_id];
+}
+
+bool DrawKeyRemap::remap(Table& table, stl::uint32_t& id, stl::uint32_t max_dense) {
+    if (id >= table.dense.size()) {
+        table.dense.resize(id + 1, unused);
+    }
+    if (table.dense[id] == unused) {
+        if (table.ids.size() > max_dense) { return false; }
+        table.dense[id] = static_cast<stl::uint32_t>(table.ids.size());
+        table.ids.push_back(id);
+    }
+    id = table.dense[id];
+    return true;
+}
+
+} // namespace saturn
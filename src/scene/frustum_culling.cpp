@@ -0,0 +1,150 @@
+#include <saturn/scene/frustum_culling.hpp>
+
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define SATURN_CULLING_SSE
+    #include <xmmintrin.h>
+#endif
+
+namespace saturn {
+
+static glm::vec4 matrix_row(glm::mat4 const& m, int row) {
+    return glm::vec4(m[0][row], m[1][row], m[2][row], m[3][row]);
+}
+
+static glm::vec4 normalize_plane(glm::vec4 plane) {
+    float const length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+    return plane * (1.0f / length);
+}
+
+Frustum extract_frustum(glm::mat4 const& view_projection) {
+    glm::vec4 const x = matrix_row(view_projection, 0);
+    glm::vec4 const y = matrix_row(view_projection, 1);
+    glm::vec4 const z = matrix_row(view_projection, 2);
+    glm::vec4 const w = matrix_row(view_projection, 3);
+
+    Frustum frustum;
+    frustum.planes[0] = normalize_plane(w + x); // left
+    frustum.planes[1] = normalize_plane(w - x); // right
+    frustum.planes[2] = normalize_plane(w + y); // bottom
+    frustum.planes[3] = normalize_plane(w - y); // top
+    frustum.planes[4] = normalize_plane(w + z); // near
+    frustum.planes[5] = normalize_plane(w - z); // far
+    return frustum;
+}
+
+// Large enough to pass or fail every plane test, small enough that multiplying with a plane stays finite
+static constexpr float infinite_bounds = 1e30f;
+
+void FrustumCuller::resize(stl::size_t count) {
+    stl::size_t const old_size = size();
+    center_x.resize(count);
+    center_y.resize(count);
+    center_z.resize(count);
+    extent_x.resize(count);
+    extent_y.resize(count);
+    extent_z.resize(count);
+    radius.resize(count);
+    for (stl::size_t i = old_size; i < count; ++i) {
+        remove(i);
+    }
+}
+
+void FrustumCuller::set(stl::uint32_t index, Bounds const& local, glm::mat4 const& world) {
+    AABB const box = transform_bounds(local, world);
+    glm::vec3 const center((box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, 
+        (box.min.z + box.max.z) * 0.5f);
+    glm::vec3 const extents((box.max.x - box.min.x) * 0.5f, (box.max.y - box.min.y) * 0.5f, 
+        (box.max.z - box.min.z) * 0.5f);
+
+    // Non-uniform scale stretches the sphere, so scale the radius by the largest axis
+    float max_scale_sq = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        glm::vec4 const axis = world[column];
+        max_scale_sq = std::max(max_scale_sq, axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    }
+
+    set_world(index, center, extents, local.radius * std::sqrt(max_scale_sq));
+}
+
+void FrustumCuller::set_infinite(stl::uint32_t index) {
+    set_world(index, glm::vec3(0, 0, 0), glm::vec3(infinite_bounds, infinite_bounds, infinite_bounds), infinite_bounds);
+}
+
+void FrustumCuller::remove(stl::uint32_t index) {
+    set_world(index, glm::vec3(0, 0, 0), glm::vec3(0, 0, 0), -infinite_bounds);
+}
+
+void FrustumCuller::set_world(stl::uint32_t index, glm::vec3 center, glm::vec3 extents, float sphere_radius) {
+    STL_ASSERT(index < size(), "Culling index out of range");
+    center_x[index] = center.x;
+    center_y[index] = center.y;
+    center_z[index] = center.z;
+    extent_x[index] = extents.x;
+    extent_y[index] = extents.y;
+    extent_z[index] = extents.z;
+    radius[index] = sphere_radius;
+}
+
+void FrustumCuller::cull(Frustum const& frustum, stl::vector<stl::uint32_t>& visible) const {
+    stl::size_t const count = size();
+    stl::size_t i = 0;
+
+#ifdef SATURN_CULLING_SSE
+    __m128 const zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 const cx = _mm_loadu_ps(center_x.data() + i);
+        __m128 const cy = _mm_loadu_ps(center_y.data() + i);
+        __m128 const cz = _mm_loadu_ps(center_z.data() + i);
+        __m128 const ex = _mm_loadu_ps(extent_x.data() + i);
+        __m128 const ey = _mm_loadu_ps(extent_y.data() + i);
+        __m128 const ez = _mm_loadu_ps(extent_z.data() + i);
+        __m128 const r = _mm_loadu_ps(radius.data() + i);
+
+        // One bit per object, cleared as soon as the object is fully outside a plane
+        int inside = 0xF;
+        for (glm::vec4 const& plane : frustum.planes) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+
+            __m128 projected = _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(std::abs(plane.x))), 
+                _mm_mul_ps(ey, _mm_set1_ps(std::abs(plane.y))));
+            projected = _mm_add_ps(projected, _mm_mul_ps(ez, _mm_set1_ps(std::abs(plane.z))));
+
+            __m128 const sphere_inside = _mm_cmpge_ps(_mm_add_ps(distance, r), zero);
+            __m128 const box_inside = _mm_cmpge_ps(_mm_add_ps(distance, projected), zero);
+            inside &= _mm_movemask_ps(_mm_and_ps(sphere_inside, box_inside));
+            if (inside == 0) { break; }
+        }
+
+        for (stl::uint32_t k = 0; k < 4; ++k) {
+            if (inside & (1 << k)) {
+                visible.push_back(i + k);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        bool inside = true;
+        for (glm::vec4 const& plane : frustum.planes) {
+            float const distance = center_x[i] * plane.x + center_y[i] * plane.y + center_z[i] * plane.z + plane.w;
+            float const projected = extent_x[i] * std::abs(plane.x) + extent_y[i] * std::abs(plane.y) 
+                + extent_z[i] * std::abs(plane.z);
+            if (distance + radius[i] < 0.0f || distance + projected < 0.0f) {
+                inside = false;
+                break;
+            }
+        }
+
+        if (inside) {
+            visible.push_back(i);
+        }
+    }
+}
+
+} // namespace saturn
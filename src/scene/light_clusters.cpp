@@ -0,0 +1,239 @@
+#include <saturn/scene/light_clusters.hpp>
+
+#include <saturn/utility/thread_pool.hpp>
+
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SATURN_CLUSTERS_SSE
+    #include <emmintrin.h>
+#endif
+
+namespace saturn {
+
+// NDC coordinates are clamped to this before they are converted to tiles, so far off-screen lights can't overflow
+static constexpr float max_ndc = 2.0f;
+
+float light_range(float intensity, float cutoff) {
+    return std::sqrt(std::max(intensity, 0.0f) / cutoff);
+}
+
+LightClusters::LightClusters(LightClusterConfig const& config) : config(config) {
+    STL_ASSERT(config.near > 0.0f && config.far > config.near, "Invalid cluster depth range");
+    inverse_log_depth_ratio = 1.0f / std::log(config.far / config.near);
+    slice_scratch.resize(config.slices);
+}
+
+stl::uint32_t LightClusters::slice_of_depth(float depth) const {
+    if (depth <= config.near) { return 0; }
+    float const slice = std::log(depth / config.near) * inverse_log_depth_ratio * config.slices;
+    return std::min(static_cast<stl::uint32_t>(slice), config.slices - 1);
+}
+
+float LightClusters::slice_near(stl::uint32_t slice) const {
+    return config.near * std::pow(config.far / config.near, static_cast<float>(slice) / config.slices);
+}
+
+void LightClusters::build(Span<glm::vec3 const> positions, Span<float const> ranges, 
+    glm::mat4 const& view, glm::mat4 const& projection) {
+    STL_ASSERT(positions.size() == ranges.size(), "Every light needs a range");
+    stl::size_t const light_count = positions.size();
+
+    view_x.resize(light_count);
+    view_y.resize(light_count);
+    view_depth.resize(light_count);
+    range.resize(light_count);
+    for (stl::size_t i = 0; i < light_count; ++i) {
+        glm::vec4 const view_pos = view * glm::vec4(positions[i], 1.0f);
+        view_x[i] = view_pos.x;
+        view_y[i] = view_pos.y;
+        // The camera looks down -z
+        view_depth[i] = -view_pos.z;
+        range[i] = ranges[i];
+    }
+
+    // Give every slice the lights that overlap its depth range
+    for (SliceScratch& scratch : slice_scratch) {
+        scratch.lights.clear();
+    }
+    for (stl::uint32_t i = 0; i < light_count; ++i) {
+        float const min_depth = view_depth[i] - range[i];
+        float const max_depth = view_depth[i] + range[i];
+        if (max_depth < config.near || min_depth > config.far) { continue; }
+
+        stl::uint32_t const first = slice_of_depth(std::max(min_depth, config.near));
+        stl::uint32_t const last = slice_of_depth(std::min(max_depth, config.far));
+        for (stl::uint32_t slice = first; slice <= last; ++slice) {
+            slice_scratch[slice].lights.push_back(i);
+        }
+    }
+
+    // Every slice owns a contiguous range of clusters, so slices can be binned independently
+    cluster_ranges.resize(cluster_count());
+    float const scale_x = projection[0][0];
+    float const scale_y = projection[1][1];
+    ThreadPool& pool = ThreadPool::get_default();
+    pool.parallel_for(config.slices, 1, [this, scale_x, scale_y](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t slice = begin; slice < end; ++slice) {
+            bin_slice(slice, scale_x, scale_y);
+        }
+    });
+
+    // Concatenate the index lists of all slices
+    stl::uint32_t total = 0;
+    for (SliceScratch& scratch : slice_scratch) {
+        scratch.first_index = total;
+        total += scratch.indices.size();
+    }
+    light_indices.resize(total);
+
+    stl::uint32_t const clusters_per_slice = config.tiles_x * config.tiles_y;
+    pool.parallel_for(config.slices, 1, [this, clusters_per_slice](stl::size_t begin, stl::size_t end) {
+        for (stl::size_t slice = begin; slice < end; ++slice) {
+            SliceScratch const& scratch = slice_scratch[slice];
+            std::copy(scratch.indices.begin(), scratch.indices.end(), light_indices.begin() + scratch.first_index);
+            ClusterLightRange* slice_ranges = cluster_ranges.data() + slice * clusters_per_slice;
+            for (stl::uint32_t cluster = 0; cluster < clusters_per_slice; ++cluster) {
+                slice_ranges[cluster].offset += scratch.first_index;
+            }
+        }
+    });
+}
+
+// Projecting the box around the light onto the screen. x / depth is monotonic in both x and depth, so the
+// extremes of the projection are at the corners of the box.
+LightClusters::TileRect LightClusters::tile_rect(stl::uint32_t light, float slice_min, float slice_max, 
+    float scale_x, float scale_y) const {
+    float const r = range[light];
+    float const min_depth = std::max(view_depth[light] - r, slice_min);
+    float const max_depth = std::min(view_depth[light] + r, slice_max);
+
+    auto project = [min_depth, max_depth](float min, float max, float scale, stl::uint32_t tiles, 
+        stl::int32_t& first, stl::int32_t& last) {
+        float const a = scale * min;
+        float const b = scale * max;
+        float const lo = std::min(std::min(a / min_depth, a / max_depth), std::min(b / min_depth, b / max_depth));
+        float const hi = std::max(std::max(a / min_depth, a / max_depth), std::max(b / min_depth, b / max_depth));
+        float const lo_tile = (std::clamp(lo, -max_ndc, max_ndc) + 1.0f) * 0.5f * tiles;
+        float const hi_tile = (std::clamp(hi, -max_ndc, max_ndc) + 1.0f) * 0.5f * tiles;
+        first = std::max(static_cast<stl::int32_t>(std::floor(lo_tile)), 0);
+        last = std::min(static_cast<stl::int32_t>(std::floor(hi_tile)), static_cast<stl::int32_t>(tiles) - 1);
+    };
+
+    TileRect rect;
+    project(view_x[light] - r, view_x[light] + r, scale_x, config.tiles_x, rect.x0, rect.x1);
+    project(view_y[light] - r, view_y[light] + r, scale_y, config.tiles_y, rect.y0, rect.y1);
+    return rect;
+}
+
+#ifdef SATURN_CLUSTERS_SSE
+
+// SSE version of the projection in tile_rect(), for 4 lights at once. Returns floor(tile coordinate) of the
+// lowest and highest point.
+static void project_4(__m128 min, __m128 max, __m128 min_depth, __m128 max_depth, float scale, stl::uint32_t tiles,
+    __m128i& first, __m128i& last) {
+    __m128 const a = _mm_mul_ps(min, _mm_set1_ps(scale));
+    __m128 const b = _mm_mul_ps(max, _mm_set1_ps(scale));
+    __m128 const a_near = _mm_div_ps(a, min_depth);
+    __m128 const a_far = _mm_div_ps(a, max_depth);
+    __m128 const b_near = _mm_div_ps(b, min_depth);
+    __m128 const b_far = _mm_div_ps(b, max_depth);
+    __m128 lo = _mm_min_ps(_mm_min_ps(a_near, a_far), _mm_min_ps(b_near, b_far));
+    __m128 hi = _mm_max_ps(_mm_max_ps(a_near, a_far), _mm_max_ps(b_near, b_far));
+
+    __m128 const limit = _mm_set1_ps(max_ndc);
+    __m128 const neg_limit = _mm_set1_ps(-max_ndc);
+    lo = _mm_max_ps(_mm_min_ps(lo, limit), neg_limit);
+    hi = _mm_max_ps(_mm_min_ps(hi, limit), neg_limit);
+
+    // Tile coordinates are > -tiles after clamping, so offsetting by tiles makes truncation equal to floor
+    __m128 const half_tiles = _mm_set1_ps(0.5f * tiles);
+    __m128 const offset = _mm_set1_ps(static_cast<float>(tiles));
+    __m128 const lo_tile = _mm_add_ps(_mm_mul_ps(_mm_add_ps(lo, _mm_set1_ps(1.0f)), half_tiles), offset);
+    __m128 const hi_tile = _mm_add_ps(_mm_mul_ps(_mm_add_ps(hi, _mm_set1_ps(1.0f)), half_tiles), offset);
+    __m128i const int_offset = _mm_set1_epi32(static_cast<stl::int32_t>(tiles));
+    first = _mm_sub_epi32(_mm_cvttps_epi32(lo_tile), int_offset);
+    last = _mm_sub_epi32(_mm_cvttps_epi32(hi_tile), int_offset);
+}
+
+#endif
+
+void LightClusters::bin_slice(stl::uint32_t slice, float scale_x, float scale_y) {
+    SliceScratch& scratch = slice_scratch[slice];
+    float const slice_min = slice_near(slice);
+    float const slice_max = slice_near(slice + 1);
+
+    stl::size_t const count = scratch.lights.size();
+    scratch.rects.resize(count);
+    stl::size_t i = 0;
+
+#ifdef SATURN_CLUSTERS_SSE
+    for (; i + 4 <= count; i += 4) {
+        stl::uint32_t const* l = scratch.lights.data() + i;
+        __m128 const x = _mm_setr_ps(view_x[l[0]], view_x[l[1]], view_x[l[2]], view_x[l[3]]);
+        __m128 const y = _mm_setr_ps(view_y[l[0]], view_y[l[1]], view_y[l[2]], view_y[l[3]]);
+        __m128 const depth = _mm_setr_ps(view_depth[l[0]], view_depth[l[1]], view_depth[l[2]], view_depth[l[3]]);
+        __m128 const r = _mm_setr_ps(range[l[0]], range[l[1]], range[l[2]], range[l[3]]);
+
+        __m128 const min_depth = _mm_max_ps(_mm_sub_ps(depth, r), _mm_set1_ps(slice_min));
+        __m128 const max_depth = _mm_min_ps(_mm_add_ps(depth, r), _mm_set1_ps(slice_max));
+
+        __m128i x0, x1, y0, y1;
+        project_4(_mm_sub_ps(x, r), _mm_add_ps(x, r), min_depth, max_depth, scale_x, config.tiles_x, x0, x1);
+        project_4(_mm_sub_ps(y, r), _mm_add_ps(y, r), min_depth, max_depth, scale_y, config.tiles_y, y0, y1);
+
+        alignas(16) stl::int32_t values[4][4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(values[0]), x0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(values[1]), x1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(values[2]), y0);
+        _mm_store_si128(reinterpret_cast<__m128i*>(values[3]), y1);
+        for (stl::size_t k = 0; k < 4; ++k) {
+            TileRect& rect = scratch.rects[i + k];
+            rect.x0 = std::max(values[0][k], 0);
+            rect.x1 = std::min(values[1][k], static_cast<stl::int32_t>(config.tiles_x) - 1);
+            rect.y0 = std::max(values[2][k], 0);
+            rect.y1 = std::min(values[3][k], static_cast<stl::int32_t>(config.tiles_y) - 1);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        scratch.rects[i] = tile_rect(scratch.lights[i], slice_min, slice_max, scale_x, scale_y);
+    }
+
+    // Count the lights per cluster, turn the counts into offsets, then fill the lists
+    stl::uint32_t const tiles_x = config.tiles_x;
+    ClusterLightRange* ranges = cluster_ranges.data() + cluster_index(0, 0, slice);
+    std::fill(ranges, ranges + tiles_x * config.tiles_y, ClusterLightRange{ 0, 0 });
+    for (TileRect const& rect : scratch.rects) {
+        for (stl::int32_t y = rect.y0; y <= rect.y1; ++y) {
+            for (stl::int32_t x = rect.x0; x <= rect.x1; ++x) {
+                ++ranges[y * tiles_x + x].count;
+            }
+        }
+    }
+
+    stl::uint32_t total = 0;
+    for (stl::uint32_t cluster = 0; cluster < tiles_x * config.tiles_y; ++cluster) {
+        ranges[cluster].offset = total;
+        total += ranges[cluster].count;
+        // Counted again while filling
+        ranges[cluster].count = 0;
+    }
+
+    scratch.indices.resize(total);
+    for (stl::size_t light = 0; light < count; ++light) {
+        TileRect const& rect = scratch.rects[light];
+        for (stl::int32_t y = rect.y0; y <= rect.y1; ++y) {
+            for (stl::int32_t x = rect.x0; x <= rect.x1; ++x) {
+                ClusterLightRange& cluster = ranges[y * tiles_x + x];
+                scratch.indices[cluster.offset + cluster.count++] = scratch.lights[light];
+            }
+        }
+    }
+}
+
+} // namespace saturn
@@ -0,0 +1,31 @@
+#include <saturn/scene/lod_selection.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace saturn {
+
+// Objects closer than this are treated as being at this depth, which selects the full resolution mesh
+static constexpr float min_lod_depth = 0.001f;
+
+float lod_screen_scale(float projection_scale, float depth, float object_scale) {
+    // The projection maps the screen height to 2 units of NDC
+    return std::abs(projection_scale) * 0.5f * object_scale / std::max(depth, min_lod_depth);
+}
+
+stl::uint32_t select_lod(Span<assets::MeshLod const> lods, float screen_scale, stl::uint32_t current, 
+    LodSettings const& settings) {
+    stl::uint32_t selected = 0;
+    for (stl::uint32_t level = 1; level < lods.size(); ++level) {
+        float limit = settings.max_screen_error;
+        if (level > current) {
+            limit *= 1.0f - settings.hysteresis;
+        }
+
+        if (lods[level].error * screen_scale > limit) { break; }
+        selected = level;
+    }
+    return selected;
+}
+
+} // namespace saturn
@@ -0,0 +1,524 @@
+#include <saturn/scene/render_scene.hpp>
+
+#include <saturn/components/world_transform.hpp>
+#include <saturn/components/static_mesh.hpp>
+#include <saturn/components/mesh_renderer.hpp>
+#include <saturn/components/point_light.hpp>
+
+#include <saturn/assets/assets.hpp>
+
+#include <phobos/renderer/material.hpp>
+
+#include <glm/common.hpp>
+
+#include <stl/assert.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace saturn {
+
+using namespace components;
+
+// Far plane of the camera, used as the depth range for sorting draws
+static constexpr float max_draw_depth = 5000.0f;
+
+void RenderScene::slot_observer::on_construct(ecs::entity_t entity) {
+    // The slot is only created once the last required component is added
+    if (affects_draws && scene.has_draw_components(entity)) {
+        scene.pending_events.push_back({ entity, SlotEvent::create_draw });
+    }
+    if (affects_lights && scene.has_light_components(entity)) {
+        scene.pending_events.push_back({ entity, SlotEvent::create_light });
+    }
+}
+
+void RenderScene::slot_observer::on_remove(ecs::entity_t entity) {
+    if (affects_draws) { scene.pending_events.push_back({ entity, SlotEvent::free_draw }); }
+    if (affects_lights) { scene.pending_events.push_back({ entity, SlotEvent::free_light }); }
+}
+
+RenderScene::~RenderScene() {
+    detach();
+}
+
+void RenderScene::attach(ecs::registry& new_registry) {
+    detach();
+    registry = &new_registry;
+
+    registry->enable_change_tracking<WorldTransform>();
+    registry->enable_change_tracking<StaticMesh>();
+    registry->enable_change_tracking<MeshRenderer>();
+    registry->enable_change_tracking<PointLight>();
+
+    registry->add_observer<WorldTransform>(&world_transform_observer);
+    registry->add_observer<StaticMesh>(&static_mesh_observer);
+    registry->add_observer<MeshRenderer>(&mesh_renderer_observer);
+    registry->add_observer<PointLight>(&point_light_observer);
+
+    auto meshes = registry->view<WorldTransform, StaticMesh, MeshRenderer>();
+    for (auto it = meshes.begin(); it != meshes.end(); ++it) {
+        create_draw_slot(it.get_entity());
+    }
+
+    auto point_lights = registry->view<WorldTransform, PointLight>();
+    for (auto it = point_lights.begin(); it != point_lights.end(); ++it) {
+        create_light_slot(it.get_entity());
+    }
+}
+
+void RenderScene::detach() {
+    if (!registry) { return; }
+
+    registry->remove_observer<WorldTransform>(&world_transform_observer);
+    registry->remove_observer<StaticMesh>(&static_mesh_observer);
+    registry->remove_observer<MeshRenderer>(&mesh_renderer_observer);
+    registry->remove_observer<PointLight>(&point_light_observer);
+    registry = nullptr;
+    pending_events.clear();
+
+    draws.clear();
+    free_draws.clear();
+    dirty_draws.clear();
+    moving_draws.clear();
+    loading_draws.clear();
+    draw_slot_of.clear();
+    live_draws = 0;
+    culler.resize(0);
+    spatial_index.clear();
+
+    lights.clear();
+    free_lights.clear();
+    dirty_lights.clear();
+    moving_lights.clear();
+    light_slot_of.clear();
+    live_lights = 0;
+    lights_changed = true;
+
+    last_tick = 0;
+}
+
+void RenderScene::update(bool new_tick) {
+    STL_ASSERT(registry, "Render scene is not attached to a registry");
+
+    apply_pending_events();
+    if (new_tick) {
+        settle_moving_slots();
+    }
+
+    // Added components are stamped too, so this also fills the slots created since the last update
+    auto transforms = registry->view_changed<WorldTransform>(last_tick);
+    for (auto it = transforms.begin(); it != transforms.end(); ++it) {
+        mark_draw_dirty(it.get_entity());
+        mark_light_dirty(it.get_entity());
+    }
+
+    auto meshes = registry->view_changed<StaticMesh>(last_tick);
+    for (auto it = meshes.begin(); it != meshes.end(); ++it) {
+        mark_draw_dirty(it.get_entity());
+    }
+
+    auto renderers = registry->view_changed<MeshRenderer>(last_tick);
+    for (auto it = renderers.begin(); it != renderers.end(); ++it) {
+        mark_draw_dirty(it.get_entity());
+    }
+
+    auto point_lights = registry->view_changed<PointLight>(last_tick);
+    for (auto it = point_lights.begin(); it != point_lights.end(); ++it) {
+        mark_light_dirty(it.get_entity());
+    }
+
+    // Draws of meshes that were loading hold the default mesh, or none
+    if (assets::get_finished_load_count() != finished_loads) {
+        finished_loads = assets::get_finished_load_count();
+        for (stl::uint32_t slot : loading_draws) {
+            DrawSlot& draw = draws[slot];
+            draw.mesh_loading = false;
+            if (draw.entity != ecs::null_entity && !draw.dirty) {
+                draw.dirty = true;
+                dirty_draws.push_back(slot);
+            }
+        }
+        loading_draws.clear();
+    }
+
+    for (stl::uint32_t slot : dirty_draws) {
+        patch_draw_slot(slot);
+    }
+    dirty_draws.clear();
+
+    for (stl::uint32_t slot : dirty_lights) {
+        patch_light_slot(slot);
+    }
+    dirty_lights.clear();
+
+    last_tick = registry->get_tick();
+}
+
+void RenderScene::update_materials(ph::RenderGraph& graph) {
+    // Materials are never removed, so only new ones have to be copied
+    if (graph.materials.size() != assets::get_material_count()) {
+        graph.materials.clear();
+        for (ph::Material* material : assets::get_all_materials()) {
+            graph.materials.push_back(*material);
+        }
+    }
+}
+
+// Blends the columns of two transforms. Not a proper rotation interpolation, but the difference
+// is invisible for the small rotations of a single tick.
+static glm::mat4 interpolate_transform(glm::mat4 const& from, glm::mat4 const& to, float alpha) {
+    return from + (to - from) * alpha;
+}
+
+void RenderScene::fill_render_graph(ph::RenderGraph& graph, Frustum const* frustum, float alpha) {
+    bool const interpolate = alpha < 1.0f;
+    // Interpolated positions of moving lights change every frame
+    if (lights_changed || graph.point_lights.size() != live_lights || (interpolate && !moving_lights.empty())) {
+        graph.point_lights.clear();
+        light_positions.clear();
+        light_ranges.clear();
+        for (LightSlot const& slot : lights) {
+            if (slot.entity != ecs::null_entity) {
+                graph.point_lights.push_back(slot.light);
+                if (slot.moving && interpolate) {
+                    graph.point_lights.back().position = glm::mix(slot.previous_position, slot.light.position, alpha);
+                }
+                light_positions.push_back(graph.point_lights.back().position);
+                light_ranges.push_back(light_range(slot.light.intensity));
+            }
+        }
+        // Rebuild once more after interpolation, so the lights end up at their current position
+        lights_changed = interpolate && !moving_lights.empty();
+    }
+
+    if (frustum) {
+        light_clusters.build(Span<glm::vec3 const>(light_positions.data(), light_positions.size()),
+            Span<float const>(light_ranges.data(), light_ranges.size()), graph.view, graph.projection);
+    }
+
+    visible_slots.clear();
+    if (frustum) {
+        culler.cull(*frustum, visible_slots);
+    } else {
+        for (stl::uint32_t slot = 0; slot < draws.size(); ++slot) {
+            if (draws[slot].entity != ecs::null_entity) {
+                visible_slots.push_back(slot);
+            }
+        }
+    }
+    stats.tested = live_draws;
+    stats.visible = visible_slots.size();
+
+    // Sort the draws so the ones sharing a material and mesh are adjacent, then merge those into batches.
+    // Draw commands and transforms are emitted in sorted order, which makes the transforms of a batch contiguous.
+    // Keys hold dense per-frame indices instead of the asset ids, which can outgrow the bits of a key.
+    draw_items.clear();
+    draw_key_remap.clear();
+    bool keys_fit = true;
+    for (stl::uint32_t slot : visible_slots) {
+        DrawSlot& draw = draws[slot];
+        // Mesh is loading and there is no default mesh
+        if (!draw.draw_cmd.mesh) { continue; }
+        float depth = 0.0f;
+        if (frustum) {
+            // The camera looks down -z in view space
+            depth = -(graph.view * draw.transform[3]).z;
+            if (draw.lods.size() > 1) {
+                float const screen_scale = lod_screen_scale(graph.projection[1][1], depth, draw.lod_scale);
+                stl::uint32_t const lod = select_lod(draw.lods, screen_scale, draw.lod, lod_settings);
+                if (lod != draw.lod) {
+                    set_draw_lod(draw, lod);
+                }
+            }
+        }
+        stl::uint32_t material = draw.draw_cmd.material_index;
+        stl::uint32_t mesh = draw.mesh_id;
+        keys_fit = keys_fit && draw_key_remap.remap(material, mesh);
+        DrawKey const key = keys_fit ? make_draw_key(material, mesh, depth, max_draw_depth) : 0;
+        draw_items.push_back({ key, slot });
+    }
+
+    draw_batches.clear();
+    if (keys_fit) {
+        radix_sort(draw_items, sort_scratch);
+        build_batches(draw_items, draw_batches);
+        for (DrawBatch& batch : draw_batches) {
+            draw_key_remap.restore(batch);
+        }
+    } else {
+        // More distinct materials or meshes in view than a key can hold. Draw unsorted, one batch per draw.
+        for (stl::uint32_t i = 0; i < draw_items.size(); ++i) {
+            DrawSlot const& draw = draws[draw_items[i].index];
+            draw_batches.push_back({ draw.draw_cmd.material_index, draw.mesh_id, i, 1 });
+        }
+    }
+
+    // Culling and sorting use the current transforms, only the emitted transforms are interpolated
+    graph.transforms.clear();
+    graph.draw_commands.clear();
+    for (DrawItem const& item : draw_items) {
+        DrawSlot const& draw = draws[item.index];
+        if (draw.moving && interpolate) {
+            graph.transforms.push_back(interpolate_transform(draw.previous_transform, draw.transform, alpha));
+        } else {
+            graph.transforms.push_back(draw.transform);
+        }
+        graph.draw_commands.push_back(draw.draw_cmd);
+    }
+}
+
+void RenderScene::set_draw_lod(DrawSlot& draw, stl::uint32_t lod) {
+    draw.lod = lod;
+    draw.draw_cmd.mesh = draw.lod_meshes[lod];
+    draw.mesh_id = static_cast<stl::uint32_t>(draw.lods[lod].mesh.id + 1);
+}
+
+void RenderScene::apply_pending_events() {
+    for (PendingEvent const& pending : pending_events) {
+        switch (pending.event) {
+        case SlotEvent::create_draw:
+            // The components may have been removed again after the event was queued
+            if (has_draw_components(pending.entity)) { create_draw_slot(pending.entity); }
+            break;
+        case SlotEvent::free_draw:
+            free_draw_slot(pending.entity);
+            break;
+        case SlotEvent::create_light:
+            if (has_light_components(pending.entity)) { create_light_slot(pending.entity); }
+            break;
+        case SlotEvent::free_light:
+            free_light_slot(pending.entity);
+            break;
+        }
+    }
+    pending_events.clear();
+}
+
+void RenderScene::settle_moving_slots() {
+    // Slots that moved in the previous tick start interpolating from where they ended up. If they
+    // are patched again this update, they start moving again.
+    for (stl::uint32_t slot : moving_draws) {
+        DrawSlot& draw = draws[slot];
+        draw.previous_transform = draw.transform;
+        draw.moving = false;
+    }
+    moving_draws.clear();
+
+    for (stl::uint32_t slot : moving_lights) {
+        LightSlot& light = lights[slot];
+        light.previous_position = light.light.position;
+        light.moving = false;
+    }
+    if (!moving_lights.empty()) {
+        lights_changed = true;
+    }
+    moving_lights.clear();
+}
+
+bool RenderScene::has_draw_components(ecs::entity_t entity) const {
+    return registry->has_component<WorldTransform>(entity) 
+        && registry->has_component<StaticMesh>(entity) 
+        && registry->has_component<MeshRenderer>(entity);
+}
+
+bool RenderScene::has_light_components(ecs::entity_t entity) const {
+    return registry->has_component<WorldTransform>(entity) && registry->has_component<PointLight>(entity);
+}
+
+void RenderScene::create_draw_slot(ecs::entity_t entity) {
+    stl::uint32_t const index = ecs::entity_index(entity);
+    if (index >= draw_slot_of.size()) {
+        draw_slot_of.resize(index + 1, null_slot);
+    }
+    if (draw_slot_of[index] != null_slot) { return; }
+
+    stl::uint32_t slot;
+    if (!free_draws.empty()) {
+        slot = free_draws.back();
+        free_draws.pop_back();
+    } else {
+        slot = draws.size();
+        draws.emplace_back();
+        culler.resize(draws.size());
+    }
+
+    draws[slot].entity = entity;
+    draw_slot_of[index] = slot;
+    ++live_draws;
+    // Filled in by the next update
+    draws[slot].dirty = true;
+    dirty_draws.push_back(slot);
+}
+
+void RenderScene::free_draw_slot(ecs::entity_t entity) {
+    stl::uint32_t const index = ecs::entity_index(entity);
+    if (index >= draw_slot_of.size() || draw_slot_of[index] == null_slot) { return; }
+
+    stl::uint32_t const slot = draw_slot_of[index];
+    if (draws[slot].proxy != AABBTree::null_node) {
+        spatial_index.remove(draws[slot].proxy);
+    }
+    // Stays in moving_draws until the next tick, settling an unused slot is harmless
+    draws[slot] = DrawSlot{};
+    culler.remove(slot);
+    free_draws.push_back(slot);
+    draw_slot_of[index] = null_slot;
+    --live_draws;
+}
+
+void RenderScene::mark_draw_dirty(ecs::entity_t entity) {
+    stl::uint32_t const index = ecs::entity_index(entity);
+    if (index >= draw_slot_of.size() || draw_slot_of[index] == null_slot) { return; }
+
+    DrawSlot& draw = draws[draw_slot_of[index]];
+    if (draw.dirty) { return; }
+    draw.dirty = true;
+    dirty_draws.push_back(draw_slot_of[index]);
+}
+
+void RenderScene::patch_draw_slot(stl::uint32_t slot) {
+    DrawSlot& draw = draws[slot];
+    // The slot was freed after it was marked dirty
+    if (!draw.dirty || draw.entity == ecs::null_entity) { return; }
+    draw.dirty = false;
+
+    ecs::registry const& ecs = *registry;
+    WorldTransform const& world = ecs.get_component<WorldTransform>(draw.entity);
+    StaticMesh const& mesh = ecs.get_component<StaticMesh>(draw.entity);
+    MeshRenderer const& mesh_renderer = ecs.get_component<MeshRenderer>(draw.entity);
+
+    if (mesh_renderer.material.id >= 0) {
+        // We can do this since the material id's are in the same order as the material vector
+        draw.draw_cmd.material_index = mesh_renderer.material.id;
+    } else {
+        draw.draw_cmd.material_index = 0;
+    }
+    draw.transform = world.matrix;
+    if (draw.fresh) {
+        draw.previous_transform = world.matrix;
+        draw.fresh = false;
+    } else if (!draw.moving) {
+        draw.moving = true;
+        moving_draws.push_back(slot);
+    }
+
+    bool const mesh_loading = assets::get_load_state(mesh.mesh) == assets::LoadState::Loading;
+    if (mesh_loading && !draw.mesh_loading) {
+        loading_draws.push_back(slot);
+    }
+    draw.mesh_loading = mesh_loading;
+
+    Span<assets::MeshLod const> const lods = assets::get_mesh_lods(mesh.mesh);
+    if (lods.data() != draw.lods.data() || lods.size() != draw.lods.size()) {
+        draw.lods = lods;
+        draw.lod_meshes.clear();
+        for (assets::MeshLod const& lod : lods) {
+            draw.lod_meshes.push_back(assets::get_mesh(lod.mesh));
+        }
+    }
+    if (lods.empty()) {
+        draw.lod = 0;
+        draw.draw_cmd.mesh = assets::get_mesh(mesh.mesh);
+        draw.mesh_id = static_cast<stl::uint32_t>(mesh.mesh.id + 1);
+    } else {
+        // Keep the current level of detail, so moving objects don't lose their hysteresis
+        set_draw_lod(draw, draw.lod < lods.size() ? draw.lod : 0);
+    }
+
+    float max_scale_sq = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        glm::vec4 const axis = world.matrix[column];
+        max_scale_sq = std::max(max_scale_sq, axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    }
+    draw.lod_scale = std::sqrt(max_scale_sq);
+
+    // Meshes without bounds can't be culled, so they are always drawn
+    if (Bounds const* bounds = assets::get_mesh_bounds(mesh.mesh)) {
+        culler.set(slot, *bounds, world.matrix);
+        AABB const box = transform_bounds(*bounds, world.matrix);
+        if (draw.proxy == AABBTree::null_node) {
+            draw.proxy = spatial_index.insert(box, draw.entity);
+        } else {
+            spatial_index.move(draw.proxy, box);
+        }
+    } else {
+        culler.set_infinite(slot);
+        if (draw.proxy != AABBTree::null_node) {
+            spatial_index.remove(draw.proxy);
+            draw.proxy = AABBTree::null_node;
+        }
+    }
+}
+
+void RenderScene::create_light_slot(ecs::entity_t entity) {
+    stl::uint32_t const index = ecs::entity_index(entity);
+    if (index >= light_slot_of.size()) {
+        light_slot_of.resize(index + 1, null_slot);
+    }
+    if (light_slot_of[index] != null_slot) { return; }
+
+    stl::uint32_t slot;
+    if (!free_lights.empty()) {
+        slot = free_lights.back();
+        free_lights.pop_back();
+    } else {
+        slot = lights.size();
+        lights.emplace_back();
+    }
+
+    lights[slot].entity = entity;
+    light_slot_of[index] = slot;
+    ++live_lights;
+    lights[slot].dirty = true;
+    dirty_lights.push_back(slot);
+}
+
+void RenderScene::free_light_slot(ecs::entity_t entity) {
+    stl::uint32_t const index = ecs::entity_index(entity);
+    if (index >= light_slot_of.size() || light_slot_of[index] == null_slot) { return; }
+
+    stl::uint32_t const slot = light_slot_of[index];
+    lights[slot] = LightSlot{};
+    free_lights.push_back(slot);
+    light_slot_of[index] = null_slot;
+    --live_lights;
+    lights_changed = true;
+}
+
+void RenderScene::mark_light_dirty(ecs::entity_t entity) {
+    stl::uint32_t const index = ecs::entity_index(entity);
+    if (index >= light_slot_of.size() || light_slot_of[index] == null_slot) { return; }
+
+    LightSlot& light = lights[light_slot_of[index]];
+    if (light.dirty) { return; }
+    light.dirty = true;
+    dirty_lights.push_back(light_slot_of[index]);
+}
+
+void RenderScene::patch_light_slot(stl::uint32_t slot) {
+    LightSlot& light = lights[slot];
+    if (!light.dirty || light.entity == ecs::null_entity) { return; }
+    light.dirty = false;
+
+    ecs::registry const& ecs = *registry;
+    WorldTransform const& world = ecs.get_component<WorldTransform>(light.entity);
+    PointLight const& point_light = ecs.get_component<PointLight>(light.entity);
+
+    glm::vec3 const position = glm::vec3(world.matrix[3]);
+    if (light.fresh) {
+        light.previous_position = position;
+        light.fresh = false;
+    } else if (!light.moving) {
+        light.moving = true;
+        moving_lights.push_back(slot);
+    }
+    light.light.position = position;
+    light.light.ambient = point_light.ambient;
+    light.light.diffuse = point_light.diffuse;
+    light.light.specular = point_light.specular;
+    light.light.intensity = point_light.intensity;
+    lights_changed = true;
+}
+
+} // namespace saturn
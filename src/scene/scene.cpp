@@ -3,12 +3,15 @@
 #include <saturn/components/point_light.hpp>
 #include <saturn/components/static_mesh.hpp>
 #include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
 #include <saturn/components/camera.hpp>
 #include <saturn/components/mesh_renderer.hpp>
 #include <saturn/components/name.hpp>
 
 #include <stb/stb_image.h>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 
 #include <phobos/present/present_manager.hpp>
 
@@ -17,98 +20,108 @@
 #include <saturn/serialization/component_serializers.hpp>
 
 #include <saturn/utility/math.hpp>
+#include <saturn/utility/profiler.hpp>
 
 #include <saturn/meta/for_each_component.hpp>
 
-#include <stl/tuple.hpp>
-
 #include <fstream>
 
 namespace saturn {
 
 void Scene::init_demo_scene(ph::VulkanContext* ctx) {
+    load_scene(ctx, "data/ecs.json", "data/blueprints.json");
+}  
+
+void Scene::init_headless_scene(fs::path const& ecs_path, fs::path const& blueprints_path) {
+    load_scene(nullptr, ecs_path, blueprints_path);
+}
+
+void Scene::load_scene(ph::VulkanContext* ctx, fs::path const& ecs_path, fs::path const& blueprints_path) {
     using namespace components;
 
-    static Context context { ctx, this };
-    set_serialize_context(&context);
+    load_context = Context{ ctx, this };
+    set_serialize_context(&load_context);
 
     // Create default material that will be used when no material is found.
     // We do this before anything else to make sure it ends up with ID 0
     ph::Material material;
-    Handle<ph::Texture> default_texture = assets::load_texture(context, "data/textures/blank.png");
+    Handle<ph::Texture> default_texture = assets::load_texture(load_context, "data/textures/blank.png");
+    // Also stands in for textures that are still loading
+    assets::set_default_texture(default_texture);
     material.texture = assets::get_texture(default_texture);
     assets::take_material(material, "default_material");
 
-    load_from_file(ecs, "data/ecs.json");
-    load_from_file(blueprints, "data/blueprints.json");
+    load_from_file(ecs, ecs_path);
+    load_from_file(blueprints, blueprints_path);
 
-    load_assets(context);
+    // Loading replaced the registry, so this has to happen after it. Components added from here on
+    // show up in the render scene through component events.
+    render_scene.attach(ecs);
+
+    load_assets(load_context);
 
     // After the entire blueprint ecs has loaded, we can resolve references to the blueprints
     resolve_blueprint_references();
     // Set the main_camera variable. Note that we won't be using this anymore once we get multiple cameras working
     find_main_camera();
-}  
+}
 
 void Scene::build_render_graph(ph::FrameInfo& frame, ph::RenderGraph& graph) {
-    using namespace components;
-    
-    // Gather materials
-    for (auto material : assets::get_all_materials()) {
-        graph.materials.push_back(*material);
-    }
-
     auto& color_attachment = frame.present_manager->get_attachment("color1");
+    build_render_graph(graph, (float)color_attachment.get_width() / (float)color_attachment.get_height());
+}
 
-    // Setup camera data
-    for (auto [transform, camera] : ecs.view<Transform, Camera>()) {
-        graph.camera_pos = transform.position;
-        graph.view = glm::lookAt(transform.position, transform.position + camera.front, camera.up);
-        graph.projection = glm::perspective(camera.fov, 
-            (float)color_attachment.get_width() / (float)color_attachment.get_height(), 0.1f, 5000.0f);
-        // Flip projection because vulkan
-        graph.projection[1][1] *= -1;
-        // Only a single camera entity is supported atm
-        break;
-    }
+void Scene::build_render_graph(ph::RenderGraph& graph, float aspect_ratio) {
+    SATURN_PROFILE_SCOPE("Build render graph");
+    sync_render_scene(graph, aspect_ratio);
+    prepare_render_graph(graph);
+}
 
-    // Setup light data
-    for (auto const&[transform, light] : ecs.view<Transform, PointLight>()) {
-        ph::PointLight pt_light;
-        pt_light.position = transform.position;
-        pt_light.ambient = light.ambient;
-        pt_light.diffuse = light.diffuse;
-        pt_light.specular = light.specular;
-        pt_light.intensity = light.intensity;
+void Scene::sync_render_scene(ph::RenderGraph& graph, float aspect_ratio, bool new_tick) {
+    SATURN_PROFILE_SCOPE("Sync render scene");
+    using namespace components;
 
-        graph.point_lights.push_back(pt_light);
+    if (new_tick) {
+        previous_camera = camera;
     }
 
-    // Meshes to render
-    for (auto const&[transform, mesh, mesh_renderer] 
-        : ecs.view<Transform, StaticMesh, MeshRenderer>()) {
-        
-        ph::RenderGraph::DrawCommand draw_cmd;
-        if (mesh_renderer.material.id >= 0) {
-            // We can do this since the material id's are in the same order as the material vector
-            draw_cmd.material_index = mesh_renderer.material.id;
-        } else {
-            draw_cmd.material_index = 0;
-        }
-        draw_cmd.mesh = assets::get_mesh(mesh.mesh);
-
-        glm::mat4 model = glm::mat4(1.0);
-
-        model = glm::translate(model, transform.position);
-        model = glm::rotate(model, {glm::radians(transform.rotation.x),
-                                glm::radians(transform.rotation.y),
-                                glm::radians(transform.rotation.z)});
-        model = glm::scale(model, transform.scale);
+    // Only a single camera entity is supported atm
+    camera.valid = false;
+    for (auto [transform, cam] : ecs.view<Transform, Camera>()) {
+        camera = RenderCamera{ true, transform.position, cam.front, cam.up, cam.fov, aspect_ratio };
+        break;
+    }
+    if (!previous_camera.valid) {
+        previous_camera = camera;
+    }
 
+    // Patch what changed since the last sync
+    render_scene.update(new_tick);
+    render_scene.update_materials(graph);
+}
 
-        graph.transforms.push_back(stl::move(model));
-        graph.draw_commands.push_back(draw_cmd);
+void Scene::prepare_render_graph(ph::RenderGraph& graph, float alpha) {
+    SATURN_PROFILE_SCOPE("Prepare render graph");
+
+    if (camera.valid) {
+        glm::vec3 position = camera.position;
+        glm::vec3 front = camera.front;
+        glm::vec3 up = camera.up;
+        if (alpha < 1.0f) {
+            position = glm::mix(previous_camera.position, camera.position, alpha);
+            front = glm::normalize(glm::mix(previous_camera.front, camera.front, alpha));
+            up = glm::normalize(glm::mix(previous_camera.up, camera.up, alpha));
+        }
+        graph.camera_pos = position;
+        graph.view = glm::lookAt(position, position + front, up);
+        graph.projection = glm::perspective(camera.fov, camera.aspect_ratio, 0.1f, 5000.0f);
+        // Flip projection because vulkan
+        graph.projection[1][1] *= -1;
     }
+
+    // Hand the visible draws to the graph
+    Frustum const frustum = extract_frustum(graph.projection * graph.view);
+    render_scene.fill_render_graph(graph, camera.valid ? &frustum : nullptr, alpha);
 }
 
 void Scene::save_to_file(ecs::registry const& registry, fs::path const& path) {
@@ -127,15 +140,11 @@ void Scene::load_from_file(ecs::registry& registry, fs::path const& path) {
 
 void Scene::resolve_blueprint_references() {
     using namespace components;
-    auto instantiate_fun = [this](ecs::entity_t entity, stl::tree<ecs::entity_t>::const_traverse_info) -> stl::tuple<> {
+    for (ecs::entity_t entity : ecs.get_hierarchy().depth_sorted()) {
         if (ecs.has_component<BlueprintInstance>(entity)) {
             instantiate_blueprint(entity, ecs.get_component<BlueprintInstance>(entity).blueprint);
         }
-
-        return {};
-    };
-
-    ecs.get_entities().traverse(instantiate_fun);
+    }
 }
 
 namespace {
@@ -161,14 +170,11 @@ void Scene::instantiate_blueprint(ecs::entity_t entity, ecs::entity_t blueprint)
 
 
 void Scene::find_main_camera() {
-    auto find_camera_fun = [this](ecs::entity_t entity, stl::tree<ecs::entity_t>::const_traverse_info) -> stl::tuple<> {
+    for (ecs::entity_t entity : ecs.get_hierarchy().depth_sorted()) {
         if (ecs.has_component<components::Camera>(entity)) {
             main_camera = entity;
         }
-        return {};
-    };
-
-    ecs.get_entities().traverse(find_camera_fun);
+    }
 }
 
 void Scene::load_assets(Context& ctx) {
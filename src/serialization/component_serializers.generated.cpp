@@ -5,7 +5,7 @@
 #include <phobos/renderer/mesh.hpp>
 #include <phobos/renderer/texture.hpp>
 
-#include <stl/tuple.hpp>
+#include <stl/vector.hpp>
 
 #include <saturn/scene/scene.hpp>
 
@@ -234,19 +234,20 @@ static void do_serialize(registry const& ecs, nlohmann::json& j, entity_t entity
 }
 
 void serialize_from_entity(nlohmann::json& j, registry const& ecs, entity_t entity) {
-    auto entity_it = ecs.get_entities().find(entity);
+    // The json array the next entity is added to. The children of an entity are added to its "Children" array.
+    stl::vector<nlohmann::json*> arrays;
+    arrays.push_back(&j);
 
-    auto serialize_fun = [&ecs](entity_t entity, stl::tree<entity_t>::const_traverse_info const& info, nlohmann::json& j)
-        -> stl::tuple<nlohmann::json&> {
-        
+    auto serialize_fun = [&ecs, &arrays](entity_t entity) {
         nlohmann::json entity_j;
         entity_j["Children"] = nlohmann::json::array();
         do_serialize(ecs, entity_j, entity);
-        j.push_back(stl::move(entity_j));
-        return stl::tie(j.back()["Children"]);
+        nlohmann::json& array = *arrays.back();
+        array.push_back(stl::move(entity_j));
+        arrays.push_back(&array.back()["Children"]);
     };
-    
-   ecs.get_entities().traverse_from(entity_it, serialize_fun, j);
+
+    ecs.get_hierarchy().traverse(entity, serialize_fun, [&arrays](entity_t) { arrays.pop_back(); });
 }
 
 
@@ -260,7 +261,8 @@ void from_json(nlohmann::json const& j, registry& ecs) {
 void to_json(nlohmann::json& j, registry const& ecs) {
     j = nlohmann::json::array();
 
-    serialize_from_entity(j, ecs, ecs.get_entities().root()->data);
+    if (ecs.get_hierarchy().empty()) { return; }
+    serialize_from_entity(j, ecs, ecs.get_hierarchy().root());
 }
 
 }
\ No newline at end of file
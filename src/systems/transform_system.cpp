@@ -0,0 +1,130 @@
+#include <saturn/systems/transform_system.hpp>
+
+#include <saturn/components/transform.hpp>
+#include <saturn/components/world_transform.hpp>
+#include <saturn/scene/scene.hpp>
+#include <saturn/utility/math.hpp>
+#include <saturn/utility/thread_pool.hpp>
+#include <saturn/utility/frame_arena.hpp>
+
+#include <vector>
+
+namespace saturn::systems {
+
+using namespace components;
+
+// Amount of entities in one depth level processed by a single task
+static constexpr stl::size_t level_chunk_size = 256;
+
+TransformSystem::~TransformSystem() {
+    if (registry) {
+        registry->remove_observer<Transform>(&removed_transforms);
+    }
+}
+
+void TransformSystem::startup(ph::VulkanContext*, Scene& scene) {
+    // Existing components are stamped with the current tick, so everything is computed in the first update
+    scene.ecs.enable_change_tracking<Transform>();
+    scene.ecs.enable_change_tracking<WorldTransform>();
+    if (registry) {
+        registry->remove_observer<Transform>(&removed_transforms);
+    }
+    registry = &scene.ecs;
+    registry->add_observer<Transform>(&removed_transforms);
+}
+
+// The nearest ancestor with a WorldTransform, or null if there is none. A Transform is relative to this ancestor,
+// entities without a Transform in between don't affect their descendants.
+static ecs::entity_t transform_parent(ecs::registry const& ecs, ecs::entity_t entity) {
+    ecs::hierarchy const& hierarchy = ecs.get_hierarchy();
+    ecs::entity_t parent = hierarchy.parent(entity);
+    while (parent != ecs::null_entity && !ecs.has_component<WorldTransform>(parent)) {
+        parent = hierarchy.parent(parent);
+    }
+    return parent;
+}
+
+// Marks the descendants whose transform parent was this entity dirty. Children without a Transform are skipped,
+// so their descendants are marked instead.
+static void mark_transform_children_changed(ecs::registry& ecs, ecs::entity_t entity) {
+    ecs::hierarchy const& hierarchy = ecs.get_hierarchy();
+    for (ecs::entity_t child = hierarchy.first_child(entity); child != ecs::null_entity; 
+            child = hierarchy.next_sibling(child)) {
+        if (ecs.has_component<Transform>(child)) {
+            ecs.mark_changed<Transform>(child);
+        } else {
+            mark_transform_children_changed(ecs, child);
+        }
+    }
+}
+
+// Removes the WorldTransform of entities that lost their Transform, so they don't keep rendering at their last
+// position. Their children are now relative to the next ancestor with a WorldTransform, so they are marked dirty.
+static void remove_stale_world_transforms(ecs::registry& ecs, Span<ecs::entity_t const> removed) {
+    for (ecs::entity_t entity : removed) {
+        // Destroyed entities lost all their components already
+        if (!ecs.is_alive(entity) || ecs.has_component<Transform>(entity) || !ecs.has_component<WorldTransform>(entity)) {
+            continue;
+        }
+        ecs.remove_component<WorldTransform>(entity);
+        mark_transform_children_changed(ecs, entity);
+    }
+}
+
+static void update_world_transform(ecs::registry& ecs, ecs::entity_t entity, stl::uint64_t since) {
+    ecs::registry const& const_ecs = ecs;
+    if (!ecs.has_component<Transform>(entity) || !ecs.has_component<WorldTransform>(entity)) { return; }
+
+    ecs::entity_t const parent = transform_parent(ecs, entity);
+    bool const has_parent = parent != ecs::null_entity;
+
+    // The transform parent is on a level above, so it was already updated and stamped if it moved this frame
+    bool const dirty = ecs.changed_since<Transform>(entity, since) 
+        || (has_parent && ecs.changed_since<WorldTransform>(parent, since));
+    if (!dirty) { return; }
+
+    Transform const& local = const_ecs.get_component<Transform>(entity);
+    glm::mat4 world = glm::compose_transform(local.position, glm::radians(local.rotation), local.scale);
+    if (has_parent) {
+        world = const_ecs.get_component<WorldTransform>(parent).matrix * world;
+    }
+    // Non-const access stamps the WorldTransform, which marks the children of this entity dirty
+    ecs.get_component<WorldTransform>(entity).matrix = world;
+}
+
+void TransformSystem::update(FrameContext& ctx) {
+    ecs::registry& ecs = ctx.ecs;
+
+    remove_stale_world_transforms(ecs, Span<ecs::entity_t const>(removed_transforms.entities.data(), 
+        removed_transforms.entities.size()));
+    removed_transforms.entities.clear();
+
+    // Give new transforms a WorldTransform first. Adding components moves them around in storage,
+    // so this is done up front, and outside of the view.
+    std::vector<ecs::entity_t, ArenaAllocator<ecs::entity_t>> missing(ctx.arena);
+    auto changed = ecs.view_changed<Transform>(last_tick);
+    for (auto it = changed.begin(); it != changed.end(); ++it) {
+        if (!ecs.has_component<WorldTransform>(it.get_entity())) {
+            missing.push_back(it.get_entity());
+        }
+    }
+    for (ecs::entity_t entity : missing) {
+        ecs.add_component<WorldTransform>(entity);
+    }
+
+    ecs::hierarchy const& hierarchy = ecs.get_hierarchy();
+    ThreadPool& pool = ThreadPool::get_default();
+    stl::uint64_t const since = last_tick;
+    for (stl::size_t depth = 0; depth < hierarchy.depth_count(); ++depth) {
+        Span<ecs::entity_t const> level = hierarchy.depth_level(depth);
+        pool.parallel_for(level.size(), level_chunk_size, [&ecs, level, since](stl::size_t begin, stl::size_t end) {
+            for (stl::size_t i = begin; i < end; ++i) {
+                update_world_transform(ecs, level[i], since);
+            }
+        });
+    }
+
+    last_tick = ecs.get_tick();
+}
+
+} // namespace saturn::systems
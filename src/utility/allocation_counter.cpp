@@ -0,0 +1,92 @@
+#include <saturn/utility/allocation_counter.hpp>
+
+#ifdef SATURN_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace saturn {
+
+static std::atomic<stl::uint64_t> heap_allocation_count = 0;
+
+static void* counted_allocate(std::size_t size) {
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void* counted_allocate_aligned(std::size_t size, std::size_t alignment) {
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) { size = 1; }
+#ifdef _MSC_VER
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void free_aligned(void* ptr) {
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+stl::uint64_t get_heap_allocation_count() {
+    return heap_allocation_count.load(std::memory_order_relaxed);
+}
+
+} // namespace saturn
+
+void* operator new(std::size_t size) {
+    if (void* ptr = saturn::counted_allocate(size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* ptr = saturn::counted_allocate(size)) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+    return saturn::counted_allocate(size);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+    return saturn::counted_allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = saturn::counted_allocate_aligned(size, static_cast<std::size_t>(alignment))) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = saturn::counted_allocate_aligned(size, static_cast<std::size_t>(alignment))) { return ptr; }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::nothrow_t const&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::nothrow_t const&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { saturn::free_aligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { saturn::free_aligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { saturn::free_aligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { saturn::free_aligned(ptr); }
+
+#else
+
+namespace saturn {
+
+stl::uint64_t get_heap_allocation_count() {
+    return 0;
+}
+
+} // namespace saturn
+
+#endif
@@ -0,0 +1,73 @@
+#include <saturn/utility/frame_arena.hpp>
+
+#include <stl/assert.hpp>
+
+#include <cstdint>
+
+namespace saturn {
+
+static stl::size_t align_up(stl::size_t value, stl::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+FrameArena::FrameArena(stl::size_t block_size) : block_size(block_size) {
+    block = static_cast<unsigned char*>(::operator new(block_size));
+}
+
+FrameArena::~FrameArena() {
+    reset();
+    ::operator delete(block);
+}
+
+void* FrameArena::allocate(stl::size_t size, stl::size_t alignment) {
+    STL_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+    if (size == 0) { size = 1; }
+
+    // Reserve enough for the worst case padding, so the bump is a single atomic add
+    stl::size_t const reserved = size + alignment - 1;
+    stl::size_t const begin = offset.fetch_add(reserved, std::memory_order_relaxed);
+    if (begin + reserved <= block_size) {
+        std::uintptr_t const address = reinterpret_cast<std::uintptr_t>(block + begin);
+        return reinterpret_cast<void*>(align_up(address, alignment));
+    }
+
+    return allocate_overflow(size, alignment);
+}
+
+void* FrameArena::allocate_overflow(stl::size_t size, stl::size_t alignment) {
+    stl::size_t const reserved = size + alignment - 1;
+    void* memory = ::operator new(reserved);
+
+    std::lock_guard lock(overflow_mutex);
+    overflow_blocks.push_back(memory);
+    overflow_size += reserved;
+    return reinterpret_cast<void*>(align_up(reinterpret_cast<std::uintptr_t>(memory), alignment));
+}
+
+void FrameArena::reset() {
+    for (void* memory : overflow_blocks) {
+        ::operator delete(memory);
+    }
+    overflow_blocks.clear();
+
+    // Grow the block so a frame like this one fits without overflowing
+    if (overflow_size != 0) {
+        stl::size_t new_size = block_size;
+        while (new_size < block_size + overflow_size) {
+            new_size *= 2;
+        }
+        ::operator delete(block);
+        block = static_cast<unsigned char*>(::operator new(new_size));
+        block_size = new_size;
+        overflow_size = 0;
+    }
+
+    offset.store(0, std::memory_order_relaxed);
+}
+
+stl::size_t FrameArena::get_used() const {
+    stl::size_t const used = offset.load(std::memory_order_relaxed);
+    return (used < block_size ? used : block_size) + overflow_size;
+}
+
+} // namespace saturn
@@ -0,0 +1,123 @@
+#include <saturn/utility/mapped_file.hpp>
+
+#include <stl/utility.hpp>
+
+#ifdef _WIN32
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace saturn {
+
+MappedFile::MappedFile(MappedFile&& rhs) {
+    *this = stl::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) {
+    if (this != &rhs) {
+        close();
+        data_ptr = rhs.data_ptr;
+        byte_size = rhs.byte_size;
+        rhs.data_ptr = nullptr;
+        rhs.byte_size = 0;
+#ifdef _WIN32
+        mapping_handle = rhs.mapping_handle;
+        rhs.mapping_handle = nullptr;
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(fs::path const& path) {
+    close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The mapping keeps the file open, so the file handle isn't needed anymore
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) { return false; }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    data_ptr = static_cast<stl::uint8_t const*>(view);
+    byte_size = static_cast<stl::size_t>(file_size.QuadPart);
+    mapping_handle = mapping;
+    return true;
+}
+
+void MappedFile::close() {
+    if (!data_ptr) { return; }
+    UnmapViewOfFile(data_ptr);
+    CloseHandle(mapping_handle);
+    data_ptr = nullptr;
+    byte_size = 0;
+    mapping_handle = nullptr;
+}
+
+void MappedFile::prefetch() const {
+    // PrefetchVirtualMemory isn't available on all supported Windows versions, and
+    // FILE_FLAG_SEQUENTIAL_SCAN already makes the cache manager read ahead.
+}
+
+#else
+
+bool MappedFile::open(fs::path const& path) {
+    close();
+
+    int const fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { return false; }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping keeps its own reference to the file, so the descriptor isn't needed anymore
+    void* const view = mmap(nullptr, static_cast<stl::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) { return false; }
+
+    data_ptr = static_cast<stl::uint8_t const*>(view);
+    byte_size = static_cast<stl::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (!data_ptr) { return; }
+    munmap(const_cast<stl::uint8_t*>(data_ptr), byte_size);
+    data_ptr = nullptr;
+    byte_size = 0;
+}
+
+void MappedFile::prefetch() const {
+    if (!data_ptr) { return; }
+    madvise(const_cast<stl::uint8_t*>(data_ptr), byte_size, MADV_WILLNEED);
+}
+
+#endif
+
+} // namespace saturn
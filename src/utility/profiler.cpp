@@ -0,0 +1,230 @@
+#include <saturn/utility/profiler.hpp>
+#include <saturn/utility/allocation_counter.hpp>
+
+#include <stl/utility.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <unordered_map>
+
+namespace saturn {
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() = default;
+
+stl::uint64_t Profiler::now() {
+    auto const time = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<stl::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+}
+
+void Profiler::begin_frame() {
+    if (!is_enabled()) { return; }
+
+    stl::uint64_t const frame = frame_count.load(std::memory_order_relaxed);
+    frame_starts[frame % frame_history] = now();
+    frame_allocations[frame % frame_history] = get_heap_allocation_count();
+    frame_count.store(frame + 1, std::memory_order_release);
+}
+
+void Profiler::record(char const* name, stl::uint64_t start, stl::uint64_t end) {
+    if (!is_enabled()) { return; }
+
+    ThreadBuffer& buffer = thread_buffer();
+    // Only this thread writes to the buffer, so the counters don't need a read-modify-write
+    stl::uint64_t const head = buffer.head.load(std::memory_order_relaxed);
+    // Pairs with the acquire fence in capture_zones(): a capture that copies any of the stores below also sees
+    // that this zone was reserved.
+    buffer.reserved.store(head + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ZoneSlot& slot = buffer.zones[head % zones_per_thread];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+Profiler::ThreadBufferOwner::~ThreadBufferOwner() {
+    if (buffer) {
+        Profiler::get().free_thread_buffer(buffer);
+    }
+}
+
+Profiler::ThreadBuffer& Profiler::thread_buffer() {
+    // Registered with the profiler on the first zone recorded on a thread, and freed when the thread exits
+    static thread_local ThreadBufferOwner owner;
+    if (owner.buffer) { return *owner.buffer; }
+
+    auto buffer = stl::make_unique<ThreadBuffer>();
+    ThreadBuffer* result = buffer.get();
+    {
+        std::lock_guard lock(threads_mutex);
+        result->thread = next_thread++;
+        threads.push_back(stl::move(buffer));
+    }
+    owner.buffer = result;
+    return *result;
+}
+
+void Profiler::free_thread_buffer(ThreadBuffer* buffer) {
+    // Captures hold the lock while they read a buffer
+    std::lock_guard lock(threads_mutex);
+    auto it = std::find_if(threads.begin(), threads.end(), [buffer](auto const& owned) {
+        return owned.get() == buffer;
+    });
+    if (it != threads.end()) {
+        threads.erase(it);
+    }
+}
+
+char const* Profiler::intern(std::string_view name) {
+    std::lock_guard lock(names_mutex);
+    return names.emplace(name).first->c_str();
+}
+
+void Profiler::set_enabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void Profiler::capture_zones(stl::vector<ProfileZone>& zones) const {
+    std::lock_guard lock(threads_mutex);
+    for (auto const& buffer : threads) {
+        // Only zones below the head are completely written
+        stl::uint64_t const head = buffer->head.load(std::memory_order_acquire);
+        stl::uint64_t const first = head > zones_per_thread ? head - zones_per_thread : 0;
+
+        stl::size_t const offset = zones.size();
+        for (stl::uint64_t i = first; i < head; ++i) {
+            ZoneSlot const& slot = buffer->zones[i % zones_per_thread];
+            zones.push_back(ProfileZone{ slot.name.load(std::memory_order_relaxed), 
+                slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed), buffer->thread });
+        }
+
+        // The owning thread kept recording while we copied. Drop the zones whose slots it may have started to
+        // overwrite, their copies can mix fields of two zones.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        stl::uint64_t const reserved = buffer->reserved.load(std::memory_order_relaxed);
+        stl::uint64_t const overwritten = reserved > zones_per_thread ? reserved - zones_per_thread : 0;
+        if (overwritten > first) {
+            stl::size_t const dropped = static_cast<stl::size_t>(std::min(overwritten, head) - first);
+            std::move(zones.begin() + offset + dropped, zones.end(), zones.begin() + offset);
+            zones.resize(zones.size() - dropped);
+        }
+    }
+}
+
+void Profiler::capture_frames(stl::vector<stl::uint64_t>& starts) const {
+    stl::uint64_t const count = frame_count.load(std::memory_order_acquire);
+    stl::uint64_t const first = count > frame_history ? count - frame_history : 0;
+    for (stl::uint64_t i = first; i < count; ++i) {
+        starts.push_back(frame_starts[i % frame_history]);
+    }
+}
+
+void Profiler::capture_frame_allocations(stl::vector<stl::uint64_t>& allocation_counts) const {
+    stl::uint64_t const count = frame_count.load(std::memory_order_acquire);
+    stl::uint64_t const first = count > frame_history ? count - frame_history : 0;
+    for (stl::uint64_t i = first; i < count; ++i) {
+        allocation_counts.push_back(frame_allocations[i % frame_history]);
+    }
+}
+
+static void write_json_string(std::ofstream& out, char const* str) {
+    out << '"';
+    for (; *str; ++str) {
+        char const c = *str;
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+bool Profiler::write_chrome_trace(fs::path const& path) const {
+    stl::vector<ProfileZone> zones;
+    capture_zones(zones);
+
+    std::ofstream out(path);
+    if (!out) { return false; }
+
+    stl::uint64_t origin = static_cast<stl::uint64_t>(-1);
+    stl::uint32_t thread_count = 0;
+    for (ProfileZone const& zone : zones) {
+        origin = std::min(origin, zone.start);
+        thread_count = std::max(thread_count, zone.thread + 1);
+    }
+
+    // Timestamps in the trace format are in microseconds
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (stl::uint32_t thread = 0; thread < thread_count; ++thread) {
+        if (!first) { out << ",\n"; }
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread
+            << ",\"args\":{\"name\":\"Thread " << thread << "\"}}";
+    }
+
+    out.precision(3);
+    out << std::fixed;
+    for (ProfileZone const& zone : zones) {
+        if (!first) { out << ",\n"; }
+        first = false;
+        out << "{\"name\":";
+        write_json_string(out, zone.name);
+        out << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << zone.thread
+            << ",\"ts\":" << static_cast<double>(zone.start - origin) / 1000.0
+            << ",\"dur\":" << static_cast<double>(zone.end - zone.start) / 1000.0 << "}";
+    }
+    out << "\n]}\n";
+
+    return static_cast<bool>(out);
+}
+
+void summarize_zones(stl::vector<ProfileZone> const& zones, stl::vector<stl::uint64_t> const& frame_starts,
+    stl::vector<ZoneSummary>& summaries) {
+
+    summaries.clear();
+    // The last frame start belongs to a frame that is still running
+    if (frame_starts.size() < 2) { return; }
+    stl::uint64_t const begin = frame_starts.front();
+    stl::uint64_t const end = frame_starts.back();
+    double const frame_count = static_cast<double>(frame_starts.size() - 1);
+
+    struct Totals {
+        stl::uint64_t total = 0;
+        stl::uint64_t max = 0;
+        stl::size_t calls = 0;
+    };
+    std::unordered_map<std::string_view, Totals> totals;
+    for (ProfileZone const& zone : zones) {
+        if (zone.start < begin || zone.start >= end) { continue; }
+        Totals& entry = totals[zone.name];
+        stl::uint64_t const duration = zone.end - zone.start;
+        entry.total += duration;
+        entry.max = std::max(entry.max, duration);
+        ++entry.calls;
+    }
+
+    for (auto const& [name, entry] : totals) {
+        ZoneSummary summary;
+        summary.name = name;
+        summary.average_ms = static_cast<double>(entry.total) / 1e6 / frame_count;
+        summary.max_ms = static_cast<double>(entry.max) / 1e6;
+        summary.calls_per_frame = static_cast<double>(entry.calls) / frame_count;
+        summaries.push_back(summary);
+    }
+    std::sort(summaries.begin(), summaries.end(), [](ZoneSummary const& lhs, ZoneSummary const& rhs) {
+        return lhs.average_ms > rhs.average_ms;
+    });
+}
+
+} // namespace saturn
@@ -0,0 +1,195 @@
+#include <saturn/utility/thread_pool.hpp>
+
+#include <stl/assert.hpp>
+#include <stl/utility.hpp>
+
+#include <algorithm>
+
+namespace saturn {
+
+// Index of the queue belonging to the current thread. External threads use the last queue.
+static thread_local stl::size_t current_queue_index = static_cast<stl::size_t>(-1);
+
+ThreadPool::ThreadPool(stl::size_t thread_count) {
+    if (thread_count == 0) { thread_count = 1; }
+
+    stl::size_t const worker_count = thread_count - 1;
+    for (stl::size_t i = 0; i < worker_count + 1; ++i) {
+        queues.push_back(stl::make_unique<WorkQueue>());
+    }
+
+    for (stl::size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back([this, i]() { worker_main(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(sleep_mutex);
+        stop = true;
+    }
+    wake_up.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::get_default() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::submit(WaitGroup& group, Task task) {
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+
+    TaskEntry entry { stl::move(task), &group };
+    if (deterministic || workers.empty()) {
+        run(entry);
+        return;
+    }
+
+    // Distribute round-robin over the worker queues, the other workers will steal if the load is uneven
+    stl::size_t const index = next_queue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    {
+        std::lock_guard lock(queues[index]->mutex);
+        queues[index]->push_back(stl::move(entry));
+    }
+    {
+        // Taking the lock avoids missing the wakeup between a worker's check and its wait
+        std::lock_guard lock(sleep_mutex);
+        queued_tasks.fetch_add(1, std::memory_order_release);
+    }
+    wake_up.notify_one();
+}
+
+void ThreadPool::wait(WaitGroup& group) {
+    while (!group.done()) {
+        // Help out instead of blocking. This also makes nested parallel_for calls from inside tasks safe.
+        if (!run_pending_task()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool ThreadPool::run_pending_task() {
+    stl::size_t const own_queue =
+        current_queue_index < queues.size() ? current_queue_index : queues.size() - 1;
+    return try_run_one(own_queue);
+}
+
+void ThreadPool::parallel_for(stl::size_t count, stl::size_t chunk_size,
+    std::function<void(stl::size_t, stl::size_t)> const& f) {
+
+    if (count == 0) { return; }
+    if (chunk_size == 0) { chunk_size = 1; }
+
+    if (deterministic || workers.empty() || count <= chunk_size) {
+        for (stl::size_t begin = 0; begin < count; begin += chunk_size) {
+            f(begin, std::min(begin + chunk_size, count));
+        }
+        return;
+    }
+
+    // The tasks capture a reference to this and their start index, which is small enough for the inline storage
+    // of std::function, so submitting a chunk doesn't allocate
+    struct Range {
+        std::function<void(stl::size_t, stl::size_t)> const& f;
+        stl::size_t chunk_size;
+        stl::size_t count;
+    } const range { f, chunk_size, count };
+
+    WaitGroup group;
+    for (stl::size_t begin = 0; begin < count; begin += chunk_size) {
+        submit(group, [&range, begin]() { range.f(begin, std::min(begin + range.chunk_size, range.count)); });
+    }
+    wait(group);
+}
+
+void ThreadPool::set_deterministic(bool value) {
+    deterministic = value;
+}
+
+bool ThreadPool::is_deterministic() const {
+    return deterministic;
+}
+
+stl::size_t ThreadPool::thread_count() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::worker_main(stl::size_t index) {
+    current_queue_index = index;
+    while (true) {
+        if (try_run_one(index)) { continue; }
+
+        std::unique_lock lock(sleep_mutex);
+        wake_up.wait(lock, [this]() { return stop || queued_tasks.load(std::memory_order_acquire) > 0; });
+        if (stop) { return; }
+    }
+}
+
+bool ThreadPool::try_pop(stl::size_t index, TaskEntry& entry) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard lock(queue.mutex);
+    if (queue.empty()) { return false; }
+    entry = queue.pop_front();
+    return true;
+}
+
+bool ThreadPool::try_steal(stl::size_t thief, TaskEntry& entry) {
+    // Start at the neighbour of the thief so not every thread hammers the same victim
+    for (stl::size_t i = 1; i < queues.size(); ++i) {
+        WorkQueue& victim = *queues[(thief + i) % queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (victim.empty()) { continue; }
+        entry = victim.pop_back();
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::try_run_one(stl::size_t index) {
+    TaskEntry entry;
+    if (!try_pop(index, entry) && !try_steal(index, entry)) {
+        return false;
+    }
+    queued_tasks.fetch_sub(1, std::memory_order_acq_rel);
+    run(entry);
+    return true;
+}
+
+void ThreadPool::WorkQueue::push_back(TaskEntry&& entry) {
+    if (count == slots.size()) {
+        // Unwrap into a larger buffer so the tasks stay in order
+        stl::vector<TaskEntry> grown;
+        grown.resize(std::max<stl::size_t>(slots.size() * 2, 64));
+        for (stl::size_t i = 0; i < count; ++i) {
+            grown[i] = stl::move(slots[(head + i) % slots.size()]);
+        }
+        slots = stl::move(grown);
+        head = 0;
+    }
+    slots[(head + count) % slots.size()] = stl::move(entry);
+    ++count;
+}
+
+ThreadPool::TaskEntry ThreadPool::WorkQueue::pop_front() {
+    STL_ASSERT(count > 0, "Popping from an empty queue");
+    TaskEntry entry = stl::move(slots[head]);
+    head = (head + 1) % slots.size();
+    --count;
+    return entry;
+}
+
+ThreadPool::TaskEntry ThreadPool::WorkQueue::pop_back() {
+    STL_ASSERT(count > 0, "Popping from an empty queue");
+    --count;
+    return stl::move(slots[(head + count) % slots.size()]);
+}
+
+void ThreadPool::run(TaskEntry& entry) {
+    entry.task();
+    entry.group->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+} // namespace saturn